@@ -0,0 +1,965 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * mmcli -- Control modem status & access information from the command line
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#define _LIBMM_INSIDE_MMCLI
+#include "libmm-glib.h"
+
+#include "mmcli.h"
+#include "mmcli-common.h"
+
+/* Operations, one per argument or per stdin line:
+ *
+ *   list                                  -> paths of all modems
+ *   modem  <PATH|INDEX> [INTERFACE...]    -> modem properties, optionally
+ *                                            only for the given interfaces
+ *                                            (e.g. "Modem3gpp", "Signal")
+ *   bearer <PATH|INDEX>                   -> bearer properties
+ *   sim    <PATH|INDEX>                   -> SIM properties
+ *   sms    <PATH|INDEX>                   -> SMS properties
+ *
+ * Modem properties are taken from the object manager cache; bearer, SIM and
+ * SMS ones are all requested at the same time, each with a single GetAll().
+ */
+
+typedef enum {
+    OPERATION_TYPE_UNKNOWN,
+    OPERATION_TYPE_LIST,
+    OPERATION_TYPE_MODEM,
+    OPERATION_TYPE_BEARER,
+    OPERATION_TYPE_SIM,
+    OPERATION_TYPE_SMS,
+} OperationType;
+
+typedef struct {
+    gchar *str;
+    OperationType type;
+    gchar *path;
+    gchar **interfaces;
+    /* JSON members to report, either these or the error */
+    GString *members;
+    GError *error;
+} Operation;
+
+/* Context */
+typedef struct {
+    MMManager *manager;
+    GCancellable *cancellable;
+    GDBusConnection *connection;
+    GPtrArray *operations;
+    guint n_pending;
+} Context;
+static Context *ctx;
+
+/* Options */
+static gboolean batch_flag;
+static gboolean monitor_flag;
+
+static GOptionEntry entries[] = {
+    { "batch", 0, 0, G_OPTION_ARG_NONE, &batch_flag,
+      "Run the operations given as arguments (or one per line in stdin) and print the results as JSON",
+      NULL
+    },
+    { "monitor", 0, 0, G_OPTION_ARG_NONE, &monitor_flag,
+      "Print modem additions, removals and property changes as JSON lines",
+      NULL
+    },
+    { NULL }
+};
+
+GOptionGroup *
+mmcli_batch_get_option_group (void)
+{
+    GOptionGroup *group;
+
+    group = g_option_group_new ("batch",
+                                "Batch options",
+                                "Show batch options",
+                                NULL,
+                                NULL);
+    g_option_group_add_entries (group, entries);
+
+    return group;
+}
+
+gboolean
+mmcli_batch_options_enabled (void)
+{
+    static guint n_actions = 0;
+    static gboolean checked = FALSE;
+
+    if (checked)
+        return !!n_actions;
+
+    n_actions = (batch_flag +
+                 monitor_flag);
+
+    if (n_actions > 1) {
+        g_printerr ("error: too many batch actions requested\n");
+        exit (EXIT_FAILURE);
+    }
+
+    if (n_actions)
+        mmcli_force_async_operation ();
+
+    checked = TRUE;
+    return !!n_actions;
+}
+
+static void
+operation_free (Operation *operation)
+{
+    if (operation->members)
+        g_string_free (operation->members, TRUE);
+    if (operation->error)
+        g_error_free (operation->error);
+    g_strfreev (operation->interfaces);
+    g_free (operation->path);
+    g_free (operation->str);
+    g_slice_free (Operation, operation);
+}
+
+static void
+context_free (Context *ctx)
+{
+    if (!ctx)
+        return;
+
+    if (ctx->operations)
+        g_ptr_array_unref (ctx->operations);
+    if (ctx->connection)
+        g_object_unref (ctx->connection);
+    if (ctx->manager)
+        g_object_unref (ctx->manager);
+    if (ctx->cancellable)
+        g_object_unref (ctx->cancellable);
+    g_free (ctx);
+}
+
+void
+mmcli_batch_shutdown (void)
+{
+    context_free (ctx);
+}
+
+/*****************************************************************************/
+/* JSON output */
+
+typedef struct {
+    gchar *key;
+    GVariant *value;
+} JsonMember;
+
+static void append_json_variant (GString *str,
+                                 GVariant *value);
+
+static void
+append_json_string (GString *str,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    g_string_append_c (str, '"');
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (str, "\\\"");
+            break;
+        case '\\':
+            g_string_append (str, "\\\\");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf (str, "\\u%04x", (guint) (guchar) *p);
+            else
+                g_string_append_c (str, *p);
+            break;
+        }
+    }
+    g_string_append_c (str, '"');
+}
+
+static gint
+json_member_cmp (const JsonMember *a,
+                 const JsonMember *b)
+{
+    return strcmp (a->key, b->key);
+}
+
+static void
+append_json_members (GString *str,
+                     GArray *members)
+{
+    guint i;
+
+    /* Always in the same order, whatever the one in which we got them */
+    g_array_sort (members, (GCompareFunc)json_member_cmp);
+
+    g_string_append_c (str, '{');
+    for (i = 0; i < members->len; i++) {
+        JsonMember *member = &g_array_index (members, JsonMember, i);
+
+        if (i > 0)
+            g_string_append_c (str, ',');
+        append_json_string (str, member->key);
+        g_string_append_c (str, ':');
+        append_json_variant (str, member->value);
+        g_variant_unref (member->value);
+        g_free (member->key);
+    }
+    g_string_append_c (str, '}');
+
+    g_array_unref (members);
+}
+
+static void
+append_json_dict (GString *str,
+                  GVariant *dict)
+{
+    GArray *members;
+    GVariantIter iter;
+    GVariant *entry;
+
+    members = g_array_sized_new (FALSE, FALSE, sizeof (JsonMember), g_variant_n_children (dict));
+
+    g_variant_iter_init (&iter, dict);
+    while ((entry = g_variant_iter_next_value (&iter)) != NULL) {
+        JsonMember member;
+        GVariant *key;
+
+        /* JSON keys are always strings */
+        key = g_variant_get_child_value (entry, 0);
+        if (g_variant_is_of_type (key, G_VARIANT_TYPE_STRING) ||
+            g_variant_is_of_type (key, G_VARIANT_TYPE_OBJECT_PATH) ||
+            g_variant_is_of_type (key, G_VARIANT_TYPE_SIGNATURE))
+            member.key = g_variant_dup_string (key, NULL);
+        else
+            member.key = g_variant_print (key, FALSE);
+        member.value = g_variant_get_child_value (entry, 1);
+        g_array_append_val (members, member);
+
+        g_variant_unref (key);
+        g_variant_unref (entry);
+    }
+
+    append_json_members (str, members);
+}
+
+static void
+append_json_variant (GString *str,
+                     GVariant *value)
+{
+    switch (g_variant_classify (value)) {
+    case G_VARIANT_CLASS_BOOLEAN:
+        g_string_append (str, g_variant_get_boolean (value) ? "true" : "false");
+        break;
+    case G_VARIANT_CLASS_BYTE:
+        g_string_append_printf (str, "%u", (guint) g_variant_get_byte (value));
+        break;
+    case G_VARIANT_CLASS_INT16:
+        g_string_append_printf (str, "%d", (gint) g_variant_get_int16 (value));
+        break;
+    case G_VARIANT_CLASS_UINT16:
+        g_string_append_printf (str, "%u", (guint) g_variant_get_uint16 (value));
+        break;
+    case G_VARIANT_CLASS_INT32:
+        g_string_append_printf (str, "%d", g_variant_get_int32 (value));
+        break;
+    case G_VARIANT_CLASS_UINT32:
+        g_string_append_printf (str, "%u", g_variant_get_uint32 (value));
+        break;
+    case G_VARIANT_CLASS_HANDLE:
+        g_string_append_printf (str, "%d", g_variant_get_handle (value));
+        break;
+    case G_VARIANT_CLASS_INT64:
+        g_string_append_printf (str, "%" G_GINT64_FORMAT, g_variant_get_int64 (value));
+        break;
+    case G_VARIANT_CLASS_UINT64:
+        g_string_append_printf (str, "%" G_GUINT64_FORMAT, g_variant_get_uint64 (value));
+        break;
+    case G_VARIANT_CLASS_DOUBLE: {
+        gdouble d;
+        gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+        /* No NaN nor infinity in JSON */
+        d = g_variant_get_double (value);
+        if (isnan (d) || isinf (d)) {
+            g_string_append (str, "null");
+            break;
+        }
+
+        /* Prefer the short representation (e.g. 18.2 instead of
+         * 18.199999999999999), as long as it reads back as the same value */
+        g_ascii_formatd (buffer, sizeof (buffer), "%.15g", d);
+        if (g_ascii_strtod (buffer, NULL) != d)
+            g_ascii_formatd (buffer, sizeof (buffer), "%.17g", d);
+        g_string_append (str, buffer);
+        break;
+    }
+    case G_VARIANT_CLASS_STRING:
+    case G_VARIANT_CLASS_OBJECT_PATH:
+    case G_VARIANT_CLASS_SIGNATURE:
+        append_json_string (str, g_variant_get_string (value, NULL));
+        break;
+    case G_VARIANT_CLASS_VARIANT: {
+        GVariant *child;
+
+        child = g_variant_get_variant (value);
+        append_json_variant (str, child);
+        g_variant_unref (child);
+        break;
+    }
+    case G_VARIANT_CLASS_MAYBE: {
+        GVariant *child;
+
+        child = g_variant_get_maybe (value);
+        if (child) {
+            append_json_variant (str, child);
+            g_variant_unref (child);
+        } else
+            g_string_append (str, "null");
+        break;
+    }
+    case G_VARIANT_CLASS_ARRAY:
+        if (g_variant_type_is_dict_entry (g_variant_type_element (g_variant_get_type (value)))) {
+            append_json_dict (str, value);
+            break;
+        }
+        /* Other arrays, just as tuples */
+        /* Fall through */
+    case G_VARIANT_CLASS_TUPLE:
+    case G_VARIANT_CLASS_DICT_ENTRY: {
+        GVariantIter iter;
+        GVariant *child;
+        gboolean first = TRUE;
+
+        g_string_append_c (str, '[');
+        g_variant_iter_init (&iter, value);
+        while ((child = g_variant_iter_next_value (&iter)) != NULL) {
+            if (!first)
+                g_string_append_c (str, ',');
+            first = FALSE;
+            append_json_variant (str, child);
+            g_variant_unref (child);
+        }
+        g_string_append_c (str, ']');
+        break;
+    }
+    default:
+        g_warn_if_reached ();
+        g_string_append (str, "null");
+        break;
+    }
+}
+
+static void
+append_json_proxy_properties (GString *str,
+                              GDBusProxy *proxy)
+{
+    GArray *members;
+    gchar **names;
+    guint i;
+
+    members = g_array_new (FALSE, FALSE, sizeof (JsonMember));
+
+    names = g_dbus_proxy_get_cached_property_names (proxy);
+    for (i = 0; names && names[i]; i++) {
+        JsonMember member;
+
+        member.value = g_dbus_proxy_get_cached_property (proxy, names[i]);
+        if (!member.value)
+            continue;
+        member.key = g_strdup (names[i]);
+        g_array_append_val (members, member);
+    }
+    g_strfreev (names);
+
+    append_json_members (str, members);
+}
+
+static gboolean
+interface_requested (const gchar *name,
+                     gchar **interfaces)
+{
+    guint i;
+
+    if (!interfaces || !interfaces[0])
+        return TRUE;
+
+    /* Either the full name or its last components, e.g. "Modem3gpp.Ussd" */
+    for (i = 0; interfaces[i]; i++) {
+        if (g_str_equal (name, interfaces[i]) ||
+            (g_str_has_suffix (name, interfaces[i]) &&
+             name[strlen (name) - strlen (interfaces[i]) - 1] == '.'))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static gint
+interface_cmp (GDBusProxy *a,
+               GDBusProxy *b)
+{
+    return strcmp (g_dbus_proxy_get_interface_name (a),
+                   g_dbus_proxy_get_interface_name (b));
+}
+
+static void
+append_json_object_interfaces (GString *str,
+                               GDBusObject *object,
+                               gchar **requested)
+{
+    GList *interfaces;
+    GList *l;
+    gboolean first = TRUE;
+
+    interfaces = g_dbus_object_get_interfaces (object);
+    interfaces = g_list_sort (interfaces, (GCompareFunc)interface_cmp);
+
+    g_string_append_c (str, '{');
+    for (l = interfaces; l; l = g_list_next (l)) {
+        GDBusProxy *proxy = G_DBUS_PROXY (l->data);
+
+        if (!interface_requested (g_dbus_proxy_get_interface_name (proxy), requested))
+            continue;
+
+        if (!first)
+            g_string_append_c (str, ',');
+        first = FALSE;
+        append_json_string (str, g_dbus_proxy_get_interface_name (proxy));
+        g_string_append_c (str, ':');
+        append_json_proxy_properties (str, proxy);
+    }
+    g_string_append_c (str, '}');
+
+    g_list_free_full (interfaces, (GDestroyNotify) g_object_unref);
+}
+
+static gint
+object_cmp (GDBusObject *a,
+            GDBusObject *b)
+{
+    return strcmp (g_dbus_object_get_object_path (a),
+                   g_dbus_object_get_object_path (b));
+}
+
+static GList *
+get_sorted_modems (MMManager *manager)
+{
+    GList *modems;
+
+    modems = g_dbus_object_manager_get_objects (G_DBUS_OBJECT_MANAGER (manager));
+    return g_list_sort (modems, (GCompareFunc)object_cmp);
+}
+
+/*****************************************************************************/
+/* Batch operations */
+
+static gchar *
+build_path (const gchar *prefix,
+            const gchar *path_or_index)
+{
+    if (g_str_has_prefix (path_or_index, prefix))
+        return g_strdup (path_or_index);
+    if (g_ascii_isdigit (path_or_index[0]))
+        return g_strdup_printf ("%s/%s", prefix, path_or_index);
+    return NULL;
+}
+
+static Operation *
+operation_new (const gchar *str)
+{
+    Operation *operation;
+    gchar **argv = NULL;
+    gint argc = 0;
+    const gchar *prefix = NULL;
+
+    operation = g_slice_new0 (Operation);
+    operation->str = g_strdup (str);
+
+    if (!g_shell_parse_argv (str, &argc, &argv, &operation->error))
+        return operation;
+
+    if (g_str_equal (argv[0], "list") && argc == 1)
+        operation->type = OPERATION_TYPE_LIST;
+    else if (g_str_equal (argv[0], "modem") && argc >= 2) {
+        operation->type = OPERATION_TYPE_MODEM;
+        prefix = MM_DBUS_MODEM_PREFIX;
+    } else if (g_str_equal (argv[0], "bearer") && argc == 2) {
+        operation->type = OPERATION_TYPE_BEARER;
+        prefix = MM_DBUS_BEARER_PREFIX;
+    } else if (g_str_equal (argv[0], "sim") && argc == 2) {
+        operation->type = OPERATION_TYPE_SIM;
+        prefix = MM_DBUS_SIM_PREFIX;
+    } else if (g_str_equal (argv[0], "sms") && argc == 2) {
+        operation->type = OPERATION_TYPE_SMS;
+        prefix = MM_DBUS_SMS_PREFIX;
+    } else {
+        operation->error = g_error_new (G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                        "invalid operation");
+        g_strfreev (argv);
+        return operation;
+    }
+
+    if (prefix) {
+        operation->path = build_path (prefix, argv[1]);
+        if (!operation->path)
+            operation->error = g_error_new (G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                                            "invalid path or index string specified: '%s'",
+                                            argv[1]);
+    }
+
+    if (operation->type == OPERATION_TYPE_MODEM && argc > 2)
+        operation->interfaces = g_strdupv (&argv[2]);
+
+    g_strfreev (argv);
+    return operation;
+}
+
+static gchar **
+read_operations (void)
+{
+    GIOChannel *channel;
+    GPtrArray *operations;
+    GIOStatus status;
+    gchar *line;
+    GError *error = NULL;
+
+    operations = g_ptr_array_new ();
+
+    channel = g_io_channel_unix_new (fileno (stdin));
+    g_io_channel_set_encoding (channel, NULL, NULL);
+    while ((status = g_io_channel_read_line (channel, &line, NULL, NULL, &error)) == G_IO_STATUS_NORMAL) {
+        /* Skip empty lines and comments */
+        g_strstrip (line);
+        if (!line[0] || line[0] == '#') {
+            g_free (line);
+            continue;
+        }
+        g_ptr_array_add (operations, line);
+    }
+    g_io_channel_unref (channel);
+
+    if (status == G_IO_STATUS_ERROR) {
+        g_printerr ("error: couldn't read operations: '%s'\n",
+                    error ? error->message : "unknown error");
+        exit (EXIT_FAILURE);
+    }
+
+    g_ptr_array_add (operations, NULL);
+    return (gchar **) g_ptr_array_free (operations, FALSE);
+}
+
+static void
+print_results (void)
+{
+    GString *str;
+    guint n_failed = 0;
+    guint i;
+
+    str = g_string_new ("[");
+    for (i = 0; i < ctx->operations->len; i++) {
+        Operation *operation = g_ptr_array_index (ctx->operations, i);
+
+        g_string_append (str, i > 0 ? ",\n{\"operation\":" : "\n{\"operation\":");
+        append_json_string (str, operation->str);
+        if (operation->error) {
+            g_dbus_error_strip_remote_error (operation->error);
+            g_string_append (str, ",\"error\":");
+            append_json_string (str, operation->error->message);
+            n_failed++;
+        } else {
+            g_string_append_c (str, ',');
+            g_string_append_len (str, operation->members->str, operation->members->len);
+        }
+        g_string_append_c (str, '}');
+    }
+    g_string_append (str, "\n]\n");
+
+    g_print ("%s", str->str);
+    fflush (stdout);
+    g_string_free (str, TRUE);
+
+    if (n_failed > 0)
+        exit (EXIT_FAILURE);
+}
+
+static void
+operation_completed (void)
+{
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending > 0)
+        return;
+
+    print_results ();
+    mmcli_async_operation_done ();
+}
+
+static void
+run_list (Operation *operation)
+{
+    GList *modems;
+    GList *l;
+
+    operation->members = g_string_new ("\"modems\":[");
+    modems = get_sorted_modems (ctx->manager);
+    for (l = modems; l; l = g_list_next (l)) {
+        if (l != modems)
+            g_string_append_c (operation->members, ',');
+        append_json_string (operation->members,
+                            g_dbus_object_get_object_path (G_DBUS_OBJECT (l->data)));
+    }
+    g_string_append_c (operation->members, ']');
+    g_list_free_full (modems, (GDestroyNotify) g_object_unref);
+}
+
+static void
+run_modem (Operation *operation)
+{
+    GDBusObject *modem;
+
+    modem = g_dbus_object_manager_get_object (G_DBUS_OBJECT_MANAGER (ctx->manager),
+                                              operation->path);
+    if (!modem) {
+        operation->error = g_error_new (G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                                        "couldn't find modem at '%s'",
+                                        operation->path);
+        return;
+    }
+
+    operation->members = g_string_new ("\"path\":");
+    append_json_string (operation->members, operation->path);
+    g_string_append (operation->members, ",\"interfaces\":");
+    append_json_object_interfaces (operation->members, modem, operation->interfaces);
+    g_object_unref (modem);
+}
+
+static const gchar *
+get_operation_interface (Operation *operation)
+{
+    switch (operation->type) {
+    case OPERATION_TYPE_BEARER:
+        return MM_DBUS_INTERFACE_BEARER;
+    case OPERATION_TYPE_SIM:
+        return MM_DBUS_INTERFACE_SIM;
+    case OPERATION_TYPE_SMS:
+        return MM_DBUS_INTERFACE_SMS;
+    default:
+        g_assert_not_reached ();
+        return NULL;
+    }
+}
+
+static void
+get_all_ready (GDBusConnection *connection,
+               GAsyncResult *res,
+               Operation *operation)
+{
+    GVariant *result;
+    GVariant *properties;
+
+    result = g_dbus_connection_call_finish (connection, res, &operation->error);
+    if (result) {
+        operation->members = g_string_new ("\"path\":");
+        append_json_string (operation->members, operation->path);
+        g_string_append (operation->members, ",\"interfaces\":{");
+        append_json_string (operation->members, get_operation_interface (operation));
+        g_string_append_c (operation->members, ':');
+        properties = g_variant_get_child_value (result, 0);
+        append_json_dict (operation->members, properties);
+        g_string_append_c (operation->members, '}');
+        g_variant_unref (properties);
+        g_variant_unref (result);
+    }
+
+    operation_completed ();
+}
+
+static void
+run_get_all (Operation *operation)
+{
+    ctx->n_pending++;
+    g_dbus_connection_call (ctx->connection,
+                            MM_DBUS_SERVICE,
+                            operation->path,
+                            "org.freedesktop.DBus.Properties",
+                            "GetAll",
+                            g_variant_new ("(s)", get_operation_interface (operation)),
+                            G_VARIANT_TYPE ("(a{sv})"),
+                            G_DBUS_CALL_FLAGS_NONE,
+                            g_dbus_proxy_get_default_timeout (mm_manager_peek_proxy (ctx->manager)),
+                            ctx->cancellable,
+                            (GAsyncReadyCallback)get_all_ready,
+                            operation);
+}
+
+static void
+run_operations (void)
+{
+    guint i;
+
+    /* Hold a reference so that we don't finish before all are launched */
+    ctx->n_pending = 1;
+
+    for (i = 0; i < ctx->operations->len; i++) {
+        Operation *operation = g_ptr_array_index (ctx->operations, i);
+
+        if (operation->error)
+            continue;
+
+        switch (operation->type) {
+        case OPERATION_TYPE_LIST:
+            run_list (operation);
+            break;
+        case OPERATION_TYPE_MODEM:
+            run_modem (operation);
+            break;
+        case OPERATION_TYPE_BEARER:
+        case OPERATION_TYPE_SIM:
+        case OPERATION_TYPE_SMS:
+            run_get_all (operation);
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+    }
+
+    operation_completed ();
+}
+
+/*****************************************************************************/
+/* Monitoring */
+
+static GString *
+monitor_line_new (const gchar *event,
+                  GDBusObject *object)
+{
+    GString *line;
+
+    line = g_string_new (NULL);
+    g_string_append_printf (line, "{\"timestamp\":%" G_GINT64_FORMAT ",\"event\":",
+                            g_get_real_time ());
+    append_json_string (line, event);
+    g_string_append (line, ",\"path\":");
+    append_json_string (line, g_dbus_object_get_object_path (object));
+    return line;
+}
+
+static void
+monitor_line_print (GString *line)
+{
+    g_string_append (line, "}\n");
+    g_print ("%s", line->str);
+    fflush (stdout);
+    g_string_free (line, TRUE);
+}
+
+static void
+monitor_modem_added (MMManager *manager,
+                     GDBusObject *modem)
+{
+    GString *line;
+
+    line = monitor_line_new ("modem-added", modem);
+    g_string_append (line, ",\"interfaces\":");
+    append_json_object_interfaces (line, modem, NULL);
+    monitor_line_print (line);
+}
+
+static void
+monitor_modem_removed (MMManager *manager,
+                       GDBusObject *modem)
+{
+    monitor_line_print (monitor_line_new ("modem-removed", modem));
+}
+
+static void
+monitor_interface_added (MMManager *manager,
+                         GDBusObject *modem,
+                         GDBusProxy *proxy)
+{
+    GString *line;
+
+    line = monitor_line_new ("interface-added", modem);
+    g_string_append (line, ",\"interface\":");
+    append_json_string (line, g_dbus_proxy_get_interface_name (proxy));
+    g_string_append (line, ",\"properties\":");
+    append_json_proxy_properties (line, proxy);
+    monitor_line_print (line);
+}
+
+static void
+monitor_interface_removed (MMManager *manager,
+                           GDBusObject *modem,
+                           GDBusProxy *proxy)
+{
+    GString *line;
+
+    line = monitor_line_new ("interface-removed", modem);
+    g_string_append (line, ",\"interface\":");
+    append_json_string (line, g_dbus_proxy_get_interface_name (proxy));
+    monitor_line_print (line);
+}
+
+static void
+monitor_properties_changed (MMManager *manager,
+                            GDBusObjectProxy *modem,
+                            GDBusProxy *proxy,
+                            GVariant *changed_properties,
+                            const gchar *const *invalidated_properties)
+{
+    GString *line;
+    guint i;
+
+    line = monitor_line_new ("properties-changed", G_DBUS_OBJECT (modem));
+    g_string_append (line, ",\"interface\":");
+    append_json_string (line, g_dbus_proxy_get_interface_name (proxy));
+    g_string_append (line, ",\"properties\":");
+    append_json_dict (line, changed_properties);
+    if (invalidated_properties && invalidated_properties[0]) {
+        g_string_append (line, ",\"invalidated\":[");
+        for (i = 0; invalidated_properties[i]; i++) {
+            if (i > 0)
+                g_string_append_c (line, ',');
+            append_json_string (line, invalidated_properties[i]);
+        }
+        g_string_append_c (line, ']');
+    }
+    monitor_line_print (line);
+}
+
+static void
+cancelled (GCancellable *cancellable)
+{
+    mmcli_async_operation_done ();
+}
+
+static void
+run_monitor (void)
+{
+    GList *modems;
+    GList *l;
+
+    g_signal_connect (ctx->manager,
+                      "object-added",
+                      G_CALLBACK (monitor_modem_added),
+                      NULL);
+    g_signal_connect (ctx->manager,
+                      "object-removed",
+                      G_CALLBACK (monitor_modem_removed),
+                      NULL);
+    g_signal_connect (ctx->manager,
+                      "interface-added",
+                      G_CALLBACK (monitor_interface_added),
+                      NULL);
+    g_signal_connect (ctx->manager,
+                      "interface-removed",
+                      G_CALLBACK (monitor_interface_removed),
+                      NULL);
+    g_signal_connect (ctx->manager,
+                      "interface-proxy-properties-changed",
+                      G_CALLBACK (monitor_properties_changed),
+                      NULL);
+
+    /* Report the modems we already have as just added */
+    modems = get_sorted_modems (ctx->manager);
+    for (l = modems; l; l = g_list_next (l))
+        monitor_modem_added (ctx->manager, G_DBUS_OBJECT (l->data));
+    g_list_free_full (modems, (GDestroyNotify) g_object_unref);
+
+    /* If we get cancelled, operation done */
+    g_cancellable_connect (ctx->cancellable,
+                           G_CALLBACK (cancelled),
+                           NULL,
+                           NULL);
+}
+
+/*****************************************************************************/
+
+static void
+get_manager_ready (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      none)
+{
+    ctx->manager = mmcli_get_manager_finish (result);
+
+    /* Setup operation timeout */
+    mmcli_force_operation_timeout (mm_manager_peek_proxy (ctx->manager));
+
+    if (monitor_flag) {
+        run_monitor ();
+        return;
+    }
+
+    if (batch_flag) {
+        run_operations ();
+        return;
+    }
+
+    g_warn_if_reached ();
+}
+
+void
+mmcli_batch_run_asynchronous (GDBusConnection *connection,
+                              GCancellable    *cancellable,
+                              gchar          **operations)
+{
+    gchar **read = NULL;
+    guint i;
+
+    if (monitor_flag && operations && operations[0]) {
+        g_printerr ("error: monitoring doesn't take any operation\n");
+        exit (EXIT_FAILURE);
+    }
+
+    /* Initialize context */
+    ctx = g_new0 (Context, 1);
+    ctx->connection = g_object_ref (connection);
+    if (cancellable)
+        ctx->cancellable = g_object_ref (cancellable);
+
+    if (batch_flag) {
+        if (!operations || !operations[0])
+            operations = read = read_operations ();
+
+        ctx->operations = g_ptr_array_new_with_free_func ((GDestroyNotify)operation_free);
+        for (i = 0; operations[i]; i++)
+            g_ptr_array_add (ctx->operations, operation_new (operations[i]));
+        g_strfreev (read);
+
+        if (ctx->operations->len == 0) {
+            g_printerr ("error: no operations given\n");
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    /* One single manager for all operations */
+    mmcli_get_manager (connection,
+                       cancellable,
+                       (GAsyncReadyCallback)get_manager_ready,
+                       NULL);
+}
@@ -276,7 +276,7 @@ list_ready (MMModemMessaging *modem,
     GList *operation_result;
     GError *error = NULL;
 
-    operation_result = mm_modem_messaging_list_finish (modem, result, &error);
+    operation_result = mm_modem_messaging_list_full_finish (modem, result, &error);
     list_process_reply (operation_result, error);
 
     mmcli_async_operation_done ();
@@ -382,10 +382,13 @@ get_modem_ready (GObject      *source,
     /* Request to list SMS? */
     if (list_flag) {
         g_debug ("Asynchronously listing SMS in modem...");
-        mm_modem_messaging_list (ctx->modem_messaging,
-                                 ctx->cancellable,
-                                 (GAsyncReadyCallback)list_ready,
-                                 NULL);
+        mm_modem_messaging_list_full (ctx->modem_messaging,
+                                      MM_SMS_STATE_UNKNOWN,
+                                      MM_SMS_STORAGE_UNKNOWN,
+                                      NULL,
+                                      ctx->cancellable,
+                                      (GAsyncReadyCallback)list_ready,
+                                      NULL);
         return;
     }
 
@@ -466,7 +469,12 @@ mmcli_modem_messaging_run_synchronous (GDBusConnection *connection)
         GList *result;
 
         g_debug ("Synchronously listing SMS messages...");
-        result = mm_modem_messaging_list_sync (ctx->modem_messaging, NULL, &error);
+        result = mm_modem_messaging_list_full_sync (ctx->modem_messaging,
+                                                    MM_SMS_STATE_UNKNOWN,
+                                                    MM_SMS_STORAGE_UNKNOWN,
+                                                    NULL,
+                                                    NULL,
+                                                    &error);
         list_process_reply (result, error);
         return;
     }
@@ -47,6 +47,7 @@ static gboolean verbose_flag;
 static gboolean version_flag;
 static gboolean async_flag;
 static gint timeout = 30; /* by default, use 30s for all operations */
+static gchar **remaining_args;
 
 static GOptionEntry main_entries[] = {
     { "verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose_flag,
@@ -65,6 +66,10 @@ static GOptionEntry main_entries[] = {
       "Timeout for the operation",
       "[SECONDS]"
     },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_STRING_ARRAY, &remaining_args,
+      NULL,
+      "[OPERATION...]"
+    },
     { NULL }
 };
 
@@ -190,6 +195,8 @@ main (gint argc, gchar **argv)
     context = g_option_context_new ("- Control and monitor the ModemManager");
     g_option_context_add_group (context,
                                 mmcli_manager_get_option_group ());
+    g_option_context_add_group (context,
+                                mmcli_batch_get_option_group ());
     g_option_context_add_group (context,
                                 mmcli_get_common_option_group ());
     g_option_context_add_group (context,
@@ -245,8 +252,23 @@ main (gint argc, gchar **argv)
     cancellable = g_cancellable_new ();
     loop = g_main_loop_new (NULL, FALSE);
 
+    /* Batch options? */
+    if (mmcli_batch_options_enabled ()) {
+        /* Ensure options from different groups are not enabled */
+        if (mmcli_manager_options_enabled () ||
+            mmcli_sim_options_enabled () ||
+            mmcli_bearer_options_enabled () ||
+            mmcli_sms_options_enabled () ||
+            mmcli_modem_options_enabled ()) {
+            g_printerr ("error: cannot use batch options and other actions "
+                        "at the same time\n");
+            exit (EXIT_FAILURE);
+        }
+
+        mmcli_batch_run_asynchronous (connection, cancellable, remaining_args);
+    }
     /* Manager options? */
-    if (mmcli_manager_options_enabled ()) {
+    else if (mmcli_manager_options_enabled ()) {
         /* Ensure options from different groups are not enabled */
         if (mmcli_modem_options_enabled ()) {
             g_printerr ("error: cannot use manager and modem options "
@@ -363,7 +385,9 @@ main (gint argc, gchar **argv)
     if (async_flag)
         g_main_loop_run (loop);
 
-    if (mmcli_manager_options_enabled ()) {
+    if (mmcli_batch_options_enabled ()) {
+        mmcli_batch_shutdown ();
+    } else if (mmcli_manager_options_enabled ()) {
         mmcli_manager_shutdown ();
     } else if (mmcli_modem_3gpp_options_enabled ()) {
         mmcli_modem_3gpp_shutdown ();
@@ -397,6 +421,7 @@ main (gint argc, gchar **argv)
         g_object_unref (cancellable);
     g_main_loop_unref (loop);
     g_object_unref (connection);
+    g_strfreev (remaining_args);
 
     return EXIT_SUCCESS;
 }
@@ -29,6 +29,14 @@ void          mmcli_force_async_operation   (void);
 void          mmcli_force_sync_operation    (void);
 void          mmcli_force_operation_timeout (GDBusProxy *proxy);
 
+/* Batch group */
+GOptionGroup *mmcli_batch_get_option_group (void);
+gboolean      mmcli_batch_options_enabled  (void);
+void          mmcli_batch_run_asynchronous (GDBusConnection *connection,
+                                            GCancellable    *cancellable,
+                                            gchar          **operations);
+void          mmcli_batch_shutdown         (void);
+
 /* Manager group */
 GOptionGroup *mmcli_manager_get_option_group (void);
 gboolean      mmcli_manager_options_enabled  (void);
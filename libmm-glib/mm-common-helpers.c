@@ -19,6 +19,10 @@
 #include <stdlib.h>
 #include <gio/gio.h>
 
+#if defined (__SSE2__)
+# include <emmintrin.h>
+#endif
+
 #include <ModemManager.h>
 
 #include "mm-enums-types.h"
@@ -1454,18 +1458,135 @@ mm_sms_delivery_state_get_string_extended (guint delivery_state)
 
 /*****************************************************************************/
 
-/* From hostap, Copyright (c) 2002-2005, Jouni Malinen <jkmaline@cc.hut.fi> */
+/* Value of each hex digit, -1 for any other character */
+static const gint8 hex_values[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const gchar hex_digits[] = "0123456789ABCDEF";
+
+#if defined (__SSE2__)
+
+/* Decode 16 hex digits into 8 bytes; FALSE if any of them isn't a hex digit */
+static inline gboolean
+hex_decode_16 (const gchar *hex,
+               guint8 *out)
+{
+    __m128i in;
+    __m128i digit;
+    __m128i digit_ok;
+    __m128i alpha;
+    __m128i alpha_ok;
+    __m128i nibbles;
+    __m128i bytes;
+
+    in = _mm_loadu_si128 ((const __m128i *) hex);
+
+    /* '0'-'9' become 0-9, anything else wraps above 9 */
+    digit = _mm_sub_epi8 (in, _mm_set1_epi8 ('0'));
+    digit_ok = _mm_cmpeq_epi8 (_mm_min_epu8 (digit, _mm_set1_epi8 (9)), digit);
+
+    /* 'a'-'f' and 'A'-'F' become 0-5, anything else wraps above 5 */
+    alpha = _mm_sub_epi8 (_mm_or_si128 (in, _mm_set1_epi8 (0x20)), _mm_set1_epi8 ('a'));
+    alpha_ok = _mm_cmpeq_epi8 (_mm_min_epu8 (alpha, _mm_set1_epi8 (5)), alpha);
+
+    if (_mm_movemask_epi8 (_mm_or_si128 (digit_ok, alpha_ok)) != 0xFFFF)
+        return FALSE;
+
+    nibbles = _mm_or_si128 (_mm_and_si128 (digit_ok, digit),
+                            _mm_andnot_si128 (digit_ok, _mm_add_epi8 (alpha, _mm_set1_epi8 (10))));
+
+    /* Each 16-bit lane has the high nibble in its low byte */
+    bytes = _mm_or_si128 (_mm_slli_epi16 (_mm_and_si128 (nibbles, _mm_set1_epi16 (0x00FF)), 4),
+                          _mm_srli_epi16 (nibbles, 8));
+    _mm_storel_epi64 ((__m128i *) out, _mm_packus_epi16 (bytes, bytes));
+    return TRUE;
+}
 
-static gint
-hex2num (gchar c)
+/* Encode 8 bytes into 16 uppercase hex digits */
+static inline void
+hex_encode_8 (const guint8 *bin,
+              gchar *out)
 {
-    if (c >= '0' && c <= '9')
-        return c - '0';
-    if (c >= 'a' && c <= 'f')
-        return c - 'a' + 10;
-    if (c >= 'A' && c <= 'F')
-        return c - 'A' + 10;
-    return -1;
+    __m128i in;
+    __m128i nibbles;
+    __m128i gap;
+
+    in = _mm_loadl_epi64 ((const __m128i *) bin);
+    nibbles = _mm_unpacklo_epi8 (_mm_and_si128 (_mm_srli_epi16 (in, 4), _mm_set1_epi8 (0x0F)),
+                                 _mm_and_si128 (in, _mm_set1_epi8 (0x0F)));
+
+    /* 10-15 need to skip the characters between '9' and 'A' */
+    gap = _mm_and_si128 (_mm_cmpgt_epi8 (nibbles, _mm_set1_epi8 (9)),
+                         _mm_set1_epi8 ('A' - '0' - 10));
+    _mm_storeu_si128 ((__m128i *) out,
+                      _mm_add_epi8 (_mm_add_epi8 (nibbles, _mm_set1_epi8 ('0')), gap));
+}
+
+#endif /* __SSE2__ */
+
+/* @out may be the same buffer as @hex: each output byte is written only once
+ * the input characters at or after its position have been read */
+static gboolean
+hex_decode (const gchar *hex,
+            gsize hex_len,
+            guint8 *out)
+{
+    gsize i = 0;
+
+#if defined (__SSE2__)
+    for (; i + 16 <= hex_len; i += 16) {
+        if (!hex_decode_16 (hex + i, out + i / 2))
+            return FALSE;
+    }
+#endif
+
+    for (; i < hex_len; i += 2) {
+        gint a, b;
+
+        a = hex_values[(guint8) hex[i]];
+        b = hex_values[(guint8) hex[i + 1]];
+        if ((a | b) < 0)
+            return FALSE;
+        out[i / 2] = (a << 4) | b;
+    }
+
+    return TRUE;
+}
+
+/* @out must have room for 2 * @len + 1 characters */
+static void
+hex_encode (const guint8 *bin,
+            gsize len,
+            gchar *out)
+{
+    gsize i = 0;
+
+#if defined (__SSE2__)
+    for (; i + 8 <= len; i += 8)
+        hex_encode_8 (bin + i, out + 2 * i);
+#endif
+
+    for (; i < len; i++) {
+        out[2 * i]     = hex_digits[bin[i] >> 4];
+        out[2 * i + 1] = hex_digits[bin[i] & 0x0F];
+    }
+    out[2 * len] = '\0';
 }
 
 gint
@@ -1473,10 +1594,10 @@ mm_utils_hex2byte (const gchar *hex)
 {
     gint a, b;
 
-    a = hex2num (*hex++);
+    a = hex_values[(guint8) hex[0]];
     if (a < 0)
         return -1;
-    b = hex2num (*hex++);
+    b = hex_values[(guint8) hex[1]];
     if (b < 0)
         return -1;
     return (a << 4) | b;
@@ -1485,11 +1606,7 @@ mm_utils_hex2byte (const gchar *hex)
 gchar *
 mm_utils_hexstr2bin (const gchar *hex, gsize *out_len)
 {
-    const gchar *ipos = hex;
-    gchar *buf = NULL;
-    gsize i;
-    gint a;
-    gchar *opos;
+    gchar *buf;
     gsize len;
 
     len = strlen (hex);
@@ -1497,21 +1614,85 @@ mm_utils_hexstr2bin (const gchar *hex, gsize *out_len)
     /* Length must be a multiple of 2 */
     g_return_val_if_fail ((len % 2) == 0, NULL);
 
-    opos = buf = g_malloc0 ((len / 2) + 1);
-    for (i = 0; i < len; i += 2) {
-        a = mm_utils_hex2byte (ipos);
-        if (a < 0) {
-            g_free (buf);
-            return NULL;
-        }
-        *opos++ = a;
-        ipos += 2;
+    buf = g_malloc ((len / 2) + 1);
+    if (!hex_decode (hex, len, (guint8 *) buf)) {
+        g_free (buf);
+        return NULL;
     }
+    buf[len / 2] = '\0';
     *out_len = len / 2;
     return buf;
 }
 
-/* End from hostap */
+/**
+ * mm_utils_hexstr2bin_buf:
+ * @hex: a hex string.
+ * @hex_len: length of @hex, or -1 if it is NUL-terminated.
+ * @out: buffer where the binary data is written.
+ * @out_size: size of @out.
+ * @out_len: (out) (allow-none): return location for the binary data length.
+ *
+ * Like mm_utils_hexstr2bin(), but writing into a caller-provided buffer
+ * instead of allocating a new one. @out is not NUL-terminated.
+ *
+ * Returns: %TRUE if @hex was decoded; %FALSE if it had an odd length, any
+ * non-hex character, or if it didn't fit in @out.
+ */
+gboolean
+mm_utils_hexstr2bin_buf (const gchar *hex,
+                         gssize hex_len,
+                         guint8 *out,
+                         gsize out_size,
+                         gsize *out_len)
+{
+    gsize len;
+
+    g_return_val_if_fail (hex != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+
+    len = (hex_len < 0 ? strlen (hex) : (gsize) hex_len);
+    if ((len % 2) != 0 || (len / 2) > out_size)
+        return FALSE;
+
+    if (!hex_decode (hex, len, out))
+        return FALSE;
+
+    if (out_len)
+        *out_len = len / 2;
+    return TRUE;
+}
+
+/**
+ * mm_utils_hexstr2bin_inplace:
+ * @hex: a NUL-terminated hex string.
+ * @out_len: (out) (allow-none): return location for the binary data length.
+ *
+ * Decodes @hex into the same buffer, and NUL-terminates the binary data.
+ * If decoding fails the contents of @hex are undefined.
+ *
+ * Returns: %TRUE if @hex was decoded; %FALSE if it had an odd length or any
+ * non-hex character.
+ */
+gboolean
+mm_utils_hexstr2bin_inplace (gchar *hex,
+                             gsize *out_len)
+{
+    gsize len;
+
+    g_return_val_if_fail (hex != NULL, FALSE);
+
+    len = strlen (hex);
+    if ((len % 2) != 0)
+        return FALSE;
+
+    if (!hex_decode (hex, len, (guint8 *) hex))
+        return FALSE;
+
+    hex[len / 2] = '\0';
+    if (out_len)
+        *out_len = len / 2;
+    return TRUE;
+}
 
 gboolean
 mm_utils_ishexstr (const gchar *hex)
@@ -1526,13 +1707,8 @@ mm_utils_ishexstr (const gchar *hex)
 
     for (i = 0; i < len; i++) {
         /* Non-hex char? */
-        if (hex[i] >= '0' && hex[i] <= '9')
-            continue;
-        if (hex[i] >= 'a' && hex[i] <= 'f')
-            continue;
-        if (hex[i] >= 'A' && hex[i] <= 'F')
-            continue;
-        return FALSE;
+        if (hex_values[(guint8) hex[i]] < 0)
+            return FALSE;
     }
 
     return TRUE;
@@ -1541,15 +1717,41 @@ mm_utils_ishexstr (const gchar *hex)
 gchar *
 mm_utils_bin2hexstr (const guint8 *bin, gsize len)
 {
-    GString *ret;
-    gsize i;
+    gchar *ret;
 
     g_return_val_if_fail (bin != NULL, NULL);
 
-    ret = g_string_sized_new (len * 2 + 1);
-    for (i = 0; i < len; i++)
-        g_string_append_printf (ret, "%.2X", bin[i]);
-    return g_string_free (ret, FALSE);
+    ret = g_malloc (len * 2 + 1);
+    hex_encode (bin, len, ret);
+    return ret;
+}
+
+/**
+ * mm_utils_bin2hexstr_buf:
+ * @bin: binary data.
+ * @len: length of @bin.
+ * @out: buffer where the NUL-terminated hex string is written.
+ * @out_size: size of @out, at least 2 * @len + 1.
+ *
+ * Like mm_utils_bin2hexstr(), but writing into a caller-provided buffer
+ * instead of allocating a new one.
+ *
+ * Returns: %TRUE if @bin was encoded, %FALSE if @out is too small.
+ */
+gboolean
+mm_utils_bin2hexstr_buf (const guint8 *bin,
+                         gsize len,
+                         gchar *out,
+                         gsize out_size)
+{
+    g_return_val_if_fail (bin != NULL || len == 0, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+
+    if (out_size < len * 2 + 1)
+        return FALSE;
+
+    hex_encode (bin, len, out);
+    return TRUE;
 }
 
 gboolean
@@ -153,6 +153,18 @@ gchar    *mm_utils_hexstr2bin (const gchar *hex, gsize *out_len);
 gchar    *mm_utils_bin2hexstr (const guint8 *bin, gsize len);
 gboolean  mm_utils_ishexstr   (const gchar *hex);
 
+gboolean  mm_utils_hexstr2bin_buf     (const gchar *hex,
+                                       gssize hex_len,
+                                       guint8 *out,
+                                       gsize out_size,
+                                       gsize *out_len);
+gboolean  mm_utils_hexstr2bin_inplace (gchar *hex,
+                                       gsize *out_len);
+gboolean  mm_utils_bin2hexstr_buf     (const guint8 *bin,
+                                       gsize len,
+                                       gchar *out,
+                                       gsize out_size);
+
 gboolean  mm_utils_check_for_single_value (guint32 value);
 
 #endif /* MM_COMMON_HELPERS_H */
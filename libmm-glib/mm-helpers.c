@@ -0,0 +1,353 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * libmm -- Access modem status & information from glib applications
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ */
+
+
+#include <stdlib.h>
+
+#include "mm-errors-types.h"
+#include "mm-helpers.h"
+
+/*****************************************************************************/
+
+#define DEFAULT_MAX_PENDING_PROXIES 8
+
+static guint
+get_max_pending_proxies (void)
+{
+    static gsize max_pending = 0;
+
+    if (g_once_init_enter (&max_pending)) {
+        const gchar *str;
+        gsize value = DEFAULT_MAX_PENDING_PROXIES;
+
+        str = g_getenv ("MM_GLIB_MAX_PENDING_PROXIES");
+        if (str) {
+            gulong aux;
+
+            aux = strtoul (str, NULL, 10);
+            if (aux > 0 && aux <= G_MAXUINT)
+                value = aux;
+        }
+        g_once_init_leave (&max_pending, value);
+    }
+
+    return (guint) max_pending;
+}
+
+typedef struct {
+    GSimpleAsyncResult *result;
+    GCancellable *cancellable;
+    GDBusConnection *connection;
+    gchar *name_owner;
+    gchar *interface_name;
+    GDBusProxy **proxies;
+    guint n_proxies;
+    guint next;
+    guint n_pending;
+    GError *error;
+} ProxyListContext;
+
+typedef struct {
+    ProxyListContext *ctx;
+    GDBusProxy *proxy;
+} GetAllRequest;
+
+static void
+proxy_list_context_free (ProxyListContext *ctx)
+{
+    guint i;
+
+    for (i = 0; i < ctx->n_proxies; i++) {
+        if (ctx->proxies[i])
+            g_object_unref (ctx->proxies[i]);
+    }
+    g_free (ctx->proxies);
+    if (ctx->error)
+        g_error_free (ctx->error);
+    if (ctx->result)
+        g_object_unref (ctx->result);
+    if (ctx->cancellable)
+        g_object_unref (ctx->cancellable);
+    g_object_unref (ctx->connection);
+    g_free (ctx->name_owner);
+    g_free (ctx->interface_name);
+    g_slice_free (ProxyListContext, ctx);
+}
+
+static void
+proxy_list_free (GList *list)
+{
+    g_list_free_full (list, (GDestroyNotify) g_object_unref);
+}
+
+static GList *
+proxy_list_context_steal_list (ProxyListContext *ctx)
+{
+    GList *list = NULL;
+    guint i;
+
+    for (i = ctx->n_proxies; i > 0; i--) {
+        list = g_list_prepend (list, ctx->proxies[i - 1]);
+        ctx->proxies[i - 1] = NULL;
+    }
+    return list;
+}
+
+static gboolean
+proxy_list_context_finished (ProxyListContext *ctx)
+{
+    return (ctx->n_pending == 0 && (ctx->error || ctx->next == ctx->n_proxies));
+}
+
+static void proxy_list_context_run (ProxyListContext *ctx);
+
+static void
+get_all_ready (GDBusConnection *connection,
+               GAsyncResult *res,
+               GetAllRequest *request)
+{
+    ProxyListContext *ctx = request->ctx;
+    GVariant *reply;
+    GError *error = NULL;
+
+    ctx->n_pending--;
+
+    reply = g_dbus_connection_call_finish (connection, res, &error);
+    if (!reply) {
+        /* Keep just the first error */
+        if (!ctx->error)
+            ctx->error = error;
+        else
+            g_error_free (error);
+    } else {
+        GVariant *properties;
+        GVariantIter iter;
+        const gchar *key;
+        GVariant *value;
+
+        properties = g_variant_get_child_value (reply, 0);
+        g_variant_iter_init (&iter, properties);
+        while (g_variant_iter_next (&iter, "{&sv}", &key, &value)) {
+            g_dbus_proxy_set_cached_property (request->proxy, key, value);
+            g_variant_unref (value);
+        }
+        g_variant_unref (properties);
+        g_variant_unref (reply);
+    }
+
+    g_slice_free (GetAllRequest, request);
+
+    /* Synchronous operations check for completion themselves */
+    if (!ctx->result)
+        return;
+
+    if (!proxy_list_context_finished (ctx)) {
+        proxy_list_context_run (ctx);
+        return;
+    }
+
+    if (ctx->error) {
+        g_simple_async_result_take_error (ctx->result, ctx->error);
+        ctx->error = NULL;
+    } else
+        g_simple_async_result_set_op_res_gpointer (ctx->result,
+                                                   proxy_list_context_steal_list (ctx),
+                                                   (GDestroyNotify)proxy_list_free);
+    g_simple_async_result_complete (ctx->result);
+    proxy_list_context_free (ctx);
+}
+
+static void
+proxy_list_context_run (ProxyListContext *ctx)
+{
+    guint max_pending;
+
+    /* Issue as many requests as allowed, unless we already got an error */
+    max_pending = get_max_pending_proxies ();
+    while (!ctx->error &&
+           ctx->n_pending < max_pending &&
+           ctx->next < ctx->n_proxies) {
+        GetAllRequest *request;
+
+        request = g_slice_new (GetAllRequest);
+        request->ctx = ctx;
+        request->proxy = ctx->proxies[ctx->next++];
+        ctx->n_pending++;
+
+        g_dbus_connection_call (ctx->connection,
+                                ctx->name_owner,
+                                g_dbus_proxy_get_object_path (request->proxy),
+                                "org.freedesktop.DBus.Properties",
+                                "GetAll",
+                                g_variant_new ("(s)", ctx->interface_name),
+                                G_VARIANT_TYPE ("(a{sv})"),
+                                G_DBUS_CALL_FLAGS_NO_AUTO_START,
+                                -1,
+                                ctx->cancellable,
+                                (GAsyncReadyCallback)get_all_ready,
+                                request);
+    }
+}
+
+static ProxyListContext *
+proxy_list_context_new (GType proxy_type,
+                        GDBusProxy *parent,
+                        const gchar *interface_name,
+                        const gchar *const *paths,
+                        GCancellable *cancellable,
+                        GError **error)
+{
+    ProxyListContext *ctx;
+    gchar *name_owner;
+    guint i;
+
+    name_owner = g_dbus_proxy_get_name_owner (parent);
+    if (!name_owner) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Cannot create proxies: no name owner");
+        return NULL;
+    }
+
+    ctx = g_slice_new0 (ProxyListContext);
+    ctx->connection = g_object_ref (g_dbus_proxy_get_connection (parent));
+    ctx->name_owner = name_owner;
+    ctx->interface_name = g_strdup (interface_name);
+    ctx->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+    ctx->n_proxies = paths ? g_strv_length ((gchar **)paths) : 0;
+    ctx->proxies = g_new0 (GDBusProxy *, ctx->n_proxies);
+
+    /* Creating the proxies on the unique name and without loading properties
+     * doesn't need any D-Bus request, so this is done right away. Signal
+     * subscriptions are bound to the caller's thread-default context. */
+    for (i = 0; i < ctx->n_proxies; i++) {
+        ctx->proxies[i] = g_initable_new (proxy_type,
+                                          cancellable,
+                                          error,
+                                          "g-flags",          (G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START |
+                                                               G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES),
+                                          "g-name",           name_owner,
+                                          "g-connection",     ctx->connection,
+                                          "g-object-path",    paths[i],
+                                          "g-interface-name", interface_name,
+                                          NULL);
+        if (!ctx->proxies[i]) {
+            proxy_list_context_free (ctx);
+            return NULL;
+        }
+    }
+
+    return ctx;
+}
+
+GList *
+mm_helpers_proxy_list_new_finish (GAsyncResult *res,
+                                  GError **error)
+{
+    GList *list;
+
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return NULL;
+
+    list = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+
+    /* The list we got, including the objects within, is owned by the async result;
+     * so we'll make sure we return a new list */
+    g_list_foreach (list, (GFunc)g_object_ref, NULL);
+    return g_list_copy (list);
+}
+
+void
+mm_helpers_proxy_list_new (GType proxy_type,
+                           GDBusProxy *parent,
+                           const gchar *interface_name,
+                           const gchar *const *paths,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    ProxyListContext *ctx;
+    GSimpleAsyncResult *result;
+    GError *error = NULL;
+
+    result = g_simple_async_result_new (G_OBJECT (parent),
+                                        callback,
+                                        user_data,
+                                        mm_helpers_proxy_list_new);
+
+    ctx = proxy_list_context_new (proxy_type, parent, interface_name, paths, cancellable, &error);
+    if (!ctx) {
+        g_simple_async_result_take_error (result, error);
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
+    /* Nothing to load? */
+    if (ctx->n_proxies == 0) {
+        g_simple_async_result_set_op_res_gpointer (result, NULL, NULL);
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        proxy_list_context_free (ctx);
+        return;
+    }
+
+    ctx->result = result;
+    proxy_list_context_run (ctx);
+}
+
+GList *
+mm_helpers_proxy_list_new_sync (GType proxy_type,
+                                GDBusProxy *parent,
+                                const gchar *interface_name,
+                                const gchar *const *paths,
+                                GCancellable *cancellable,
+                                GError **error)
+{
+    ProxyListContext *ctx;
+    GMainContext *context;
+    GList *list = NULL;
+
+    ctx = proxy_list_context_new (proxy_type, parent, interface_name, paths, cancellable, error);
+    if (!ctx)
+        return NULL;
+
+    /* Run the requests in our own context, so that we only dispatch their
+     * replies while waiting */
+    context = g_main_context_new ();
+    g_main_context_push_thread_default (context);
+    proxy_list_context_run (ctx);
+    while (!proxy_list_context_finished (ctx)) {
+        g_main_context_iteration (context, TRUE);
+        proxy_list_context_run (ctx);
+    }
+    g_main_context_pop_thread_default (context);
+    g_main_context_unref (context);
+
+    if (ctx->error) {
+        g_propagate_error (error, ctx->error);
+        ctx->error = NULL;
+    } else
+        list = proxy_list_context_steal_list (ctx);
+
+    proxy_list_context_free (ctx);
+    return list;
+}
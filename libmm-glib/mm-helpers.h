@@ -23,6 +23,8 @@
 #ifndef _MM_HELPERS_H_
 #define _MM_HELPERS_H_
 
+#include <gio/gio.h>
+
 #define RETURN_NON_EMPTY_CONSTANT_STRING(input) do {    \
         const gchar *str;                               \
                                                         \
@@ -42,4 +44,26 @@
     } while (0);                                        \
     return NULL
 
+/* Concurrent creation of the proxies for a list of object paths. Proxies
+ * are created on the unique name of the owner of @parent, and all their
+ * properties are loaded with parallel GetAll() requests. The maximum number
+ * of requests in flight defaults to 8, and can be changed with the
+ * MM_GLIB_MAX_PENDING_PROXIES environment variable. The returned list keeps
+ * the order of the given paths. */
+void   mm_helpers_proxy_list_new        (GType proxy_type,
+                                         GDBusProxy *parent,
+                                         const gchar *interface_name,
+                                         const gchar *const *paths,
+                                         GCancellable *cancellable,
+                                         GAsyncReadyCallback callback,
+                                         gpointer user_data);
+GList *mm_helpers_proxy_list_new_finish (GAsyncResult *res,
+                                         GError **error);
+GList *mm_helpers_proxy_list_new_sync   (GType proxy_type,
+                                         GDBusProxy *parent,
+                                         const gchar *interface_name,
+                                         const gchar *const *paths,
+                                         GCancellable *cancellable,
+                                         GError **error);
+
 #endif /* _MM_HELPERS_H_ */
@@ -40,6 +40,12 @@
  * This object is also a #GDBusObjectManagerClient, and therefore it allows to
  * use the standard ObjectManager interface to list and handle the managed
  * modem objects.
+ *
+ * Objects listed from a modem (e.g. with mm_modem_list_bearers() or
+ * mm_modem_messaging_list()) are created concurrently, with at most 8 requests
+ * in flight at any time. This process-wide limit can be changed by setting the
+ * <envar>MM_GLIB_MAX_PENDING_PROXIES</envar> environment variable to a positive
+ * number before the first listing.
  */
 
 G_DEFINE_TYPE (MMManager, mm_manager, MM_GDBUS_TYPE_OBJECT_MANAGER_CLIENT)
@@ -218,53 +218,226 @@ mm_modem_messaging_get_default_storage (MMModemMessaging *self)
 
 /*****************************************************************************/
 
-typedef struct {
-    MMModemMessaging *self;
-    GSimpleAsyncResult *result;
-    GCancellable *cancellable;
-    gchar **sms_paths;
-    GList *sms_objects;
-    guint i;
-} ListSmsContext;
-
 static void
 sms_object_list_free (GList *list)
 {
     g_list_free_full (list, (GDestroyNotify) g_object_unref);
 }
 
+/**
+ * mm_modem_messaging_list_finish:
+ * @self: A #MMModem.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_messaging_list().
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with mm_modem_messaging_list().
+ *
+ * Returns: (element-type ModemManager.Sms) (transfer full): A list of #MMSms objects, or #NULL if either not found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_messaging_list_finish (MMModemMessaging *self,
+                                GAsyncResult *res,
+                                GError **error)
+{
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+
+    return mm_helpers_proxy_list_new_finish (res, error);
+}
+
+/**
+ * mm_modem_messaging_list:
+ * @self: A #MMModemMessaging.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
+ * @user_data: User data to pass to @callback.
+ *
+ * Asynchronously lists the #MMSms objects in the modem.
+ *
+ * The #MMSms objects are all created concurrently, up to the limit described in #MMManager.
+ *
+ * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
+ * You can then call mm_modem_messaging_list_finish() to get the result of the operation.
+ *
+ * See mm_modem_messaging_list_sync() for the synchronous, blocking version of this method.
+ */
+void
+mm_modem_messaging_list (MMModemMessaging *self,
+                         GCancellable *cancellable,
+                         GAsyncReadyCallback callback,
+                         gpointer user_data)
+{
+    gchar **sms_paths;
+
+    g_return_if_fail (MM_IS_MODEM_MESSAGING (self));
+
+    sms_paths = mm_gdbus_modem_messaging_dup_messages (MM_GDBUS_MODEM_MESSAGING (self));
+    mm_helpers_proxy_list_new (MM_TYPE_SMS,
+                               G_DBUS_PROXY (self),
+                               "org.freedesktop.ModemManager1.Sms",
+                               (const gchar *const *)sms_paths,
+                               cancellable,
+                               callback,
+                               user_data);
+    g_strfreev (sms_paths);
+}
+
+/**
+ * mm_modem_messaging_list_sync:
+ * @self: A #MMModemMessaging.
+ * @cancellable: (allow-none): A #GCancellable or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Synchronously lists the #MMSms objects in the modem.
+ *
+ * The calling thread is blocked until a reply is received. See mm_modem_messaging_list()
+ * for the asynchronous version of this method.
+ *
+ * Returns: (element-type MMSms) (transfer full): A list of #MMSms objects, or #NULL if either not found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
+ */
+GList *
+mm_modem_messaging_list_sync (MMModemMessaging *self,
+                              GCancellable *cancellable,
+                              GError **error)
+{
+    GList *sms_objects;
+    gchar **sms_paths;
+
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), NULL);
+
+    sms_paths = mm_gdbus_modem_messaging_dup_messages (MM_GDBUS_MODEM_MESSAGING (self));
+    sms_objects = mm_helpers_proxy_list_new_sync (MM_TYPE_SMS,
+                                                  G_DBUS_PROXY (self),
+                                                  "org.freedesktop.ModemManager1.Sms",
+                                                  (const gchar *const *)sms_paths,
+                                                  cancellable,
+                                                  error);
+    g_strfreev (sms_paths);
+    return sms_objects;
+}
+
+/*****************************************************************************/
+
+/* Maximum number of messages requested in each ListFull() call */
+#define LIST_FULL_PAGE_SIZE 100
+
+static GVariant *
+build_list_full_filter (MMSmsState state,
+                        MMSmsStorage storage,
+                        const gchar *since)
+{
+    GVariantBuilder builder;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    if (state != MM_SMS_STATE_UNKNOWN)
+        g_variant_builder_add (&builder, "{sv}", "state", g_variant_new_uint32 (state));
+    if (storage != MM_SMS_STORAGE_UNKNOWN)
+        g_variant_builder_add (&builder, "{sv}", "storage", g_variant_new_uint32 (storage));
+    if (since)
+        g_variant_builder_add (&builder, "{sv}", "since", g_variant_new_string (since));
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static gboolean
+list_full_build_objects (MMModemMessaging *self,
+                         GVariant *messages,
+                         GList **sms_objects,
+                         GError **error)
+{
+    GVariantIter iter;
+    const gchar *path;
+    GVariant *properties;
+    gchar *name_owner;
+
+    /* Proxies are created on the unique name and without loading properties,
+     * so that no additional D-Bus request is needed; the properties we got
+     * are just set in the cache */
+    name_owner = g_dbus_proxy_get_name_owner (G_DBUS_PROXY (self));
+    if (!name_owner) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Cannot list SMS messages: no name owner");
+        return FALSE;
+    }
+
+    g_variant_iter_init (&iter, messages);
+    while (g_variant_iter_next (&iter, "(&o@a{sv})", &path, &properties)) {
+        GObject *sms;
+        GVariantIter prop_iter;
+        const gchar *key;
+        GVariant *value;
+
+        sms = g_initable_new (MM_TYPE_SMS,
+                              NULL,
+                              error,
+                              "g-flags",          (G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START |
+                                                   G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES),
+                              "g-name",           name_owner,
+                              "g-connection",     g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
+                              "g-object-path",    path,
+                              "g-interface-name", "org.freedesktop.ModemManager1.Sms",
+                              NULL);
+        if (!sms) {
+            g_variant_unref (properties);
+            g_free (name_owner);
+            return FALSE;
+        }
+
+        g_variant_iter_init (&prop_iter, properties);
+        while (g_variant_iter_next (&prop_iter, "{&sv}", &key, &value)) {
+            g_dbus_proxy_set_cached_property (G_DBUS_PROXY (sms), key, value);
+            g_variant_unref (value);
+        }
+        g_variant_unref (properties);
+
+        /* Keep the object */
+        *sms_objects = g_list_prepend (*sms_objects, sms);
+    }
+
+    g_free (name_owner);
+    return TRUE;
+}
+
+typedef struct {
+    MMModemMessaging *self;
+    GSimpleAsyncResult *result;
+    GCancellable *cancellable;
+    GVariant *filter;
+    GList *sms_objects;
+} ListFullContext;
+
 static void
-list_sms_context_complete_and_free (ListSmsContext *ctx)
+list_full_context_complete_and_free (ListFullContext *ctx)
 {
     g_simple_async_result_complete_in_idle (ctx->result);
 
-    g_strfreev (ctx->sms_paths);
     sms_object_list_free (ctx->sms_objects);
+    g_variant_unref (ctx->filter);
     g_object_unref (ctx->result);
     if (ctx->cancellable)
         g_object_unref (ctx->cancellable);
-    g_object_ref (ctx->self);
-    g_slice_free (ListSmsContext, ctx);
+    g_object_unref (ctx->self);
+    g_slice_free (ListFullContext, ctx);
 }
 
 /**
- * mm_modem_messaging_list_finish:
- * @self: A #MMModem.
- * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_messaging_list().
+ * mm_modem_messaging_list_full_finish:
+ * @self: A #MMModemMessaging.
+ * @res: The #GAsyncResult obtained from the #GAsyncReadyCallback passed to mm_modem_messaging_list_full().
  * @error: Return location for error or %NULL.
  *
- * Finishes an operation started with mm_modem_messaging_list().
+ * Finishes an operation started with mm_modem_messaging_list_full().
  *
  * Returns: (element-type ModemManager.Sms) (transfer full): A list of #MMSms objects, or #NULL if either not found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
  */
 GList *
-mm_modem_messaging_list_finish (MMModemMessaging *self,
-                                GAsyncResult *res,
-                                GError **error)
+mm_modem_messaging_list_full_finish (MMModemMessaging *self,
+                                     GAsyncResult *res,
+                                     GError **error)
 {
     GList *list;
 
-    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), FALSE);
+    g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), NULL);
 
     if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
         return NULL;
@@ -277,161 +450,175 @@ mm_modem_messaging_list_finish (MMModemMessaging *self,
     return g_list_copy (list);
 }
 
-static void create_next_sms (ListSmsContext *ctx);
+static void list_full_request_page (ListFullContext *ctx,
+                                    const gchar *cursor);
 
 static void
-list_build_object_ready (GDBusConnection *connection,
-                         GAsyncResult *res,
-                         ListSmsContext *ctx)
+list_full_ready (MmGdbusModemMessaging *proxy,
+                 GAsyncResult *res,
+                 ListFullContext *ctx)
 {
     GError *error = NULL;
-    GObject *sms;
-    GObject *source_object;
+    GVariant *messages = NULL;
+    gchar *next_cursor = NULL;
+    gboolean built;
 
-    source_object = g_async_result_get_source_object (res);
-    sms = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), res, &error);
-    g_object_unref (source_object);
-
-    if (error) {
+    if (!mm_gdbus_modem_messaging_call_list_full_finish (proxy, &messages, &next_cursor, res, &error)) {
         g_simple_async_result_take_error (ctx->result, error);
-        list_sms_context_complete_and_free (ctx);
+        list_full_context_complete_and_free (ctx);
         return;
     }
 
-    /* Keep the object */
-    ctx->sms_objects = g_list_prepend (ctx->sms_objects, sms);
+    built = list_full_build_objects (ctx->self, messages, &ctx->sms_objects, &error);
+    g_variant_unref (messages);
+    if (!built) {
+        g_free (next_cursor);
+        g_simple_async_result_take_error (ctx->result, error);
+        list_full_context_complete_and_free (ctx);
+        return;
+    }
 
-    /* If no more smss, just end here. */
-    if (!ctx->sms_paths[++ctx->i]) {
-        g_simple_async_result_set_op_res_gpointer (ctx->result,
-                                                   ctx->sms_objects,
-                                                   (GDestroyNotify)sms_object_list_free);
-        ctx->sms_objects = NULL;
-        list_sms_context_complete_and_free (ctx);
+    /* More pages to request? */
+    if (next_cursor && next_cursor[0]) {
+        list_full_request_page (ctx, next_cursor);
+        g_free (next_cursor);
         return;
     }
+    g_free (next_cursor);
 
-    /* Keep on creating next object */
-    create_next_sms (ctx);
+    g_simple_async_result_set_op_res_gpointer (ctx->result,
+                                               g_list_reverse (ctx->sms_objects),
+                                               (GDestroyNotify)sms_object_list_free);
+    ctx->sms_objects = NULL;
+    list_full_context_complete_and_free (ctx);
 }
 
 static void
-create_next_sms (ListSmsContext *ctx)
+list_full_request_page (ListFullContext *ctx,
+                        const gchar *cursor)
 {
-    g_async_initable_new_async (MM_TYPE_SMS,
-                                G_PRIORITY_DEFAULT,
-                                ctx->cancellable,
-                                (GAsyncReadyCallback)list_build_object_ready,
-                                ctx,
-                                "g-flags",          G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-                                "g-name",           MM_DBUS_SERVICE,
-                                "g-connection",     g_dbus_proxy_get_connection (G_DBUS_PROXY (ctx->self)),
-                                "g-object-path",    ctx->sms_paths[ctx->i],
-                                "g-interface-name", "org.freedesktop.ModemManager1.Sms",
-                                NULL);
+    mm_gdbus_modem_messaging_call_list_full (MM_GDBUS_MODEM_MESSAGING (ctx->self),
+                                             ctx->filter,
+                                             cursor,
+                                             LIST_FULL_PAGE_SIZE,
+                                             ctx->cancellable,
+                                             (GAsyncReadyCallback)list_full_ready,
+                                             ctx);
 }
 
 /**
- * mm_modem_messaging_list:
+ * mm_modem_messaging_list_full:
  * @self: A #MMModemMessaging.
+ * @state: A #MMSmsState to filter the messages, or %MM_SMS_STATE_UNKNOWN to list messages in any state.
+ * @storage: A #MMSmsStorage to filter the messages, or %MM_SMS_STORAGE_UNKNOWN to list messages in any storage.
+ * @since: (allow-none): An ISO8601 timestamp to list only messages received since then, or %NULL.
  * @cancellable: (allow-none): A #GCancellable or %NULL.
  * @callback: A #GAsyncReadyCallback to call when the request is satisfied or %NULL.
  * @user_data: User data to pass to @callback.
  *
- * Asynchronously lists the #MMSms objects in the modem.
+ * Asynchronously lists the #MMSms objects in the modem matching the given
+ * filters.
+ *
+ * Unlike mm_modem_messaging_list(), the properties of all messages are
+ * retrieved along with the list itself, so there is no additional request
+ * for each #MMSms object created.
  *
  * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
- * You can then call mm_modem_messaging_list_finish() to get the result of the operation.
+ * You can then call mm_modem_messaging_list_full_finish() to get the result of the operation.
  *
- * See mm_modem_messaging_list_sync() for the synchronous, blocking version of this method.
+ * See mm_modem_messaging_list_full_sync() for the synchronous, blocking version of this method.
  */
 void
-mm_modem_messaging_list (MMModemMessaging *self,
-                         GCancellable *cancellable,
-                         GAsyncReadyCallback callback,
-                         gpointer user_data)
+mm_modem_messaging_list_full (MMModemMessaging *self,
+                              MMSmsState state,
+                              MMSmsStorage storage,
+                              const gchar *since,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
 {
-    ListSmsContext *ctx;
+    ListFullContext *ctx;
 
     g_return_if_fail (MM_IS_MODEM_MESSAGING (self));
 
-    ctx = g_slice_new0 (ListSmsContext);
+    ctx = g_slice_new0 (ListFullContext);
     ctx->self = g_object_ref (self);
     ctx->result = g_simple_async_result_new (G_OBJECT (self),
                                              callback,
                                              user_data,
-                                             mm_modem_messaging_list);
+                                             mm_modem_messaging_list_full);
     if (cancellable)
         ctx->cancellable = g_object_ref (cancellable);
+    ctx->filter = build_list_full_filter (state, storage, since);
 
-    ctx->sms_paths = mm_gdbus_modem_messaging_dup_messages (MM_GDBUS_MODEM_MESSAGING (self));
-
-    /* If no SMS, just end here. */
-    if (!ctx->sms_paths || !ctx->sms_paths[0]) {
-        g_simple_async_result_set_op_res_gpointer (ctx->result, NULL, NULL);
-        list_sms_context_complete_and_free (ctx);
-        return;
-    }
-
-    /* Got list of paths. If at least one found, start creating objects for each */
-    ctx->i = 0;
-    create_next_sms (ctx);
+    list_full_request_page (ctx, "");
 }
 
 /**
- * mm_modem_messaging_list_sync:
+ * mm_modem_messaging_list_full_sync:
  * @self: A #MMModemMessaging.
+ * @state: A #MMSmsState to filter the messages, or %MM_SMS_STATE_UNKNOWN to list messages in any state.
+ * @storage: A #MMSmsStorage to filter the messages, or %MM_SMS_STORAGE_UNKNOWN to list messages in any storage.
+ * @since: (allow-none): An ISO8601 timestamp to list only messages received since then, or %NULL.
  * @cancellable: (allow-none): A #GCancellable or %NULL.
  * @error: Return location for error or %NULL.
  *
- * Synchronously lists the #MMSms objects in the modem.
+ * Synchronously lists the #MMSms objects in the modem matching the given
+ * filters.
  *
- * The calling thread is blocked until a reply is received. See mm_modem_messaging_list()
+ * The calling thread is blocked until a reply is received. See mm_modem_messaging_list_full()
  * for the asynchronous version of this method.
  *
  * Returns: (element-type MMSms) (transfer full): A list of #MMSms objects, or #NULL if either not found or @error is set. The returned value should be freed with g_list_free_full() using g_object_unref() as #GDestroyNotify function.
  */
 GList *
-mm_modem_messaging_list_sync (MMModemMessaging *self,
-                              GCancellable *cancellable,
-                              GError **error)
+mm_modem_messaging_list_full_sync (MMModemMessaging *self,
+                                   MMSmsState state,
+                                   MMSmsStorage storage,
+                                   const gchar *since,
+                                   GCancellable *cancellable,
+                                   GError **error)
 {
     GList *sms_objects = NULL;
-    gchar **sms_paths = NULL;
-    guint i;
+    GVariant *filter;
+    gchar *cursor;
+    gboolean success;
 
     g_return_val_if_fail (MM_IS_MODEM_MESSAGING (self), NULL);
 
-    sms_paths = mm_gdbus_modem_messaging_dup_messages (MM_GDBUS_MODEM_MESSAGING (self));
-
-    /* Only non-empty lists are returned */
-    if (!sms_paths)
-        return NULL;
-
-    for (i = 0; sms_paths[i]; i++) {
-        GObject *sms;
-
-        sms = g_initable_new (MM_TYPE_SMS,
-                                 cancellable,
-                                 error,
-                                 "g-flags",          G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-                                 "g-name",           MM_DBUS_SERVICE,
-                                 "g-connection",     g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
-                                 "g-object-path",    sms_paths[i],
-                                 "g-interface-name", "org.freedesktop.ModemManager1.Sms",
-                              NULL);
-        if (!sms) {
-            sms_object_list_free (sms_objects);
-            g_strfreev (sms_paths);
-            return NULL;
+    filter = build_list_full_filter (state, storage, since);
+    cursor = g_strdup ("");
+
+    do {
+        GVariant *messages = NULL;
+        gchar *next_cursor = NULL;
+
+        success = mm_gdbus_modem_messaging_call_list_full_sync (MM_GDBUS_MODEM_MESSAGING (self),
+                                                                filter,
+                                                                cursor,
+                                                                LIST_FULL_PAGE_SIZE,
+                                                                &messages,
+                                                                &next_cursor,
+                                                                cancellable,
+                                                                error);
+        g_free (cursor);
+        cursor = next_cursor;
+
+        if (success) {
+            success = list_full_build_objects (self, messages, &sms_objects, error);
+            g_variant_unref (messages);
         }
+    } while (success && cursor && cursor[0]);
 
-        /* Keep the object */
-        sms_objects = g_list_prepend (sms_objects, sms);
+    g_free (cursor);
+    g_variant_unref (filter);
+
+    if (!success) {
+        sms_object_list_free (sms_objects);
+        return NULL;
     }
 
-    g_strfreev (sms_paths);
-    return sms_objects;
+    return g_list_reverse (sms_objects);
 }
 
 /*****************************************************************************/
@@ -102,6 +102,23 @@ GList *mm_modem_messaging_list_sync   (MMModemMessaging *self,
                                        GCancellable *cancellable,
                                        GError **error);
 
+void   mm_modem_messaging_list_full        (MMModemMessaging *self,
+                                            MMSmsState state,
+                                            MMSmsStorage storage,
+                                            const gchar *since,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+GList *mm_modem_messaging_list_full_finish (MMModemMessaging *self,
+                                            GAsyncResult *res,
+                                            GError **error);
+GList *mm_modem_messaging_list_full_sync   (MMModemMessaging *self,
+                                            MMSmsState state,
+                                            MMSmsStorage storage,
+                                            const gchar *since,
+                                            GCancellable *cancellable,
+                                            GError **error);
+
 void     mm_modem_messaging_delete        (MMModemMessaging *self,
                                            const gchar *sms,
                                            GCancellable *cancellable,
@@ -1751,35 +1751,6 @@ mm_modem_disable_sync (MMModem *self,
 
 /*****************************************************************************/
 
-typedef struct {
-    MMModem *self;
-    GSimpleAsyncResult *result;
-    GCancellable *cancellable;
-    gchar **bearer_paths;
-    GList *bearer_objects;
-    guint i;
-} ListBearersContext;
-
-static void
-bearer_object_list_free (GList *list)
-{
-    g_list_free_full (list, (GDestroyNotify) g_object_unref);
-}
-
-static void
-list_bearers_context_complete_and_free (ListBearersContext *ctx)
-{
-    g_simple_async_result_complete_in_idle (ctx->result);
-
-    g_strfreev (ctx->bearer_paths);
-    bearer_object_list_free (ctx->bearer_objects);
-    g_object_unref (ctx->result);
-    if (ctx->cancellable)
-        g_object_unref (ctx->cancellable);
-    g_object_ref (ctx->self);
-    g_slice_free (ListBearersContext, ctx);
-}
-
 /**
  * mm_modem_list_bearers_finish:
  * @self: A #MMModem.
@@ -1795,73 +1766,9 @@ mm_modem_list_bearers_finish (MMModem *self,
                               GAsyncResult *res,
                               GError **error)
 {
-    GList *list;
-
     g_return_val_if_fail (MM_IS_MODEM (self), NULL);
 
-    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
-        return NULL;
-
-    list = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
-
-    /* The list we got, including the objects within, is owned by the async result;
-     * so we'll make sure we return a new list */
-    g_list_foreach (list, (GFunc)g_object_ref, NULL);
-    return g_list_copy (list);
-}
-
-static void create_next_bearer (ListBearersContext *ctx);
-
-static void
-modem_list_bearers_build_object_ready (GDBusConnection *connection,
-                                       GAsyncResult *res,
-                                       ListBearersContext *ctx)
-{
-    GObject *bearer;
-    GError *error = NULL;
-    GObject *source_object;
-
-    source_object = g_async_result_get_source_object (res);
-    bearer = g_async_initable_new_finish (G_ASYNC_INITABLE (source_object), res, &error);
-    g_object_unref (source_object);
-
-    if (error) {
-        g_simple_async_result_take_error (ctx->result, error);
-        list_bearers_context_complete_and_free (ctx);
-        return;
-    }
-
-    /* Keep the object */
-    ctx->bearer_objects = g_list_prepend (ctx->bearer_objects, bearer);
-
-    /* If no more bearers, just end here. */
-    if (!ctx->bearer_paths[++ctx->i]) {
-        g_simple_async_result_set_op_res_gpointer (ctx->result,
-                                                   ctx->bearer_objects,
-                                                   (GDestroyNotify)bearer_object_list_free);
-        ctx->bearer_objects = NULL;
-        list_bearers_context_complete_and_free (ctx);
-        return;
-    }
-
-    /* Keep on creating next object */
-    create_next_bearer (ctx);
-}
-
-static void
-create_next_bearer (ListBearersContext *ctx)
-{
-    g_async_initable_new_async (MM_TYPE_BEARER,
-                                G_PRIORITY_DEFAULT,
-                                ctx->cancellable,
-                                (GAsyncReadyCallback)modem_list_bearers_build_object_ready,
-                                ctx,
-                                "g-flags",          G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-                                "g-name",           MM_DBUS_SERVICE,
-                                "g-connection",     g_dbus_proxy_get_connection (G_DBUS_PROXY (ctx->self)),
-                                "g-object-path",    ctx->bearer_paths[ctx->i],
-                                "g-interface-name", "org.freedesktop.ModemManager1.Bearer",
-                                NULL);
+    return mm_helpers_proxy_list_new_finish (res, error);
 }
 
 /**
@@ -1873,6 +1780,8 @@ create_next_bearer (ListBearersContext *ctx)
  *
  * Asynchronously lists the packet data bearers in the #MMModem.
  *
+ * The #MMBearer objects are all created concurrently, up to the limit described in #MMManager.
+ *
  * When the operation is finished, @callback will be invoked in the <link linkend="g-main-context-push-thread-default">thread-default main loop</link> of the thread you are calling this method from.
  * You can then call mm_modem_list_bearers_finish() to get the result of the operation.
  *
@@ -1884,32 +1793,20 @@ mm_modem_list_bearers (MMModem *self,
                        GAsyncReadyCallback callback,
                        gpointer user_data)
 {
-    ListBearersContext *ctx;
+    gchar **bearer_paths;
 
     g_return_if_fail (MM_IS_MODEM (self));
 
-    ctx = g_slice_new0 (ListBearersContext);
-    ctx->self = g_object_ref (self);
-    ctx->result = g_simple_async_result_new (G_OBJECT (self),
-                                             callback,
-                                             user_data,
-                                             mm_modem_list_bearers);
-    if (cancellable)
-        ctx->cancellable = g_object_ref (cancellable);
-
     /* Read from the property, skip List() */
-    ctx->bearer_paths = mm_gdbus_modem_dup_bearers (MM_GDBUS_MODEM (self));
-
-    /* If no bearers, just end here. */
-    if (!ctx->bearer_paths || !ctx->bearer_paths[0]) {
-        g_simple_async_result_set_op_res_gpointer (ctx->result, NULL, NULL);
-        list_bearers_context_complete_and_free (ctx);
-        return;
-    }
-
-    /* Got list of paths. If at least one found, start creating objects for each */
-    ctx->i = 0;
-    create_next_bearer (ctx);
+    bearer_paths = mm_gdbus_modem_dup_bearers (MM_GDBUS_MODEM (self));
+    mm_helpers_proxy_list_new (MM_TYPE_BEARER,
+                               G_DBUS_PROXY (self),
+                               "org.freedesktop.ModemManager1.Bearer",
+                               (const gchar *const *)bearer_paths,
+                               cancellable,
+                               callback,
+                               user_data);
+    g_strfreev (bearer_paths);
 }
 
 /**
@@ -1930,41 +1827,19 @@ mm_modem_list_bearers_sync (MMModem *self,
                             GCancellable *cancellable,
                             GError **error)
 {
-    GList *bearer_objects = NULL;
-    gchar **bearer_paths = NULL;
-    guint i;
+    GList *bearer_objects;
+    gchar **bearer_paths;
 
     g_return_val_if_fail (MM_IS_MODEM (self), NULL);
 
     /* Read from the property, skip List() */
     bearer_paths = mm_gdbus_modem_dup_bearers (MM_GDBUS_MODEM (self));
-
-    /* Only non-empty lists are returned */
-    if (!bearer_paths)
-        return NULL;
-
-    for (i = 0; bearer_paths[i]; i++) {
-        GObject *bearer;
-
-        bearer = g_initable_new (MM_TYPE_BEARER,
-                                 cancellable,
-                                 error,
-                                 "g-flags",          G_DBUS_PROXY_FLAGS_DO_NOT_AUTO_START,
-                                 "g-name",           MM_DBUS_SERVICE,
-                                 "g-connection",     g_dbus_proxy_get_connection (G_DBUS_PROXY (self)),
-                                 "g-object-path",    bearer_paths[i],
-                                 "g-interface-name", "org.freedesktop.ModemManager1.Bearer",
-                                 NULL);
-        if (!bearer) {
-            bearer_object_list_free (bearer_objects);
-            g_strfreev (bearer_paths);
-            return NULL;
-        }
-
-        /* Keep the object */
-        bearer_objects = g_list_prepend (bearer_objects, bearer);
-    }
-
+    bearer_objects = mm_helpers_proxy_list_new_sync (MM_TYPE_BEARER,
+                                                     G_DBUS_PROXY (self),
+                                                     "org.freedesktop.ModemManager1.Bearer",
+                                                     (const gchar *const *)bearer_paths,
+                                                     cancellable,
+                                                     error);
     g_strfreev (bearer_paths);
     return bearer_objects;
 }
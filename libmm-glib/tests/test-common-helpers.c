@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <glib-object.h>
 
 #include <libmm-glib.h>
@@ -486,6 +488,187 @@ field_parser_double (void)
     g_free (str);
 }
 
+/********************* HEX CODEC TESTS *********************/
+
+/* Longer than a couple of SIMD blocks, so that all tail lengths are tried */
+#define HEX_TEST_MAX_LEN 40
+
+static gchar *
+hex_encode_reference (const guint8 *bin,
+                      gsize len)
+{
+    GString *str;
+    gsize i;
+
+    str = g_string_new ("");
+    for (i = 0; i < len; i++)
+        g_string_append_printf (str, "%.2X", bin[i]);
+    return g_string_free (str, FALSE);
+}
+
+static void
+hex_codec_roundtrip (void)
+{
+    guint8 bin[HEX_TEST_MAX_LEN];
+    gsize len;
+    gsize i;
+
+    for (i = 0; i < HEX_TEST_MAX_LEN; i++)
+        bin[i] = (guint8) (i * 37 + 11);
+
+    for (len = 0; len <= HEX_TEST_MAX_LEN; len++) {
+        gchar *expected;
+        gchar *hex;
+        gchar *lower;
+        gchar *decoded;
+        gchar buf[2 * HEX_TEST_MAX_LEN + 1];
+        guint8 out[HEX_TEST_MAX_LEN];
+        gsize out_len;
+
+        expected = hex_encode_reference (bin, len);
+
+        /* Encoding */
+        hex = mm_utils_bin2hexstr (bin, len);
+        g_assert_cmpstr (hex, ==, expected);
+        g_assert (mm_utils_bin2hexstr_buf (bin, len, buf, 2 * len + 1) == TRUE);
+        g_assert_cmpstr (buf, ==, expected);
+        if (len > 0)
+            g_assert (mm_utils_bin2hexstr_buf (bin, len, buf, 2 * len) == FALSE);
+
+        /* Decoding, both upper and lower case */
+        lower = g_ascii_strdown (hex, -1);
+
+        decoded = mm_utils_hexstr2bin (hex, &out_len);
+        g_assert (decoded != NULL);
+        g_assert_cmpuint (out_len, ==, len);
+        g_assert (memcmp (decoded, bin, len) == 0);
+        g_free (decoded);
+
+        g_assert (mm_utils_hexstr2bin_buf (lower, -1, out, len, &out_len) == TRUE);
+        g_assert_cmpuint (out_len, ==, len);
+        g_assert (memcmp (out, bin, len) == 0);
+        if (len > 0)
+            g_assert (mm_utils_hexstr2bin_buf (lower, -1, out, len - 1, &out_len) == FALSE);
+
+        g_assert (mm_utils_hexstr2bin_inplace (lower, &out_len) == TRUE);
+        g_assert_cmpuint (out_len, ==, len);
+        g_assert (memcmp (lower, bin, len) == 0);
+        g_assert (lower[len] == '\0');
+
+        g_free (lower);
+        g_free (hex);
+        g_free (expected);
+    }
+}
+
+static void
+hex_codec_invalid (void)
+{
+    static const gchar invalid[] = { 'g', 'G', ':', '/', '@', '`', ' ', '\x80', '\xff' };
+    gchar hex[2 * HEX_TEST_MAX_LEN + 1];
+    guint8 out[HEX_TEST_MAX_LEN];
+    gsize out_len;
+    guint i;
+    guint j;
+
+    /* Odd length */
+    g_assert (mm_utils_hexstr2bin_buf ("ABC", -1, out, sizeof (out), &out_len) == FALSE);
+    g_assert (mm_utils_hexstr2bin_buf ("ABCD", 3, out, sizeof (out), &out_len) == FALSE);
+    g_assert (mm_utils_ishexstr ("ABC") == FALSE);
+
+    /* Explicit length shorter than the string */
+    g_assert (mm_utils_hexstr2bin_buf ("ABCDZZ", 4, out, sizeof (out), &out_len) == TRUE);
+    g_assert_cmpuint (out_len, ==, 2);
+    g_assert_cmphex (out[0], ==, 0xAB);
+    g_assert_cmphex (out[1], ==, 0xCD);
+
+    /* A single non-hex character anywhere must be detected */
+    for (i = 0; i < 2 * HEX_TEST_MAX_LEN; i++) {
+        for (j = 0; j < G_N_ELEMENTS (invalid); j++) {
+            memset (hex, 'a', 2 * HEX_TEST_MAX_LEN);
+            hex[2 * HEX_TEST_MAX_LEN] = '\0';
+            hex[i] = invalid[j];
+
+            g_assert (mm_utils_ishexstr (hex) == FALSE);
+            g_assert (mm_utils_hexstr2bin (hex, &out_len) == NULL);
+            g_assert (mm_utils_hexstr2bin_buf (hex, -1, out, sizeof (out), &out_len) == FALSE);
+            g_assert (mm_utils_hexstr2bin_inplace (hex, &out_len) == FALSE);
+        }
+    }
+
+    g_assert_cmpint (mm_utils_hex2byte ("7f"), ==, 0x7f);
+    g_assert_cmpint (mm_utils_hex2byte ("7g"), ==, -1);
+    g_assert_cmpint (mm_utils_hex2byte ("\0" "0"), ==, -1);
+}
+
+/* Byte-by-byte decoder, as used before, to compare against */
+static gboolean
+hex_decode_reference (const gchar *hex,
+                      guint8 *out)
+{
+    gsize len;
+    gsize i;
+
+    len = strlen (hex);
+    for (i = 0; i < len; i += 2) {
+        gchar byte[3] = { hex[i], hex[i + 1], '\0' };
+        gchar *end;
+
+        out[i / 2] = (guint8) strtoul (byte, &end, 16);
+        if (*end)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+hex_codec_perf (void)
+{
+    /* Size of a long SMS PDU */
+    guint8 bin[176];
+    guint8 out[sizeof (bin)];
+    gchar hex[2 * sizeof (bin) + 1];
+    gdouble reference_time;
+    gdouble time;
+    guint i;
+
+    if (!g_test_perf ())
+        return;
+
+    for (i = 0; i < sizeof (bin); i++)
+        bin[i] = g_random_int_range (0, 256);
+
+#define HEX_PERF_ITERATIONS 100000
+
+    g_test_timer_start ();
+    for (i = 0; i < HEX_PERF_ITERATIONS; i++)
+        g_free (hex_encode_reference (bin, sizeof (bin)));
+    reference_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (i = 0; i < HEX_PERF_ITERATIONS; i++)
+        mm_utils_bin2hexstr_buf (bin, sizeof (bin), hex, sizeof (hex));
+    time = g_test_timer_elapsed ();
+    g_test_minimized_result (time, "hex encode: %.3f s (reference %.3f s, %.1fx)",
+                             time, reference_time, reference_time / time);
+
+    g_test_timer_start ();
+    for (i = 0; i < HEX_PERF_ITERATIONS; i++)
+        hex_decode_reference (hex, out);
+    reference_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (i = 0; i < HEX_PERF_ITERATIONS; i++)
+        mm_utils_hexstr2bin_buf (hex, sizeof (hex) - 1, out, sizeof (out), NULL);
+    time = g_test_timer_elapsed ();
+    g_test_minimized_result (time, "hex decode: %.3f s (reference %.3f s, %.1fx)",
+                             time, reference_time, reference_time / time);
+
+    g_assert (memcmp (out, bin, sizeof (bin)) == 0);
+
+#undef HEX_PERF_ITERATIONS
+}
+
 /**************************************************************/
 
 int main (int argc, char **argv)
@@ -525,5 +708,9 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/Common/FieldParsers/Uint", field_parser_uint);
     g_test_add_func ("/MM/Common/FieldParsers/Double", field_parser_double);
 
+    g_test_add_func ("/MM/Common/HexCodec/roundtrip", hex_codec_roundtrip);
+    g_test_add_func ("/MM/Common/HexCodec/invalid", hex_codec_invalid);
+    g_test_add_func ("/MM/Common/HexCodec/perf", hex_codec_perf);
+
     return g_test_run ();
 }
@@ -23,6 +23,7 @@
 #include "mm-log.h"
 #include "mm-charsets.h"
 #include "mm-errors-types.h"
+#include "mm-modem-helpers.h"
 #include "mm-modem-helpers-cinterion.h"
 
 /* Setup relationship between the 3G band bitmask in the modem and the bitmask
@@ -482,3 +483,98 @@ mm_cinterion_parse_sind_response (const gchar *response,
 
     return TRUE;
 }
+
+/*****************************************************************************/
+/* ^SMONI response parser */
+
+static gboolean
+smoni_get_value (gchar **split,
+                 guint n_fields,
+                 guint field,
+                 gdouble *out)
+{
+    /* Unknown values are given as "--" or empty */
+    return (field < n_fields &&
+            strpbrk (split[field], "0123456789") != NULL &&
+            mm_get_double_from_str (split[field], out));
+}
+
+gboolean
+mm_cinterion_parse_smoni_query_response (const gchar *response,
+                                         MMSignal **out_gsm,
+                                         MMSignal **out_umts,
+                                         MMSignal **out_lte,
+                                         GError **error)
+{
+    gchar **split;
+    guint n_fields;
+    guint i;
+    gdouble value;
+    gdouble ecio;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    g_assert (out_gsm != NULL);
+    g_assert (out_umts != NULL);
+    g_assert (out_lte != NULL);
+
+    if (!response) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED, "Missing response");
+        return FALSE;
+    }
+
+    /* Format, only the fields we care about:
+     *
+     * ^SMONI: 2G,<ARFCN>,<BCCH>,...
+     * ^SMONI: 3G,<UARFCN>,<PSC>,<EC/n0>,<RSCP>,...
+     * ^SMONI: 4G,<EARFCN>,<Band>,<DL bw>,<UL bw>,<Mode>,<MCC>,<MNC>,<TAC>,
+     *            <Global Cell ID>,<Physical Cell ID>,<Srxlev|TX power>,<RSRP>,<RSRQ>,...
+     *
+     * <BCCH> and <RSCP> are given in dBm, <EC/n0> in dB; while searching
+     * for a cell there are no values at all.
+     */
+    response = mm_strip_tag (response, "^SMONI:");
+    split = g_strsplit (response, ",", -1);
+    n_fields = g_strv_length (split);
+    for (i = 0; i < n_fields; i++)
+        g_strstrip (split[i]);
+
+    if (n_fields > 0 && g_str_equal (split[0], "2G")) {
+        if (smoni_get_value (split, n_fields, 2, &value)) {
+            gsm = mm_signal_new ();
+            mm_signal_set_rssi (gsm, value);
+        }
+    } else if (n_fields > 0 && g_str_equal (split[0], "3G")) {
+        /* There is no RSCP in MMSignal; report the RSSI it implies */
+        if (smoni_get_value (split, n_fields, 3, &ecio)) {
+            umts = mm_signal_new ();
+            mm_signal_set_ecio (umts, ecio);
+            if (smoni_get_value (split, n_fields, 4, &value))
+                mm_signal_set_rssi (umts, value - ecio);
+        }
+    } else if (n_fields > 0 && g_str_equal (split[0], "4G")) {
+        if (smoni_get_value (split, n_fields, 12, &value)) {
+            lte = mm_signal_new ();
+            mm_signal_set_rsrp (lte, value);
+        }
+        if (smoni_get_value (split, n_fields, 13, &value)) {
+            if (!lte)
+                lte = mm_signal_new ();
+            mm_signal_set_rsrq (lte, value);
+        }
+    }
+
+    g_strfreev (split);
+
+    if (!gsm && !umts && !lte) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "No signal information in ^SMONI response");
+        return FALSE;
+    }
+
+    *out_gsm = gsm;
+    *out_umts = umts;
+    *out_lte = lte;
+    return TRUE;
+}
@@ -63,4 +63,13 @@ gboolean mm_cinterion_parse_sind_response (const gchar *response,
                                            guint *value,
                                            GError **error);
 
+/*****************************************************************************/
+/* ^SMONI response parser */
+
+gboolean mm_cinterion_parse_smoni_query_response (const gchar *response,
+                                                  MMSignal **out_gsm,
+                                                  MMSignal **out_umts,
+                                                  MMSignal **out_lte,
+                                                  GError **error);
+
 #endif  /* MM_MODEM_HELPERS_CINTERION_H */
@@ -365,6 +365,99 @@ test_sind_response_simstatus (void)
     common_test_sind_response ("^SIND: simstatus,1,5", "simstatus", 1, 5);
 }
 
+/*****************************************************************************/
+/* Test ^SMONI responses */
+
+static void
+test_smoni_response_2g (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_cinterion_parse_smoni_query_response ("^SMONI: 2G,71,-61,262,02,0143,83BA,33,33,3,6,G,NOCONN",
+                                                   &gsm, &umts, &lte,
+                                                   &error);
+    g_assert_no_error (error);
+    g_assert (res == TRUE);
+    g_assert (gsm != NULL);
+    g_assert (umts == NULL);
+    g_assert (lte == NULL);
+    g_assert_cmpfloat (mm_signal_get_rssi (gsm), ==, -61.0);
+    g_object_unref (gsm);
+}
+
+static void
+test_smoni_response_3g (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_cinterion_parse_smoni_query_response ("^SMONI: 3G,10564,296,-7.5,-79,262,02,0143,00228FF,-92,-78,NOCONN",
+                                                   &gsm, &umts, &lte,
+                                                   &error);
+    g_assert_no_error (error);
+    g_assert (res == TRUE);
+    g_assert (gsm == NULL);
+    g_assert (umts != NULL);
+    g_assert (lte == NULL);
+    g_assert_cmpfloat (mm_signal_get_ecio (umts), ==, -7.5);
+    g_assert_cmpfloat (mm_signal_get_rssi (umts), ==, -71.5);
+    g_object_unref (umts);
+}
+
+static void
+test_smoni_response_4g (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_cinterion_parse_smoni_query_response ("^SMONI: 4G,6300,20,10,10,FDD,262,02,BF75,0345103,350,33,-94,-7,NOCONN",
+                                                   &gsm, &umts, &lte,
+                                                   &error);
+    g_assert_no_error (error);
+    g_assert (res == TRUE);
+    g_assert (gsm == NULL);
+    g_assert (umts == NULL);
+    g_assert (lte != NULL);
+    g_assert_cmpfloat (mm_signal_get_rsrp (lte), ==, -94.0);
+    g_assert_cmpfloat (mm_signal_get_rsrq (lte), ==, -7.0);
+    g_object_unref (lte);
+}
+
+static void
+test_smoni_response_search (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_cinterion_parse_smoni_query_response ("^SMONI: 4G,SEARCH",
+                                                   &gsm, &umts, &lte,
+                                                   &error);
+    g_assert (error != NULL);
+    g_assert (res == FALSE);
+    g_error_free (error);
+    error = NULL;
+
+    res = mm_cinterion_parse_smoni_query_response ("^SMONI: 3G,10564,296,--,--,262,02,0143,00228FF,-92,-78,NOCONN",
+                                                   &gsm, &umts, &lte,
+                                                   &error);
+    g_assert (error != NULL);
+    g_assert (res == FALSE);
+    g_error_free (error);
+}
+
 /*****************************************************************************/
 
 void
@@ -400,6 +493,10 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/cinterion/scfg/response/2g/ucs2",   test_scfg_response_2g_ucs2);
     g_test_add_func ("/MM/cinterion/cnmi/phs8",               test_cnmi_phs8);
     g_test_add_func ("/MM/cinterion/sind/response/simstatus", test_sind_response_simstatus);
+    g_test_add_func ("/MM/cinterion/smoni/response/2g",       test_smoni_response_2g);
+    g_test_add_func ("/MM/cinterion/smoni/response/3g",       test_smoni_response_3g);
+    g_test_add_func ("/MM/cinterion/smoni/response/4g",       test_smoni_response_4g);
+    g_test_add_func ("/MM/cinterion/smoni/response/search",   test_smoni_response_search);
 
     return g_test_run ();
 }
@@ -42,6 +42,7 @@
 #include "mm-iface-modem-location.h"
 #include "mm-iface-modem-time.h"
 #include "mm-iface-modem-cdma.h"
+#include "mm-iface-modem-signal.h"
 #include "mm-broadband-modem-huawei.h"
 #include "mm-broadband-bearer-huawei.h"
 #include "mm-broadband-bearer.h"
@@ -54,11 +55,13 @@ static void iface_modem_3gpp_ussd_init (MMIfaceModem3gppUssd *iface);
 static void iface_modem_location_init (MMIfaceModemLocation *iface);
 static void iface_modem_cdma_init (MMIfaceModemCdma *iface);
 static void iface_modem_time_init (MMIfaceModemTime *iface);
+static void iface_modem_signal_init (MMIfaceModemSignal *iface);
 
 static MMIfaceModem *iface_modem_parent;
 static MMIfaceModem3gpp *iface_modem_3gpp_parent;
 static MMIfaceModemLocation *iface_modem_location_parent;
 static MMIfaceModemCdma *iface_modem_cdma_parent;
+static MMIfaceModemSignal *iface_modem_signal_parent;
 
 G_DEFINE_TYPE_EXTENDED (MMBroadbandModemHuawei, mm_broadband_modem_huawei, MM_TYPE_BROADBAND_MODEM, 0,
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM, iface_modem_init)
@@ -66,7 +69,8 @@ G_DEFINE_TYPE_EXTENDED (MMBroadbandModemHuawei, mm_broadband_modem_huawei, MM_TY
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_3GPP_USSD, iface_modem_3gpp_ussd_init)
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_CDMA, iface_modem_cdma_init)
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_LOCATION, iface_modem_location_init)
-                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_TIME, iface_modem_time_init));
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_TIME, iface_modem_time_init)
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_SIGNAL, iface_modem_signal_init));
 
 typedef enum {
     FEATURE_SUPPORT_UNKNOWN,
@@ -79,6 +83,8 @@ struct _MMBroadbandModemHuaweiPrivate {
     GRegex *rssi_regex;
     GRegex *rssilvl_regex;
     GRegex *hrssilvl_regex;
+    GRegex *csnr_regex;
+    GRegex *hcsq_regex;
 
     /* Regex for access-technology related notifications */
     GRegex *mode_regex;
@@ -90,14 +96,12 @@ struct _MMBroadbandModemHuaweiPrivate {
     /* Regex to ignore */
     GRegex *boot_regex;
     GRegex *connect_regex;
-    GRegex *csnr_regex;
     GRegex *cusatp_regex;
     GRegex *cusatend_regex;
     GRegex *dsdormant_regex;
     GRegex *simst_regex;
     GRegex *srvst_regex;
     GRegex *stin_regex;
-    GRegex *hcsq_regex;
     GRegex *pdpdeact_regex;
     GRegex *ndisend_regex;
     GRegex *rfswitch_regex;
@@ -110,9 +114,22 @@ struct _MMBroadbandModemHuaweiPrivate {
     FeatureSupport prefmode_support;
     FeatureSupport time_support;
     FeatureSupport nwtime_support;
+    FeatureSupport hcsq_support;
 
     MMModemLocationSource enabled_sources;
 
+    /* Extended signal information last reported by ^HCSQ or ^CSNR */
+    gboolean signal_reports_enabled;
+    gboolean signal_reported;
+    MMModemAccessTechnology signal_act;
+    MMSignal *signal;
+
+    /* Values in the reply to an explicit ^HCSQ? query; kept apart so that
+     * they're not taken as unsolicited reports */
+    gboolean hcsq_query_pending;
+    MMModemAccessTechnology hcsq_query_act;
+    MMSignal *hcsq_query_signal;
+
     GArray *syscfg_supported_modes;
     GArray *syscfgex_supported_modes;
     GArray *prefmode_supported_modes;
@@ -1544,6 +1561,136 @@ huawei_signal_changed (MMPortSerialAt *port,
     mm_iface_modem_update_signal_quality (MM_IFACE_MODEM (self), (guint)quality);
 }
 
+static void
+signal_values_get (MMModemAccessTechnology act,
+                   MMSignal *signal,
+                   MMSignal **cdma,
+                   MMSignal **evdo,
+                   MMSignal **gsm,
+                   MMSignal **umts,
+                   MMSignal **lte)
+{
+    MMSignal **current = NULL;
+
+    /* Only the current technology is reported; values of any other one (or
+     * all of them, when there is no service) are no longer valid, so give
+     * empty ones to have them explicitly cleared */
+    *cdma = mm_signal_new ();
+    *evdo = mm_signal_new ();
+    *gsm  = mm_signal_new ();
+    *umts = mm_signal_new ();
+    *lte  = mm_signal_new ();
+
+    if (!signal)
+        return;
+
+    switch (act) {
+    case MM_MODEM_ACCESS_TECHNOLOGY_1XRTT:
+        current = cdma;
+        break;
+    case MM_MODEM_ACCESS_TECHNOLOGY_EVDO0:
+        current = evdo;
+        break;
+    case MM_MODEM_ACCESS_TECHNOLOGY_GSM:
+        current = gsm;
+        break;
+    case MM_MODEM_ACCESS_TECHNOLOGY_UMTS:
+        current = umts;
+        break;
+    case MM_MODEM_ACCESS_TECHNOLOGY_LTE:
+        current = lte;
+        break;
+    default:
+        return;
+    }
+
+    g_object_unref (*current);
+    *current = g_object_ref (signal);
+}
+
+static void
+huawei_update_signal (MMBroadbandModemHuawei *self,
+                      MMModemAccessTechnology act,
+                      MMSignal *signal)
+{
+    MMSignal *cdma, *evdo, *gsm, *umts, *lte;
+
+    /* Reports only include the current technology, so replace whatever
+     * we had */
+    if (self->priv->signal)
+        g_object_unref (self->priv->signal);
+    self->priv->signal = signal;
+    self->priv->signal_act = act;
+    self->priv->signal_reported = TRUE;
+
+    signal_values_get (act, signal, &cdma, &evdo, &gsm, &umts, &lte);
+    mm_iface_modem_signal_update (MM_IFACE_MODEM_SIGNAL (self), cdma, evdo, gsm, umts, lte);
+    g_clear_object (&cdma);
+    g_clear_object (&evdo);
+    g_clear_object (&gsm);
+    g_clear_object (&umts);
+    g_clear_object (&lte);
+}
+
+static void
+huawei_hcsq_changed (MMPortSerialAt *port,
+                     GMatchInfo *match_info,
+                     MMBroadbandModemHuawei *self)
+{
+    gchar *str;
+    MMModemAccessTechnology act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+    MMSignal *signal = NULL;
+    GError *error = NULL;
+
+    str = g_match_info_fetch (match_info, 1);
+    if (!mm_huawei_parse_hcsq_response (str, &act, &signal, &error)) {
+        mm_dbg ("Ignoring invalid ^HCSQ report: %s", error->message);
+        g_error_free (error);
+        g_free (str);
+        return;
+    }
+    g_free (str);
+
+    /* The reply to our own ^HCSQ? query is also matched here */
+    if (self->priv->hcsq_query_pending) {
+        if (self->priv->hcsq_query_signal)
+            g_object_unref (self->priv->hcsq_query_signal);
+        self->priv->hcsq_query_signal = signal;
+        self->priv->hcsq_query_act = act;
+        return;
+    }
+
+    huawei_update_signal (self, act, signal);
+}
+
+static void
+huawei_csnr_changed (MMPortSerialAt *port,
+                     GMatchInfo *match_info,
+                     MMBroadbandModemHuawei *self)
+{
+    gchar *str;
+    gint rscp = 0;
+    gint ecio = 0;
+    MMSignal *signal;
+    GError *error = NULL;
+
+    str = g_match_info_fetch (match_info, 1);
+    if (!mm_huawei_parse_csnr_response (str, &rscp, &ecio, &error)) {
+        mm_dbg ("Ignoring invalid ^CSNR report: %s", error->message);
+        g_error_free (error);
+        g_free (str);
+        return;
+    }
+    g_free (str);
+
+    /* WCDMA only; as there is no RSCP in MMSignal, report the RSSI it
+     * implies instead */
+    signal = mm_signal_new ();
+    mm_signal_set_ecio (signal, (gdouble)ecio);
+    mm_signal_set_rssi (signal, (gdouble)(rscp - ecio));
+    huawei_update_signal (self, MM_MODEM_ACCESS_TECHNOLOGY_UMTS, signal);
+}
+
 static void
 huawei_mode_changed (MMPortSerialAt *port,
                      GMatchInfo *match_info,
@@ -1741,6 +1888,14 @@ set_3gpp_unsolicited_events_handlers (MMBroadbandModemHuawei *self,
             enable ? self : NULL,
             NULL);
 
+        /* Extended signal information related (^HCSQ is always handled) */
+        mm_port_serial_at_add_unsolicited_msg_handler (
+            port,
+            self->priv->csnr_regex,
+            enable ? (MMPortSerialAtUnsolicitedMsgFn)huawei_csnr_changed : NULL,
+            enable ? self : NULL,
+            NULL);
+
         /* Access technology related */
         mm_port_serial_at_add_unsolicited_msg_handler (
             port,
@@ -1766,6 +1921,13 @@ set_3gpp_unsolicited_events_handlers (MMBroadbandModemHuawei *self,
     }
 
     g_list_free_full (ports, (GDestroyNotify)g_object_unref);
+
+    self->priv->signal_reports_enabled = enable;
+
+    /* Without reports, values would get stale; and when enabling them, only
+     * the reports received from now on can be trusted to keep coming */
+    self->priv->signal_reported = FALSE;
+    g_clear_object (&self->priv->signal);
 }
 
 static gboolean
@@ -3568,6 +3730,234 @@ modem_time_check_support (MMIfaceModemTime *self,
                                result);
 }
 
+/*****************************************************************************/
+/* Check support (Signal interface) */
+
+static gboolean
+modem_signal_check_support_finish (MMIfaceModemSignal *self,
+                                   GAsyncResult *res,
+                                   GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+parent_signal_check_support_ready (MMIfaceModemSignal *self,
+                                   GAsyncResult *res,
+                                   GSimpleAsyncResult *simple)
+{
+    GError *error = NULL;
+
+    if (!iface_modem_signal_parent->check_support_finish (self, res, &error))
+        g_simple_async_result_take_error (simple, error);
+    else
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+hcsq_check_ready (MMBaseModem *_self,
+                  GAsyncResult *res,
+                  GSimpleAsyncResult *simple)
+{
+    MMBroadbandModemHuawei *self = MM_BROADBAND_MODEM_HUAWEI (_self);
+
+    self->priv->hcsq_query_pending = FALSE;
+    g_clear_object (&self->priv->hcsq_query_signal);
+
+    if (!mm_base_modem_at_command_finish (_self, res, NULL)) {
+        /* Fall back to the generic implementation */
+        self->priv->hcsq_support = FEATURE_NOT_SUPPORTED;
+        iface_modem_signal_parent->check_support (
+            MM_IFACE_MODEM_SIGNAL (self),
+            (GAsyncReadyCallback)parent_signal_check_support_ready,
+            simple);
+        return;
+    }
+
+    self->priv->hcsq_support = FEATURE_SUPPORTED;
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+modem_signal_check_support (MMIfaceModemSignal *self,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        modem_signal_check_support);
+
+    MM_BROADBAND_MODEM_HUAWEI (self)->priv->hcsq_query_pending = TRUE;
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "^HCSQ?",
+                              3,
+                              FALSE,
+                              (GAsyncReadyCallback)hcsq_check_ready,
+                              result);
+}
+
+/*****************************************************************************/
+/* Load extended signal information (Signal interface) */
+
+typedef struct {
+    MMSignal *cdma;
+    MMSignal *evdo;
+    MMSignal *gsm;
+    MMSignal *umts;
+    MMSignal *lte;
+} SignalLoadValuesResult;
+
+static void
+signal_load_values_result_free (SignalLoadValuesResult *result)
+{
+    g_clear_object (&result->cdma);
+    g_clear_object (&result->evdo);
+    g_clear_object (&result->gsm);
+    g_clear_object (&result->umts);
+    g_clear_object (&result->lte);
+    g_slice_free (SignalLoadValuesResult, result);
+}
+
+static gboolean
+modem_signal_load_values_finish (MMIfaceModemSignal *self,
+                                 GAsyncResult *res,
+                                 MMSignal **cdma,
+                                 MMSignal **evdo,
+                                 MMSignal **gsm,
+                                 MMSignal **umts,
+                                 MMSignal **lte,
+                                 GError **error)
+{
+    SignalLoadValuesResult *values;
+
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return FALSE;
+
+    values = g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+    *cdma = values->cdma ? g_object_ref (values->cdma) : NULL;
+    *evdo = values->evdo ? g_object_ref (values->evdo) : NULL;
+    *gsm  = values->gsm  ? g_object_ref (values->gsm)  : NULL;
+    *umts = values->umts ? g_object_ref (values->umts) : NULL;
+    *lte  = values->lte  ? g_object_ref (values->lte)  : NULL;
+    return TRUE;
+}
+
+static void
+signal_load_values_set_result (GSimpleAsyncResult *simple,
+                               MMModemAccessTechnology act,
+                               MMSignal *signal)
+{
+    SignalLoadValuesResult *values;
+
+    values = g_slice_new0 (SignalLoadValuesResult);
+    signal_values_get (act, signal,
+                       &values->cdma, &values->evdo,
+                       &values->gsm, &values->umts, &values->lte);
+    g_simple_async_result_set_op_res_gpointer (simple,
+                                               values,
+                                               (GDestroyNotify)signal_load_values_result_free);
+}
+
+static void
+parent_signal_load_values_ready (MMIfaceModemSignal *self,
+                                 GAsyncResult *res,
+                                 GSimpleAsyncResult *simple)
+{
+    SignalLoadValuesResult *values;
+    GError *error = NULL;
+
+    values = g_slice_new0 (SignalLoadValuesResult);
+    if (!iface_modem_signal_parent->load_values_finish (self, res,
+                                                        &values->cdma, &values->evdo,
+                                                        &values->gsm, &values->umts, &values->lte,
+                                                        &error)) {
+        g_slice_free (SignalLoadValuesResult, values);
+        g_simple_async_result_take_error (simple, error);
+    } else
+        g_simple_async_result_set_op_res_gpointer (simple,
+                                                   values,
+                                                   (GDestroyNotify)signal_load_values_result_free);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+hcsq_load_ready (MMBaseModem *_self,
+                 GAsyncResult *res,
+                 GSimpleAsyncResult *simple)
+{
+    MMBroadbandModemHuawei *self = MM_BROADBAND_MODEM_HUAWEI (_self);
+    GError *error = NULL;
+
+    self->priv->hcsq_query_pending = FALSE;
+
+    /* The ^HCSQ line in the reply is always matched by the unsolicited
+     * message handler before we get here, so the response itself is empty;
+     * take the values it stored instead */
+    if (!mm_base_modem_at_command_finish (_self, res, &error))
+        g_simple_async_result_take_error (simple, error);
+    else if (!self->priv->hcsq_query_signal)
+        g_simple_async_result_set_error (simple,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_FAILED,
+                                         "No ^HCSQ response received");
+    else
+        signal_load_values_set_result (simple, self->priv->hcsq_query_act, self->priv->hcsq_query_signal);
+    g_clear_object (&self->priv->hcsq_query_signal);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+modem_signal_load_values (MMIfaceModemSignal *_self,
+                          GCancellable *cancellable,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    MMBroadbandModemHuawei *self = MM_BROADBAND_MODEM_HUAWEI (_self);
+    GSimpleAsyncResult *result;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        modem_signal_load_values);
+
+    /* If the modem reports changes by itself, the last values reported are
+     * still the current ones; no need to query */
+    if (self->priv->signal_reports_enabled && self->priv->signal_reported) {
+        signal_load_values_set_result (result, self->priv->signal_act, self->priv->signal);
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
+    if (self->priv->hcsq_support == FEATURE_SUPPORTED) {
+        /* Only the values in the reply count */
+        self->priv->hcsq_query_pending = TRUE;
+        g_clear_object (&self->priv->hcsq_query_signal);
+        mm_base_modem_at_command (MM_BASE_MODEM (self),
+                                  "^HCSQ?",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)hcsq_load_ready,
+                                  result);
+        return;
+    }
+
+    iface_modem_signal_parent->load_values (
+        _self,
+        cancellable,
+        (GAsyncReadyCallback)parent_signal_load_values_ready,
+        result);
+}
+
 /*****************************************************************************/
 /* Setup ports (Broadband modem class) */
 
@@ -3618,10 +4008,6 @@ set_ignored_unsolicited_events_handlers (MMBroadbandModemHuawei *self)
             port,
             self->priv->stin_regex,
             NULL, NULL, NULL);
-        mm_port_serial_at_add_unsolicited_msg_handler (
-            port,
-            self->priv->hcsq_regex,
-            NULL, NULL, NULL);
         mm_port_serial_at_add_unsolicited_msg_handler (
             port,
             self->priv->pdpdeact_regex,
@@ -3639,6 +4025,29 @@ set_ignored_unsolicited_events_handlers (MMBroadbandModemHuawei *self)
     g_list_free_full (ports, (GDestroyNotify)g_object_unref);
 }
 
+static void
+set_always_handled_unsolicited_events_handlers (MMBroadbandModemHuawei *self)
+{
+    GList *ports, *l;
+
+    ports = get_at_port_list (self);
+
+    for (l = ports; l; l = g_list_next (l)) {
+        MMPortSerialAt *port = MM_PORT_SERIAL_AT (l->data);
+
+        /* The reply to ^HCSQ? is matched here as well, so the values it
+         * gives can only be taken from this handler */
+        mm_port_serial_at_add_unsolicited_msg_handler (
+            port,
+            self->priv->hcsq_regex,
+            (MMPortSerialAtUnsolicitedMsgFn)huawei_hcsq_changed,
+            self,
+            NULL);
+    }
+
+    g_list_free_full (ports, (GDestroyNotify)g_object_unref);
+}
+
 static void
 gps_trace_received (MMPortSerialGps *port,
                     const gchar *trace,
@@ -3658,6 +4067,9 @@ setup_ports (MMBroadbandModem *self)
     /* Unsolicited messages to always ignore */
     set_ignored_unsolicited_events_handlers (MM_BROADBAND_MODEM_HUAWEI (self));
 
+    /* Unsolicited messages to always handle */
+    set_always_handled_unsolicited_events_handlers (MM_BROADBAND_MODEM_HUAWEI (self));
+
     /* Now reset the unsolicited messages we'll handle when enabled */
     set_3gpp_unsolicited_events_handlers (MM_BROADBAND_MODEM_HUAWEI (self), FALSE);
     set_cdma_unsolicited_events_handlers (MM_BROADBAND_MODEM_HUAWEI (self), FALSE);
@@ -3723,7 +4135,7 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     self->priv->connect_regex = g_regex_new ("\\r\\n\\^CONNECT .+\\r\\n",
                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->csnr_regex = g_regex_new ("\\r\\n\\^CSNR:.+\\r\\n",
+    self->priv->csnr_regex = g_regex_new ("\\r\\n(\\^CSNR:.+)\\r\\n",
                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     self->priv->cusatp_regex = g_regex_new ("\\r\\n\\+CUSATP:.+\\r\\n",
                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
@@ -3737,8 +4149,7 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     self->priv->stin_regex = g_regex_new ("\\r\\n\\^STIN:.+\\r\\n",
                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hcsq_regex = g_regex_new ("\\r\\n\\^HCSQ:.+\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->hcsq_regex = mm_huawei_hcsq_regex_get ();
     self->priv->pdpdeact_regex = g_regex_new ("\\r\\n\\^PDPDEACT:.+\\r+\\n",
                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
     self->priv->ndisend_regex = g_regex_new ("\\r\\n\\^NDISEND:.+\\r+\\n",
@@ -3754,6 +4165,7 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
     self->priv->prefmode_support = FEATURE_SUPPORT_UNKNOWN;
     self->priv->nwtime_support = FEATURE_SUPPORT_UNKNOWN;
     self->priv->time_support = FEATURE_SUPPORT_UNKNOWN;
+    self->priv->hcsq_support = FEATURE_SUPPORT_UNKNOWN;
 }
 
 static void
@@ -3787,6 +4199,10 @@ finalize (GObject *object)
         g_array_unref (self->priv->syscfgex_supported_modes);
     if (self->priv->prefmode_supported_modes)
         g_array_unref (self->priv->prefmode_supported_modes);
+    if (self->priv->signal)
+        g_object_unref (self->priv->signal);
+    if (self->priv->hcsq_query_signal)
+        g_object_unref (self->priv->hcsq_query_signal);
 
     G_OBJECT_CLASS (mm_broadband_modem_huawei_parent_class)->finalize (object);
 }
@@ -3891,6 +4307,17 @@ iface_modem_time_init (MMIfaceModemTime *iface)
     iface->load_network_timezone_finish = modem_time_load_network_timezone_finish;
 }
 
+static void
+iface_modem_signal_init (MMIfaceModemSignal *iface)
+{
+    iface_modem_signal_parent = g_type_interface_peek_parent (iface);
+
+    iface->check_support = modem_signal_check_support;
+    iface->check_support_finish = modem_signal_check_support_finish;
+    iface->load_values = modem_signal_load_values;
+    iface->load_values_finish = modem_signal_load_values_finish;
+}
+
 static void
 mm_broadband_modem_huawei_class_init (MMBroadbandModemHuaweiClass *klass)
 {
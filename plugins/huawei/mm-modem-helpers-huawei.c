@@ -1184,3 +1184,183 @@ gboolean mm_huawei_parse_time_response (const gchar *response,
     return ret;
 }
 
+/*****************************************************************************/
+/* ^HCSQ response parser */
+
+GRegex *
+mm_huawei_hcsq_regex_get (void)
+{
+    return g_regex_new ("\\r\\n(\\^HCSQ:.+)\\r+\\n",
+                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
+                        0,
+                        NULL);
+}
+
+/* Most levels are reported in 1 dBm (or 0.5 dB) steps with 0 meaning "below
+ * the minimum"; we report the lower bound of the range. 255 means unknown. */
+
+static gboolean
+hcsq_level_to_value (const gchar *str,
+                     guint max,
+                     gdouble min,
+                     gdouble step,
+                     gdouble *out)
+{
+    guint level;
+
+    if (!str || !mm_get_uint_from_str (str, &level) || level > max)
+        return FALSE;
+    *out = min - step + (step * level);
+    return TRUE;
+}
+
+#define HCSQ_RSSI(str, out) hcsq_level_to_value (str,  96, -120.0, 1.0, out)
+#define HCSQ_RSCP(str, out) hcsq_level_to_value (str,  96, -120.0, 1.0, out)
+#define HCSQ_ECIO(str, out) hcsq_level_to_value (str,  65,  -32.0, 0.5, out)
+#define HCSQ_RSRP(str, out) hcsq_level_to_value (str,  97, -140.0, 1.0, out)
+#define HCSQ_SINR(str, out) hcsq_level_to_value (str, 251,  -20.0, 0.2, out)
+#define HCSQ_RSRQ(str, out) hcsq_level_to_value (str,  34,  -19.5, 0.5, out)
+
+gboolean
+mm_huawei_parse_hcsq_response (const gchar *response,
+                               MMModemAccessTechnology *out_act,
+                               MMSignal **out_signal,
+                               GError **error)
+{
+    gchar **split;
+    const gchar *mode;
+    guint n_values;
+    guint i;
+    gdouble value;
+    gdouble rscp;
+    MMModemAccessTechnology act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+    MMSignal *signal = NULL;
+
+    g_assert (out_act != NULL);
+    g_assert (out_signal != NULL);
+
+    /* Format:
+     *
+     * ^HCSQ: "NOSERVICE"
+     * ^HCSQ: "GSM",<rssi>
+     * ^HCSQ: "WCDMA",<rssi>,<rscp>,<ecio>
+     * ^HCSQ: "LTE",<rssi>,<rsrp>,<sinr>,<rsrq>
+     * ^HCSQ: "CDMA",<rssi>,<ecio>
+     * ^HCSQ: "EVDO",<rssi>,<sinr>,<ecio>
+     */
+    response = mm_strip_tag (response, "^HCSQ:");
+    split = g_strsplit (response, ",", -1);
+    n_values = g_strv_length (split);
+    if (n_values < 1) {
+        g_set_error_literal (error,
+                             MM_CORE_ERROR,
+                             MM_CORE_ERROR_FAILED,
+                             "Couldn't parse ^HCSQ reply");
+        g_strfreev (split);
+        return FALSE;
+    }
+
+    for (i = 0; i < n_values; i++)
+        g_strstrip (split[i]);
+    mode = mm_strip_quotes (split[0]);
+
+    if (g_str_equal (mode, "NOSERVICE")) {
+        /* Nothing to report */
+    } else if (g_str_equal (mode, "GSM")) {
+        act = MM_MODEM_ACCESS_TECHNOLOGY_GSM;
+        signal = mm_signal_new ();
+        if (n_values > 1 && HCSQ_RSSI (split[1], &value))
+            mm_signal_set_rssi (signal, value);
+    } else if (g_str_equal (mode, "WCDMA")) {
+        act = MM_MODEM_ACCESS_TECHNOLOGY_UMTS;
+        signal = mm_signal_new ();
+        if (n_values > 1 && HCSQ_RSSI (split[1], &value))
+            mm_signal_set_rssi (signal, value);
+        /* There is no RSCP in MMSignal; only used to compute the RSSI when
+         * that is not given */
+        if (n_values > 3 && HCSQ_ECIO (split[3], &value)) {
+            mm_signal_set_ecio (signal, value);
+            if (mm_signal_get_rssi (signal) == MM_SIGNAL_UNKNOWN &&
+                HCSQ_RSCP (split[2], &rscp))
+                mm_signal_set_rssi (signal, rscp - value);
+        }
+    } else if (g_str_equal (mode, "LTE")) {
+        act = MM_MODEM_ACCESS_TECHNOLOGY_LTE;
+        signal = mm_signal_new ();
+        if (n_values > 1 && HCSQ_RSSI (split[1], &value))
+            mm_signal_set_rssi (signal, value);
+        if (n_values > 2 && HCSQ_RSRP (split[2], &value))
+            mm_signal_set_rsrp (signal, value);
+        if (n_values > 3 && HCSQ_SINR (split[3], &value))
+            mm_signal_set_snr (signal, value);
+        if (n_values > 4 && HCSQ_RSRQ (split[4], &value))
+            mm_signal_set_rsrq (signal, value);
+    } else if (g_str_equal (mode, "CDMA")) {
+        act = MM_MODEM_ACCESS_TECHNOLOGY_1XRTT;
+        signal = mm_signal_new ();
+        if (n_values > 1 && HCSQ_RSSI (split[1], &value))
+            mm_signal_set_rssi (signal, value);
+        if (n_values > 2 && HCSQ_ECIO (split[2], &value))
+            mm_signal_set_ecio (signal, value);
+    } else if (g_str_equal (mode, "EVDO")) {
+        act = MM_MODEM_ACCESS_TECHNOLOGY_EVDO0;
+        signal = mm_signal_new ();
+        if (n_values > 1 && HCSQ_RSSI (split[1], &value))
+            mm_signal_set_rssi (signal, value);
+        if (n_values > 3 && HCSQ_ECIO (split[3], &value))
+            mm_signal_set_ecio (signal, value);
+    } else {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Unknown ^HCSQ system mode: '%s'",
+                     mode);
+        g_strfreev (split);
+        return FALSE;
+    }
+
+    g_strfreev (split);
+
+    *out_act = act;
+    *out_signal = signal;
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* ^CSNR response parser */
+
+gboolean
+mm_huawei_parse_csnr_response (const gchar *response,
+                               gint *out_rscp,
+                               gint *out_ecio,
+                               GError **error)
+{
+    GRegex *r;
+    GMatchInfo *match_info = NULL;
+    gboolean ret = FALSE;
+
+    g_assert (out_rscp != NULL);
+    g_assert (out_ecio != NULL);
+
+    /* Format, in dBm and dB respectively:
+     *
+     * ^CSNR: <rscp>,<ecio>
+     */
+    r = g_regex_new ("\\^CSNR:\\s*(-?\\d+)\\s*,\\s*(-?\\d+)", 0, 0, NULL);
+    g_assert (r != NULL);
+
+    if (g_regex_match (r, response, 0, &match_info) &&
+        mm_get_int_from_match_info (match_info, 1, out_rscp) &&
+        mm_get_int_from_match_info (match_info, 2, out_ecio))
+        ret = TRUE;
+    else
+        g_set_error_literal (error,
+                             MM_CORE_ERROR,
+                             MM_CORE_ERROR_FAILED,
+                             "Couldn't parse ^CSNR reply");
+
+    g_match_info_free (match_info);
+    g_regex_unref (r);
+
+    return ret;
+}
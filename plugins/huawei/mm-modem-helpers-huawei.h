@@ -129,4 +129,25 @@ gboolean mm_huawei_parse_time_response (const gchar *response,
                                         MMNetworkTimezone **tzp,
                                         GError **error);
 
+/*****************************************************************************/
+/* ^HCSQ response parser */
+
+/* Matches both unsolicited reports and the reply to ^HCSQ?; the whole
+ * ^HCSQ line is given in the first match group */
+GRegex *mm_huawei_hcsq_regex_get (void);
+
+/* Signal is NULL when there is no service */
+gboolean mm_huawei_parse_hcsq_response (const gchar *response,
+                                        MMModemAccessTechnology *out_act,
+                                        MMSignal **out_signal,
+                                        GError **error);
+
+/*****************************************************************************/
+/* ^CSNR response parser */
+
+gboolean mm_huawei_parse_csnr_response (const gchar *response,
+                                        gint *out_rscp,
+                                        gint *out_ecio,
+                                        GError **error);
+
 #endif  /* MM_MODEM_HELPERS_HUAWEI_H */
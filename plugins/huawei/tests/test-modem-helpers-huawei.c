@@ -16,6 +16,11 @@
 #include <glib.h>
 #include <glib-object.h>
 #include <locale.h>
+#include <string.h>
+#include <pty.h>
+#include <unistd.h>
+#include <termios.h>
+#include <fcntl.h>
 
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
@@ -24,6 +29,8 @@
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-huawei.h"
+#include "mm-port-serial-at.h"
+#include "mm-serial-parsers.h"
 
 /*****************************************************************************/
 /* Test ^NDISSTAT / ^NDISSTATQRY responses */
@@ -1133,6 +1140,279 @@ test_time (void)
     }
 }
 
+/*****************************************************************************/
+/* Test ^HCSQ responses */
+
+#define UNKNOWN MM_SIGNAL_UNKNOWN
+
+typedef struct {
+    const gchar *str;
+    gboolean ret;
+    MMModemAccessTechnology act;
+    gdouble rssi;
+    gdouble ecio;
+    gdouble rsrp;
+    gdouble snr;
+    gdouble rsrq;
+} HcsqTest;
+
+static const HcsqTest hcsq_tests[] = {
+    { "^HCSQ: \"LTE\",50,60,120,20", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_LTE,
+      -71.0, UNKNOWN, -81.0, 3.8, -10.0 },
+    { "^HCSQ:\"LTE\",255,255,255,255\r\n", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_LTE,
+      UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"WCDMA\",30,30,58", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_UMTS,
+      -91.0, -3.5, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"WCDMA\",255,30,58", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_UMTS,
+      -87.5, -3.5, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"GSM\",20", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_GSM,
+      -101.0, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"CDMA\",40,30", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_1XRTT,
+      -81.0, -17.5, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"NOSERVICE\"", TRUE, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
+      UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN },
+    { "^HCSQ: \"UNKNOWN\",20", FALSE, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
+      UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN },
+    { NULL, FALSE, MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN,
+      UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN }
+};
+
+static void
+assert_signal_value (gdouble expected,
+                     gdouble value)
+{
+    if (expected == UNKNOWN)
+        g_assert_cmpfloat (value, ==, UNKNOWN);
+    else
+        g_assert_cmpfloat (ABS (expected - value), <, 0.001);
+}
+
+static void
+test_hcsq (void)
+{
+    guint i;
+
+    for (i = 0; hcsq_tests[i].str; i++) {
+        GError *error = NULL;
+        MMModemAccessTechnology act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
+        MMSignal *signal = NULL;
+        gboolean ret;
+
+        ret = mm_huawei_parse_hcsq_response (hcsq_tests[i].str,
+                                             &act,
+                                             &signal,
+                                             &error);
+
+        g_assert (ret == hcsq_tests[i].ret);
+        g_assert (ret == (error ? FALSE : TRUE));
+        g_clear_error (&error);
+        if (!ret)
+            continue;
+
+        g_assert_cmpuint (act, ==, hcsq_tests[i].act);
+        if (act == MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN) {
+            g_assert (signal == NULL);
+            continue;
+        }
+
+        g_assert (signal != NULL);
+        assert_signal_value (hcsq_tests[i].rssi, mm_signal_get_rssi (signal));
+        assert_signal_value (hcsq_tests[i].ecio, mm_signal_get_ecio (signal));
+        assert_signal_value (hcsq_tests[i].rsrp, mm_signal_get_rsrp (signal));
+        assert_signal_value (hcsq_tests[i].snr,  mm_signal_get_snr  (signal));
+        assert_signal_value (hcsq_tests[i].rsrq, mm_signal_get_rsrq (signal));
+        g_object_unref (signal);
+    }
+}
+
+/*****************************************************************************/
+/* Test ^HCSQ? replies going through an AT port */
+
+typedef struct {
+    GMainLoop *loop;
+    int master;
+    GString *request;
+    MMModemAccessTechnology act;
+    MMSignal *signal;
+    gchar *response;
+    GError *error;
+} HcsqPortTest;
+
+static void
+hcsq_port_report (MMPortSerialAt *port,
+                  GMatchInfo *match_info,
+                  HcsqPortTest *ctx)
+{
+    gchar *str;
+
+    str = g_match_info_fetch (match_info, 1);
+    g_assert (mm_huawei_parse_hcsq_response (str, &ctx->act, &ctx->signal, NULL));
+    g_free (str);
+}
+
+static gboolean
+hcsq_port_modem (HcsqPortTest *ctx)
+{
+    static const gchar reply[] = "\r\n^HCSQ: \"LTE\",50,60,120,20\r\n\r\nOK\r\n";
+    gchar buf[64];
+    ssize_t n;
+
+    /* Reply once the whole command has been received */
+    n = read (ctx->master, buf, sizeof (buf));
+    if (n > 0)
+        g_string_append_len (ctx->request, buf, n);
+    if (!strchr (ctx->request->str, '\r'))
+        return TRUE;
+
+    g_assert_cmpstr (ctx->request->str, ==, "AT^HCSQ?\r");
+    g_assert_cmpint (write (ctx->master, reply, strlen (reply)), ==, strlen (reply));
+    return FALSE;
+}
+
+static void
+hcsq_port_command_ready (MMPortSerialAt *port,
+                         GAsyncResult *res,
+                         HcsqPortTest *ctx)
+{
+    ctx->response = g_strdup (mm_port_serial_at_command_finish (port, res, &ctx->error));
+    g_main_loop_quit (ctx->loop);
+}
+
+static gboolean
+hcsq_port_timeout (HcsqPortTest *ctx)
+{
+    g_assert_not_reached ();
+    return FALSE;
+}
+
+static void
+test_hcsq_port (void)
+{
+    HcsqPortTest ctx;
+    struct termios stbuf;
+    int slave;
+    MMPortSerialAt *port;
+    GRegex *regex;
+    GError *error = NULL;
+    guint timeout_id;
+
+    memset (&ctx, 0, sizeof (ctx));
+    g_assert (openpty (&ctx.master, &slave, NULL, NULL, NULL) == 0);
+
+    /* set raw mode on the slave using kernel default parameters */
+    memset (&stbuf, 0, sizeof (stbuf));
+    tcgetattr (slave, &stbuf);
+    tcflush (slave, TCIOFLUSH);
+    cfmakeraw (&stbuf);
+    tcsetattr (slave, TCSANOW, &stbuf);
+    fcntl (slave, F_SETFL, O_NONBLOCK);
+    fcntl (ctx.master, F_SETFL, O_NONBLOCK);
+
+    port = MM_PORT_SERIAL_AT (g_object_new (MM_TYPE_PORT_SERIAL_AT,
+                                            MM_PORT_DEVICE, "hcsq",
+                                            MM_PORT_SUBSYS, MM_PORT_SUBSYS_TTY,
+                                            MM_PORT_TYPE, MM_PORT_TYPE_AT,
+                                            MM_PORT_SERIAL_FD, slave,
+                                            MM_PORT_SERIAL_SEND_DELAY, (guint64) 0,
+                                            MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED, FALSE,
+                                            NULL));
+    mm_port_serial_at_set_response_parser (port,
+                                           mm_serial_parser_v1_parse,
+                                           mm_serial_parser_v1_new (),
+                                           mm_serial_parser_v1_destroy);
+
+    /* Same setup as the modem: ^HCSQ is always handled */
+    regex = mm_huawei_hcsq_regex_get ();
+    mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                   regex,
+                                                   (MMPortSerialAtUnsolicitedMsgFn)hcsq_port_report,
+                                                   &ctx,
+                                                   NULL);
+
+    g_assert (mm_port_serial_open (MM_PORT_SERIAL (port), &error));
+    g_assert_no_error (error);
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+    ctx.request = g_string_new ("");
+    mm_port_serial_at_command (port,
+                               "^HCSQ?",
+                               3,
+                               FALSE,
+                               FALSE,
+                               NULL,
+                               (GAsyncReadyCallback)hcsq_port_command_ready,
+                               &ctx);
+    g_timeout_add (10, (GSourceFunc)hcsq_port_modem, &ctx);
+    timeout_id = g_timeout_add_seconds (5, (GSourceFunc)hcsq_port_timeout, &ctx);
+    g_main_loop_run (ctx.loop);
+    g_source_remove (timeout_id);
+
+    /* The ^HCSQ line never makes it to the command response; the values
+     * must be taken from the unsolicited message handler */
+    g_assert_no_error (ctx.error);
+    g_assert (ctx.response != NULL);
+    g_assert (strstr (ctx.response, "^HCSQ") == NULL);
+    g_assert_cmpuint (ctx.act, ==, MM_MODEM_ACCESS_TECHNOLOGY_LTE);
+    g_assert (ctx.signal != NULL);
+    assert_signal_value (-71.0, mm_signal_get_rssi (ctx.signal));
+    assert_signal_value (-81.0, mm_signal_get_rsrp (ctx.signal));
+    assert_signal_value (3.8,   mm_signal_get_snr  (ctx.signal));
+    assert_signal_value (-10.0, mm_signal_get_rsrq (ctx.signal));
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_object_unref (port);
+    g_regex_unref (regex);
+    g_object_unref (ctx.signal);
+    g_free (ctx.response);
+    g_string_free (ctx.request, TRUE);
+    g_main_loop_unref (ctx.loop);
+    close (ctx.master);
+}
+
+/*****************************************************************************/
+/* Test ^CSNR responses */
+
+typedef struct {
+    const gchar *str;
+    gboolean ret;
+    gint rscp;
+    gint ecio;
+} CsnrTest;
+
+static const CsnrTest csnr_tests[] = {
+    { "^CSNR: -102,-8", TRUE, -102, -8 },
+    { "\r\n^CSNR:-85,0\r\n", TRUE, -85, 0 },
+    { "^CSNR: -102", FALSE, 0, 0 },
+    { NULL, FALSE, 0, 0 }
+};
+
+static void
+test_csnr (void)
+{
+    guint i;
+
+    for (i = 0; csnr_tests[i].str; i++) {
+        GError *error = NULL;
+        gint rscp = 0;
+        gint ecio = 0;
+        gboolean ret;
+
+        ret = mm_huawei_parse_csnr_response (csnr_tests[i].str,
+                                             &rscp,
+                                             &ecio,
+                                             &error);
+
+        g_assert (ret == csnr_tests[i].ret);
+        g_assert (ret == (error ? FALSE : TRUE));
+        g_clear_error (&error);
+        if (!ret)
+            continue;
+
+        g_assert_cmpint (rscp, ==, csnr_tests[i].rscp);
+        g_assert_cmpint (ecio, ==, csnr_tests[i].ecio);
+    }
+}
+
 /*****************************************************************************/
 
 void
@@ -1173,6 +1453,9 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/huawei/syscfgex/response", test_syscfgex_response);
     g_test_add_func ("/MM/huawei/nwtime", test_nwtime);
     g_test_add_func ("/MM/huawei/time", test_time);
+    g_test_add_func ("/MM/huawei/hcsq", test_hcsq);
+    g_test_add_func ("/MM/huawei/hcsq/port", test_hcsq_port);
+    g_test_add_func ("/MM/huawei/csnr", test_csnr);
 
     return g_test_run ();
 }
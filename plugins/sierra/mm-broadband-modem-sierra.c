@@ -33,20 +33,25 @@
 #include "mm-iface-modem-3gpp.h"
 #include "mm-iface-modem-cdma.h"
 #include "mm-iface-modem-time.h"
+#include "mm-iface-modem-signal.h"
 #include "mm-common-sierra.h"
+#include "mm-modem-helpers-sierra.h"
 #include "mm-broadband-bearer-sierra.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_cdma_init (MMIfaceModemCdma *iface);
 static void iface_modem_time_init (MMIfaceModemTime *iface);
+static void iface_modem_signal_init (MMIfaceModemSignal *iface);
 
 static MMIfaceModem *iface_modem_parent;
 static MMIfaceModemCdma *iface_modem_cdma_parent;
+static MMIfaceModemSignal *iface_modem_signal_parent;
 
 G_DEFINE_TYPE_EXTENDED (MMBroadbandModemSierra, mm_broadband_modem_sierra, MM_TYPE_BROADBAND_MODEM, 0,
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM, iface_modem_init)
                         G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_CDMA, iface_modem_cdma_init)
-                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_TIME, iface_modem_time_init));
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_TIME, iface_modem_time_init)
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_IFACE_MODEM_SIGNAL, iface_modem_signal_init));
 
 typedef enum {
     TIME_METHOD_UNKNOWN = 0,
@@ -56,6 +61,8 @@ typedef enum {
 
 struct _MMBroadbandModemSierraPrivate {
     TimeMethod time_method;
+    /* Flag to know if we should use AT!GSTATUS for extended signal info */
+    gboolean gstatus_supported;
 };
 
 /*****************************************************************************/
@@ -1620,6 +1627,124 @@ modem_time_check_support (MMIfaceModemTime *self,
         result);
 }
 
+/*****************************************************************************/
+/* Check support (Signal interface) */
+
+static gboolean
+signal_check_support_finish (MMIfaceModemSignal *self,
+                             GAsyncResult *res,
+                             GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
+}
+
+static void
+parent_signal_check_support_ready (MMIfaceModemSignal *self,
+                                   GAsyncResult *res,
+                                   GSimpleAsyncResult *simple)
+{
+    GError *error = NULL;
+
+    if (!iface_modem_signal_parent->check_support_finish (self, res, &error))
+        g_simple_async_result_take_error (simple, error);
+    else
+        g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+gstatus_check_ready (MMBaseModem *_self,
+                     GAsyncResult *res,
+                     GSimpleAsyncResult *simple)
+{
+    MMBroadbandModemSierra *self = MM_BROADBAND_MODEM_SIERRA (_self);
+
+    if (!mm_base_modem_at_command_finish (_self, res, NULL)) {
+        /* Try with the generic implementation */
+        iface_modem_signal_parent->check_support (
+            MM_IFACE_MODEM_SIGNAL (self),
+            (GAsyncReadyCallback)parent_signal_check_support_ready,
+            simple);
+        return;
+    }
+
+    self->priv->gstatus_supported = TRUE;
+    g_simple_async_result_set_op_res_gboolean (simple, TRUE);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+signal_check_support (MMIfaceModemSignal *self,
+                      GAsyncReadyCallback callback,
+                      gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        signal_check_support);
+
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "!GSTATUS?",
+                              3,
+                              FALSE,
+                              (GAsyncReadyCallback)gstatus_check_ready,
+                              result);
+}
+
+/*****************************************************************************/
+/* Load extended signal information (Signal interface) */
+
+static gboolean
+signal_load_values_finish (MMIfaceModemSignal *_self,
+                           GAsyncResult *res,
+                           MMSignal **cdma,
+                           MMSignal **evdo,
+                           MMSignal **gsm,
+                           MMSignal **umts,
+                           MMSignal **lte,
+                           GError **error)
+{
+    MMBroadbandModemSierra *self = MM_BROADBAND_MODEM_SIERRA (_self);
+    const gchar *response;
+
+    if (!self->priv->gstatus_supported)
+        return iface_modem_signal_parent->load_values_finish (_self, res, cdma, evdo, gsm, umts, lte, error);
+
+    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, error);
+    if (!response ||
+        !mm_sierra_parse_gstatus_response (response, gsm, umts, lte, error))
+        return FALSE;
+
+    *cdma = NULL;
+    *evdo = NULL;
+    return TRUE;
+}
+
+static void
+signal_load_values (MMIfaceModemSignal *_self,
+                    GCancellable *cancellable,
+                    GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+    MMBroadbandModemSierra *self = MM_BROADBAND_MODEM_SIERRA (_self);
+
+    if (!self->priv->gstatus_supported) {
+        iface_modem_signal_parent->load_values (_self, cancellable, callback, user_data);
+        return;
+    }
+
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "!GSTATUS?",
+                              3,
+                              FALSE,
+                              callback,
+                              user_data);
+}
+
 /*****************************************************************************/
 /* Setup ports (Broadband modem class) */
 
@@ -1714,6 +1839,17 @@ iface_modem_time_init (MMIfaceModemTime *iface)
     iface->load_network_time_finish = modem_time_load_network_time_finish;
 }
 
+static void
+iface_modem_signal_init (MMIfaceModemSignal *iface)
+{
+    iface_modem_signal_parent = g_type_interface_peek_parent (iface);
+
+    iface->check_support = signal_check_support;
+    iface->check_support_finish = signal_check_support_finish;
+    iface->load_values = signal_load_values;
+    iface->load_values_finish = signal_load_values_finish;
+}
+
 static void
 mm_broadband_modem_sierra_class_init (MMBroadbandModemSierraClass *klass)
 {
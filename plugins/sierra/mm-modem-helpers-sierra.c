@@ -0,0 +1,174 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2015 The ModemManager Authors
+ */
+
+#include <string.h>
+
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-log.h"
+#include "mm-errors-types.h"
+#include "mm-modem-helpers.h"
+#include "mm-modem-helpers-sierra.h"
+
+/*****************************************************************************/
+/* !GSTATUS response parser */
+
+static GHashTable *
+gstatus_split_fields (const gchar *response)
+{
+    GHashTable *fields;
+    gchar **lines;
+    guint i;
+
+    fields = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+    /* Each line holds one or more "<key>: <value>" pairs separated by tabs */
+    lines = g_strsplit_set (response, "\r\n", -1);
+    for (i = 0; lines[i]; i++) {
+        gchar **pairs;
+        guint j;
+
+        pairs = g_strsplit (lines[i], "\t", -1);
+        for (j = 0; pairs[j]; j++) {
+            gchar *sep;
+            gchar *key;
+
+            sep = strchr (pairs[j], ':');
+            if (!sep)
+                continue;
+
+            *sep = '\0';
+            key = g_strstrip (pairs[j]);
+
+            /* When reported per antenna, keep the value of the main one,
+             * which always comes first */
+            if (!key[0] || g_hash_table_lookup (fields, key))
+                continue;
+
+            g_hash_table_insert (fields,
+                                 g_strdup (key),
+                                 g_strdup (g_strstrip (sep + 1)));
+        }
+        g_strfreev (pairs);
+    }
+    g_strfreev (lines);
+
+    return fields;
+}
+
+static gboolean
+gstatus_get_value (GHashTable *fields,
+                   const gchar *key,
+                   gdouble *out)
+{
+    const gchar *str;
+
+    /* Unknown values are given as "---" */
+    str = g_hash_table_lookup (fields, key);
+    return (str &&
+            strpbrk (str, "0123456789") != NULL &&
+            mm_get_double_from_str (str, out));
+}
+
+gboolean
+mm_sierra_parse_gstatus_response (const gchar *response,
+                                  MMSignal **out_gsm,
+                                  MMSignal **out_umts,
+                                  MMSignal **out_lte,
+                                  GError **error)
+{
+    GHashTable *fields;
+    const gchar *mode;
+    gdouble value;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    g_assert (out_gsm != NULL);
+    g_assert (out_umts != NULL);
+    g_assert (out_lte != NULL);
+
+    if (!response) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED, "Missing response");
+        return FALSE;
+    }
+
+    /* Format, only the fields we care about:
+     *
+     * !GSTATUS:
+     * System mode:   LTE           PS state:    Attached
+     * PCC RxM RSSI:  -65           RSRP (dBm):  -94
+     * PCC RxD RSSI:  -67           RSRP (dBm):  -96
+     * RSRQ (dB):     -8.3          Cell ID:     01A5A101 (27632897)
+     * SINR (dB):      18.2
+     *
+     * or, in 2G/3G:
+     *
+     * System mode:   WCDMA         PS state:    Attached
+     * RxM RSSI C0:   -93           RxD RSSI C0:  ---
+     */
+    fields = gstatus_split_fields (mm_strip_tag (response, "!GSTATUS:"));
+
+    mode = g_hash_table_lookup (fields, "System mode");
+    if (!mode) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "No system mode in !GSTATUS response");
+        g_hash_table_unref (fields);
+        return FALSE;
+    }
+
+    if (g_str_equal (mode, "LTE")) {
+        lte = mm_signal_new ();
+        if (gstatus_get_value (fields, "PCC RxM RSSI", &value))
+            mm_signal_set_rssi (lte, value);
+        if (gstatus_get_value (fields, "RSRP (dBm)", &value))
+            mm_signal_set_rsrp (lte, value);
+        if (gstatus_get_value (fields, "RSRQ (dB)", &value))
+            mm_signal_set_rsrq (lte, value);
+        if (gstatus_get_value (fields, "SINR (dB)", &value))
+            mm_signal_set_snr (lte, value);
+        if (mm_signal_get_rssi (lte) == MM_SIGNAL_UNKNOWN &&
+            mm_signal_get_rsrp (lte) == MM_SIGNAL_UNKNOWN &&
+            mm_signal_get_rsrq (lte) == MM_SIGNAL_UNKNOWN &&
+            mm_signal_get_snr (lte) == MM_SIGNAL_UNKNOWN)
+            g_clear_object (&lte);
+    } else if (g_str_equal (mode, "WCDMA")) {
+        if (gstatus_get_value (fields, "RxM RSSI C0", &value)) {
+            umts = mm_signal_new ();
+            mm_signal_set_rssi (umts, value);
+        }
+    } else if (g_str_equal (mode, "GSM")) {
+        if (gstatus_get_value (fields, "RxM RSSI C0", &value) ||
+            gstatus_get_value (fields, "RSSI (dBm)", &value)) {
+            gsm = mm_signal_new ();
+            mm_signal_set_rssi (gsm, value);
+        }
+    }
+
+    g_hash_table_unref (fields);
+
+    if (!gsm && !umts && !lte) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "No signal information in !GSTATUS response");
+        return FALSE;
+    }
+
+    *out_gsm = gsm;
+    *out_umts = umts;
+    *out_lte = lte;
+    return TRUE;
+}
@@ -0,0 +1,158 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2015 The ModemManager Authors
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <locale.h>
+
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-log.h"
+#include "mm-modem-helpers.h"
+#include "mm-modem-helpers-sierra.h"
+
+/*****************************************************************************/
+/* Test !GSTATUS responses */
+
+static void
+test_gstatus_response_lte (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_sierra_parse_gstatus_response (
+        "!GSTATUS: \r\n"
+        "Current Time:  4597\t\tTemperature: 41\r\n"
+        "Reset Counter: 1\t\tMode:        ONLINE         \r\n"
+        "System mode:   LTE        \tPS state:    Attached     \r\n"
+        "LTE band:      B17     \t\tLTE bw:      10 MHz  \r\n"
+        "LTE Rx chan:   5780\t\tLTE Tx chan: 23780\r\n"
+        "EMM state:     Registered     \tNormal Service \r\n"
+        "RRC state:     RRC Idle       \r\n"
+        "IMS reg state: No Srv  \t\t\r\n"
+        "\r\n"
+        "PCC RxM RSSI:  -65\t\tRSRP (dBm):  -94\r\n"
+        "PCC RxD RSSI:  -67\t\tRSRP (dBm):  -96\r\n"
+        "Tx Power:      0\t\tTAC:         4B2F (19247)\r\n"
+        "RSRQ (dB):     -8.3\t\tCell ID:     01A5A101 (27632897)\r\n"
+        "SINR (dB):      18.2\r\n",
+        &gsm, &umts, &lte,
+        &error);
+    g_assert_no_error (error);
+    g_assert (res == TRUE);
+    g_assert (gsm == NULL);
+    g_assert (umts == NULL);
+    g_assert (lte != NULL);
+    g_assert_cmpfloat (mm_signal_get_rssi (lte), ==, -65.0);
+    g_assert_cmpfloat (mm_signal_get_rsrp (lte), ==, -94.0);
+    g_assert_cmpfloat (mm_signal_get_rsrq (lte), ==, -8.3);
+    g_assert_cmpfloat (mm_signal_get_snr (lte), ==, 18.2);
+    g_object_unref (lte);
+}
+
+static void
+test_gstatus_response_wcdma (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_sierra_parse_gstatus_response (
+        "!GSTATUS: \r\n"
+        "Current Time:  3335\t\tTemperature: 32\r\n"
+        "Reset Counter: 2\t\tMode:        ONLINE         \r\n"
+        "System mode:   WCDMA        \tPS state:    Attached     \r\n"
+        "WCDMA band:    WCDMA 1900\r\n"
+        "WCDMA channel: 612\r\n"
+        "GMM (PS) state:REGISTERED  \tNO SUBSTATE     \r\n"
+        "MM (CS) state: IDLE        \tNORMAL SERVICE  \r\n"
+        "\r\n"
+        "WCDMA L1 state:L1M_PCH_SLEEP     \tLAC:         1234 (4660)\r\n"
+        "RRC state:     DISCONNECTED  \r\n"
+        "RxM RSSI C0:   -93\tRxD RSSI C0:  ---\r\n"
+        "RxM RSSI C1:   ---\tRxD RSSI C1:  ---\r\n",
+        &gsm, &umts, &lte,
+        &error);
+    g_assert_no_error (error);
+    g_assert (res == TRUE);
+    g_assert (gsm == NULL);
+    g_assert (umts != NULL);
+    g_assert (lte == NULL);
+    g_assert_cmpfloat (mm_signal_get_rssi (umts), ==, -93.0);
+    g_object_unref (umts);
+}
+
+static void
+test_gstatus_response_no_service (void)
+{
+    GError *error = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+    gboolean res;
+
+    res = mm_sierra_parse_gstatus_response (
+        "!GSTATUS: \r\n"
+        "Current Time:  12\t\tTemperature: 30\r\n"
+        "System mode:   No service   \tPS state:    Not attached \r\n",
+        &gsm, &umts, &lte,
+        &error);
+    g_assert (error != NULL);
+    g_assert (res == FALSE);
+    g_error_free (error);
+}
+
+/*****************************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    setlocale (LC_ALL, "");
+
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/sierra/gstatus/response/lte",        test_gstatus_response_lte);
+    g_test_add_func ("/MM/sierra/gstatus/response/wcdma",      test_gstatus_response_wcdma);
+    g_test_add_func ("/MM/sierra/gstatus/response/no-service", test_gstatus_response_no_service);
+
+    return g_test_run ();
+}
@@ -28,6 +28,7 @@
 
 #include "mm-base-manager.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-context.h"
 
 #if WITH_SUSPEND_RESUME
@@ -55,20 +56,71 @@ quit_cb (gpointer user_data)
     return FALSE;
 }
 
+static void
+dump_trace (void)
+{
+    const gchar *path;
+    GError *error = NULL;
+
+    /* Never dump to a default location, the user must explicitly request it */
+    path = mm_context_get_trace_file ();
+    if (!path) {
+        mm_info ("Not dumping trace: no trace file given");
+        return;
+    }
+
+    if (!mm_trace_dump (path, &error)) {
+        mm_warn ("Couldn't dump trace to '%s': %s", path, error->message);
+        g_error_free (error);
+        return;
+    }
+    mm_info ("Trace dumped to '%s'", path);
+}
+
+static gboolean
+dump_trace_cb (gpointer user_data)
+{
+    dump_trace ();
+    return TRUE;
+}
+
+static gboolean
+dump_port_metrics_cb (gpointer user_data)
+{
+    if (manager)
+        mm_base_manager_log_port_metrics (manager);
+    return TRUE;
+}
+
+static void
+shutdown_ready (MMBaseManager *self,
+                GAsyncResult *res,
+                GMainLoop *inner)
+{
+    GError *error = NULL;
+
+    if (!mm_base_manager_shutdown_finish (self, res, &error)) {
+        mm_warn ("%s", error->message);
+        g_error_free (error);
+    }
+
+    g_main_loop_quit (inner);
+}
+
 #if WITH_SUSPEND_RESUME
 
 static void
 sleeping_cb (MMSleepMonitor *sleep_monitor)
 {
-    mm_dbg ("Removing devices... (sleeping)");
-    mm_base_manager_shutdown (manager, FALSE);
+    mm_dbg ("Preparing devices... (sleeping)");
+    mm_base_manager_sleep (manager);
 }
 
 static void
 resuming_cb (MMSleepMonitor *sleep_monitor)
 {
-    mm_dbg ("Re-scanning (resuming)");
-    mm_base_manager_start (manager, FALSE);
+    mm_dbg ("Revalidating devices... (resuming)");
+    mm_base_manager_resume (manager);
 }
 
 #endif
@@ -153,6 +205,12 @@ main (int argc, char *argv[])
 
     g_unix_signal_add (SIGTERM, quit_cb, NULL);
     g_unix_signal_add (SIGINT, quit_cb, NULL);
+    g_unix_signal_add (SIGUSR2, dump_port_metrics_cb, NULL);
+
+    if (mm_context_get_trace_buffer ()) {
+        mm_trace_init (mm_context_get_trace_buffer ());
+        g_unix_signal_add (SIGUSR1, dump_trace_cb, NULL);
+    }
 
     mm_info ("ModemManager (version " MM_DIST_VERSION ") starting in %s bus...",
              mm_context_get_test_session () ? "session" : "system");
@@ -186,29 +244,17 @@ main (int argc, char *argv[])
     loop = NULL;
 
     if (manager) {
-        GTimer *timer;
-
-        mm_base_manager_shutdown (manager, TRUE);
-
         /* Wait for all modems to be disabled and removed, but don't wait
          * forever: if disabling the modems takes longer than 20s, just
          * shutdown anyway. */
-        timer = g_timer_new ();
-        while (mm_base_manager_num_modems (manager) &&
-               g_timer_elapsed (timer, NULL) < (gdouble)MAX_SHUTDOWN_TIME_SECS) {
-            GMainContext *ctx = g_main_loop_get_context (inner);
-
-            g_main_context_iteration (ctx, FALSE);
-            g_usleep (50);
-        }
-
-        if (mm_base_manager_num_modems (manager))
-            mm_warn ("Disabling modems took too long, "
-                     "shutting down with '%u' modems around",
-                     mm_base_manager_num_modems (manager));
+        mm_base_manager_shutdown (manager,
+                                  TRUE,
+                                  MAX_SHUTDOWN_TIME_SECS,
+                                  (GAsyncReadyCallback)shutdown_ready,
+                                  inner);
+        g_main_loop_run (inner);
 
         g_object_unref (manager);
-        g_timer_destroy (timer);
     }
 
     g_main_loop_unref (inner);
@@ -217,6 +263,11 @@ main (int argc, char *argv[])
 
     mm_info ("ModemManager is shut down");
 
+    if (mm_context_get_trace_buffer ()) {
+        dump_trace ();
+        mm_trace_shutdown ();
+    }
+
     mm_log_shutdown ();
 
     return 0;
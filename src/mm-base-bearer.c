@@ -35,6 +35,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-base-modem.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-modem-helpers.h"
 
 /* We require up to 20s to get a proper IP when using PPP */
@@ -80,6 +81,8 @@ struct _MMBaseBearerPrivate {
 
     /* Cancellable for connect() */
     GCancellable *connect_cancellable;
+    /* When the ongoing connection attempt started, if tracing */
+    gint64 connect_trace_start;
     /* handler id for the disconnect + cancel connect request */
     gulong disconnect_signal_handler;
 
@@ -459,6 +462,12 @@ connect_ready (MMBaseBearer *self,
 
     /* NOTE: connect() implementations *MUST* handle cancellations themselves */
     result = MM_BASE_BEARER_GET_CLASS (self)->connect_finish (self, res, &error);
+
+    mm_trace_span (self->priv->modem ? mm_base_modem_get_device (self->priv->modem) : NULL,
+                   "bearer",
+                   "connect",
+                   self->priv->connect_trace_start,
+                   !!result);
     if (!result) {
         mm_dbg ("Couldn't connect bearer '%s': '%s'",
                 self->priv->path,
@@ -589,6 +598,7 @@ mm_base_bearer_connect (MMBaseBearer *self,
     /* Connecting! */
     mm_dbg ("Connecting bearer '%s'", self->priv->path);
     self->priv->connect_cancellable = g_cancellable_new ();
+    self->priv->connect_trace_start = mm_trace_now ();
     bearer_update_status (self, MM_BEARER_STATUS_CONNECTING);
     MM_BASE_BEARER_GET_CLASS (self)->connect (
         self,
@@ -1004,6 +1014,49 @@ mm_base_bearer_report_connection_status (MMBaseBearer *self,
     return MM_BASE_BEARER_GET_CLASS (self)->report_connection_status (self, status);
 }
 
+/*****************************************************************************/
+
+static void
+reload_connection_status_ready (MMBaseBearer *self,
+                                GAsyncResult *res)
+{
+    MMBearerConnectionStatus status;
+    GError *error = NULL;
+
+    status = MM_BASE_BEARER_GET_CLASS (self)->reload_connection_status_finish (self, res, &error);
+    if (status == MM_BEARER_CONNECTION_STATUS_UNKNOWN) {
+        mm_dbg ("Couldn't reload connection status of bearer '%s': %s",
+                self->priv->path,
+                error ? error->message : "unknown error");
+        g_clear_error (&error);
+        return;
+    }
+
+    /* Only act on a disconnection not yet known; a new connection attempt
+     * may have been started meanwhile */
+    if (status == MM_BEARER_CONNECTION_STATUS_DISCONNECTED &&
+        self->priv->status == MM_BEARER_STATUS_CONNECTED) {
+        mm_dbg ("Bearer '%s' is no longer connected", self->priv->path);
+        mm_base_bearer_report_connection_status (self, MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
+    }
+}
+
+void
+mm_base_bearer_reload_connection_status (MMBaseBearer *self)
+{
+    if (self->priv->status != MM_BEARER_STATUS_CONNECTED)
+        return;
+
+    if (!MM_BASE_BEARER_GET_CLASS (self)->reload_connection_status ||
+        !MM_BASE_BEARER_GET_CLASS (self)->reload_connection_status_finish)
+        return;
+
+    MM_BASE_BEARER_GET_CLASS (self)->reload_connection_status (
+        self,
+        (GAsyncReadyCallback)reload_connection_status_ready,
+        NULL);
+}
+
 static void
 set_property (GObject *object,
               guint prop_id,
@@ -104,6 +104,14 @@ struct _MMBaseBearerClass {
     /* Report connection status of this bearer */
     void (* report_connection_status) (MMBaseBearer *bearer,
                                        MMBearerConnectionStatus status);
+
+    /* Query the modem for the connection status of this bearer (optional) */
+    void (* reload_connection_status) (MMBaseBearer *bearer,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data);
+    MMBearerConnectionStatus (* reload_connection_status_finish) (MMBaseBearer *bearer,
+                                                                  GAsyncResult *res,
+                                                                  GError **error);
 };
 
 GType mm_base_bearer_get_type (void);
@@ -136,4 +144,8 @@ void mm_base_bearer_disconnect_force (MMBaseBearer *self);
 void mm_base_bearer_report_connection_status (MMBaseBearer *self,
                                               MMBearerConnectionStatus status);
 
+/* Checks whether a connected bearer is still connected in the modem (e.g.
+ * after the system resumes) and reports the disconnection if it isn't */
+void mm_base_bearer_reload_connection_status (MMBaseBearer *self);
+
 #endif /* MM_BASE_BEARER_H */
@@ -29,6 +29,12 @@
 
 #include "mm-base-manager.h"
 #include "mm-device.h"
+#include "mm-iface-modem.h"
+#include "mm-iface-modem-3gpp.h"
+#include "mm-iface-modem-cdma.h"
+#include "mm-base-modem-at.h"
+#include "mm-base-bearer.h"
+#include "mm-bearer-list.h"
 #include "mm-plugin-manager.h"
 #include "mm-auth.h"
 #include "mm-plugin.h"
@@ -67,6 +73,26 @@ struct _MMBaseManagerPrivate {
     MMPluginManager *plugin_manager;
     /* The container of devices being prepared */
     GHashTable *devices;
+    /* Device lookup tables, by port sysfs path, by port devpath (to match
+     * DEVPATH_OLD) and by modem. Devices are owned by the main table. */
+    GHashTable *devices_by_port;
+    GHashTable *devices_by_port_devpath;
+    GHashTable *devices_by_modem;
+    /* Number of devices being revalidated after a resume */
+    guint n_resuming;
+    /* Candidate ports found in device scans, pending to be processed */
+    GQueue *scan_queue;
+    guint scan_idle_id;
+    /* Physical devices found while processing a device scan, by the subsystem
+     * of the port and the sysfs path of its parent */
+    GHashTable *physdev_cache;
+    /* Time since the first device is tracked, until the first modem is created */
+    GTimer *first_modem_timer;
+    gboolean first_modem_created;
+    /* Uevents pending to be processed, by group key and by port sysfs path */
+    GHashTable *uevent_groups;
+    GHashTable *uevent_groups_by_port;
+    guint uevents_suppressed;
     /* The Object Manager server */
     GDBusObjectManagerServer *object_manager;
 
@@ -80,33 +106,31 @@ static MMDevice *
 find_device_by_modem (MMBaseManager *manager,
                       MMBaseModem *modem)
 {
-    GHashTableIter iter;
-    gpointer key, value;
-
-    g_hash_table_iter_init (&iter, manager->priv->devices);
-    while (g_hash_table_iter_next (&iter, &key, &value)) {
-        MMDevice *candidate = MM_DEVICE (value);
-
-        if (modem == mm_device_peek_modem (candidate))
-            return candidate;
-    }
-    return NULL;
+    return g_hash_table_lookup (manager->priv->devices_by_modem, modem);
 }
 
+/* Renamed ports are looked up by their previous DEVPATH first, and then by
+ * their current sysfs path. Ignored ports are also indexed, but they are not
+ * owned by the device, so these matches are skipped. */
 static MMDevice *
 find_device_by_port (MMBaseManager *manager,
                      GUdevDevice *port)
 {
-    GHashTableIter iter;
-    gpointer key, value;
-
-    g_hash_table_iter_init (&iter, manager->priv->devices);
-    while (g_hash_table_iter_next (&iter, &key, &value)) {
-        MMDevice *candidate = MM_DEVICE (value);
+    MMDevice *device;
+    const gchar *devpath_old;
 
-        if (mm_device_owns_port (candidate, port))
-            return candidate;
+    devpath_old = g_udev_device_get_property (port, "DEVPATH_OLD");
+    if (devpath_old) {
+        device = g_hash_table_lookup (manager->priv->devices_by_port_devpath, devpath_old);
+        if (device && mm_device_owns_port (device, port))
+            return device;
     }
+
+    device = g_hash_table_lookup (manager->priv->devices_by_port,
+                                  g_udev_device_get_sysfs_path (port));
+    if (device && mm_device_owns_port (device, port))
+        return device;
+
     return NULL;
 }
 
@@ -127,6 +151,114 @@ find_device_by_udev_device (MMBaseManager *manager,
 
 /*****************************************************************************/
 
+static void
+device_port_grabbed (MMDevice *device,
+                     GUdevDevice *port,
+                     MMBaseManager *self)
+{
+    const gchar *devpath;
+
+    g_hash_table_insert (self->priv->devices_by_port,
+                         g_strdup (g_udev_device_get_sysfs_path (port)),
+                         device);
+    devpath = g_udev_device_get_property (port, "DEVPATH");
+    if (devpath)
+        g_hash_table_insert (self->priv->devices_by_port_devpath,
+                             g_strdup (devpath),
+                             device);
+}
+
+static void
+device_port_released (MMDevice *device,
+                      GUdevDevice *port,
+                      MMBaseManager *self)
+{
+    const gchar *devpath;
+
+    g_hash_table_remove (self->priv->devices_by_port,
+                         g_udev_device_get_sysfs_path (port));
+    devpath = g_udev_device_get_property (port, "DEVPATH");
+    if (devpath)
+        g_hash_table_remove (self->priv->devices_by_port_devpath, devpath);
+}
+
+static gboolean
+device_index_entry_matches (gpointer key,
+                            MMDevice *value,
+                            MMDevice *device)
+{
+    return (value == device);
+}
+
+static void
+device_modem_updated (MMDevice *device,
+                      GParamSpec *pspec,
+                      MMBaseManager *self)
+{
+    MMBaseModem *modem;
+
+    /* Modems get created or removed rarely, so just drop the old entry */
+    g_hash_table_foreach_remove (self->priv->devices_by_modem,
+                                 (GHRFunc)device_index_entry_matches,
+                                 device);
+
+    modem = mm_device_peek_modem (device);
+    if (modem)
+        g_hash_table_insert (self->priv->devices_by_modem, modem, device);
+}
+
+static void
+track_device (MMBaseManager *self,
+              const gchar *path,
+              MMDevice *device)
+{
+    g_hash_table_insert (self->priv->devices, g_strdup (path), device);
+
+    /* Report how long it takes to get the first modem exposed */
+    if (!self->priv->first_modem_timer && !self->priv->first_modem_created)
+        self->priv->first_modem_timer = g_timer_new ();
+
+    g_signal_connect (device,
+                      MM_DEVICE_PORT_GRABBED,
+                      G_CALLBACK (device_port_grabbed),
+                      self);
+    g_signal_connect (device,
+                      MM_DEVICE_PORT_RELEASED,
+                      G_CALLBACK (device_port_released),
+                      self);
+    g_signal_connect (device,
+                      "notify::" MM_DEVICE_MODEM,
+                      G_CALLBACK (device_modem_updated),
+                      self);
+}
+
+static void
+untrack_device_indexes (MMBaseManager *self,
+                        MMDevice *device)
+{
+    g_signal_handlers_disconnect_by_data (device, self);
+
+    g_hash_table_foreach_remove (self->priv->devices_by_port,
+                                 (GHRFunc)device_index_entry_matches,
+                                 device);
+    g_hash_table_foreach_remove (self->priv->devices_by_port_devpath,
+                                 (GHRFunc)device_index_entry_matches,
+                                 device);
+    g_hash_table_foreach_remove (self->priv->devices_by_modem,
+                                 (GHRFunc)device_index_entry_matches,
+                                 device);
+}
+
+static void
+untrack_device (MMBaseManager *self,
+                MMDevice *device)
+{
+    untrack_device_indexes (self, device);
+    g_hash_table_remove (self->priv->devices, mm_device_get_path (device));
+}
+
+/*****************************************************************************/
+
 typedef struct {
     MMBaseManager *self;
     MMDevice *device;
@@ -160,6 +292,13 @@ find_device_support_ready (MMPluginManager *plugin_manager,
     } else {
         mm_info ("Modem for device at '%s' successfully created",
                  mm_device_get_path (ctx->device));
+        if (ctx->self->priv->first_modem_timer) {
+            mm_info ("First modem created %.3lfs after the first device was detected",
+                     g_timer_elapsed (ctx->self->priv->first_modem_timer, NULL));
+            g_timer_destroy (ctx->self->priv->first_modem_timer);
+            ctx->self->priv->first_modem_timer = NULL;
+            ctx->self->priv->first_modem_created = TRUE;
+        }
     }
 
     find_device_support_context_free (ctx);
@@ -239,6 +378,42 @@ find_physical_device (GUdevDevice *child)
     return physdev;
 }
 
+static GUdevDevice *
+find_physical_device_cached (MMBaseManager *self,
+                             GUdevDevice *child)
+{
+    GUdevDevice *parent;
+    GUdevDevice *physdev;
+    gchar *key;
+
+    /* Only cache while processing a device scan, where sibling ports are
+     * looked up one after the other */
+    if (!self->priv->physdev_cache)
+        return find_physical_device (child);
+
+    parent = g_udev_device_get_parent (child);
+    if (!parent)
+        return find_physical_device (child);
+
+    /* The physical device is the same for all ports of a given subsystem
+     * sharing the same parent */
+    key = g_strdup_printf ("%s:%s",
+                           g_udev_device_get_subsystem (child),
+                           g_udev_device_get_sysfs_path (parent));
+    g_object_unref (parent);
+
+    if (g_hash_table_lookup_extended (self->priv->physdev_cache, key, NULL, (gpointer *)&physdev)) {
+        g_free (key);
+        return (physdev ? g_object_ref (physdev) : NULL);
+    }
+
+    physdev = find_physical_device (child);
+    g_hash_table_insert (self->priv->physdev_cache,
+                         key,
+                         physdev ? g_object_ref (physdev) : NULL);
+    return physdev;
+}
+
 static void
 device_removed (MMBaseManager *self,
                 GUdevDevice *udev_device)
@@ -267,7 +442,7 @@ device_removed (MMBaseManager *self,
             if (!mm_device_peek_port_probe_list (device)) {
                 mm_dbg ("Removing empty device '%s'", mm_device_get_path (device));
                 mm_device_remove_modem (device);
-                g_hash_table_remove (self->priv->devices, mm_device_get_path (device));
+                untrack_device (self, device);
             }
         }
 
@@ -286,7 +461,7 @@ device_removed (MMBaseManager *self,
     if (device) {
         mm_dbg ("Removing device '%s'", mm_device_get_path (device));
         mm_device_remove_modem (device);
-        g_hash_table_remove (self->priv->devices, mm_device_get_path (device));
+        untrack_device (self, device);
         return;
     }
 
@@ -338,7 +513,7 @@ device_added (MMBaseManager *manager,
      * that "owns" all the ports of the device, like the USB device or the PCI
      * device the provides each tty or network port.
      */
-    physdev = find_physical_device (port);
+    physdev = find_physical_device_cached (manager, port);
     if (!physdev) {
         /* Warn about it, but filter out some common ports that we know don't have
          * anything to do with mobile broadband.
@@ -389,9 +564,7 @@ device_added (MMBaseManager *manager,
 
         /* Keep the device listed in the Manager */
         device = mm_device_new (physdev, hotplugged);
-        g_hash_table_insert (manager->priv->devices,
-                             g_strdup (physdev_path),
-                             device);
+        track_device (manager, physdev_path, device);
 
         /* Launch device support check */
         ctx = g_slice_new (FindDeviceSupportContext);
@@ -412,6 +585,137 @@ out:
         g_object_unref (physdev);
 }
 
+/*****************************************************************************/
+/* Uevent coalescing
+ *
+ * When a modem resets or switches USB composition, the kernel emits bursts of
+ * remove/add/change events for each of its interfaces. Events are grouped per
+ * physical device and only processed once the group has been quiet for a short
+ * settle time, applying a single net change per port. */
+
+/* Time to wait for more events in the same group before processing them */
+#define UEVENT_SETTLE_TIME_MS 250
+/* Maximum time to hold events of a group which keeps on getting new ones */
+#define UEVENT_MAX_DELAY_MS 2000
+
+typedef struct {
+    gchar *path;
+    /* Whether this is one of the ports we handle, or a parent usb device */
+    gboolean is_port;
+    /* Whether we knew about the port before the first event */
+    gboolean known;
+    /* First remove event received, if any */
+    GUdevDevice *removed;
+    /* Last add/move/change event received after the last remove, if any */
+    GUdevDevice *added;
+} UeventPort;
+
+typedef struct {
+    MMBaseManager *self;
+    gchar *key;
+    GTimer *timer;
+    guint timeout_id;
+    guint n_events;
+    /* UeventPort in the order of their first event */
+    GQueue *ports;
+} UeventGroup;
+
+static void
+uevent_port_free (UeventPort *port)
+{
+    if (port->removed)
+        g_object_unref (port->removed);
+    if (port->added)
+        g_object_unref (port->added);
+    g_free (port->path);
+    g_slice_free (UeventPort, port);
+}
+
+static void
+uevent_group_free (UeventGroup *group)
+{
+    if (group->timeout_id)
+        g_source_remove (group->timeout_id);
+    g_queue_free_full (group->ports, (GDestroyNotify)uevent_port_free);
+    g_timer_destroy (group->timer);
+    g_free (group->key);
+    g_slice_free (UeventGroup, group);
+}
+
+static gboolean
+uevent_group_flush (UeventGroup *group)
+{
+    MMBaseManager *self = group->self;
+    guint n_actions = 0;
+    GList *l;
+
+    group->timeout_id = 0;
+
+    /* Stop tracking the group before applying the changes, so that any new
+     * event starts a new group */
+    for (l = group->ports->head; l; l = g_list_next (l))
+        g_hash_table_remove (self->priv->uevent_groups_by_port, ((UeventPort *)l->data)->path);
+    g_hash_table_steal (self->priv->uevent_groups, group->key);
+
+    /* Removals first, so that re-added ports get probed from scratch */
+    for (l = group->ports->head; l; l = g_list_next (l)) {
+        UeventPort *port = l->data;
+
+        /* Ports added and removed again within the window are just ignored */
+        if (port->removed && (port->known || !port->is_port)) {
+            device_removed (self, port->removed);
+            n_actions++;
+        }
+    }
+
+    for (l = group->ports->head; l; l = g_list_next (l)) {
+        UeventPort *port = l->data;
+
+        if (port->added) {
+            device_added (self, port->added, TRUE, FALSE);
+            n_actions++;
+        }
+    }
+
+    self->priv->uevents_suppressed += group->n_events - n_actions;
+    mm_dbg ("(%s) %u uevents coalesced into %u changes in %.3lfs (%u suppressed so far)",
+            group->key,
+            group->n_events,
+            n_actions,
+            g_timer_elapsed (group->timer, NULL),
+            self->priv->uevents_suppressed);
+
+    uevent_group_free (group);
+    return FALSE;
+}
+
+static gchar *
+uevent_group_key (MMBaseManager *self,
+                  GUdevDevice *udev_device)
+{
+    MMDevice *device;
+    GUdevDevice *physdev;
+    gchar *key;
+
+    /* Devices we already know about are grouped by their physical device
+     * path, same as unknown ones whose physical device can be found */
+    device = find_device_by_port (self, udev_device);
+    if (!device)
+        device = find_device_by_udev_device (self, udev_device);
+    if (device)
+        return g_strdup (mm_device_get_path (device));
+
+    physdev = find_physical_device (udev_device);
+    if (physdev) {
+        key = g_strdup (g_udev_device_get_sysfs_path (physdev));
+        g_object_unref (physdev);
+        return key;
+    }
+
+    /* Otherwise, e.g. for removed devices without parent, on its own */
+    return g_strdup (g_udev_device_get_sysfs_path (udev_device));
+}
+
 static void
 handle_uevent (GUdevClient *client,
                const char *action,
@@ -421,6 +725,12 @@ handle_uevent (GUdevClient *client,
     MMBaseManager *self = MM_BASE_MANAGER (user_data);
     const gchar *subsys;
     const gchar *name;
+    const gchar *path;
+    gboolean is_port;
+    gboolean is_remove;
+    UeventGroup *group;
+    UeventPort *port = NULL;
+    GList *l;
 
     g_return_if_fail (action != NULL);
 
@@ -433,48 +743,163 @@ handle_uevent (GUdevClient *client,
      * but for remove, also handle usb parent device remove events
      */
     name = g_udev_device_get_name (device);
-    if (   (g_str_equal (action, "add") || g_str_equal (action, "move") || g_str_equal (action, "change"))
-        && (!g_str_has_prefix (subsys, "usb") || (name && g_str_has_prefix (name, "cdc-wdm"))))
-        device_added (self, device, TRUE, FALSE);
-    else if (g_str_equal (action, "remove"))
-        device_removed (self, device);
+    is_port = (!g_str_has_prefix (subsys, "usb") || (name && g_str_has_prefix (name, "cdc-wdm")));
+    is_remove = g_str_equal (action, "remove");
+    if (!is_remove &&
+        !(is_port && (g_str_equal (action, "add") || g_str_equal (action, "move") || g_str_equal (action, "change"))))
+        return;
+
+    path = g_udev_device_get_sysfs_path (device);
+
+    /* Events of a port which already has some pending always go to the same
+     * group, so that they are applied in order */
+    group = g_hash_table_lookup (self->priv->uevent_groups_by_port, path);
+    if (!group) {
+        gchar *key;
+
+        key = uevent_group_key (self, device);
+        group = g_hash_table_lookup (self->priv->uevent_groups, key);
+        if (!group) {
+            group = g_slice_new0 (UeventGroup);
+            group->self = self;
+            group->key = key;
+            group->timer = g_timer_new ();
+            group->ports = g_queue_new ();
+            g_hash_table_insert (self->priv->uevent_groups, group->key, group);
+        } else
+            g_free (key);
+    } else {
+        for (l = group->ports->head; l && !port; l = g_list_next (l)) {
+            if (g_str_equal (((UeventPort *)l->data)->path, path))
+                port = l->data;
+        }
+    }
+
+    if (!port) {
+        port = g_slice_new0 (UeventPort);
+        port->path = g_strdup (path);
+        port->is_port = is_port;
+        port->known = (is_port && !!find_device_by_port (self, device));
+        g_queue_push_tail (group->ports, port);
+        g_hash_table_insert (self->priv->uevent_groups_by_port, port->path, group);
+    }
+
+    if (is_remove) {
+        if (!port->removed)
+            port->removed = g_object_ref (device);
+        g_clear_object (&port->added);
+    } else {
+        /* Only the last one is relevant */
+        if (port->added)
+            g_object_unref (port->added);
+        port->added = g_object_ref (device);
+    }
+    group->n_events++;
+
+    /* Wait until the group settles, but not forever */
+    if (group->timeout_id)
+        g_source_remove (group->timeout_id);
+    group->timeout_id = g_timeout_add (MIN (UEVENT_SETTLE_TIME_MS,
+                                            MAX (0, UEVENT_MAX_DELAY_MS - (gint)(g_timer_elapsed (group->timer, NULL) * 1000))),
+                                       (GSourceFunc)uevent_group_flush,
+                                       group);
 }
 
+/*****************************************************************************/
+
+/* Maximum number of scanned ports processed in a single idle cycle */
+#define SCAN_BATCH_SIZE 8
+
 typedef struct {
-    MMBaseManager *self;
     GUdevDevice *device;
     gboolean manual_scan;
-} StartDeviceAdded;
+} ScannedPort;
+
+static void
+scanned_port_free (ScannedPort *scanned)
+{
+    g_object_unref (scanned->device);
+    g_slice_free (ScannedPort, scanned);
+}
+
+static void
+physdev_cache_value_free (GUdevDevice *physdev)
+{
+    if (physdev)
+        g_object_unref (physdev);
+}
 
 static gboolean
-start_device_added_idle (StartDeviceAdded *ctx)
+scan_queue_idle (MMBaseManager *self)
 {
-    device_added (ctx->self, ctx->device, FALSE, ctx->manual_scan);
-    g_object_unref (ctx->self);
-    g_object_unref (ctx->device);
-    g_slice_free (StartDeviceAdded, ctx);
+    guint i;
+
+    for (i = 0; i < SCAN_BATCH_SIZE && !g_queue_is_empty (self->priv->scan_queue); i++) {
+        ScannedPort *scanned;
+
+        scanned = g_queue_pop_head (self->priv->scan_queue);
+        device_added (self, scanned->device, FALSE, scanned->manual_scan);
+        scanned_port_free (scanned);
+    }
+
+    if (!g_queue_is_empty (self->priv->scan_queue))
+        return TRUE;
+
+    /* Scan finished; parent devices may change from now on */
+    g_hash_table_destroy (self->priv->physdev_cache);
+    self->priv->physdev_cache = NULL;
+    self->priv->scan_idle_id = 0;
+    mm_dbg ("Finished processing device scan...");
     return FALSE;
 }
 
-static void
-start_device_added (MMBaseManager *self,
-                    GUdevDevice *device,
-                    gboolean manual_scan)
+static guint
+scan_subsystem (MMBaseManager *self,
+                const gchar *subsystem,
+                gboolean manual_scan)
 {
-    StartDeviceAdded *ctx;
+    GUdevEnumerator *enumerator;
+    GList *devices, *iter;
+    guint n_candidates = 0;
 
-    ctx = g_slice_new (StartDeviceAdded);
-    ctx->self = g_object_ref (self);
-    ctx->device = g_object_ref (device);
-    ctx->manual_scan = manual_scan;
-    g_idle_add ((GSourceFunc)start_device_added_idle, ctx);
+    /* Let udev filter out the ports already excluded by the candidate rules */
+    enumerator = g_udev_enumerator_new (self->priv->udev);
+    g_udev_enumerator_add_match_subsystem (enumerator, subsystem);
+    g_udev_enumerator_add_match_property (enumerator, "ID_MM_CANDIDATE", "1");
+    devices = g_udev_enumerator_execute (enumerator);
+    g_object_unref (enumerator);
+
+    for (iter = devices; iter; iter = g_list_next (iter)) {
+        GUdevDevice *device = G_UDEV_DEVICE (iter->data);
+        ScannedPort *scanned;
+
+        /* From the usb subsystems, only cdc-wdm ports are handled */
+        if (g_str_has_prefix (subsystem, "usb")) {
+            const gchar *name;
+
+            name = g_udev_device_get_name (device);
+            if (!name || !g_str_has_prefix (name, "cdc-wdm")) {
+                g_object_unref (device);
+                continue;
+            }
+        }
+
+        scanned = g_slice_new (ScannedPort);
+        scanned->device = device;
+        scanned->manual_scan = manual_scan;
+        g_queue_push_tail (self->priv->scan_queue, scanned);
+        n_candidates++;
+    }
+    g_list_free (devices);
+
+    return n_candidates;
 }
 
 void
 mm_base_manager_start (MMBaseManager *manager,
                        gboolean manual_scan)
 {
-    GList *devices, *iter;
+    guint n_candidates = 0;
 
     g_return_if_fail (manager != NULL);
     g_return_if_fail (MM_IS_BASE_MANAGER (manager));
@@ -484,76 +909,161 @@ mm_base_manager_start (MMBaseManager *manager,
 
     mm_dbg ("Starting %s device scan...", manual_scan ? "manual" : "automatic");
 
-    devices = g_udev_client_query_by_subsystem (manager->priv->udev, "tty");
-    for (iter = devices; iter; iter = g_list_next (iter)) {
-        start_device_added (manager, G_UDEV_DEVICE (iter->data), manual_scan);
-        g_object_unref (G_OBJECT (iter->data));
-    }
-    g_list_free (devices);
+    n_candidates += scan_subsystem (manager, "tty", manual_scan);
+    n_candidates += scan_subsystem (manager, "net", manual_scan);
+    n_candidates += scan_subsystem (manager, "usb", manual_scan);
+    /* Newer kernels report 'usbmisc' subsystem */
+    n_candidates += scan_subsystem (manager, "usbmisc", manual_scan);
 
-    devices = g_udev_client_query_by_subsystem (manager->priv->udev, "net");
-    for (iter = devices; iter; iter = g_list_next (iter)) {
-        start_device_added (manager, G_UDEV_DEVICE (iter->data), manual_scan);
-        g_object_unref (G_OBJECT (iter->data));
+    mm_dbg ("Finished device scan: %u candidate ports found", n_candidates);
+
+    if (!manager->priv->scan_idle_id && !g_queue_is_empty (manager->priv->scan_queue)) {
+        if (!manager->priv->physdev_cache)
+            manager->priv->physdev_cache = g_hash_table_new_full (g_str_hash,
+                                                                  g_str_equal,
+                                                                  g_free,
+                                                                  (GDestroyNotify)physdev_cache_value_free);
+        manager->priv->scan_idle_id = g_idle_add ((GSourceFunc)scan_queue_idle, manager);
     }
-    g_list_free (devices);
+}
 
-    devices = g_udev_client_query_by_subsystem (manager->priv->udev, "usb");
-    for (iter = devices; iter; iter = g_list_next (iter)) {
-        const gchar *name;
+/*****************************************************************************/
 
-        name = g_udev_device_get_name (G_UDEV_DEVICE (iter->data));
-        if (name && g_str_has_prefix (name, "cdc-wdm"))
-            start_device_added (manager, G_UDEV_DEVICE (iter->data), manual_scan);
-        g_object_unref (G_OBJECT (iter->data));
-    }
-    g_list_free (devices);
+typedef struct {
+    MMBaseManager *self;
+    GSimpleAsyncResult *result;
+    GTimer *timer;
+    guint timeout_id;
+    /* List of ShutdownDeviceContext still disabling */
+    GList *pending;
+} ShutdownContext;
 
-    /* Newer kernels report 'usbmisc' subsystem */
-    devices = g_udev_client_query_by_subsystem (manager->priv->udev, "usbmisc");
-    for (iter = devices; iter; iter = g_list_next (iter)) {
-        const gchar *name;
+typedef struct {
+    ShutdownContext *parent;
+    MMDevice *device;
+    MMBaseModem *modem;
+    gdouble started;
+} ShutdownDeviceContext;
 
-        name = g_udev_device_get_name (G_UDEV_DEVICE (iter->data));
-        if (name && g_str_has_prefix (name, "cdc-wdm"))
-            start_device_added (manager, G_UDEV_DEVICE (iter->data), manual_scan);
-        g_object_unref (G_OBJECT (iter->data));
-    }
-    g_list_free (devices);
+static void
+shutdown_context_complete_and_free (ShutdownContext *ctx)
+{
+    /* Always in idle, so that callers may run a mainloop right after
+     * requesting the shutdown */
+    g_simple_async_result_complete_in_idle (ctx->result);
+    g_object_unref (ctx->result);
+    if (ctx->timeout_id)
+        g_source_remove (ctx->timeout_id);
+    g_timer_destroy (ctx->timer);
+    g_object_unref (ctx->self);
+    g_slice_free (ShutdownContext, ctx);
+}
 
-    mm_dbg ("Finished device scan...");
+gboolean
+mm_base_manager_shutdown_finish (MMBaseManager *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
 }
 
-/*****************************************************************************/
+static void
+remove_disabled_device (MMBaseManager *self,
+                        MMDevice *device,
+                        MMBaseModem *modem)
+{
+    /* The device may have been removed (e.g. unplugged) meanwhile */
+    if (find_device_by_modem (self, modem) != device)
+        return;
+
+    g_cancellable_cancel (mm_base_modem_peek_cancellable (modem));
+    mm_device_remove_modem (device);
+    untrack_device (self, device);
+}
 
 static void
 remove_disable_ready (MMBaseModem *modem,
                       GAsyncResult *res,
-                      MMBaseManager *self)
+                      ShutdownDeviceContext *device_ctx)
 {
-    MMDevice *device;
+    ShutdownContext *ctx = device_ctx->parent;
 
     /* We don't care about errors disabling at this point */
     mm_base_modem_disable_finish (modem, res, NULL);
 
-    device = find_device_by_modem (self, modem);
-    if (device) {
-        g_cancellable_cancel (mm_base_modem_peek_cancellable (modem));
-        mm_device_remove_modem (device);
-        g_hash_table_remove (self->priv->devices, device);
+    /* Already given up on this one? */
+    if (ctx) {
+        mm_dbg ("(%s) modem disabled in %.3lfs",
+                mm_device_get_path (device_ctx->device),
+                g_timer_elapsed (ctx->timer, NULL) - device_ctx->started);
+
+        remove_disabled_device (ctx->self, device_ctx->device, modem);
+
+        ctx->pending = g_list_remove (ctx->pending, device_ctx);
+        if (!ctx->pending) {
+            mm_dbg ("All modems disabled in %.3lfs", g_timer_elapsed (ctx->timer, NULL));
+            g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+            shutdown_context_complete_and_free (ctx);
+        }
     }
+
+    g_object_unref (device_ctx->modem);
+    g_object_unref (device_ctx->device);
+    g_slice_free (ShutdownDeviceContext, device_ctx);
+}
+
+static gboolean
+shutdown_timeout_cb (ShutdownContext *ctx)
+{
+    GList *l;
+    guint n_pending;
+
+    ctx->timeout_id = 0;
+
+    /* Disables run in parallel, so every modem still around already had the
+     * whole time budget; remove them without waiting any longer. Their
+     * contexts are released once the disable operation returns. */
+    n_pending = g_list_length (ctx->pending);
+    for (l = ctx->pending; l; l = g_list_next (l)) {
+        ShutdownDeviceContext *device_ctx = l->data;
+
+        mm_warn ("(%s) modem not disabled after %.3lfs, removing it",
+                 mm_device_get_path (device_ctx->device),
+                 g_timer_elapsed (ctx->timer, NULL) - device_ctx->started);
+        device_ctx->parent = NULL;
+        remove_disabled_device (ctx->self, device_ctx->device, device_ctx->modem);
+    }
+    g_list_free (ctx->pending);
+    ctx->pending = NULL;
+
+    g_simple_async_result_set_error (ctx->result,
+                                     MM_CORE_ERROR,
+                                     MM_CORE_ERROR_TIMEOUT,
+                                     "Disabling modems took too long, "
+                                     "'%u' modems removed without being disabled",
+                                     n_pending);
+    shutdown_context_complete_and_free (ctx);
+    return FALSE;
 }
 
 static void
 foreach_disable (gpointer key,
                  MMDevice *device,
-                 MMBaseManager *self)
+                 ShutdownContext *ctx)
 {
+    ShutdownDeviceContext *device_ctx;
     MMBaseModem *modem;
 
     modem = mm_device_peek_modem (device);
-    if (modem)
-        mm_base_modem_disable (modem, (GAsyncReadyCallback)remove_disable_ready, self);
+    if (!modem)
+        return;
+
+    device_ctx = g_slice_new (ShutdownDeviceContext);
+    device_ctx->parent = ctx;
+    device_ctx->device = g_object_ref (device);
+    device_ctx->modem = g_object_ref (modem);
+    device_ctx->started = g_timer_elapsed (ctx->timer, NULL);
+    ctx->pending = g_list_prepend (ctx->pending, device_ctx);
 }
 
 static gboolean
@@ -567,31 +1077,302 @@ foreach_remove (gpointer key,
     if (modem)
         g_cancellable_cancel (mm_base_modem_peek_cancellable (modem));
     mm_device_remove_modem (device);
+    untrack_device_indexes (self, device);
     return TRUE;
 }
 
 void
 mm_base_manager_shutdown (MMBaseManager *self,
-                          gboolean disable)
+                          gboolean disable,
+                          guint timeout_secs,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
 {
+    ShutdownContext *ctx;
+    GList *pending;
+    GList *l;
+
     g_return_if_fail (self != NULL);
     g_return_if_fail (MM_IS_BASE_MANAGER (self));
 
     /* Cancel all ongoing auth requests */
     g_cancellable_cancel (self->priv->authp_cancellable);
 
-    if (disable) {
-        g_hash_table_foreach (self->priv->devices, (GHFunc)foreach_disable, self);
+    ctx = g_slice_new0 (ShutdownContext);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             mm_base_manager_shutdown);
+    ctx->timer = g_timer_new ();
+
+    if (disable)
+        g_hash_table_foreach (self->priv->devices, (GHFunc)foreach_disable, ctx);
+
+    /* Nothing to disable, just remove directly */
+    if (!ctx->pending) {
+        g_hash_table_foreach_remove (self->priv->devices, (GHRFunc)foreach_remove, self);
+        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+        shutdown_context_complete_and_free (ctx);
+        return;
+    }
 
-        /* Disabling may take a few iterations of the mainloop, so the caller
-         * has to iterate the mainloop until all devices have been disabled and
-         * removed.
-         */
+    mm_dbg ("Disabling %u modems...", g_list_length (ctx->pending));
+    ctx->timeout_id = g_timeout_add_seconds (timeout_secs, (GSourceFunc)shutdown_timeout_cb, ctx);
+
+    /* Launch all disables in parallel. Iterate a copy, as disabling may
+     * complete right away and modify the list. */
+    pending = g_list_copy (ctx->pending);
+    for (l = pending; l; l = g_list_next (l)) {
+        ShutdownDeviceContext *device_ctx = l->data;
+
+        mm_base_modem_disable (device_ctx->modem,
+                               (GAsyncReadyCallback)remove_disable_ready,
+                               device_ctx);
+    }
+    g_list_free (pending);
+}
+
+/*****************************************************************************/
+/* Suspend/resume */
+
+static gboolean
+foreach_sleep (gpointer key,
+               MMDevice *device,
+               MMBaseManager *self)
+{
+    /* Devices with a modem are kept around, to be revalidated on resume.
+     * Devices still being probed are removed, and get reprobed once resumed. */
+    if (mm_device_peek_modem (device))
+        return FALSE;
+
+    untrack_device_indexes (self, device);
+    return TRUE;
+}
+
+void
+mm_base_manager_sleep (MMBaseManager *self)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_BASE_MANAGER (self));
+
+    g_hash_table_foreach_remove (self->priv->devices, (GHRFunc)foreach_sleep, self);
+
+    mm_dbg ("Keeping %u devices while sleeping", g_hash_table_size (self->priv->devices));
+}
+
+typedef struct {
+    MMBaseManager *self;
+    MMDevice *device;
+    MMBaseModem *modem;
+} ResumeDeviceContext;
+
+static void
+registration_checks_ready (GObject *modem,
+                           GAsyncResult *res)
+{
+    GError *error = NULL;
+    gboolean success;
+
+    if (MM_IS_IFACE_MODEM_3GPP (modem))
+        success = mm_iface_modem_3gpp_run_registration_checks_finish (MM_IFACE_MODEM_3GPP (modem), res, &error);
+    else
+        success = mm_iface_modem_cdma_run_registration_checks_finish (MM_IFACE_MODEM_CDMA (modem), res, &error);
+
+    if (!success) {
+        mm_dbg ("Couldn't refresh registration after resume: '%s'", error->message);
+        g_error_free (error);
+    }
+}
+
+static void
+resume_refresh_bearer (MMBaseBearer *bearer,
+                       gpointer user_data)
+{
+    mm_base_bearer_reload_connection_status (bearer);
+}
+
+static void
+resume_refresh_modem (MMBaseModem *modem)
+{
+    MMModemState state = MM_MODEM_STATE_UNKNOWN;
+    MMBearerList *bearer_list = NULL;
+
+    /* Only dynamic state needs to be refreshed, and only enabled modems
+     * have any */
+    g_object_get (modem, MM_IFACE_MODEM_STATE, &state, NULL);
+    if (state < MM_MODEM_STATE_ENABLED)
         return;
+
+    mm_iface_modem_refresh_access_technologies (MM_IFACE_MODEM (modem));
+
+    if (MM_IS_IFACE_MODEM_3GPP (modem) && mm_iface_modem_is_3gpp (MM_IFACE_MODEM (modem)))
+        mm_iface_modem_3gpp_run_registration_checks (MM_IFACE_MODEM_3GPP (modem),
+                                                     (GAsyncReadyCallback)registration_checks_ready,
+                                                     NULL);
+    else if (MM_IS_IFACE_MODEM_CDMA (modem) && mm_iface_modem_is_cdma (MM_IFACE_MODEM (modem)))
+        mm_iface_modem_cdma_run_registration_checks (MM_IFACE_MODEM_CDMA (modem),
+                                                     (GAsyncReadyCallback)registration_checks_ready,
+                                                     NULL);
+
+    /* Connections may have been dropped by the network while sleeping */
+    g_object_get (modem, MM_IFACE_MODEM_BEARER_LIST, &bearer_list, NULL);
+    if (bearer_list) {
+        mm_bearer_list_foreach (bearer_list, resume_refresh_bearer, NULL);
+        g_object_unref (bearer_list);
+    }
+}
+
+static void
+resume_device_context_complete_and_free (ResumeDeviceContext *ctx,
+                                         gboolean valid)
+{
+    MMBaseManager *self = ctx->self;
+
+    /* The device may have been removed (e.g. unplugged) meanwhile */
+    if (g_hash_table_lookup (self->priv->devices, mm_device_get_path (ctx->device)) == ctx->device &&
+        mm_device_peek_modem (ctx->device) == ctx->modem) {
+        if (valid) {
+            mm_dbg ("(%s) device kept after resume", mm_device_get_path (ctx->device));
+            resume_refresh_modem (ctx->modem);
+        } else {
+            mm_info ("(%s) device changed while sleeping, will be reprobed",
+                     mm_device_get_path (ctx->device));
+            g_cancellable_cancel (mm_base_modem_peek_cancellable (ctx->modem));
+            mm_device_remove_modem (ctx->device);
+            untrack_device (self, ctx->device);
+        }
     }
 
-    /* Otherwise, just remove directly */
-    g_hash_table_foreach_remove (self->priv->devices, (GHRFunc)foreach_remove, self);
+    g_object_unref (ctx->modem);
+    g_object_unref (ctx->device);
+    g_slice_free (ResumeDeviceContext, ctx);
+
+    /* Once all kept devices are revalidated, rescan to pick up new ports and
+     * to reprobe the devices that were removed */
+    g_assert (self->priv->n_resuming > 0);
+    if (--self->priv->n_resuming == 0) {
+        mm_dbg ("Re-scanning after resume...");
+        mm_base_manager_start (self, FALSE);
+    }
+    g_object_unref (self);
+}
+
+static void
+resume_ping_ready (MMBaseModem *modem,
+                   GAsyncResult *res,
+                   ResumeDeviceContext *ctx)
+{
+    GError *error = NULL;
+
+    if (!mm_base_modem_at_command_finish (modem, res, &error)) {
+        mm_dbg ("(%s) AT port not responding after resume: '%s'",
+                mm_device_get_path (ctx->device),
+                error->message);
+        g_error_free (error);
+        resume_device_context_complete_and_free (ctx, FALSE);
+        return;
+    }
+
+    resume_device_context_complete_and_free (ctx, TRUE);
+}
+
+static gboolean
+device_ports_unchanged (MMBaseManager *self,
+                        MMDevice *device,
+                        MMBaseModem *modem)
+{
+    GList *l;
+
+    /* Virtual ports are not exposed in udev */
+    if (mm_device_is_virtual (device))
+        return TRUE;
+
+    for (l = mm_device_peek_port_probe_list (device); l; l = g_list_next (l)) {
+        GUdevDevice *port;
+        GUdevDevice *current;
+
+        port = mm_port_probe_peek_port (MM_PORT_PROBE (l->data));
+        current = g_udev_client_query_by_sysfs_path (self->priv->udev,
+                                                     g_udev_device_get_sysfs_path (port));
+        if (!current) {
+            mm_dbg ("(%s) port '%s' gone while sleeping",
+                    mm_device_get_path (device),
+                    g_udev_device_get_name (port));
+            return FALSE;
+        }
+        g_object_unref (current);
+    }
+
+#if defined WITH_QMI
+    if (mm_base_modem_peek_port_qmi (modem) &&
+        !mm_port_qmi_is_open (mm_base_modem_peek_port_qmi (modem)))
+        return FALSE;
+#endif
+#if defined WITH_MBIM
+    if (mm_base_modem_peek_port_mbim (modem) &&
+        !mm_port_mbim_is_open (mm_base_modem_peek_port_mbim (modem)))
+        return FALSE;
+#endif
+
+    return TRUE;
+}
+
+void
+mm_base_manager_resume (MMBaseManager *self)
+{
+    GHashTableIter iter;
+    gpointer value;
+    GList *devices = NULL;
+    GList *l;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_BASE_MANAGER (self));
+
+    /* Collect first, as invalid devices get removed from the table */
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        if (mm_device_peek_modem (MM_DEVICE (value)))
+            devices = g_list_prepend (devices, g_object_ref (value));
+    }
+
+    /* Hold the rescan until all devices are revalidated */
+    self->priv->n_resuming++;
+
+    for (l = devices; l; l = g_list_next (l)) {
+        ResumeDeviceContext *ctx;
+
+        ctx = g_slice_new (ResumeDeviceContext);
+        ctx->self = g_object_ref (self);
+        ctx->device = g_object_ref (l->data);
+        ctx->modem = g_object_ref (mm_device_peek_modem (ctx->device));
+        self->priv->n_resuming++;
+
+        if (!device_ports_unchanged (self, ctx->device, ctx->modem)) {
+            resume_device_context_complete_and_free (ctx, FALSE);
+            continue;
+        }
+
+        /* Ping AT capable modems; QMI and MBIM ports were checked above */
+        if (!mm_base_modem_peek_best_at_port (ctx->modem, NULL)) {
+            resume_device_context_complete_and_free (ctx, TRUE);
+            continue;
+        }
+
+        mm_base_modem_at_command (ctx->modem,
+                                  "",
+                                  3,
+                                  FALSE,
+                                  (GAsyncReadyCallback)resume_ping_ready,
+                                  ctx);
+    }
+    g_list_free_full (devices, (GDestroyNotify)g_object_unref);
+
+    g_assert (self->priv->n_resuming > 0);
+    if (--self->priv->n_resuming == 0) {
+        mm_dbg ("Re-scanning after resume...");
+        mm_base_manager_start (self, FALSE);
+    }
 }
 
 guint32
@@ -728,6 +1509,95 @@ handle_scan_devices (MmGdbusOrgFreedesktopModemManager1 *manager,
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Serial port I/O metrics */
+
+static GList *
+modem_peek_serial_ports (MMBaseModem *modem)
+{
+    MMPortSerial *ports[5];
+    GList *list = NULL;
+    guint i;
+
+    ports[0] = (MMPortSerial *) mm_base_modem_peek_port_primary (modem);
+    ports[1] = (MMPortSerial *) mm_base_modem_peek_port_secondary (modem);
+    ports[2] = (MMPortSerial *) mm_base_modem_peek_port_qcdm (modem);
+    ports[3] = (MMPortSerial *) mm_base_modem_peek_port_gps_control (modem);
+    ports[4] = (MMPortSerial *) mm_base_modem_peek_port_gps (modem);
+
+    for (i = 0; i < G_N_ELEMENTS (ports); i++) {
+        if (ports[i] && !g_list_find (list, ports[i]))
+            list = g_list_append (list, ports[i]);
+    }
+
+    return list;
+}
+
+static GList *
+peek_serial_ports (MMBaseManager *self)
+{
+    GHashTableIter iter;
+    gpointer value;
+    GList *list = NULL;
+
+    g_hash_table_iter_init (&iter, self->priv->devices);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        MMBaseModem *modem;
+
+        modem = mm_device_peek_modem (MM_DEVICE (value));
+        if (modem)
+            list = g_list_concat (list, modem_peek_serial_ports (modem));
+    }
+
+    return list;
+}
+
+void
+mm_base_manager_log_port_metrics (MMBaseManager *self)
+{
+    GList *ports;
+    GList *l;
+
+    g_return_if_fail (MM_IS_BASE_MANAGER (self));
+
+    ports = peek_serial_ports (self);
+    if (!ports) {
+        mm_info ("No serial ports in use");
+        return;
+    }
+
+    for (l = ports; l; l = g_list_next (l)) {
+        gchar *str;
+
+        str = mm_port_serial_build_metrics_string (MM_PORT_SERIAL (l->data));
+        mm_info ("(%s) %s", mm_port_get_device (MM_PORT (l->data)), str);
+        g_free (str);
+    }
+    g_list_free (ports);
+}
+
+static gboolean
+handle_get_port_metrics (MmGdbusTest *skeleton,
+                         GDBusMethodInvocation *invocation,
+                         MMBaseManager *self)
+{
+    GVariantBuilder builder;
+    GList *ports;
+    GList *l;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+
+    ports = peek_serial_ports (self);
+    for (l = ports; l; l = g_list_next (l))
+        g_variant_builder_add (&builder, "{sv}",
+                               mm_port_get_device (MM_PORT (l->data)),
+                               mm_port_serial_build_metrics_variant (MM_PORT_SERIAL (l->data)));
+    g_list_free (ports);
+
+    mm_gdbus_test_complete_get_port_metrics (skeleton, invocation, g_variant_builder_end (&builder));
+    return TRUE;
+}
+
 /*****************************************************************************/
 /* Test profile setup */
 
@@ -749,9 +1619,7 @@ handle_set_profile (MmGdbusTest *skeleton,
     /* Create device and keep it listed in the Manager */
     physdev = g_strdup_printf ("/virtual/%s", id);
     device = mm_device_virtual_new (physdev, TRUE);
-    g_hash_table_insert (self->priv->devices,
-                         g_strdup (physdev),
-                         device);
+    track_device (self, physdev, device);
 
     /* Grab virtual ports */
     mm_device_virtual_grab_ports (device, (const gchar **)ports);
@@ -785,7 +1653,7 @@ out:
 
     if (error) {
         mm_device_remove_modem (device);
-        g_hash_table_remove (self->priv->devices, mm_device_get_path (device));
+        untrack_device (self, device);
         g_dbus_method_invocation_return_gerror (invocation, error);
         g_error_free (error);
     } else
@@ -906,6 +1774,16 @@ mm_base_manager_init (MMBaseManager *manager)
 
     /* Setup internal lists of device objects */
     priv->devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    priv->devices_by_port = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    priv->devices_by_port_devpath = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    priv->devices_by_modem = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    /* Setup uevent groups; groups and ports own their keys */
+    priv->uevent_groups = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)uevent_group_free);
+    priv->uevent_groups_by_port = g_hash_table_new (g_str_hash, g_str_equal);
+
+    /* Setup queue of scanned ports */
+    priv->scan_queue = g_queue_new ();
 
     /* Setup UDev client */
     priv->udev = g_udev_client_new (subsys);
@@ -964,6 +1842,10 @@ initable_init (GInitable *initable,
                           "handle-set-profile",
                           G_CALLBACK (handle_set_profile),
                           initable);
+        g_signal_connect (priv->test_skeleton,
+                          "handle-get-port-metrics",
+                          G_CALLBACK (handle_get_port_metrics),
+                          initable);
         if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (priv->test_skeleton),
                                                priv->connection,
                                                MM_DBUS_PATH,
@@ -982,6 +1864,21 @@ finalize (GObject *object)
 
     g_free (priv->plugin_dir);
 
+    /* Port entries point to strings owned by the groups */
+    g_hash_table_destroy (priv->uevent_groups_by_port);
+    g_hash_table_destroy (priv->uevent_groups);
+
+    if (priv->scan_idle_id)
+        g_source_remove (priv->scan_idle_id);
+    g_queue_free_full (priv->scan_queue, (GDestroyNotify)scanned_port_free);
+    if (priv->physdev_cache)
+        g_hash_table_destroy (priv->physdev_cache);
+    if (priv->first_modem_timer)
+        g_timer_destroy (priv->first_modem_timer);
+
+    g_hash_table_destroy (priv->devices_by_port);
+    g_hash_table_destroy (priv->devices_by_port_devpath);
+    g_hash_table_destroy (priv->devices_by_modem);
     g_hash_table_destroy (priv->devices);
 
     if (priv->udev)
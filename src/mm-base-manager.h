@@ -57,9 +57,21 @@ MMBaseManager   *mm_base_manager_new         (GDBusConnection *bus,
 void             mm_base_manager_start       (MMBaseManager *manager,
                                               gboolean manual_scan);
 
-void             mm_base_manager_shutdown    (MMBaseManager *manager,
-                                              gboolean disable);
+void             mm_base_manager_shutdown        (MMBaseManager *manager,
+                                                  gboolean disable,
+                                                  guint timeout_secs,
+                                                  GAsyncReadyCallback callback,
+                                                  gpointer user_data);
+gboolean         mm_base_manager_shutdown_finish (MMBaseManager *manager,
+                                                  GAsyncResult *res,
+                                                  GError **error);
+
+void             mm_base_manager_sleep       (MMBaseManager *manager);
+
+void             mm_base_manager_resume      (MMBaseManager *manager);
 
 guint32          mm_base_manager_num_modems  (MMBaseManager *manager);
 
+void             mm_base_manager_log_port_metrics (MMBaseManager *manager);
+
 #endif /* MM_BASE_MANAGER_H */
@@ -438,6 +438,8 @@ typedef struct {
     gulong cancelled_id;
     GCancellable *modem_cancellable;
     GCancellable *user_cancellable;
+    MMBaseModemAtResponseLineFn line_fn;
+    gpointer line_fn_user_data;
     GSimpleAsyncResult *result;
 } AtCommandContext;
 
@@ -471,6 +473,18 @@ mm_base_modem_at_command_full_finish (MMBaseModem *self,
     return g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
 }
 
+static void
+at_command_line (MMPortSerialAt *port,
+                 const gchar *line,
+                 AtCommandContext *ctx)
+{
+    /* Once cancelled, we just wait for the command to finish */
+    if (g_cancellable_is_cancelled (ctx->cancellable))
+        return;
+
+    ctx->line_fn (ctx->self, line, ctx->line_fn_user_data);
+}
+
 static void
 at_command_ready (MMPortSerialAt *port,
                   GAsyncResult *res,
@@ -504,16 +518,18 @@ at_command_ready (MMPortSerialAt *port,
     at_command_context_free (ctx);
 }
 
-void
-mm_base_modem_at_command_full (MMBaseModem *self,
-                               MMPortSerialAt *port,
-                               const gchar *command,
-                               guint timeout,
-                               gboolean allow_cached,
-                               gboolean is_raw,
-                               GCancellable *cancellable,
-                               GAsyncReadyCallback callback,
-                               gpointer user_data)
+static void
+at_command_run (MMBaseModem *self,
+                MMPortSerialAt *port,
+                const gchar *command,
+                guint timeout,
+                gboolean allow_cached,
+                gboolean is_raw,
+                MMBaseModemAtResponseLineFn line_fn,
+                gpointer line_fn_user_data,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
 {
     AtCommandContext *ctx;
 
@@ -528,6 +544,8 @@ mm_base_modem_at_command_full (MMBaseModem *self,
                                              callback,
                                              user_data,
                                              mm_base_modem_at_command_full);
+    ctx->line_fn = line_fn;
+    ctx->line_fn_user_data = line_fn_user_data;
 
     /* Setup cancellables */
     ctx->modem_cancellable = mm_base_modem_get_cancellable (self);
@@ -546,6 +564,20 @@ mm_base_modem_at_command_full (MMBaseModem *self,
     }
 
     /* Go on with the command */
+    if (line_fn) {
+        mm_port_serial_at_command_streamed (
+            port,
+            command,
+            timeout,
+            is_raw,
+            (MMPortSerialAtResponseLineFn)at_command_line,
+            ctx,
+            ctx->cancellable,
+            (GAsyncReadyCallback)at_command_ready,
+            ctx);
+        return;
+    }
+
     mm_port_serial_at_command (
         port,
         command,
@@ -557,6 +589,71 @@ mm_base_modem_at_command_full (MMBaseModem *self,
         ctx);
 }
 
+void
+mm_base_modem_at_command_full (MMBaseModem *self,
+                               MMPortSerialAt *port,
+                               const gchar *command,
+                               guint timeout,
+                               gboolean allow_cached,
+                               gboolean is_raw,
+                               GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data)
+{
+    at_command_run (self,
+                    port,
+                    command,
+                    timeout,
+                    allow_cached,
+                    is_raw,
+                    NULL,
+                    NULL,
+                    cancellable,
+                    callback,
+                    user_data);
+}
+
+void
+mm_base_modem_at_command_streamed (MMBaseModem *self,
+                                   MMPortSerialAt *port,
+                                   const gchar *command,
+                                   guint timeout,
+                                   MMBaseModemAtResponseLineFn line_fn,
+                                   gpointer line_fn_user_data,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+    g_return_if_fail (line_fn != NULL);
+
+    /* No port given, so we'll try to guess which is best */
+    if (!port) {
+        GError *error = NULL;
+
+        port = mm_base_modem_peek_best_at_port (self, &error);
+        if (!port) {
+            g_assert (error != NULL);
+            g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
+                                                       callback,
+                                                       user_data,
+                                                       error);
+            return;
+        }
+    }
+
+    at_command_run (self,
+                    port,
+                    command,
+                    timeout,
+                    FALSE, /* never cached */
+                    FALSE, /* not raw */
+                    line_fn,
+                    line_fn_user_data,
+                    cancellable,
+                    callback,
+                    user_data);
+}
+
 const gchar *
 mm_base_modem_at_command_finish (MMBaseModem *self,
                                  GAsyncResult *res,
@@ -164,4 +164,23 @@ const gchar *mm_base_modem_at_command_full_finish (MMBaseModem *self,
                                                    GAsyncResult *res,
                                                    GError **error);
 
+/* AT command handling where each intermediate line of the reply is reported
+ * through @line_fn as soon as it's received, instead of waiting for the whole
+ * response. Useful for long listings (e.g. +CMGL or +COPS=?). If no @port is
+ * given, the best AT port available is used. The final response given in
+ * mm_base_modem_at_command_full_finish() will be empty on success. */
+typedef void (* MMBaseModemAtResponseLineFn) (MMBaseModem *self,
+                                              const gchar *line,
+                                              gpointer user_data);
+
+void mm_base_modem_at_command_streamed (MMBaseModem *self,
+                                        MMPortSerialAt *port,
+                                        const gchar *command,
+                                        guint timeout,
+                                        MMBaseModemAtResponseLineFn line_fn,
+                                        gpointer line_fn_user_data,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+
 #endif /* MM_BASE_MODEM_AT_H */
@@ -794,7 +794,7 @@ sms_get_store_or_send_command (MMSmsPart *part,
         guint8 *pdu;
         guint pdulen = 0;
         guint msgstart = 0;
-        gchar *hex;
+        gchar *msg_data;
 
         /* AT+CMGW=<length>[, <stat>]<CR> PDU can be entered. <CTRL-Z>/<ESC> */
 
@@ -803,24 +803,18 @@ sms_get_store_or_send_command (MMSmsPart *part,
             /* 'error' should already be set */
             return FALSE;
 
-        /* Convert PDU to hex */
-        hex = mm_utils_bin2hexstr (pdu, pdulen);
+        /* Convert PDU to hex, directly followed by the CTRL-Z */
+        msg_data = g_malloc (pdulen * 2 + 2);
+        mm_utils_bin2hexstr_buf (pdu, pdulen, msg_data, pdulen * 2 + 1);
+        msg_data[pdulen * 2] = '\x1a';
+        msg_data[pdulen * 2 + 1] = '\0';
         g_free (pdu);
 
-        if (!hex) {
-            g_set_error (error,
-                         MM_CORE_ERROR,
-                         MM_CORE_ERROR_FAILED,
-                         "Not enough memory to send SMS PDU");
-            return FALSE;
-        }
-
         /* CMGW/S length is the size of the PDU without SMSC information */
         *out_cmd = g_strdup_printf ("+CMG%c=%d",
                                     store_or_send ? 'S' : 'W',
                                     pdulen - msgstart);
-        *out_msg_data = g_strdup_printf ("%s\x1a", hex);
-        g_free (hex);
+        *out_msg_data = msg_data;
     }
 
     return TRUE;
@@ -1290,6 +1290,83 @@ disconnect (MMBaseBearer *_self,
     disconnect_context_step (ctx);
 }
 
+/*****************************************************************************/
+/* Reload connection status */
+
+static MMBearerConnectionStatus
+reload_connection_status_finish (MMBaseBearer *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return MM_BEARER_CONNECTION_STATUS_UNKNOWN;
+
+    return (MMBearerConnectionStatus) GPOINTER_TO_UINT (g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res)));
+}
+
+static void
+get_packet_service_status_ready (QmiClientWds *client,
+                                 GAsyncResult *res,
+                                 GSimpleAsyncResult *simple)
+{
+    QmiMessageWdsGetPacketServiceStatusOutput *output;
+    QmiWdsConnectionStatus connection_status;
+    GError *error = NULL;
+
+    output = qmi_client_wds_get_packet_service_status_finish (client, res, &error);
+    if (!output ||
+        !qmi_message_wds_get_packet_service_status_output_get_result (output, &error) ||
+        !qmi_message_wds_get_packet_service_status_output_get_connection_status (output, &connection_status, &error))
+        g_simple_async_result_take_error (simple, error);
+    else
+        g_simple_async_result_set_op_res_gpointer (
+            simple,
+            GUINT_TO_POINTER (connection_status == QMI_WDS_CONNECTION_STATUS_CONNECTED ?
+                              MM_BEARER_CONNECTION_STATUS_CONNECTED :
+                              MM_BEARER_CONNECTION_STATUS_DISCONNECTED),
+            NULL);
+
+    if (output)
+        qmi_message_wds_get_packet_service_status_output_unref (output);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+}
+
+static void
+reload_connection_status (MMBaseBearer *_self,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    MMBearerQmi *self = MM_BEARER_QMI (_self);
+    GSimpleAsyncResult *result;
+    QmiClientWds *client;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        reload_connection_status);
+
+    /* Either client is enough, both run on the same packet data session */
+    client = (self->priv->client_ipv4 ? self->priv->client_ipv4 : self->priv->client_ipv6);
+    if (!client) {
+        g_simple_async_result_set_error (result,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_FAILED,
+                                         "Couldn't reload QMI bearer connection status: "
+                                         "this bearer is not connected");
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
+    qmi_client_wds_get_packet_service_status (client,
+                                              NULL,
+                                              10,
+                                              NULL,
+                                              (GAsyncReadyCallback)get_packet_service_status_ready,
+                                              result);
+}
+
 /*****************************************************************************/
 
 static void
@@ -1403,6 +1480,8 @@ mm_bearer_qmi_class_init (MMBearerQmiClass *klass)
     base_bearer_class->disconnect = disconnect;
     base_bearer_class->disconnect_finish = disconnect_finish;
     base_bearer_class->report_connection_status = report_connection_status;
+    base_bearer_class->reload_connection_status = reload_connection_status;
+    base_bearer_class->reload_connection_status_finish = reload_connection_status_finish;
 
     /* Properties */
     properties[PROP_FORCE_DHCP] =
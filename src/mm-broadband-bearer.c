@@ -86,6 +86,7 @@ typedef struct {
     guint cid;
     guint max_cid;
     gboolean use_existing_cid;
+    gboolean cid_from_cache;
     MMBearerIpFamily ip_family;
 } DetailedConnectContext;
 
@@ -619,6 +620,163 @@ dial_3gpp (MMBroadbandBearer *self,
     g_free (command);
 }
 
+/*****************************************************************************/
+/* PDP context cache
+ *
+ * The list of PDP contexts defined in the modem is kept once read or written,
+ * so that reconnecting with the same APN and IP type may dial right away. The
+ * cache is dropped when the modem is no longer enabled or the SIM changes, and
+ * when dialing with a cached context fails.
+ */
+
+#define PDP_CONTEXT_CACHE_TAG "broadband-bearer-pdp-context-cache"
+static GQuark pdp_context_cache_quark;
+
+typedef struct {
+    /* MM3gppPdpContext; NULL if unknown */
+    GList *contexts;
+} PdpContextCache;
+
+static void
+pdp_context_cache_clear (PdpContextCache *cache)
+{
+    if (cache->contexts) {
+        mm_dbg ("Clearing PDP context cache");
+        mm_3gpp_pdp_context_list_free (cache->contexts);
+        cache->contexts = NULL;
+    }
+}
+
+static void
+pdp_context_cache_free (PdpContextCache *cache)
+{
+    pdp_context_cache_clear (cache);
+    g_slice_free (PdpContextCache, cache);
+}
+
+static void
+pdp_context_cache_modem_state_changed (MMBaseModem *modem,
+                                       GParamSpec *pspec,
+                                       PdpContextCache *cache)
+{
+    MMModemState state = MM_MODEM_STATE_UNKNOWN;
+
+    g_object_get (modem, MM_IFACE_MODEM_STATE, &state, NULL);
+    if (state < MM_MODEM_STATE_ENABLED)
+        pdp_context_cache_clear (cache);
+}
+
+static PdpContextCache *
+get_pdp_context_cache (MMBaseModem *modem)
+{
+    PdpContextCache *cache;
+
+    if (G_UNLIKELY (!pdp_context_cache_quark))
+        pdp_context_cache_quark = g_quark_from_static_string (PDP_CONTEXT_CACHE_TAG);
+
+    cache = g_object_get_qdata (G_OBJECT (modem), pdp_context_cache_quark);
+    if (!cache) {
+        cache = g_slice_new0 (PdpContextCache);
+        g_object_set_qdata_full (G_OBJECT (modem),
+                                 pdp_context_cache_quark,
+                                 cache,
+                                 (GDestroyNotify)pdp_context_cache_free);
+
+        /* Signal handlers go away with the modem, same as the cache */
+        g_signal_connect (modem,
+                          "notify::" MM_IFACE_MODEM_STATE,
+                          G_CALLBACK (pdp_context_cache_modem_state_changed),
+                          cache);
+        g_signal_connect_swapped (modem,
+                                  "notify::" MM_IFACE_MODEM_SIM,
+                                  G_CALLBACK (pdp_context_cache_clear),
+                                  cache);
+    }
+
+    return cache;
+}
+
+static void
+pdp_context_cache_set (MMBaseModem *modem,
+                       GList *pdp_list)
+{
+    PdpContextCache *cache;
+    GList *l;
+
+    cache = get_pdp_context_cache (modem);
+    pdp_context_cache_clear (cache);
+
+    for (l = pdp_list; l; l = g_list_next (l)) {
+        MM3gppPdpContext *pdp = l->data;
+        MM3gppPdpContext *copy;
+
+        copy = g_slice_new0 (MM3gppPdpContext);
+        copy->cid = pdp->cid;
+        copy->pdp_type = pdp->pdp_type;
+        copy->apn = g_strdup (pdp->apn);
+        cache->contexts = g_list_prepend (cache->contexts, copy);
+    }
+    cache->contexts = g_list_reverse (cache->contexts);
+}
+
+static void
+pdp_context_cache_update (MMBaseModem *modem,
+                          guint cid,
+                          MMBearerIpFamily pdp_type,
+                          const gchar *apn)
+{
+    PdpContextCache *cache;
+    MM3gppPdpContext *pdp = NULL;
+    GList *l;
+
+    /* Only update a known list, a single context is not enough to look
+     * for a CID to use */
+    cache = get_pdp_context_cache (modem);
+    if (!cache->contexts)
+        return;
+
+    for (l = cache->contexts; l; l = g_list_next (l)) {
+        if (((MM3gppPdpContext *)l->data)->cid == cid) {
+            pdp = l->data;
+            break;
+        }
+    }
+
+    if (!pdp) {
+        pdp = g_slice_new0 (MM3gppPdpContext);
+        pdp->cid = cid;
+        cache->contexts = g_list_append (cache->contexts, pdp);
+    }
+
+    pdp->pdp_type = pdp_type;
+    g_free (pdp->apn);
+    pdp->apn = g_strdup (apn);
+}
+
+static guint
+pdp_context_cache_lookup (MMBaseModem *modem,
+                          MMBearerIpFamily pdp_type,
+                          const gchar *apn)
+{
+    PdpContextCache *cache;
+    GList *l;
+
+    if (!apn || !apn[0])
+        return 0;
+
+    cache = get_pdp_context_cache (modem);
+    for (l = cache->contexts; l; l = g_list_next (l)) {
+        MM3gppPdpContext *pdp = l->data;
+
+        if (pdp->pdp_type == pdp_type &&
+            pdp->apn &&
+            !g_ascii_strcasecmp (pdp->apn, apn))
+            return pdp->cid;
+    }
+
+    return 0;
+}
+
 /*****************************************************************************/
 /* 3GPP CONNECT
  *
@@ -683,6 +841,9 @@ dial_3gpp_ready (MMBroadbandModem *modem,
     if (!ctx->data) {
         /* Clear CID when it failed to connect. */
         ctx->self->priv->cid = 0;
+        /* The cached PDP context may not be valid any more */
+        if (ctx->cid_from_cache)
+            pdp_context_cache_clear (get_pdp_context_cache (ctx->modem));
         g_simple_async_result_take_error (ctx->result, error);
         detailed_connect_context_complete_and_free (ctx);
         return;
@@ -773,11 +934,17 @@ initialize_pdp_context_ready (MMBaseModem *modem,
     if (error) {
         mm_warn ("Couldn't initialize PDP context with our APN: '%s'",
                  error->message);
+        /* We don't know what the context looks like now */
+        pdp_context_cache_clear (get_pdp_context_cache (modem));
         g_simple_async_result_take_error (ctx->result, error);
         detailed_connect_context_complete_and_free (ctx);
         return;
     }
 
+    pdp_context_cache_update (modem,
+                              ctx->cid,
+                              ctx->ip_family,
+                              mm_bearer_properties_get_apn (mm_base_bearer_peek_config (MM_BASE_BEARER (ctx->self))));
     start_3gpp_dial (ctx);
 }
 
@@ -971,6 +1138,8 @@ parse_pdp_list (MMBaseModem *modem,
         g_free (ip_family_str);
     }
 
+    pdp_context_cache_set (modem, pdp_list);
+
     /* Look for the exact PDP context we want */
     for (l = pdp_list; l; l = g_list_next (l)) {
         MM3gppPdpContext *pdp = l->data;
@@ -1041,6 +1210,21 @@ connect_3gpp (MMBroadbandBearer *self,
                                         callback,
                                         user_data);
 
+    /* If we already know a PDP context with the same APN and IP type, just
+     * use it */
+    if (mm_3gpp_get_pdp_type_from_ip_family (ctx->ip_family)) {
+        ctx->cid = pdp_context_cache_lookup (ctx->modem,
+                                             ctx->ip_family,
+                                             mm_bearer_properties_get_apn (mm_base_bearer_peek_config (MM_BASE_BEARER (self))));
+        if (ctx->cid) {
+            mm_dbg ("Using cached PDP context with CID %u", ctx->cid);
+            ctx->use_existing_cid = TRUE;
+            ctx->cid_from_cache = TRUE;
+            start_3gpp_dial (ctx);
+            return;
+        }
+    }
+
     mm_dbg ("Looking for best CID...");
     mm_base_modem_at_sequence_full (ctx->modem,
                                     ctx->primary,
@@ -1820,6 +2004,105 @@ disconnect (MMBaseBearer *self,
     g_object_unref (modem);
 }
 
+/*****************************************************************************/
+/* Reload connection status */
+
+static MMBearerConnectionStatus
+reload_connection_status_finish (MMBaseBearer *self,
+                                 GAsyncResult *res,
+                                 GError **error)
+{
+    if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
+        return MM_BEARER_CONNECTION_STATUS_UNKNOWN;
+
+    return (MMBearerConnectionStatus) GPOINTER_TO_UINT (g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res)));
+}
+
+static void
+cgact_query_ready (MMBaseModem *modem,
+                   GAsyncResult *res,
+                   GSimpleAsyncResult *simple)
+{
+    MMBroadbandBearer *self;
+    const gchar *response;
+    GList *pdp_active_list = NULL;
+    GList *l;
+    GError *error = NULL;
+    MMBearerConnectionStatus status = MM_BEARER_CONNECTION_STATUS_UNKNOWN;
+
+    self = MM_BROADBAND_BEARER (g_async_result_get_source_object (G_ASYNC_RESULT (simple)));
+
+    response = mm_base_modem_at_command_finish (modem, res, &error);
+    if (response)
+        pdp_active_list = mm_3gpp_parse_cgact_read_response (response, &error);
+
+    for (l = pdp_active_list; l; l = g_list_next (l)) {
+        MM3gppPdpContextActive *pdp_active = l->data;
+
+        if (pdp_active->cid == self->priv->cid) {
+            status = (pdp_active->active ?
+                      MM_BEARER_CONNECTION_STATUS_CONNECTED :
+                      MM_BEARER_CONNECTION_STATUS_DISCONNECTED);
+            break;
+        }
+    }
+    mm_3gpp_pdp_context_active_list_free (pdp_active_list);
+
+    if (error)
+        g_simple_async_result_take_error (simple, error);
+    else if (status == MM_BEARER_CONNECTION_STATUS_UNKNOWN)
+        g_simple_async_result_set_error (simple,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_FAILED,
+                                         "PDP context %u not reported",
+                                         self->priv->cid);
+    else
+        g_simple_async_result_set_op_res_gpointer (simple, GUINT_TO_POINTER (status), NULL);
+    g_simple_async_result_complete (simple);
+    g_object_unref (simple);
+    g_object_unref (self);
+}
+
+static void
+reload_connection_status (MMBaseBearer *self,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    GSimpleAsyncResult *result;
+    MMBaseModem *modem = NULL;
+
+    result = g_simple_async_result_new (G_OBJECT (self),
+                                        callback,
+                                        user_data,
+                                        reload_connection_status);
+
+    /* Only 3GPP connections with a known PDP context can be checked */
+    if (MM_BROADBAND_BEARER (self)->priv->connection_type != CONNECTION_TYPE_3GPP ||
+        !MM_BROADBAND_BEARER (self)->priv->cid) {
+        g_simple_async_result_set_error (result,
+                                         MM_CORE_ERROR,
+                                         MM_CORE_ERROR_UNSUPPORTED,
+                                         "Connection status cannot be reloaded");
+        g_simple_async_result_complete_in_idle (result);
+        g_object_unref (result);
+        return;
+    }
+
+    g_object_get (self,
+                  MM_BASE_BEARER_MODEM, &modem,
+                  NULL);
+    g_assert (modem != NULL);
+
+    /* Fails by itself if there's no AT port other than the data one */
+    mm_base_modem_at_command (modem,
+                              "+CGACT?",
+                              10,
+                              FALSE,
+                              (GAsyncReadyCallback)cgact_query_ready,
+                              result);
+    g_object_unref (modem);
+}
+
 /*****************************************************************************/
 
 static void
@@ -2095,6 +2378,8 @@ mm_broadband_bearer_class_init (MMBroadbandBearerClass *klass)
     base_bearer_class->disconnect = disconnect;
     base_bearer_class->disconnect_finish = disconnect_finish;
     base_bearer_class->report_connection_status = report_connection_status;
+    base_bearer_class->reload_connection_status = reload_connection_status;
+    base_bearer_class->reload_connection_status_finish = reload_connection_status_finish;
 
     klass->connect_3gpp = connect_3gpp;
     klass->connect_3gpp_finish = detailed_connect_finish;
@@ -6153,6 +6153,7 @@ typedef struct {
     GSimpleAsyncResult *result;
     QmiClientNas *client;
     gboolean enable;
+    gboolean signal_info_configured;
 } EnableUnsolicitedEventsContext;
 
 static void
@@ -6242,6 +6243,7 @@ ri_signal_info_ready (QmiClientNas *client,
 {
     QmiMessageNasRegisterIndicationsOutput *output = NULL;
     GError *error = NULL;
+    gboolean registered = FALSE;
 
     output = qmi_client_nas_register_indications_finish (client, res, &error);
     if (!output) {
@@ -6250,11 +6252,21 @@ ri_signal_info_ready (QmiClientNas *client,
     } else if (!qmi_message_nas_register_indications_output_get_result (output, &error)) {
         mm_dbg ("Couldn't register indications: '%s'", error->message);
         g_error_free (error);
-    }
+    } else
+        registered = TRUE;
 
     if (output)
         qmi_message_nas_register_indications_output_unref (output);
 
+    /* With thresholds configured and indications enabled, signal changes are
+     * reported by the modem itself, so there is no need to keep on polling.
+     * Otherwise, go back to the periodic checks. */
+    g_object_set (ctx->self,
+                  MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED, (ctx->enable &&
+                                                                  ctx->signal_info_configured &&
+                                                                  registered),
+                  NULL);
+
     /* Just ignore errors for now */
     ctx->self->priv->unsolicited_events_enabled = ctx->enable;
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -6293,7 +6305,8 @@ config_signal_info_ready (QmiClientNas *client,
     } else if (!qmi_message_nas_config_signal_info_output_get_result (output, &error)) {
         mm_dbg ("Couldn't config signal info: '%s'", error->message);
         g_error_free (error);
-    }
+    } else
+        ctx->signal_info_configured = TRUE;
 
     if (output)
         qmi_message_nas_config_signal_info_output_unref (output);
@@ -6302,12 +6315,32 @@ config_signal_info_ready (QmiClientNas *client,
     common_enable_disable_unsolicited_events_signal_info (ctx);
 }
 
+static GArray *
+signal_info_thresholds_new (gconstpointer data,
+                            guint element_size,
+                            guint n_elements)
+{
+    GArray *thresholds;
+
+    thresholds = g_array_sized_new (FALSE, FALSE, element_size, n_elements);
+    g_array_append_vals (thresholds, data, n_elements);
+    return thresholds;
+}
+
 static void
 common_enable_disable_unsolicited_events_signal_info_config (EnableUnsolicitedEventsContext *ctx)
 {
     /* RSSI values go between -105 and -60 for 3GPP technologies,
      * and from -105 to -90 in 3GPP2 technologies (approx). */
     static const gint8 thresholds_data[] = { -100, -97, -95, -92, -90, -85, -80, -75, -70, -65 };
+    /* The remaining ones are only needed for the extended signal values, so
+     * keep them coarse; every threshold crossed means an indication.
+     * ECIO in units of -0.5 dB; SNR in units of 0.1 dB. */
+    static const gint16 ecio_thresholds_data[] = { 4, 10, 20, 30 };
+    static const guint8 sinr_thresholds_data[] = { 2, 4, 6 };
+    static const gint16 lte_snr_thresholds_data[] = { -50, 0, 50, 100, 200 };
+    static const gint8 rsrq_thresholds_data[] = { -20, -15, -10, -5 };
+    static const gint16 rsrp_thresholds_data[] = { -125, -115, -105, -95, -85 };
     QmiMessageNasConfigSignalInfoInput *input;
     GArray *thresholds;
 
@@ -6328,6 +6361,36 @@ common_enable_disable_unsolicited_events_signal_info_config (EnableUnsolicitedEv
         thresholds,
         NULL);
     g_array_unref (thresholds);
+
+    thresholds = signal_info_thresholds_new (ecio_thresholds_data,
+                                             sizeof (gint16),
+                                             G_N_ELEMENTS (ecio_thresholds_data));
+    qmi_message_nas_config_signal_info_input_set_ecio_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
+
+    thresholds = signal_info_thresholds_new (sinr_thresholds_data,
+                                             sizeof (guint8),
+                                             G_N_ELEMENTS (sinr_thresholds_data));
+    qmi_message_nas_config_signal_info_input_set_sinr_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
+
+    thresholds = signal_info_thresholds_new (lte_snr_thresholds_data,
+                                             sizeof (gint16),
+                                             G_N_ELEMENTS (lte_snr_thresholds_data));
+    qmi_message_nas_config_signal_info_input_set_lte_snr_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
+
+    thresholds = signal_info_thresholds_new (rsrq_thresholds_data,
+                                             sizeof (gint8),
+                                             G_N_ELEMENTS (rsrq_thresholds_data));
+    qmi_message_nas_config_signal_info_input_set_rsrq_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
+
+    thresholds = signal_info_thresholds_new (rsrp_thresholds_data,
+                                             sizeof (gint16),
+                                             G_N_ELEMENTS (rsrp_thresholds_data));
+    qmi_message_nas_config_signal_info_input_set_rsrp_threshold (input, thresholds, NULL);
+    g_array_unref (thresholds);
     qmi_client_nas_config_signal_info (
         ctx->client,
         input,
@@ -6502,6 +6565,8 @@ event_report_indication_cb (QmiClientNas *client,
 
 #if defined WITH_NEWEST_QMI_COMMANDS
 
+static gdouble get_db_from_sinr_level (QmiNasEvdoSinrLevel level);
+
 static void
 signal_info_indication_cb (QmiClientNas *client,
                            QmiIndicationNasSignalInfoOutput *output,
@@ -6509,7 +6574,18 @@ signal_info_indication_cb (QmiClientNas *client,
 {
     gint8 rssi_max = -125;
     gint8 rssi;
+    gint16 ecio;
+    QmiNasEvdoSinrLevel sinr_level;
+    gint32 io;
+    gint8 rsrq;
+    gint16 rsrp;
+    gint16 snr;
     guint8 quality;
+    MMSignal *cdma = NULL;
+    MMSignal *evdo = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
 
     /* We do not report per-technology signal quality, so just get the highest
      * one of the ones reported. TODO: When several technologies are in use, if
@@ -6517,34 +6593,52 @@ signal_info_indication_cb (QmiClientNas *client,
      * value, we'll need to have an internal cache of per-technology values, in
      * order to report always the one with the maximum value. */
 
-    if (qmi_indication_nas_signal_info_output_get_cdma_signal_strength (output, &rssi, NULL, NULL)) {
+    if (qmi_indication_nas_signal_info_output_get_cdma_signal_strength (output, &rssi, &ecio, NULL)) {
         mm_dbg ("RSSI (CDMA): %d dBm", rssi);
         if (qmi_dbm_valid (rssi, QMI_NAS_RADIO_INTERFACE_CDMA_1X))
             rssi_max = MAX (rssi, rssi_max);
+        cdma = mm_signal_new ();
+        mm_signal_set_rssi (cdma, (gdouble)rssi);
+        mm_signal_set_ecio (cdma, ((gdouble)ecio) * (-0.5));
     }
 
-    if (qmi_indication_nas_signal_info_output_get_hdr_signal_strength (output, &rssi, NULL, NULL, NULL, NULL)) {
+    if (qmi_indication_nas_signal_info_output_get_hdr_signal_strength (output, &rssi, &ecio, &sinr_level, &io, NULL)) {
         mm_dbg ("RSSI (HDR): %d dBm", rssi);
         if (qmi_dbm_valid (rssi, QMI_NAS_RADIO_INTERFACE_CDMA_1XEVDO))
             rssi_max = MAX (rssi, rssi_max);
+        evdo = mm_signal_new ();
+        mm_signal_set_rssi (evdo, (gdouble)rssi);
+        mm_signal_set_ecio (evdo, ((gdouble)ecio) * (-0.5));
+        mm_signal_set_sinr (evdo, get_db_from_sinr_level (sinr_level));
+        mm_signal_set_io (evdo, (gdouble)io);
     }
 
     if (qmi_indication_nas_signal_info_output_get_gsm_signal_strength (output, &rssi, NULL)) {
         mm_dbg ("RSSI (GSM): %d dBm", rssi);
         if (qmi_dbm_valid (rssi, QMI_NAS_RADIO_INTERFACE_GSM))
             rssi_max = MAX (rssi, rssi_max);
+        gsm = mm_signal_new ();
+        mm_signal_set_rssi (gsm, (gdouble)rssi);
     }
 
-    if (qmi_indication_nas_signal_info_output_get_wcdma_signal_strength (output, &rssi, NULL, NULL)) {
+    if (qmi_indication_nas_signal_info_output_get_wcdma_signal_strength (output, &rssi, &ecio, NULL)) {
         mm_dbg ("RSSI (WCDMA): %d dBm", rssi);
         if (qmi_dbm_valid (rssi, QMI_NAS_RADIO_INTERFACE_UMTS))
             rssi_max = MAX (rssi, rssi_max);
+        umts = mm_signal_new ();
+        mm_signal_set_rssi (umts, (gdouble)rssi);
+        mm_signal_set_ecio (umts, ((gdouble)ecio) * (-0.5));
     }
 
-    if (qmi_indication_nas_signal_info_output_get_lte_signal_strength (output, &rssi, NULL, NULL, NULL, NULL)) {
+    if (qmi_indication_nas_signal_info_output_get_lte_signal_strength (output, &rssi, &rsrq, &rsrp, &snr, NULL)) {
         mm_dbg ("RSSI (LTE): %d dBm", rssi);
         if (qmi_dbm_valid (rssi, QMI_NAS_RADIO_INTERFACE_LTE))
             rssi_max = MAX (rssi, rssi_max);
+        lte = mm_signal_new ();
+        mm_signal_set_rssi (lte, (gdouble)rssi);
+        mm_signal_set_rsrq (lte, (gdouble)rsrq);
+        mm_signal_set_rsrp (lte, (gdouble)rsrp);
+        mm_signal_set_snr (lte, (0.1) * ((gdouble)snr));
     }
 
     if (rssi_max < 0) {
@@ -6556,6 +6650,15 @@ signal_info_indication_cb (QmiClientNas *client,
         mm_iface_modem_update_signal_quality (MM_IFACE_MODEM (self), quality);
     } else
         mm_dbg ("Ignoring invalid signal strength: %d dBm", rssi_max);
+
+    /* Same values as the ones loaded when polling the extended signal info */
+    mm_iface_modem_signal_update (MM_IFACE_MODEM_SIGNAL (self), cdma, evdo, gsm, umts, lte);
+
+    g_clear_object (&cdma);
+    g_clear_object (&evdo);
+    g_clear_object (&gsm);
+    g_clear_object (&umts);
+    g_clear_object (&lte);
 }
 
 #endif /* WITH_NEWEST_QMI_COMMANDS */
@@ -6976,15 +7079,46 @@ typedef struct {
 
     /* For each step */
     GArray *message_array;
-    guint i;
+    /* Raw read replies, kept until they can be processed in order */
+    QmiMessageWmsRawReadOutput **outputs;
+    gboolean *completed;
+    guint next_read;
+    guint next_take;
+    guint n_pending;
 } LoadInitialSmsPartsContext;
 
+/* Maximum number of raw reads in flight */
+#define WMS_RAW_READ_WINDOW 4
+
+typedef struct {
+    LoadInitialSmsPartsContext *ctx;
+    guint i;
+} RawReadRequest;
+
+static void
+load_initial_sms_parts_context_clear_reads (LoadInitialSmsPartsContext *ctx)
+{
+    if (ctx->outputs) {
+        guint i;
+
+        for (i = 0; i < ctx->message_array->len; i++) {
+            if (ctx->outputs[i])
+                qmi_message_wms_raw_read_output_unref (ctx->outputs[i]);
+        }
+        g_free (ctx->outputs);
+        ctx->outputs = NULL;
+    }
+    g_free (ctx->completed);
+    ctx->completed = NULL;
+}
+
 static void
 load_initial_sms_parts_context_complete_and_free (LoadInitialSmsPartsContext *ctx)
 {
     g_simple_async_result_complete (ctx->result);
     g_object_unref (ctx->result);
 
+    load_initial_sms_parts_context_clear_reads (ctx);
     if (ctx->message_array)
         g_array_unref (ctx->message_array);
 
@@ -7057,11 +7191,40 @@ add_new_read_sms_part (MMIfaceModemMessaging *self,
     }
 }
 
+static void
+take_raw_read_output (LoadInitialSmsPartsContext *ctx,
+                      guint i,
+                      QmiMessageWmsRawReadOutput *output)
+{
+    QmiWmsMessageTagType tag;
+    QmiWmsMessageFormat format;
+    GArray *data;
+    QmiMessageWmsListMessagesOutputMessageListElement *message;
+
+    message = &g_array_index (ctx->message_array,
+                              QmiMessageWmsListMessagesOutputMessageListElement,
+                              i);
+
+    qmi_message_wms_raw_read_output_get_raw_message_data (
+        output,
+        &tag,
+        &format,
+        &data,
+        NULL);
+    add_new_read_sms_part (MM_IFACE_MODEM_MESSAGING (ctx->self),
+                           mm_sms_storage_to_qmi_storage_type (ctx->storage),
+                           message->memory_index,
+                           tag,
+                           format,
+                           data);
+}
+
 static void
 wms_raw_read_ready (QmiClientWms *client,
                     GAsyncResult *res,
-                    LoadInitialSmsPartsContext *ctx)
+                    RawReadRequest *request)
 {
+    LoadInitialSmsPartsContext *ctx = request->ctx;
     QmiMessageWmsRawReadOutput *output = NULL;
     GError *error = NULL;
 
@@ -7074,35 +7237,28 @@ wms_raw_read_ready (QmiClientWms *client,
     } else if (!qmi_message_wms_raw_read_output_get_result (output, &error)) {
         mm_dbg ("Couldn't read raw message: %s", error->message);
         g_error_free (error);
-    } else {
-        QmiWmsMessageTagType tag;
-        QmiWmsMessageFormat format;
-        GArray *data;
-        QmiMessageWmsListMessagesOutputMessageListElement *message;
-
-        message = &g_array_index (ctx->message_array,
-                                  QmiMessageWmsListMessagesOutputMessageListElement,
-                                  ctx->i);
-
-        qmi_message_wms_raw_read_output_get_raw_message_data (
-            output,
-            &tag,
-            &format,
-            &data,
-            NULL);
-        add_new_read_sms_part (MM_IFACE_MODEM_MESSAGING (ctx->self),
-                               mm_sms_storage_to_qmi_storage_type (ctx->storage),
-                               message->memory_index,
-                               tag,
-                               format,
-                               data);
-    }
-
-    if (output)
         qmi_message_wms_raw_read_output_unref (output);
+        output = NULL;
+    }
+
+    ctx->outputs[request->i] = output;
+    ctx->completed[request->i] = TRUE;
+    ctx->n_pending--;
+    g_slice_free (RawReadRequest, request);
+
+    /* Replies may come in any order, but parts are taken in the same order
+     * as they were listed */
+    while (ctx->next_take < ctx->message_array->len &&
+           ctx->completed[ctx->next_take]) {
+        if (ctx->outputs[ctx->next_take]) {
+            take_raw_read_output (ctx, ctx->next_take, ctx->outputs[ctx->next_take]);
+            qmi_message_wms_raw_read_output_unref (ctx->outputs[ctx->next_take]);
+            ctx->outputs[ctx->next_take] = NULL;
+        }
+        ctx->next_take++;
+    }
 
     /* Keep on reading parts */
-    ctx->i++;
     read_next_sms_part (ctx);
 }
 
@@ -7111,11 +7267,8 @@ static void load_initial_sms_parts_step (LoadInitialSmsPartsContext *ctx);
 static void
 read_next_sms_part (LoadInitialSmsPartsContext *ctx)
 {
-    QmiMessageWmsListMessagesOutputMessageListElement *message;
-    QmiMessageWmsRawReadInput *input;
-
-    if (ctx->i >= ctx->message_array->len ||
-        !ctx->message_array) {
+    if (!ctx->message_array ||
+        ctx->next_take >= ctx->message_array->len) {
         /* If we just listed all SMS, we're done. Otherwise go to next tag. */
         if (ctx->step == LOAD_INITIAL_SMS_PARTS_STEP_3GPP_LIST_ALL)
             ctx->step = LOAD_INITIAL_SMS_PARTS_STEP_3GPP_LAST;
@@ -7127,38 +7280,51 @@ read_next_sms_part (LoadInitialSmsPartsContext *ctx)
         return;
     }
 
-    message = &g_array_index (ctx->message_array,
-                              QmiMessageWmsListMessagesOutputMessageListElement,
-                              ctx->i);
+    /* Keep a bounded window of reads in flight */
+    while (ctx->n_pending < WMS_RAW_READ_WINDOW &&
+           ctx->next_read < ctx->message_array->len) {
+        QmiMessageWmsListMessagesOutputMessageListElement *message;
+        QmiMessageWmsRawReadInput *input;
+        RawReadRequest *request;
 
-    input = qmi_message_wms_raw_read_input_new ();
-    qmi_message_wms_raw_read_input_set_message_memory_storage_id (
-        input,
-        mm_sms_storage_to_qmi_storage_type (ctx->storage),
-        message->memory_index,
-        NULL);
+        message = &g_array_index (ctx->message_array,
+                                  QmiMessageWmsListMessagesOutputMessageListElement,
+                                  ctx->next_read);
 
-    /* set message mode */
-    if (ctx->step < LOAD_INITIAL_SMS_PARTS_STEP_3GPP_LAST)
-        qmi_message_wms_raw_read_input_set_message_mode (
-            input,
-            QMI_WMS_MESSAGE_MODE_GSM_WCDMA,
-            NULL);
-    else if (ctx->step < LOAD_INITIAL_SMS_PARTS_STEP_CDMA_LAST)
-        qmi_message_wms_raw_read_input_set_message_mode (
+        input = qmi_message_wms_raw_read_input_new ();
+        qmi_message_wms_raw_read_input_set_message_memory_storage_id (
             input,
-            QMI_WMS_MESSAGE_MODE_CDMA,
+            mm_sms_storage_to_qmi_storage_type (ctx->storage),
+            message->memory_index,
             NULL);
-    else
-        g_assert_not_reached ();
 
-    qmi_client_wms_raw_read (QMI_CLIENT_WMS (ctx->client),
-                             input,
-                             3,
-                             NULL,
-                             (GAsyncReadyCallback)wms_raw_read_ready,
-                             ctx);
-    qmi_message_wms_raw_read_input_unref (input);
+        /* set message mode */
+        if (ctx->step < LOAD_INITIAL_SMS_PARTS_STEP_3GPP_LAST)
+            qmi_message_wms_raw_read_input_set_message_mode (
+                input,
+                QMI_WMS_MESSAGE_MODE_GSM_WCDMA,
+                NULL);
+        else if (ctx->step < LOAD_INITIAL_SMS_PARTS_STEP_CDMA_LAST)
+            qmi_message_wms_raw_read_input_set_message_mode (
+                input,
+                QMI_WMS_MESSAGE_MODE_CDMA,
+                NULL);
+        else
+            g_assert_not_reached ();
+
+        request = g_slice_new (RawReadRequest);
+        request->ctx = ctx;
+        request->i = ctx->next_read++;
+        ctx->n_pending++;
+
+        qmi_client_wms_raw_read (QMI_CLIENT_WMS (ctx->client),
+                                 input,
+                                 3,
+                                 NULL,
+                                 (GAsyncReadyCallback)wms_raw_read_ready,
+                                 request);
+        qmi_message_wms_raw_read_input_unref (input);
+    }
 }
 
 static void
@@ -7193,6 +7359,7 @@ wms_list_messages_ready (QmiClientWms *client,
         NULL);
 
     /* Keep a reference to the array ourselves */
+    load_initial_sms_parts_context_clear_reads (ctx);
     if (ctx->message_array)
         g_array_unref (ctx->message_array);
     ctx->message_array = g_array_ref (message_array);
@@ -7200,7 +7367,11 @@ wms_list_messages_ready (QmiClientWms *client,
     qmi_message_wms_list_messages_output_unref (output);
 
     /* Start reading parts */
-    ctx->i = 0;
+    ctx->outputs = g_new0 (QmiMessageWmsRawReadOutput *, ctx->message_array->len);
+    ctx->completed = g_new0 (gboolean, ctx->message_array->len);
+    ctx->next_read = 0;
+    ctx->next_take = 0;
+    ctx->n_pending = 0;
     read_next_sms_part (ctx);
 }
 
@@ -45,6 +45,7 @@
 #include "mm-sms-part-3gpp.h"
 #include "mm-base-sim.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
 #include "mm-port-serial-qcdm.h"
@@ -92,6 +93,7 @@ enum {
     PROP_MODEM_SIM,
     PROP_MODEM_BEARER_LIST,
     PROP_MODEM_STATE,
+    PROP_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED,
     PROP_MODEM_3GPP_REGISTRATION_STATE,
     PROP_MODEM_3GPP_CS_NETWORK_SUPPORTED,
     PROP_MODEM_3GPP_PS_NETWORK_SUPPORTED,
@@ -125,6 +127,7 @@ struct _MMBroadbandModemPrivate {
     MMBaseSim *modem_sim;
     MMBearerList *modem_bearer_list;
     MMModemState modem_state;
+    gboolean modem_periodic_signal_check_disabled;
     /* Implementation helpers */
     MMModemCharset modem_current_charset;
     gboolean modem_cind_support_checked;
@@ -3673,7 +3676,7 @@ modem_3gpp_scan_networks_finish (MMIfaceModem3gpp *self,
 {
     const gchar *result;
 
-    result = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, error);
+    result = mm_base_modem_at_command_full_finish (MM_BASE_MODEM (self), res, error);
     if (!result)
         return NULL;
 
@@ -3685,12 +3688,23 @@ modem_3gpp_scan_networks (MMIfaceModem3gpp *self,
                           GAsyncReadyCallback callback,
                           gpointer user_data)
 {
-    mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              "+COPS=?",
-                              120,
-                              FALSE,
-                              callback,
-                              user_data);
+    MMPortSerialAt *port;
+
+    /* A network scan may take minutes; run it in the secondary port if
+     * available so that the primary one is not blocked in the meantime. */
+    port = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
+    if (!port || !mm_port_serial_is_open (MM_PORT_SERIAL (port)))
+        port = mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL);
+
+    mm_base_modem_at_command_full (MM_BASE_MODEM (self),
+                                   port,
+                                   "+COPS=?",
+                                   120,
+                                   FALSE,
+                                   FALSE, /* raw */
+                                   NULL, /* cancellable */
+                                   callback,
+                                   user_data);
 }
 
 /*****************************************************************************/
@@ -5602,9 +5616,10 @@ sms_part_ready (MMBroadbandModem *self,
                 GAsyncResult *res,
                 SmsPartContext *ctx)
 {
-    MMSmsPart *part;
+    MMSmsPart *part = NULL;
     gint rv, status, tpdu_len;
     gchar pdu[MM_SMS_PART_3GPP_MAX_PDU_LEN + 1];
+    gsize pdu_len;
     const gchar *response;
     GError *error = NULL;
 
@@ -5634,7 +5649,14 @@ sms_part_ready (MMBroadbandModem *self,
         return;
     }
 
-    part = mm_sms_part_3gpp_new_from_pdu (ctx->idx, pdu, &error);
+    /* The PDU is already in our own buffer, decode it right there */
+    if (!mm_utils_hexstr2bin_inplace (pdu, &pdu_len))
+        error = g_error_new_literal (MM_CORE_ERROR,
+                                     MM_CORE_ERROR_FAILED,
+                                     "Couldn't convert 3GPP PDU from hex to binary");
+    else
+        part = mm_sms_part_3gpp_new_from_binary_pdu (ctx->idx, (const guint8 *) pdu, pdu_len, &error);
+
     if (part) {
         mm_dbg ("Correctly parsed PDU (%d)", ctx->idx);
         mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
@@ -5904,6 +5926,11 @@ typedef struct {
     MMBroadbandModem *self;
     GSimpleAsyncResult *result;
     MMSmsStorage list_storage;
+    /* Streamed PDU mode listing */
+    gboolean expecting_pdu;
+    gint pdu_index;
+    gint pdu_status;
+    guint n_parts;
 } ListPartsContext;
 
 static void
@@ -6081,52 +6108,66 @@ sms_state_from_index (guint index)
     }
 }
 
+static void
+sms_pdu_part_list_line (MMBaseModem *self,
+                        const gchar *line,
+                        ListPartsContext *ctx)
+{
+    gchar *pdu;
+    MMSmsPart *part;
+    GError *error = NULL;
+
+    /* Each part comes in two lines: the +CMGL header with index and status,
+     * and then the PDU itself, so that we can parse and take each part as
+     * soon as it is received, without waiting for the whole listing. */
+    if (mm_3gpp_parse_pdu_cmgl_header (line, &ctx->pdu_index, &ctx->pdu_status)) {
+        ctx->expecting_pdu = TRUE;
+        return;
+    }
+
+    if (!ctx->expecting_pdu) {
+        mm_dbg ("Ignoring unexpected line in +CMGL response: '%s'", line);
+        return;
+    }
+    ctx->expecting_pdu = FALSE;
+
+    pdu = mm_strip_quotes (g_strstrip (g_strdup (line)));
+    part = mm_sms_part_3gpp_new_from_pdu (ctx->pdu_index, pdu, &error);
+    if (part) {
+        mm_dbg ("Correctly parsed PDU (%d)", ctx->pdu_index);
+        mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
+                                            part,
+                                            sms_state_from_index (ctx->pdu_status),
+                                            ctx->list_storage);
+        ctx->n_parts++;
+    } else {
+        /* Don't treat the error as critical */
+        mm_dbg ("Error parsing PDU (%d): %s", ctx->pdu_index, error->message);
+        g_error_free (error);
+    }
+    g_free (pdu);
+}
+
 static void
 sms_pdu_part_list_ready (MMBroadbandModem *self,
                          GAsyncResult *res,
                          ListPartsContext *ctx)
 {
-    const gchar *response;
     GError *error = NULL;
-    GList *info_list;
-    GList *l;
 
     /* Always always always unlock mem1 storage. Warned you've been. */
     mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
 
-    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
-    if (error) {
-        g_simple_async_result_take_error (ctx->result, error);
-        list_parts_context_complete_and_free (ctx);
-        return;
-    }
-
-    info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
-    if (error) {
+    /* Parts were already taken as they were received */
+    if (!mm_base_modem_at_command_full_finish (MM_BASE_MODEM (self), res, &error)) {
         g_simple_async_result_take_error (ctx->result, error);
         list_parts_context_complete_and_free (ctx);
         return;
     }
 
-    for (l = info_list; l; l = g_list_next (l)) {
-        MM3gppPduInfo *info = l->data;
-        MMSmsPart *part;
-
-        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, &error);
-        if (part) {
-            mm_dbg ("Correctly parsed PDU (%d)", info->index);
-            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
-                                                part,
-                                                sms_state_from_index (info->status),
-                                                ctx->list_storage);
-        } else {
-            /* Don't treat the error as critical */
-            mm_dbg ("Error parsing PDU (%d): %s", info->index, error->message);
-            g_clear_error (&error);
-        }
-    }
-
-    mm_3gpp_pdu_info_list_free (info_list);
+    mm_dbg ("Listed %u SMS parts in storage '%s'",
+            ctx->n_parts,
+            mm_sms_storage_get_string (ctx->list_storage));
 
     /* We consider all done */
     g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -6151,16 +6192,26 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
     /* Storage now set and locked */
 
     /* Get SMS parts from ALL types.
-     * Different command to be used if we are on Text or PDU mode */
+     * Different command to be used if we are on Text or PDU mode. In PDU
+     * mode, parts are processed as the listing is received. */
+    if (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode) {
+        mm_base_modem_at_command_streamed (MM_BASE_MODEM (self),
+                                           NULL, /* best port */
+                                           "+CMGL=4",
+                                           20,
+                                           (MMBaseModemAtResponseLineFn)sms_pdu_part_list_line,
+                                           ctx,
+                                           NULL, /* cancellable */
+                                           (GAsyncReadyCallback)sms_pdu_part_list_ready,
+                                           ctx);
+        return;
+    }
+
     mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                               "+CMGL=4" :
-                               "+CMGL=\"ALL\""),
+                              "+CMGL=\"ALL\"",
                               20,
                               FALSE,
-                              (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                                                     sms_pdu_part_list_ready :
-                                                     sms_text_part_list_ready),
+                              (GAsyncReadyCallback)sms_text_part_list_ready,
                               ctx);
 }
 
@@ -7264,11 +7315,21 @@ typedef struct {
     GCancellable *cancellable;
     GTimer *timer;
     guint max_registration_time;
+    guint recheck_id;
+    gulong cdma1x_registration_state_changed_id;
+    gulong evdo_registration_state_changed_id;
 } RegisterInCdmaNetworkContext;
 
 static void
 register_in_cdma_network_context_complete_and_free (RegisterInCdmaNetworkContext *ctx)
 {
+    if (ctx->recheck_id)
+        g_source_remove (ctx->recheck_id);
+    if (ctx->cdma1x_registration_state_changed_id)
+        g_signal_handler_disconnect (ctx->self, ctx->cdma1x_registration_state_changed_id);
+    if (ctx->evdo_registration_state_changed_id)
+        g_signal_handler_disconnect (ctx->self, ctx->evdo_registration_state_changed_id);
+
     /* If our cancellable reference is still around, clear it */
     if (ctx->self->priv->modem_cdma_pending_registration_cancellable ==
         ctx->cancellable) {
@@ -7278,7 +7339,8 @@ register_in_cdma_network_context_complete_and_free (RegisterInCdmaNetworkContext
     if (ctx->timer)
         g_timer_destroy (ctx->timer);
 
-    g_simple_async_result_complete (ctx->result);
+    /* May be completed while the registration state is being updated */
+    g_simple_async_result_complete_in_idle (ctx->result);
     g_object_unref (ctx->result);
     g_object_unref (ctx->cancellable);
     g_object_unref (ctx->self);
@@ -7303,6 +7365,10 @@ modem_cdma_register_in_network_finish (MMIfaceModemCdma *self,
      state == MM_MODEM_CDMA_REGISTRATION_STATE_ROAMING ||   \
      state == MM_MODEM_CDMA_REGISTRATION_STATE_REGISTERED)
 
+/* Registration state updates are processed as soon as they're received;
+ * polling is just a safety net */
+#define CDMA_REGISTRATION_RECHECK_TIMEOUT_SECS 10
+
 static void run_cdma_registration_checks_ready (MMBroadbandModem *self,
                                                 GAsyncResult *res,
                                                 RegisterInCdmaNetworkContext *ctx);
@@ -7310,6 +7376,8 @@ static void run_cdma_registration_checks_ready (MMBroadbandModem *self,
 static gboolean
 run_cdma_registration_checks_again (RegisterInCdmaNetworkContext *ctx)
 {
+    ctx->recheck_id = 0;
+
     /* Get fresh registration state */
     mm_iface_modem_cdma_run_registration_checks (
         MM_IFACE_MODEM_CDMA (ctx->self),
@@ -7318,17 +7386,34 @@ run_cdma_registration_checks_again (RegisterInCdmaNetworkContext *ctx)
     return FALSE;
 }
 
+static void cdma_registration_state_changed (RegisterInCdmaNetworkContext *ctx);
+
 static void
-run_cdma_registration_checks_ready (MMBroadbandModem *self,
-                                    GAsyncResult *res,
-                                    RegisterInCdmaNetworkContext *ctx)
+register_in_cdma_network_context_check_state (RegisterInCdmaNetworkContext *ctx,
+                                              const gchar *source)
 {
-    GError *error = NULL;
+    MMBroadbandModem *self = ctx->self;
+    gdouble elapsed;
 
-    mm_iface_modem_cdma_run_registration_checks_finish (MM_IFACE_MODEM_CDMA (self), res, &error);
+    elapsed = g_timer_elapsed (ctx->timer, NULL);
 
-    if (error) {
-        mm_dbg ("CDMA registration check failed: '%s'", error->message);
+    /* If we got registered in at least one CDMA network, end registration checks */
+    if (REG_IS_DONE (self->priv->modem_cdma_cdma1x_registration_state) ||
+        REG_IS_DONE (self->priv->modem_cdma_evdo_registration_state)) {
+        mm_dbg ("Modem is currently registered in a CDMA network "
+                "(CDMA1x: '%s', EV-DO: '%s') (%s, after %.3lfs)",
+                REG_IS_DONE (self->priv->modem_cdma_cdma1x_registration_state) ? "yes" : "no",
+                REG_IS_DONE (self->priv->modem_cdma_evdo_registration_state) ? "yes" : "no",
+                source,
+                elapsed);
+        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
+        register_in_cdma_network_context_complete_and_free (ctx);
+        return;
+    }
+
+    /* Don't spend too much time waiting to get registered */
+    if (elapsed > ctx->max_registration_time) {
+        mm_dbg ("CDMA registration check timed out");
         mm_iface_modem_cdma_update_cdma1x_registration_state (
             MM_IFACE_MODEM_CDMA (self),
             MM_MODEM_CDMA_REGISTRATION_STATE_UNKNOWN,
@@ -7340,27 +7425,62 @@ run_cdma_registration_checks_ready (MMBroadbandModem *self,
         mm_iface_modem_cdma_update_access_technologies (
             MM_IFACE_MODEM_CDMA (self),
             MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN);
-
-        g_simple_async_result_take_error (ctx->result, error);
+        g_simple_async_result_take_error (
+            ctx->result,
+            mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_NETWORK_TIMEOUT));
         register_in_cdma_network_context_complete_and_free (ctx);
         return;
     }
 
-    /* If we got registered in at least one CDMA network, end registration checks */
-    if (REG_IS_DONE (self->priv->modem_cdma_cdma1x_registration_state) ||
-        REG_IS_DONE (self->priv->modem_cdma_evdo_registration_state)) {
-        mm_dbg ("Modem is currently registered in a CDMA network "
-                "(CDMA1x: '%s', EV-DO: '%s')",
-                REG_IS_DONE (self->priv->modem_cdma_cdma1x_registration_state) ? "yes" : "no",
-                REG_IS_DONE (self->priv->modem_cdma_evdo_registration_state) ? "yes" : "no");
-        g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
-        register_in_cdma_network_context_complete_and_free (ctx);
+    /* Wait for the registration state to change, and check again later on
+     * anyway; right when the maximum registration time is over at the latest. */
+    mm_dbg ("Modem not yet registered in a CDMA network... will recheck soon");
+    if (!ctx->cdma1x_registration_state_changed_id)
+        ctx->cdma1x_registration_state_changed_id =
+            g_signal_connect_swapped (self,
+                                      "notify::" MM_IFACE_MODEM_CDMA_CDMA1X_REGISTRATION_STATE,
+                                      G_CALLBACK (cdma_registration_state_changed),
+                                      ctx);
+    if (!ctx->evdo_registration_state_changed_id)
+        ctx->evdo_registration_state_changed_id =
+            g_signal_connect_swapped (self,
+                                      "notify::" MM_IFACE_MODEM_CDMA_EVDO_REGISTRATION_STATE,
+                                      G_CALLBACK (cdma_registration_state_changed),
+                                      ctx);
+    if (!ctx->recheck_id)
+        ctx->recheck_id = g_timeout_add_seconds (MIN (CDMA_REGISTRATION_RECHECK_TIMEOUT_SECS,
+                                                      ctx->max_registration_time - (guint)elapsed + 1),
+                                                 (GSourceFunc)run_cdma_registration_checks_again,
+                                                 ctx);
+}
+
+static void
+cdma_registration_state_changed (RegisterInCdmaNetworkContext *ctx)
+{
+    /* If a registration check is running, its result will be processed */
+    if (!ctx->recheck_id)
         return;
-    }
 
-    /* Don't spend too much time waiting to get registered */
-    if (g_timer_elapsed (ctx->timer, NULL) > ctx->max_registration_time) {
-        mm_dbg ("CDMA registration check timed out");
+    if (!REG_IS_DONE (ctx->self->priv->modem_cdma_cdma1x_registration_state) &&
+        !REG_IS_DONE (ctx->self->priv->modem_cdma_evdo_registration_state))
+        return;
+
+    g_source_remove (ctx->recheck_id);
+    ctx->recheck_id = 0;
+    register_in_cdma_network_context_check_state (ctx, "state update");
+}
+
+static void
+run_cdma_registration_checks_ready (MMBroadbandModem *self,
+                                    GAsyncResult *res,
+                                    RegisterInCdmaNetworkContext *ctx)
+{
+    GError *error = NULL;
+
+    mm_iface_modem_cdma_run_registration_checks_finish (MM_IFACE_MODEM_CDMA (self), res, &error);
+
+    if (error) {
+        mm_dbg ("CDMA registration check failed: '%s'", error->message);
         mm_iface_modem_cdma_update_cdma1x_registration_state (
             MM_IFACE_MODEM_CDMA (self),
             MM_MODEM_CDMA_REGISTRATION_STATE_UNKNOWN,
@@ -7372,18 +7492,13 @@ run_cdma_registration_checks_ready (MMBroadbandModem *self,
         mm_iface_modem_cdma_update_access_technologies (
             MM_IFACE_MODEM_CDMA (self),
             MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN);
-        g_simple_async_result_take_error (
-            ctx->result,
-            mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_NETWORK_TIMEOUT));
+
+        g_simple_async_result_take_error (ctx->result, error);
         register_in_cdma_network_context_complete_and_free (ctx);
         return;
     }
 
-    /* Check again in a few seconds. */
-    mm_dbg ("Modem not yet registered in a CDMA network... will recheck soon");
-    g_timeout_add_seconds (3,
-                           (GSourceFunc)run_cdma_registration_checks_again,
-                           ctx);
+    register_in_cdma_network_context_check_state (ctx, "registration check");
 }
 
 static void
@@ -7510,6 +7625,70 @@ enable_location_gathering (MMIfaceModemLocation *self,
     g_object_unref (result);
 }
 
+/*****************************************************************************/
+/* Check extended signal support (Signal interface) */
+
+static gboolean
+modem_signal_check_support_finish (MMIfaceModemSignal *self,
+                                   GAsyncResult *res,
+                                   GError **error)
+{
+    return !!mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, error);
+}
+
+static void
+modem_signal_check_support (MMIfaceModemSignal *self,
+                            GAsyncReadyCallback callback,
+                            gpointer user_data)
+{
+    /* Extended signal quality reports are 3GPP only */
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CESQ=?",
+                              3,
+                              TRUE,
+                              callback,
+                              user_data);
+}
+
+/*****************************************************************************/
+/* Load extended signal information (Signal interface) */
+
+static gboolean
+modem_signal_load_values_finish (MMIfaceModemSignal *self,
+                                 GAsyncResult *res,
+                                 MMSignal **cdma,
+                                 MMSignal **evdo,
+                                 MMSignal **gsm,
+                                 MMSignal **umts,
+                                 MMSignal **lte,
+                                 GError **error)
+{
+    const gchar *response;
+
+    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, error);
+    if (!response ||
+        !mm_3gpp_cesq_response_to_signal_info (response, gsm, umts, lte, error))
+        return FALSE;
+
+    *cdma = NULL;
+    *evdo = NULL;
+    return TRUE;
+}
+
+static void
+modem_signal_load_values (MMIfaceModemSignal *self,
+                          GCancellable *cancellable,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+    mm_base_modem_at_command (MM_BASE_MODEM (self),
+                              "+CESQ",
+                              5,
+                              FALSE,
+                              callback,
+                              user_data);
+}
+
 /*****************************************************************************/
 
 static const gchar *primary_init_sequence[] = {
@@ -8210,6 +8389,12 @@ disabling_step (DisablingContext *ctx)
     if (disabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "broadband-modem-disabling",
+                   ctx,
+                   ctx->step,
+                   ctx->step == DISABLING_STEP_LAST);
+
     switch (ctx->step) {
     case DISABLING_STEP_FIRST:
         /* Fall down to next step */
@@ -8555,6 +8740,12 @@ enabling_step (EnablingContext *ctx)
     if (enabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "broadband-modem-enabling",
+                   ctx,
+                   ctx->step,
+                   ctx->step == ENABLING_STEP_LAST);
+
     switch (ctx->step) {
     case ENABLING_STEP_FIRST:
         /* Fall down to next step */
@@ -9011,6 +9202,12 @@ initialize_step (InitializeContext *ctx)
     if (initialize_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "broadband-modem-initialization",
+                   ctx,
+                   ctx->step,
+                   ctx->step == INITIALIZE_STEP_LAST);
+
     switch (ctx->step) {
     case INITIALIZE_STEP_FIRST:
         /* Fall down to next step */
@@ -9400,6 +9597,9 @@ set_property (GObject *object,
     case PROP_MODEM_STATE:
         self->priv->modem_state = g_value_get_enum (value);
         break;
+    case PROP_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED:
+        self->priv->modem_periodic_signal_check_disabled = g_value_get_boolean (value);
+        break;
     case PROP_MODEM_3GPP_REGISTRATION_STATE:
         self->priv->modem_3gpp_registration_state = g_value_get_enum (value);
         break;
@@ -9498,6 +9698,9 @@ get_property (GObject *object,
     case PROP_MODEM_STATE:
         g_value_set_enum (value, self->priv->modem_state);
         break;
+    case PROP_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED:
+        g_value_set_boolean (value, self->priv->modem_periodic_signal_check_disabled);
+        break;
     case PROP_MODEM_3GPP_REGISTRATION_STATE:
         g_value_set_enum (value, self->priv->modem_3gpp_registration_state);
         break;
@@ -9829,6 +10032,10 @@ iface_modem_time_init (MMIfaceModemTime *iface)
 static void
 iface_modem_signal_init (MMIfaceModemSignal *iface)
 {
+    iface->check_support = modem_signal_check_support;
+    iface->check_support_finish = modem_signal_check_support_finish;
+    iface->load_values = modem_signal_load_values;
+    iface->load_values_finish = modem_signal_load_values_finish;
 }
 
 static void
@@ -9928,6 +10135,10 @@ mm_broadband_modem_class_init (MMBroadbandModemClass *klass)
                                       PROP_MODEM_STATE,
                                       MM_IFACE_MODEM_STATE);
 
+    g_object_class_override_property (object_class,
+                                      PROP_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED,
+                                      MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED);
+
     g_object_class_override_property (object_class,
                                       PROP_MODEM_3GPP_REGISTRATION_STATE,
                                       MM_IFACE_MODEM_3GPP_REGISTRATION_STATE);
@@ -28,21 +28,19 @@
 typedef struct {
     const char *gsm_name;
     const char *other_name;
-    const char *iconv_from_name;
-    const char *iconv_to_name;
     MMModemCharset charset;
 } CharsetEntry;
 
 static CharsetEntry charset_map[] = {
-    { "UTF-8",   "UTF8",   "UTF-8",     "UTF-8//TRANSLIT",     MM_MODEM_CHARSET_UTF8 },
-    { "UCS2",    NULL,     "UCS-2BE",   "UCS-2BE//TRANSLIT",   MM_MODEM_CHARSET_UCS2 },
-    { "IRA",     "ASCII",  "ASCII",     "ASCII//TRANSLIT",     MM_MODEM_CHARSET_IRA },
-    { "GSM",     NULL,     NULL,        NULL,                  MM_MODEM_CHARSET_GSM },
-    { "8859-1",  NULL,     "ISO8859-1", "ISO8859-1//TRANSLIT", MM_MODEM_CHARSET_8859_1 },
-    { "PCCP437", "CP437",  "CP437",     "CP437//TRANSLIT",     MM_MODEM_CHARSET_PCCP437 },
-    { "PCDN",    "CP850",  "CP850",     "CP850//TRANSLIT",     MM_MODEM_CHARSET_PCDN },
-    { "HEX",     NULL,     NULL,        NULL,                  MM_MODEM_CHARSET_HEX },
-    { NULL,      NULL,     NULL,        NULL,                  MM_MODEM_CHARSET_UNKNOWN }
+    { "UTF-8",   "UTF8",   MM_MODEM_CHARSET_UTF8 },
+    { "UCS2",    NULL,     MM_MODEM_CHARSET_UCS2 },
+    { "IRA",     "ASCII",  MM_MODEM_CHARSET_IRA },
+    { "GSM",     NULL,     MM_MODEM_CHARSET_GSM },
+    { "8859-1",  NULL,     MM_MODEM_CHARSET_8859_1 },
+    { "PCCP437", "CP437",  MM_MODEM_CHARSET_PCCP437 },
+    { "PCDN",    "CP850",  MM_MODEM_CHARSET_PCDN },
+    { "HEX",     NULL,     MM_MODEM_CHARSET_HEX },
+    { NULL,      NULL,     MM_MODEM_CHARSET_UNKNOWN }
 };
 
 const char *
@@ -78,354 +76,587 @@ mm_modem_charset_from_string (const char *string)
     return MM_MODEM_CHARSET_UNKNOWN;
 }
 
-static const char *
-charset_iconv_to (MMModemCharset charset)
+/*****************************************************************************/
+/* Single-byte charset tables
+ *
+ * Each single-byte charset is described by a forward table giving the Unicode
+ * code point of each of its 128 non-ASCII (or, for GSM, all) codes. The
+ * reverse lookup (Unicode to code) is built once from the forward table: a
+ * direct-indexed table for U+0000..U+00FF and a sorted array, searched with
+ * bsearch(), for everything above.
+ */
+
+#define GSM_DEF_ALPHABET_SIZE 128
+#define GSM_ESCAPE_CHAR       0x1b
+
+/**
+ * gsm_def_alphabet:
+ *
+ * Mapping from GSM default alphabet to Unicode. The escape code is left
+ * unmapped, as it's only valid as prefix of a character in the extension table.
+ *
+ * ETSI GSM 03.38, version 6.0.1, section 6.2.1; Default alphabet. Mapping to UCS-2.
+ * Mapping according to http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
+ */
+static const gunichar gsm_def_alphabet[GSM_DEF_ALPHABET_SIZE] = {
+    /* @         £         $         ¥ */
+    0x0040, 0x00a3, 0x0024, 0x00a5,
+    /* è         é         ù         ì */
+    0x00e8, 0x00e9, 0x00f9, 0x00ec,
+    /* ò         Ç         \n        Ø */
+    0x00f2, 0x00c7, 0x000a, 0x00d8,
+    /* ø         \r        Å         å */
+    0x00f8, 0x000d, 0x00c5, 0x00e5,
+    /* Δ         _         Φ         Γ */
+    0x0394, 0x005f, 0x03a6, 0x0393,
+    /* Λ         Ω         Π         Ψ */
+    0x039b, 0x03a9, 0x03a0, 0x03a8,
+    /* Σ         Θ         Ξ         Escape */
+    0x03a3, 0x0398, 0x039e, 0x0000,
+    /* Æ         æ         ß         É */
+    0x00c6, 0x00e6, 0x00df, 0x00c9,
+    /* ' '       !         "         # */
+    0x0020, 0x0021, 0x0022, 0x0023,
+    /* ¤         %         &         ' */
+    0x00a4, 0x0025, 0x0026, 0x0027,
+    /* (         )         *         + */
+    0x0028, 0x0029, 0x002a, 0x002b,
+    /* ,         -         .         / */
+    0x002c, 0x002d, 0x002e, 0x002f,
+    /* 0         1         2         3 */
+    0x0030, 0x0031, 0x0032, 0x0033,
+    /* 4         5         6         7 */
+    0x0034, 0x0035, 0x0036, 0x0037,
+    /* 8         9         :         ; */
+    0x0038, 0x0039, 0x003a, 0x003b,
+    /* <         =         >         ? */
+    0x003c, 0x003d, 0x003e, 0x003f,
+    /* ¡         A         B         C */
+    0x00a1, 0x0041, 0x0042, 0x0043,
+    /* D         E         F         G */
+    0x0044, 0x0045, 0x0046, 0x0047,
+    /* H         I         J         K */
+    0x0048, 0x0049, 0x004a, 0x004b,
+    /* L         M         N         O */
+    0x004c, 0x004d, 0x004e, 0x004f,
+    /* P         Q         R         S */
+    0x0050, 0x0051, 0x0052, 0x0053,
+    /* T         U         V         W */
+    0x0054, 0x0055, 0x0056, 0x0057,
+    /* X         Y         Z         Ä */
+    0x0058, 0x0059, 0x005a, 0x00c4,
+    /* Ö         Ñ         Ü         § */
+    0x00d6, 0x00d1, 0x00dc, 0x00a7,
+    /* ¿         a         b         c */
+    0x00bf, 0x0061, 0x0062, 0x0063,
+    /* d         e         f         g */
+    0x0064, 0x0065, 0x0066, 0x0067,
+    /* h         i         j         k */
+    0x0068, 0x0069, 0x006a, 0x006b,
+    /* l         m         n         o */
+    0x006c, 0x006d, 0x006e, 0x006f,
+    /* p         q         r         s */
+    0x0070, 0x0071, 0x0072, 0x0073,
+    /* t         u         v         w */
+    0x0074, 0x0075, 0x0076, 0x0077,
+    /* x         y         z         ä */
+    0x0078, 0x0079, 0x007a, 0x00e4,
+    /* ö         ñ         ü         à */
+    0x00f6, 0x00f1, 0x00fc, 0x00e0
+};
+
+/**
+ * gsm_ext_alphabet:
+ *
+ * Mapping from GSM extension table to Unicode, indexed by the code following
+ * the escape code.
+ */
+static const gunichar gsm_ext_alphabet[GSM_DEF_ALPHABET_SIZE] = {
+    [0x0a] = 0x000c, /* form feed */
+    [0x14] = 0x005e, /* ^ */
+    [0x28] = 0x007b, /* { */
+    [0x29] = 0x007d, /* } */
+    [0x2f] = 0x005c, /* \ */
+    [0x3c] = 0x005b, /* [ */
+    [0x3d] = 0x007e, /* ~ */
+    [0x3e] = 0x005d, /* ] */
+    [0x40] = 0x007c, /* | */
+    [0x65] = 0x20ac, /* € */
+};
+
+/* Codes 0x80 to 0xFF of code page 437 */
+static const gunichar pccp437_alphabet[128] = {
+    0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7, 0x00ea,
+    0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5, 0x00c9, 0x00e6,
+    0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9, 0x00ff, 0x00d6, 0x00dc,
+    0x00a2, 0x00a3, 0x00a5, 0x20a7, 0x0192, 0x00e1, 0x00ed, 0x00f3, 0x00fa,
+    0x00f1, 0x00d1, 0x00aa, 0x00ba, 0x00bf, 0x2310, 0x00ac, 0x00bd, 0x00bc,
+    0x00a1, 0x00ab, 0x00bb, 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561,
+    0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255d, 0x255c, 0x255b,
+    0x2510, 0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x255e, 0x255f,
+    0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x2567, 0x2568,
+    0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256b, 0x256a, 0x2518,
+    0x250c, 0x2588, 0x2584, 0x258c, 0x2590, 0x2580, 0x03b1, 0x00df, 0x0393,
+    0x03c0, 0x03a3, 0x03c3, 0x00b5, 0x03c4, 0x03a6, 0x0398, 0x03a9, 0x03b4,
+    0x221e, 0x03c6, 0x03b5, 0x2229, 0x2261, 0x00b1, 0x2265, 0x2264, 0x2320,
+    0x2321, 0x00f7, 0x2248, 0x00b0, 0x2219, 0x00b7, 0x221a, 0x207f, 0x00b2,
+    0x25a0, 0x00a0
+};
+
+/* Codes 0x80 to 0xFF of code page 850 */
+static const gunichar pcdn_alphabet[128] = {
+    0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7, 0x00ea,
+    0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5, 0x00c9, 0x00e6,
+    0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9, 0x00ff, 0x00d6, 0x00dc,
+    0x00f8, 0x00a3, 0x00d8, 0x00d7, 0x0192, 0x00e1, 0x00ed, 0x00f3, 0x00fa,
+    0x00f1, 0x00d1, 0x00aa, 0x00ba, 0x00bf, 0x00ae, 0x00ac, 0x00bd, 0x00bc,
+    0x00a1, 0x00ab, 0x00bb, 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x00c1,
+    0x00c2, 0x00c0, 0x00a9, 0x2563, 0x2551, 0x2557, 0x255d, 0x00a2, 0x00a5,
+    0x2510, 0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x00e3, 0x00c3,
+    0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x00a4, 0x00f0,
+    0x00d0, 0x00ca, 0x00cb, 0x00c8, 0x0131, 0x00cd, 0x00ce, 0x00cf, 0x2518,
+    0x250c, 0x2588, 0x2584, 0x00a6, 0x00cc, 0x2580, 0x00d3, 0x00df, 0x00d4,
+    0x00d2, 0x00f5, 0x00d5, 0x00b5, 0x00fe, 0x00de, 0x00da, 0x00db, 0x00d9,
+    0x00fd, 0x00dd, 0x00af, 0x00b4, 0x00ad, 0x00b1, 0x2017, 0x00be, 0x00b6,
+    0x00a7, 0x00f7, 0x00b8, 0x00b0, 0x00a8, 0x00b7, 0x00b9, 0x00b3, 0x00b2,
+    0x25a0, 0x00a0
+};
+
+typedef struct {
+    gunichar uc;
+    guint8   code;
+} ReverseEntry;
+
+typedef struct {
+    /* Unicode code point of each code starting at forward_start, 0 if unmapped;
+     * codes below forward_start are plain ASCII */
+    const gunichar *forward;
+    guint8          forward_start;
+    /* Built on first use */
+    gint16          reverse_low[256];
+    ReverseEntry   *reverse_high;
+    guint           n_reverse_high;
+} SingleByteCodec;
+
+static SingleByteCodec gsm_def_codec  = { gsm_def_alphabet,  0x00 };
+static SingleByteCodec gsm_ext_codec  = { gsm_ext_alphabet,  0x00 };
+static SingleByteCodec pccp437_codec  = { pccp437_alphabet,  0x80 };
+static SingleByteCodec pcdn_codec     = { pcdn_alphabet,     0x80 };
+
+static gint
+reverse_entry_cmp (gconstpointer a,
+                   gconstpointer b)
 {
-    CharsetEntry *iter = &charset_map[0];
+    const ReverseEntry *ea = a;
+    const ReverseEntry *eb = b;
 
-    g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
+    return (ea->uc > eb->uc) - (ea->uc < eb->uc);
+}
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->iconv_to_name;
-        iter++;
+static void
+single_byte_codec_build_reverse (SingleByteCodec *codec)
+{
+    GArray *high;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (codec->reverse_low); i++)
+        codec->reverse_low[i] = (i < codec->forward_start) ? (gint16) i : -1;
+
+    high = g_array_new (FALSE, FALSE, sizeof (ReverseEntry));
+    for (i = 0; i < 128; i++) {
+        ReverseEntry entry;
+
+        entry.uc = codec->forward[i];
+        entry.code = codec->forward_start + i;
+
+        if (!entry.uc)
+            continue;
+
+        if (entry.uc < G_N_ELEMENTS (codec->reverse_low)) {
+            /* First code wins if a code point is mapped more than once */
+            if (codec->reverse_low[entry.uc] < 0)
+                codec->reverse_low[entry.uc] = entry.code;
+        } else
+            g_array_append_val (high, entry);
     }
-    g_warn_if_reached ();
-    return NULL;
+    g_array_sort (high, reverse_entry_cmp);
+
+    codec->n_reverse_high = high->len;
+    codec->reverse_high = (ReverseEntry *) g_array_free (high, FALSE);
 }
 
-static const char *
-charset_iconv_from (MMModemCharset charset)
+static void
+single_byte_codecs_init (void)
 {
-    CharsetEntry *iter = &charset_map[0];
+    static gsize initialized = 0;
+
+    if (g_once_init_enter (&initialized)) {
+        single_byte_codec_build_reverse (&gsm_def_codec);
+        single_byte_codec_build_reverse (&gsm_ext_codec);
+        single_byte_codec_build_reverse (&pccp437_codec);
+        single_byte_codec_build_reverse (&pcdn_codec);
+        g_once_init_leave (&initialized, 1);
+    }
+}
 
-    g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
+static gboolean
+single_byte_codec_decode (const SingleByteCodec *codec,
+                          guint8 code,
+                          gunichar *out_uc)
+{
+    if (code < codec->forward_start) {
+        *out_uc = code;
+        return TRUE;
+    }
 
-    while (iter->gsm_name) {
-        if (iter->charset == charset)
-            return iter->iconv_from_name;
-        iter++;
+    if (code - codec->forward_start >= 128)
+        return FALSE;
+
+    *out_uc = codec->forward[code - codec->forward_start];
+    return (*out_uc != 0);
+}
+
+static gboolean
+single_byte_codec_encode (const SingleByteCodec *codec,
+                          gunichar uc,
+                          guint8 *out_code)
+{
+    ReverseEntry key;
+    const ReverseEntry *found;
+
+    single_byte_codecs_init ();
+
+    if (uc < G_N_ELEMENTS (codec->reverse_low)) {
+        if (codec->reverse_low[uc] < 0)
+            return FALSE;
+        *out_code = (guint8) codec->reverse_low[uc];
+        return TRUE;
     }
-    g_warn_if_reached ();
-    return NULL;
+
+    key.uc = uc;
+    found = bsearch (&key,
+                     codec->reverse_high,
+                     codec->n_reverse_high,
+                     sizeof (ReverseEntry),
+                     reverse_entry_cmp);
+    if (!found)
+        return FALSE;
+
+    *out_code = found->code;
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Codec engine */
+
+static const gchar hex_digits[] = "0123456789ABCDEF";
+
+/* Encodes a single character in the given charset; returns the number of
+ * bytes written to @out, or 0 if the character cannot be represented. */
+static guint
+charset_encode_unichar (MMModemCharset charset,
+                        gunichar uc,
+                        guint8 out[6])
+{
+    switch (charset) {
+    case MM_MODEM_CHARSET_UTF8:
+        return g_unichar_to_utf8 (uc, (gchar *) out);
+    case MM_MODEM_CHARSET_IRA:
+        if (uc > 0x7F)
+            return 0;
+        out[0] = (guint8) uc;
+        return 1;
+    case MM_MODEM_CHARSET_8859_1:
+        if (uc > 0xFF)
+            return 0;
+        out[0] = (guint8) uc;
+        return 1;
+    case MM_MODEM_CHARSET_UCS2:
+        if (uc > 0xFFFF || (uc >= 0xD800 && uc <= 0xDFFF))
+            return 0;
+        out[0] = (guint8) (uc >> 8);
+        out[1] = (guint8) (uc & 0xFF);
+        return 2;
+    case MM_MODEM_CHARSET_GSM:
+        if (single_byte_codec_encode (&gsm_def_codec, uc, &out[0]))
+            return 1;
+        if (single_byte_codec_encode (&gsm_ext_codec, uc, &out[1])) {
+            out[0] = GSM_ESCAPE_CHAR;
+            return 2;
+        }
+        return 0;
+    case MM_MODEM_CHARSET_PCCP437:
+        return single_byte_codec_encode (&pccp437_codec, uc, &out[0]) ? 1 : 0;
+    case MM_MODEM_CHARSET_PCDN:
+        return single_byte_codec_encode (&pcdn_codec, uc, &out[0]) ? 1 : 0;
+    case MM_MODEM_CHARSET_HEX:
+    case MM_MODEM_CHARSET_UNKNOWN:
+    default:
+        return 0;
+    }
+}
+
+/* Encodes the whole UTF-8 string, appending the result to @out either as
+ * raw bytes or directly in hex representation. If @translit is given,
+ * characters not representable in the charset are replaced by '?'. */
+static gboolean
+charset_encode_utf8 (MMModemCharset charset,
+                     const gchar *utf8,
+                     gboolean translit,
+                     gboolean hex,
+                     GByteArray *out)
+{
+    const gchar *p;
+
+    for (p = utf8; *p; p = g_utf8_next_char (p)) {
+        guint8 encoded[6];
+        gunichar uc;
+        guint n;
+        guint i;
+
+        uc = g_utf8_get_char_validated (p, -1);
+        if (uc == (gunichar) -1 || uc == (gunichar) -2)
+            return FALSE;
+
+        n = charset_encode_unichar (charset, uc, encoded);
+        if (!n && translit)
+            n = charset_encode_unichar (charset, '?', encoded);
+        if (!n)
+            return FALSE;
+
+        if (!hex) {
+            g_byte_array_append (out, encoded, n);
+            continue;
+        }
+
+        for (i = 0; i < n; i++) {
+            guint8 digits[2];
+
+            digits[0] = hex_digits[encoded[i] >> 4];
+            digits[1] = hex_digits[encoded[i] & 0x0F];
+            g_byte_array_append (out, digits, 2);
+        }
+    }
+
+    return TRUE;
+}
+
+static inline gboolean
+source_get_byte (const gchar *src,
+                 gboolean hex,
+                 gsize i,
+                 guint8 *out)
+{
+    gint hi;
+    gint lo;
+
+    if (!hex) {
+        *out = (guint8) src[i];
+        return TRUE;
+    }
+
+    hi = g_ascii_xdigit_value (src[2 * i]);
+    lo = g_ascii_xdigit_value (src[2 * i + 1]);
+    if (hi < 0 || lo < 0)
+        return FALSE;
+    *out = (guint8) ((hi << 4) | lo);
+    return TRUE;
+}
+
+/* Decodes @n_bytes bytes given in the charset, appending the UTF-8 result to
+ * @out. If @hex is given, @src is the hex representation of the bytes, and
+ * it is decoded on the fly. If @strict is given, bytes not valid in the
+ * charset make the whole conversion fail; otherwise they're replaced by '?'. */
+static gboolean
+charset_decode_append (MMModemCharset charset,
+                       const gchar *src,
+                       gsize n_bytes,
+                       gboolean hex,
+                       gboolean strict,
+                       GString *out)
+{
+    gsize i;
+
+    if (charset == MM_MODEM_CHARSET_UCS2 && (n_bytes % 2) != 0)
+        return FALSE;
+
+    for (i = 0; i < n_bytes; i++) {
+        gboolean mapped = TRUE;
+        gunichar uc = 0;
+        guint8 b;
+
+        if (!source_get_byte (src, hex, i, &b))
+            return FALSE;
+
+        switch (charset) {
+        case MM_MODEM_CHARSET_UTF8:
+            g_string_append_c (out, (gchar) b);
+            continue;
+        case MM_MODEM_CHARSET_IRA:
+            uc = b;
+            mapped = (b <= 0x7F);
+            break;
+        case MM_MODEM_CHARSET_8859_1:
+            uc = b;
+            break;
+        case MM_MODEM_CHARSET_UCS2: {
+            guint8 lo;
+
+            if (!source_get_byte (src, hex, ++i, &lo))
+                return FALSE;
+            uc = (b << 8) | lo;
+            mapped = (uc < 0xD800 || uc > 0xDFFF);
+            break;
+        }
+        case MM_MODEM_CHARSET_GSM:
+            if (b == GSM_ESCAPE_CHAR && (i + 1) < n_bytes) {
+                guint8 next;
+
+                if (!source_get_byte (src, hex, i + 1, &next))
+                    return FALSE;
+                if (single_byte_codec_decode (&gsm_ext_codec, next, &uc)) {
+                    i++;
+                    break;
+                }
+            }
+            mapped = single_byte_codec_decode (&gsm_def_codec, b, &uc);
+            break;
+        case MM_MODEM_CHARSET_PCCP437:
+            mapped = single_byte_codec_decode (&pccp437_codec, b, &uc);
+            break;
+        case MM_MODEM_CHARSET_PCDN:
+            mapped = single_byte_codec_decode (&pcdn_codec, b, &uc);
+            break;
+        case MM_MODEM_CHARSET_HEX:
+        case MM_MODEM_CHARSET_UNKNOWN:
+        default:
+            return FALSE;
+        }
+
+        if (!mapped) {
+            if (strict)
+                return FALSE;
+            uc = '?';
+        }
+        g_string_append_unichar (out, uc);
+    }
+
+    return TRUE;
 }
 
+static gchar *
+byte_array_free_to_string (GByteArray *array)
+{
+    g_byte_array_append (array, (const guint8 *) "\0", 1);
+    return (gchar *) g_byte_array_free (array, FALSE);
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_modem_charset_byte_array_append (GByteArray *array,
                                     const char *utf8,
                                     gboolean quoted,
                                     MMModemCharset charset)
 {
-    const char *iconv_to;
-    char *converted;
-    GError *error = NULL;
-    gsize written = 0;
+    guint initial_len;
 
     g_return_val_if_fail (array != NULL, FALSE);
     g_return_val_if_fail (utf8 != NULL, FALSE);
+    g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, FALSE);
 
-    iconv_to = charset_iconv_to (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
+    initial_len = array->len;
 
-    converted = g_convert (utf8, -1, iconv_to, "UTF-8", NULL, &written, &error);
-    if (!converted) {
-        if (error) {
-            g_warning ("%s: failed to convert '%s' to %s character set: (%d) %s",
-                       __func__, utf8, iconv_to,
-                       error->code, error->message);
-            g_error_free (error);
-        }
+    if (quoted)
+        g_byte_array_append (array, (const guint8 *) "\"", 1);
+
+    if (!charset_encode_utf8 (charset, utf8, TRUE, FALSE, array)) {
+        g_warning ("%s: failed to convert '%s' to %s character set",
+                   __func__, utf8, mm_modem_charset_to_string (charset));
+        g_byte_array_set_size (array, initial_len);
         return FALSE;
     }
 
-    if (quoted)
-        g_byte_array_append (array, (const guint8 *) "\"", 1);
-    g_byte_array_append (array, (const guint8 *) converted, written);
     if (quoted)
         g_byte_array_append (array, (const guint8 *) "\"", 1);
 
-    g_free (converted);
     return TRUE;
 }
 
 char *
 mm_modem_charset_hex_to_utf8 (const char *src, MMModemCharset charset)
 {
-    char *unconverted, *converted;
-    const char *iconv_from;
-    gsize unconverted_len = 0;
-    GError *error = NULL;
+    GString *converted;
+    gsize src_len;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    iconv_from = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_from != NULL, FALSE);
-
-    unconverted = mm_utils_hexstr2bin (src, &unconverted_len);
-    if (!unconverted)
+    src_len = strlen (src);
+    if ((src_len % 2) != 0)
         return NULL;
 
-    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
-        return unconverted;
-
-    converted = g_convert (unconverted, unconverted_len,
-                           "UTF-8//TRANSLIT", iconv_from,
-                           NULL, NULL, &error);
-    if (!converted || error) {
-        g_clear_error (&error);
-        converted = NULL;
+    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA) {
+        gsize unconverted_len = 0;
+
+        return mm_utils_hexstr2bin (src, &unconverted_len);
     }
 
-    g_free (unconverted);
+    /* Hex decoding and charset conversion are done in the same pass */
+    converted = g_string_sized_new (src_len + 1);
+    if (!charset_decode_append (charset, src, src_len / 2, TRUE, TRUE, converted)) {
+        g_string_free (converted, TRUE);
+        return NULL;
+    }
 
-    return converted;
+    return g_string_free (converted, FALSE);
 }
 
 char *
 mm_modem_charset_utf8_to_hex (const char *src, MMModemCharset charset)
 {
-    gsize converted_len = 0;
-    char *converted;
-    const char *iconv_to;
-    GError *error = NULL;
-    gchar *hex;
+    GByteArray *hex;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
 
-    iconv_to = charset_iconv_from (charset);
-    g_return_val_if_fail (iconv_to != NULL, FALSE);
-
     if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
         return g_strdup (src);
 
-    converted = g_convert (src, strlen (src),
-                           iconv_to, "UTF-8//TRANSLIT",
-                           NULL, &converted_len, &error);
-    if (!converted || error) {
-        g_clear_error (&error);
-        g_free (converted);
+    /* Charset conversion and hex encoding are done in the same pass */
+    hex = g_byte_array_sized_new (4 * strlen (src) + 1);
+    if (!charset_encode_utf8 (charset, src, FALSE, TRUE, hex)) {
+        g_byte_array_free (hex, TRUE);
         return NULL;
     }
 
-    /* Get hex representation of the string */
-    hex = mm_utils_bin2hexstr ((guint8 *)converted, converted_len);
-    g_free (converted);
-    return hex;
+    return byte_array_free_to_string (hex);
 }
 
 /* GSM 03.38 encoding conversion stuff */
 
-#define GSM_DEF_ALPHABET_SIZE 128
-#define GSM_EXT_ALPHABET_SIZE 10
-
-typedef struct GsmUtf8Mapping {
-    gchar chars[3];
-    guint8 len;
-    guint8 gsm;  /* only used for extended GSM charset */
-} GsmUtf8Mapping;
-
-#define ONE(a)     { {a, 0x00, 0x00}, 1, 0 }
-#define TWO(a, b)  { {a, b,    0x00}, 2, 0 }
-
-/**
- * gsm_def_utf8_alphabet:
- *
- * Mapping from GSM default alphabet to UTF-8.
- *
- * ETSI GSM 03.38, version 6.0.1, section 6.2.1; Default alphabet. Mapping to UCS-2.
- * Mapping according to http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
- */
-static const GsmUtf8Mapping gsm_def_utf8_alphabet[GSM_DEF_ALPHABET_SIZE] = {
-    /* @             £                $                ¥   */
-    ONE(0x40),       TWO(0xc2, 0xa3), ONE(0x24),       TWO(0xc2, 0xa5),
-    /* è             é                ù                ì   */
-    TWO(0xc3, 0xa8), TWO(0xc3, 0xa9), TWO(0xc3, 0xb9), TWO(0xc3, 0xac),
-    /* ò             Ç                \n               Ø   */
-    TWO(0xc3, 0xb2), TWO(0xc3, 0x87), ONE(0x0a),       TWO(0xc3, 0x98),
-    /* ø             \r               Å                å   */
-    TWO(0xc3, 0xb8), ONE(0x0d),       TWO(0xc3, 0x85), TWO(0xc3, 0xa5),
-    /* Δ             _                Φ                Γ   */
-    TWO(0xce, 0x94), ONE(0x5f),       TWO(0xce, 0xa6), TWO(0xce, 0x93),
-    /* Λ             Ω                Π                Ψ   */
-    TWO(0xce, 0x9b), TWO(0xce, 0xa9), TWO(0xce, 0xa0), TWO(0xce, 0xa8),
-    /* Σ             Θ                Ξ                Escape Code */
-    TWO(0xce, 0xa3), TWO(0xce, 0x98), TWO(0xce, 0x9e), ONE(0xa0),
-    /* Æ             æ                ß                É   */
-    TWO(0xc3, 0x86), TWO(0xc3, 0xa6), TWO(0xc3, 0x9f), TWO(0xc3, 0x89),
-    /* ' '           !                "                #   */
-    ONE(0x20),       ONE(0x21),       ONE(0x22),       ONE(0x23),
-    /* ¤             %                &                '   */
-    TWO(0xc2, 0xa4), ONE(0x25),       ONE(0x26),       ONE(0x27),
-    /* (             )                *                +   */
-    ONE(0x28),       ONE(0x29),       ONE(0x2a),       ONE(0x2b),
-    /* ,             -                .                /   */
-    ONE(0x2c),       ONE(0x2d),       ONE(0x2e),       ONE(0x2f),
-    /* 0             1                2                3   */
-    ONE(0x30),       ONE(0x31),       ONE(0x32),       ONE(0x33),
-    /* 4             5                6                7   */
-    ONE(0x34),       ONE(0x35),       ONE(0x36),       ONE(0x37),
-    /* 8             9                :                ;   */
-    ONE(0x38),       ONE(0x39),       ONE(0x3a),       ONE(0x3b),
-    /* <             =                >                ?   */
-    ONE(0x3c),       ONE(0x3d),       ONE(0x3e),       ONE(0x3f),
-    /* ¡             A                B                C   */
-    TWO(0xc2, 0xa1), ONE(0x41),       ONE(0x42),       ONE(0x43),
-    /* D             E                F                G   */
-    ONE(0x44),       ONE(0x45),       ONE(0x46),       ONE(0x47),
-    /* H             I                J                K   */
-    ONE(0x48),       ONE(0x49),       ONE(0x4a),       ONE(0x4b),
-    /* L             M                N                O   */
-    ONE(0x4c),       ONE(0x4d),       ONE(0x4e),       ONE(0x4f),
-    /* P             Q                R                S   */
-    ONE(0x50),       ONE(0x51),       ONE(0x52),       ONE(0x53),
-    /* T             U                V                W   */
-    ONE(0x54),       ONE(0x55),       ONE(0x56),       ONE(0x57),
-    /* X             Y                Z                Ä   */
-    ONE(0x58),       ONE(0x59),       ONE(0x5a),       TWO(0xc3, 0x84),
-    /* Ö             Ñ                Ü                §   */
-    TWO(0xc3, 0x96), TWO(0xc3, 0x91), TWO(0xc3, 0x9c), TWO(0xc2, 0xa7),
-    /* ¿             a                b                c   */
-    TWO(0xc2, 0xbf), ONE(0x61),       ONE(0x62),       ONE(0x63),
-    /* d             e                f                g   */
-    ONE(0x64),       ONE(0x65),       ONE(0x66),       ONE(0x67),
-    /* h             i                j                k   */
-    ONE(0x68),       ONE(0x69),       ONE(0x6a),       ONE(0x6b),
-    /* l             m                n                o   */
-    ONE(0x6c),       ONE(0x6d),       ONE(0x6e),       ONE(0x6f),
-    /* p             q                r                s   */
-    ONE(0x70),       ONE(0x71),       ONE(0x72),       ONE(0x73),
-    /* t             u                v                w   */
-    ONE(0x74),       ONE(0x75),       ONE(0x76),       ONE(0x77),
-    /* x             y                z                ä   */
-    ONE(0x78),       ONE(0x79),       ONE(0x7a),       TWO(0xc3, 0xa4),
-    /* ö             ñ                ü                à   */
-    TWO(0xc3, 0xb6), TWO(0xc3, 0xb1), TWO(0xc3, 0xbc), TWO(0xc3, 0xa0)
-};
-
-static guint8
-gsm_def_char_to_utf8 (const guint8 gsm, guint8 out_utf8[2])
-{
-    g_return_val_if_fail (gsm < GSM_DEF_ALPHABET_SIZE, 0);
-    memcpy (&out_utf8[0], &gsm_def_utf8_alphabet[gsm].chars[0], gsm_def_utf8_alphabet[gsm].len);
-    return gsm_def_utf8_alphabet[gsm].len;
-}
-
-static gboolean
-utf8_to_gsm_def_char (const char *utf8, guint32 len, guint8 *out_gsm)
-{
-    int i;
-
-    if (len > 0 && len < 4) {
-        for (i = 0; i < GSM_DEF_ALPHABET_SIZE; i++) {
-            if (gsm_def_utf8_alphabet[i].len == len) {
-                if (memcmp (&gsm_def_utf8_alphabet[i].chars[0], utf8, len) == 0) {
-                    *out_gsm = i;
-                    return TRUE;
-                }
-            }
-        }
-    }
-    return FALSE;
-}
-
-
-#define EONE(a, g)        { {a, 0x00, 0x00}, 1, g }
-#define ETHR(a, b, c, g)  { {a, b,    c},    3, g }
-
-/**
- * gsm_ext_utf8_alphabet:
- *
- * Mapping from GSM extended alphabet to UTF-8.
- *
- */
-static const GsmUtf8Mapping gsm_ext_utf8_alphabet[GSM_EXT_ALPHABET_SIZE] = {
-    /* form feed      ^                 {                 }  */
-    EONE(0x0c, 0x0a), EONE(0x5e, 0x14), EONE(0x7b, 0x28), EONE(0x7d, 0x29),
-    /* \              [                 ~                 ]  */
-    EONE(0x5c, 0x2f), EONE(0x5b, 0x3c), EONE(0x7e, 0x3d), EONE(0x5d, 0x3e),
-    /* |              €                                      */
-    EONE(0x7c, 0x40), ETHR(0xe2, 0x82, 0xac, 0x65)
-};
-
-#define GSM_ESCAPE_CHAR 0x1b
-
-static guint8
-gsm_ext_char_to_utf8 (const guint8 gsm, guint8 out_utf8[3])
-{
-    int i;
-
-    for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-        if (gsm == gsm_ext_utf8_alphabet[i].gsm) {
-            memcpy (&out_utf8[0], &gsm_ext_utf8_alphabet[i].chars[0], gsm_ext_utf8_alphabet[i].len);
-            return gsm_ext_utf8_alphabet[i].len;
-        }
-    }
-    return 0;
-}
-
-static gboolean
-utf8_to_gsm_ext_char (const char *utf8, guint32 len, guint8 *out_gsm)
-{
-    int i;
-
-    if (len > 0 && len < 4) {
-        for (i = 0; i < GSM_EXT_ALPHABET_SIZE; i++) {
-            if (gsm_ext_utf8_alphabet[i].len == len) {
-                if (memcmp (&gsm_ext_utf8_alphabet[i].chars[0], utf8, len) == 0) {
-                    *out_gsm = gsm_ext_utf8_alphabet[i].gsm;
-                    return TRUE;
-                }
-            }
-        }
-    }
-    return FALSE;
-}
-
 guint8 *
 mm_charset_gsm_unpacked_to_utf8 (const guint8 *gsm, guint32 len)
 {
-    int i;
-    GByteArray *utf8;
+    GString *utf8;
 
     g_return_val_if_fail (gsm != NULL, NULL);
     g_return_val_if_fail (len < 4096, NULL);
 
     /* worst case initial length */
-    utf8 = g_byte_array_sized_new (len * 2 + 1);
-
-    for (i = 0; i < len; i++) {
-        guint8 uchars[4];
-        guint8 ulen;
-
-        if (gsm[i] == GSM_ESCAPE_CHAR) {
-            /* Extended alphabet, decode next char */
-            ulen = gsm_ext_char_to_utf8 (gsm[i+1], uchars);
-            if (ulen)
-                i += 1;
-        } else {
-            /* Default alphabet */
-            ulen = gsm_def_char_to_utf8 (gsm[i], uchars);
-        }
+    utf8 = g_string_sized_new (len * 2 + 1);
 
-        if (ulen)
-            g_byte_array_append (utf8, &uchars[0], ulen);
-        else
-            g_byte_array_append (utf8, (guint8 *) "?", 1);
-    }
+    /* Non-strict decoding never fails, unknown chars are replaced by '?' */
+    charset_decode_append (MM_MODEM_CHARSET_GSM, (const gchar *) gsm, len, FALSE, FALSE, utf8);
 
-    g_byte_array_append (utf8, (guint8 *) "\0", 1);  /* NULL terminator */
-    return g_byte_array_free (utf8, FALSE);
+    return (guint8 *) g_string_free (utf8, FALSE);
 }
 
 guint8 *
 mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
 {
     GByteArray *gsm;
-    const char *c = utf8, *next = c;
-    static const guint8 gesc = GSM_ESCAPE_CHAR;
-    int i = 0;
+    const char *c;
 
     g_return_val_if_fail (utf8 != NULL, NULL);
     g_return_val_if_fail (out_len != NULL, NULL);
@@ -441,21 +672,14 @@ mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
         return g_byte_array_free (gsm, FALSE);
     }
 
-    while (next && *next) {
-        guint8 gch = 0x3f;  /* 0x3f == '?' */
-
-        next = g_utf8_next_char (c);
+    /* Characters not available in the GSM alphabets are skipped */
+    for (c = utf8; *c; c = g_utf8_next_char (c)) {
+        guint8 gch[6];
+        guint n;
 
-        /* Try escaped chars first, then default alphabet */
-        if (utf8_to_gsm_ext_char (c, next - c, &gch)) {
-            /* Add the escape char */
-            g_byte_array_append (gsm, &gesc, 1);
-            g_byte_array_append (gsm, &gch, 1);
-        } else if (utf8_to_gsm_def_char (c, next - c, &gch))
-            g_byte_array_append (gsm, &gch, 1);
-
-        c = next;
-        i++;
+        n = charset_encode_unichar (MM_MODEM_CHARSET_GSM, g_utf8_get_char (c), gch);
+        if (n)
+            g_byte_array_append (gsm, gch, n);
     }
 
     *out_len = gsm->len;
@@ -465,15 +689,12 @@ mm_charset_utf8_to_unpacked_gsm (const char *utf8, guint32 *out_len)
 static gboolean
 gsm_is_subset (gunichar c, const char *utf8, gsize ulen, guint *out_clen)
 {
-    guint8 gsm;
+    guint8 gsm[6];
 
-    *out_clen = 1;
-    if (utf8_to_gsm_def_char (utf8, ulen, &gsm))
+    *out_clen = charset_encode_unichar (MM_MODEM_CHARSET_GSM, c, gsm);
+    if (*out_clen)
         return TRUE;
-    if (utf8_to_gsm_ext_char (utf8, ulen, &gsm)) {
-        *out_clen = 2;
-        return TRUE;
-    }
+    *out_clen = 1;
     return FALSE;
 }
 
@@ -501,67 +722,19 @@ iso88591_is_subset (gunichar c, const char *utf8, gsize ulen, guint *out_clen)
 static gboolean
 pccp437_is_subset (gunichar c, const char *utf8, gsize ulen, guint *out_clen)
 {
-    static const gunichar t[] = {
-        0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7, 0x00ea,
-        0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5, 0x00c9, 0x00e6,
-        0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9, 0x00ff, 0x00d6, 0x00dc,
-        0x00a2, 0x00a3, 0x00a5, 0x20a7, 0x0192, 0x00e1, 0x00ed, 0x00f3, 0x00fa,
-        0x00f1, 0x00d1, 0x00aa, 0x00ba, 0x00bf, 0x2310, 0x00ac, 0x00bd, 0x00bc,
-        0x00a1, 0x00ab, 0x00bb, 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561,
-        0x2562, 0x2556, 0x2555, 0x2563, 0x2551, 0x2557, 0x255d, 0x255c, 0x255b,
-        0x2510, 0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x255e, 0x255f,
-        0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x2567, 0x2568,
-        0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256b, 0x256a, 0x2518,
-        0x250c, 0x2588, 0x2584, 0x258c, 0x2590, 0x2580, 0x03b1, 0x00df, 0x0393,
-        0x03c0, 0x03a3, 0x03c3, 0x00b5, 0x03c4, 0x03a6, 0x0398, 0x03a9, 0x03b4,
-        0x221e, 0x03c6, 0x03b5, 0x2229, 0x2261, 0x00b1, 0x2265, 0x2264, 0x2320,
-        0x2321, 0x00f7, 0x2248, 0x00b0, 0x2219, 0x00b7, 0x221a, 0x207f, 0x00b2,
-        0x25a0, 0x00a0
-    };
-    int i;
+    guint8 code;
 
     *out_clen = 1;
-
-    if (c <= 0x7F)
-        return TRUE;
-    for (i = 0; i < sizeof (t) / sizeof (t[0]); i++) {
-        if (c == t[i])
-            return TRUE;
-    }
-    return FALSE;
+    return single_byte_codec_encode (&pccp437_codec, c, &code);
 }
 
 static gboolean
 pcdn_is_subset (gunichar c, const char *utf8, gsize ulen, guint *out_clen)
 {
-    static const gunichar t[] = {
-        0x00c7, 0x00fc, 0x00e9, 0x00e2, 0x00e4, 0x00e0, 0x00e5, 0x00e7, 0x00ea,
-        0x00eb, 0x00e8, 0x00ef, 0x00ee, 0x00ec, 0x00c4, 0x00c5, 0x00c9, 0x00e6,
-        0x00c6, 0x00f4, 0x00f6, 0x00f2, 0x00fb, 0x00f9, 0x00ff, 0x00d6, 0x00dc,
-        0x00f8, 0x00a3, 0x00d8, 0x00d7, 0x0192, 0x00e1, 0x00ed, 0x00f3, 0x00fa,
-        0x00f1, 0x00d1, 0x00aa, 0x00ba, 0x00bf, 0x00ae, 0x00ac, 0x00bd, 0x00bc,
-        0x00a1, 0x00ab, 0x00bb, 0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x00c1,
-        0x00c2, 0x00c0, 0x00a9, 0x2563, 0x2551, 0x2557, 0x255d, 0x00a2, 0x00a5,
-        0x2510, 0x2514, 0x2534, 0x252c, 0x251c, 0x2500, 0x253c, 0x00e3, 0x00c3,
-        0x255a, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256c, 0x00a4, 0x00f0,
-        0x00d0, 0x00ca, 0x00cb, 0x00c8, 0x0131, 0x00cd, 0x00ce, 0x00cf, 0x2518,
-        0x250c, 0x2588, 0x2584, 0x00a6, 0x00cc, 0x2580, 0x00d3, 0x00df, 0x00d4,
-        0x00d2, 0x00f5, 0x00d5, 0x00b5, 0x00fe, 0x00de, 0x00da, 0x00db, 0x00d9,
-        0x00fd, 0x00dd, 0x00af, 0x00b4, 0x00ad, 0x00b1, 0x2017, 0x00be, 0x00b6,
-        0x00a7, 0x00f7, 0x00b8, 0x00b0, 0x00a8, 0x00b7, 0x00b9, 0x00b3, 0x00b2,
-        0x25a0, 0x00a0
-    };
-    int i;
+    guint8 code;
 
     *out_clen = 1;
-
-    if (c <= 0x7F)
-        return TRUE;
-    for (i = 0; i < sizeof (t) / sizeof (t[0]); i++) {
-        if (c == t[i])
-            return TRUE;
-    }
-    return FALSE;
+    return single_byte_codec_encode (&pcdn_codec, c, &code);
 }
 
 typedef struct {
@@ -636,18 +809,47 @@ mm_charset_get_encoded_len (const char *utf8,
     return len;
 }
 
-guint8 *
-gsm_unpack (const guint8 *gsm,
-            guint32 num_septets,
-            guint8 start_offset,  /* in _bits_ */
-            guint32 *out_unpacked_len)
+/* Little-endian load of 8 bytes, at any alignment */
+static inline guint64
+gsm_load_le64 (const guint8 *p)
 {
-    GByteArray *unpacked;
-    int i;
+    guint64 v;
+
+    memcpy (&v, p, sizeof (v));
+    return GUINT64_FROM_LE (v);
+}
 
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+void
+gsm_unpack_buf (const guint8 *gsm,
+                guint32 num_septets,
+                guint8 start_offset,  /* in _bits_ */
+                guint8 *out)
+{
+    guint32 packed_len;
+    guint32 i = 0;
+
+    gsm += start_offset / 8;
+    start_offset %= 8;
+    packed_len = (start_offset + (num_septets * 7) + 7) / 8;
+
+    /* 8 septets from each 7 octets, as long as a whole 64-bit word can be
+     * loaded without reading past the packed data */
+    for (; (i + 8 <= num_septets) && ((i / 8) * 7 + 8 <= packed_len); i += 8) {
+        guint64 w;
+
+        w = gsm_load_le64 (&gsm[(i / 8) * 7]) >> start_offset;
+        out[i]     =  w         & 0x7F;
+        out[i + 1] = (w >> 7)   & 0x7F;
+        out[i + 2] = (w >> 14)  & 0x7F;
+        out[i + 3] = (w >> 21)  & 0x7F;
+        out[i + 4] = (w >> 28)  & 0x7F;
+        out[i + 5] = (w >> 35)  & 0x7F;
+        out[i + 6] = (w >> 42)  & 0x7F;
+        out[i + 7] = (w >> 49)  & 0x7F;
+    }
 
-    for (i = 0; i < num_septets; i++) {
+    /* Remaining septets, one at a time */
+    for (; i < num_septets; i++) {
         guint8 bits_here, bits_in_next, octet, offset, c;
         guint32 start_bit;
 
@@ -665,11 +867,79 @@ gsm_unpack (const guint8 *gsm,
             octet = gsm[(start_bit / 8) + 1];
             c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
         }
-        g_byte_array_append (unpacked, &c, 1);
+        out[i] = c;
     }
+}
+
+guint8 *
+gsm_unpack (const guint8 *gsm,
+            guint32 num_septets,
+            guint8 start_offset,  /* in _bits_ */
+            guint32 *out_unpacked_len)
+{
+    guint8 *unpacked;
 
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    unpacked = g_malloc (num_septets + 1);
+    gsm_unpack_buf (gsm, num_septets, start_offset, unpacked);
+
+    *out_unpacked_len = num_septets;
+    return unpacked;
+}
+
+guint32
+gsm_pack_buf (const guint8 *src,
+              guint32 src_len,
+              guint8 start_offset,
+              guint8 *out)
+{
+    guint64 acc;
+    guint bits;
+    guint8 *p = out;
+    guint32 i = 0;
+
+    g_return_val_if_fail (start_offset < 8, 0);
+
+    /* Keep whatever is already in the bits before the start offset */
+    acc = start_offset ? (out[0] & ((1 << start_offset) - 1)) : 0;
+    bits = start_offset;
+
+    /* 8 septets into 7 octets; less than 8 bits are ever left pending, so
+     * the 56 new ones always fit in the accumulator */
+    for (; i + 8 <= src_len; i += 8) {
+        acc |= ((guint64) (src[i]     & 0x7F) << bits)        |
+               ((guint64) (src[i + 1] & 0x7F) << (bits + 7))  |
+               ((guint64) (src[i + 2] & 0x7F) << (bits + 14)) |
+               ((guint64) (src[i + 3] & 0x7F) << (bits + 21)) |
+               ((guint64) (src[i + 4] & 0x7F) << (bits + 28)) |
+               ((guint64) (src[i + 5] & 0x7F) << (bits + 35)) |
+               ((guint64) (src[i + 6] & 0x7F) << (bits + 42)) |
+               ((guint64) (src[i + 7] & 0x7F) << (bits + 49));
+        p[0] = acc;
+        p[1] = acc >> 8;
+        p[2] = acc >> 16;
+        p[3] = acc >> 24;
+        p[4] = acc >> 32;
+        p[5] = acc >> 40;
+        p[6] = acc >> 48;
+        p += 7;
+        acc >>= 56;
+    }
+
+    /* Remaining septets, one at a time */
+    for (; i < src_len; i++) {
+        acc |= (guint64) (src[i] & 0x7F) << bits;
+        bits += 7;
+        if (bits >= 8) {
+            *p++ = acc;
+            acc >>= 8;
+            bits -= 8;
+        }
+    }
+
+    if (bits)
+        *p++ = acc;
+
+    return p - out;
 }
 
 guint8 *
@@ -679,29 +949,13 @@ gsm_pack (const guint8 *src,
           guint32 *out_packed_len)
 {
     guint8 *packed;
-    guint octet = 0, lshift, plen;
-    int i = 0;
+    guint plen;
 
     g_return_val_if_fail (start_offset < 8, NULL);
 
-    plen = (src_len * 7) + start_offset; /* total length in bits */
-    if (plen % 8)
-        plen += 8;
-    plen /= 8;  /* now in bytes */
-
+    plen = GSM_PACKED_LEN (src_len, start_offset);
     packed = g_malloc0 (plen);
-
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
-        if (lshift > 1) {
-            /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
-        }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
-    }
+    gsm_pack_buf (src, src_len, start_offset, packed);
 
     if (out_packed_len)
         *out_packed_len = plen;
@@ -735,17 +989,15 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
     case MM_MODEM_CHARSET_8859_1:
     case MM_MODEM_CHARSET_PCCP437:
     case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_from;
-        GError *error = NULL;
-
-        iconv_from = charset_iconv_from (charset);
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", iconv_from,
-                          NULL, NULL, &error);
-        if (!utf8 || error) {
-            g_clear_error (&error);
-            utf8 = NULL;
-        }
+        GString *converted;
+        gsize len;
+
+        len = strlen (str);
+        converted = g_string_sized_new (2 * len + 1);
+        if (charset_decode_append (charset, str, len, FALSE, TRUE, converted))
+            utf8 = g_string_free (converted, FALSE);
+        else
+            g_string_free (converted, TRUE);
 
         g_free (str);
         break;
@@ -754,7 +1006,7 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
     case MM_MODEM_CHARSET_UCS2: {
         gsize len;
         gboolean possibly_hex = TRUE;
-        gsize bread = 0, bwritten = 0;
+        const gchar *end = NULL;
 
         /* If the string comes in hex-UCS-2, len needs to be a multiple of 4 */
         len = strlen (str);
@@ -778,28 +1030,25 @@ mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset)
         }
 
         /* If not hex, then it might be raw UCS-2 (very unlikely) or ASCII/UTF-8
-         * (much more likely).  Try to convert to UTF-8 and if that fails, use
-         * the partial conversion length to re-convert the part of the string
-         * that is UTF-8, if any.
+         * (much more likely).  Validate it as UTF-8 and if that fails, keep the
+         * part of the string that is valid UTF-8, if any.
          */
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          &bread, &bwritten, NULL);
+        if (g_utf8_validate (str, -1, &end)) {
+            utf8 = str;
+            break;
+        }
 
-        /* Valid conversion, or we didn't get enough valid UTF-8 */
-        if (utf8 || (bwritten <= 2)) {
+        /* We didn't get enough valid UTF-8 */
+        if ((end - str) <= 2) {
             g_free (str);
             break;
         }
 
-        /* Last try; chop off the original string at the conversion failure
+        /* Last try; chop off the original string at the validation failure
          * location and get what we can.
          */
-        str[bread] = '\0';
-        utf8 = g_convert (str, strlen (str),
-                          "UTF-8//TRANSLIT", "UTF-8//TRANSLIT",
-                          NULL, NULL, NULL);
-        g_free (str);
+        str[end - str] = '\0';
+        utf8 = str;
         break;
     }
 
@@ -855,44 +1104,27 @@ mm_utf8_take_and_convert_to_charset (gchar *str,
         break;
 
     case MM_MODEM_CHARSET_GSM:
-    case MM_MODEM_CHARSET_8859_1:
-    case MM_MODEM_CHARSET_PCCP437:
-    case MM_MODEM_CHARSET_PCDN: {
-        const gchar *iconv_to;
-        GError *error = NULL;
-
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, NULL, &error);
-        if (!encoded || error) {
-            g_clear_error (&error);
-            encoded = NULL;
-        }
-
+        /* Unpacked GSM may include NUL bytes ('@' is 0x00), so it cannot be
+         * given in a NUL-terminated string; callers must use
+         * mm_charset_utf8_to_unpacked_gsm() instead */
         g_free (str);
         break;
-    }
 
+    case MM_MODEM_CHARSET_8859_1:
+    case MM_MODEM_CHARSET_PCCP437:
+    case MM_MODEM_CHARSET_PCDN:
     case MM_MODEM_CHARSET_UCS2: {
-        const gchar *iconv_to;
-        gsize encoded_len = 0;
-        GError *error = NULL;
-        gchar *hex;
-
-        iconv_to = charset_iconv_from (charset);
-        encoded = g_convert (str, strlen (str),
-                             iconv_to, "UTF-8",
-                             NULL, &encoded_len, &error);
-        if (!encoded || error) {
-            g_clear_error (&error);
-            encoded = NULL;
-        }
+        GByteArray *array;
+        gboolean hex;
+
+        /* UCS-2 is given in hex representation */
+        hex = (charset == MM_MODEM_CHARSET_UCS2);
+        array = g_byte_array_sized_new ((hex ? 4 : 2) * strlen (str) + 1);
+        if (charset_encode_utf8 (charset, str, FALSE, hex, array))
+            encoded = byte_array_free_to_string (array);
+        else
+            g_byte_array_free (array, TRUE);
 
-        /* Get hex representation of the string */
-        hex = mm_utils_bin2hexstr ((guint8 *)encoded, encoded_len);
-        g_free (encoded);
-        encoded = hex;
         g_free (str);
         break;
     }
@@ -72,8 +72,27 @@ guint8 *gsm_pack (const guint8 *src,
                   guint8 start_offset,  /* in bits */
                   guint32 *out_packed_len);
 
+/* Octets needed to pack @num_septets septets after @start_offset bits */
+#define GSM_PACKED_LEN(num_septets, start_offset) \
+    (((guint32) (num_septets) * 7 + (start_offset) + 7) / 8)
+
+/* Like gsm_unpack(), but writing the @num_septets septets into @out */
+void gsm_unpack_buf (const guint8 *gsm,
+                     guint32 num_septets,
+                     guint8 start_offset,  /* in bits */
+                     guint8 *out);
+
+/* Like gsm_pack(), but writing into @out, which must hold at least
+ * GSM_PACKED_LEN() octets; the bits of the first octet before
+ * @start_offset are kept. Returns the number of octets written. */
+guint32 gsm_pack_buf (const guint8 *src,
+                      guint32 src_len,
+                      guint8 start_offset,  /* in bits */
+                      guint8 *out);
+
 gchar *mm_charset_take_and_convert_to_utf8 (gchar *str, MMModemCharset charset);
 
+/* Not for GSM, which always gives NULL; see mm_charset_utf8_to_unpacked_gsm() */
 gchar *mm_utf8_take_and_convert_to_charset (gchar *str,
                                             MMModemCharset charset);
 
@@ -26,6 +26,9 @@ static const gchar *log_level;
 static const gchar *log_file;
 static gboolean show_ts;
 static gboolean rel_ts;
+static gint network_scan_interval;
+static gint trace_buffer;
+static const gchar *trace_file;
 
 static const GOptionEntry entries[] = {
     { "version", 'V', 0, G_OPTION_ARG_NONE, &version_flag, "Print version", NULL },
@@ -34,6 +37,9 @@ static const GOptionEntry entries[] = {
     { "log-file", 0, 0, G_OPTION_ARG_STRING, &log_file, "Path to log file", NULL },
     { "timestamps", 0, 0, G_OPTION_ARG_NONE, &show_ts, "Show timestamps in log output", NULL },
     { "relative-timestamps", 0, 0, G_OPTION_ARG_NONE, &rel_ts, "Use relative timestamps (from MM start)", NULL },
+    { "network-scan-interval", 0, 0, G_OPTION_ARG_INT, &network_scan_interval, "Scan 3GPP networks in the background every [SECS] seconds while enabled (0 to disable)", "[SECS]" },
+    { "trace-buffer", 0, 0, G_OPTION_ARG_INT, &trace_buffer, "Trace step machines and port transactions, keeping the last [SPANS] spans", "[SPANS]" },
+    { "trace-file", 0, 0, G_OPTION_ARG_FILENAME, &trace_file, "Path where to dump the trace (on SIGUSR1 and on exit); the trace is not dumped if not given", "[PATH]" },
     { NULL }
 };
 
@@ -67,6 +73,24 @@ mm_context_get_relative_timestamps (void)
     return rel_ts;
 }
 
+guint
+mm_context_get_network_scan_interval (void)
+{
+    return network_scan_interval > 0 ? (guint) network_scan_interval : 0;
+}
+
+guint
+mm_context_get_trace_buffer (void)
+{
+    return trace_buffer > 0 ? (guint) trace_buffer : 0;
+}
+
+const gchar *
+mm_context_get_trace_file (void)
+{
+    return trace_file;
+}
+
 /*****************************************************************************/
 /* Test context */
 
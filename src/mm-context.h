@@ -31,6 +31,9 @@ const gchar *mm_context_get_log_level           (void);
 const gchar *mm_context_get_log_file            (void);
 gboolean     mm_context_get_timestamps          (void);
 gboolean     mm_context_get_relative_timestamps (void);
+guint        mm_context_get_network_scan_interval (void);
+guint        mm_context_get_trace_buffer        (void);
+const gchar *mm_context_get_trace_file          (void);
 
 /* Testing support */
 gboolean     mm_context_get_test_session        (void);
@@ -71,6 +71,14 @@ struct _MMDevicePrivate {
     GList *port_probes;
     GList *ignored_port_probes;
 
+    /* Port probe lookup tables, for both the probed and the ignored ports,
+     * keyed by sysfs path and by devpath (to match DEVPATH_OLD). Keys and
+     * values are owned by the probes in the lists above. */
+    GHashTable *port_probes_by_sysfs_path;
+    GHashTable *port_probes_by_devpath;
+    GHashTable *ignored_port_probes_by_sysfs_path;
+    GHashTable *ignored_port_probes_by_devpath;
+
     /* The Modem object for this device */
     MMBaseModem *modem;
 
@@ -86,43 +94,72 @@ struct _MMDevicePrivate {
 
 /*****************************************************************************/
 
-static MMPortProbe *
-device_find_probe_with_device (MMDevice    *self,
-                               GUdevDevice *udev_port,
-                               gboolean lookup_ignored)
+static void
+probe_index_add (GHashTable *by_sysfs_path,
+                 GHashTable *by_devpath,
+                 MMPortProbe *probe)
 {
-    GList *l;
+    GUdevDevice *udev_port;
+    const gchar *devpath;
 
-    for (l = self->priv->port_probes; l; l = g_list_next (l)) {
-        MMPortProbe *probe = MM_PORT_PROBE (l->data);
+    udev_port = mm_port_probe_peek_port (probe);
+    g_hash_table_insert (by_sysfs_path,
+                         (gpointer) g_udev_device_get_sysfs_path (udev_port),
+                         probe);
+    devpath = g_udev_device_get_property (udev_port, "DEVPATH");
+    if (devpath)
+        g_hash_table_insert (by_devpath, (gpointer) devpath, probe);
+}
 
-        if (   g_udev_device_has_property (udev_port, "DEVPATH_OLD")
-            && g_str_has_suffix (g_udev_device_get_sysfs_path (mm_port_probe_peek_port (probe)),
-                                 g_udev_device_get_property (udev_port, "DEVPATH_OLD")))
-            return probe;
+static void
+probe_index_remove (GHashTable *by_sysfs_path,
+                    GHashTable *by_devpath,
+                    MMPortProbe *probe)
+{
+    GUdevDevice *udev_port;
+    const gchar *devpath;
+
+    udev_port = mm_port_probe_peek_port (probe);
+    g_hash_table_remove (by_sysfs_path, g_udev_device_get_sysfs_path (udev_port));
+    devpath = g_udev_device_get_property (udev_port, "DEVPATH");
+    if (devpath)
+        g_hash_table_remove (by_devpath, devpath);
+}
+
+static MMPortProbe *
+probe_index_lookup (GHashTable *by_sysfs_path,
+                    GHashTable *by_devpath,
+                    GUdevDevice *udev_port)
+{
+    const gchar *devpath_old;
+    MMPortProbe *probe;
 
-        if (g_str_equal (g_udev_device_get_sysfs_path (mm_port_probe_peek_port (probe)),
-                         g_udev_device_get_sysfs_path (udev_port)))
+    devpath_old = g_udev_device_get_property (udev_port, "DEVPATH_OLD");
+    if (devpath_old) {
+        probe = g_hash_table_lookup (by_devpath, devpath_old);
+        if (probe)
             return probe;
     }
 
-    if (!lookup_ignored)
-        return NULL;
-
-    for (l = self->priv->ignored_port_probes; l; l = g_list_next (l)) {
-        MMPortProbe *probe = MM_PORT_PROBE (l->data);
+    return g_hash_table_lookup (by_sysfs_path, g_udev_device_get_sysfs_path (udev_port));
+}
 
-        if (   g_udev_device_has_property (udev_port, "DEVPATH_OLD")
-            && g_str_has_suffix (g_udev_device_get_sysfs_path (mm_port_probe_peek_port (probe)),
-                                 g_udev_device_get_property (udev_port, "DEVPATH_OLD")))
-            return probe;
+static MMPortProbe *
+device_find_probe_with_device (MMDevice    *self,
+                               GUdevDevice *udev_port,
+                               gboolean lookup_ignored)
+{
+    MMPortProbe *probe;
 
-        if (g_str_equal (g_udev_device_get_sysfs_path (mm_port_probe_peek_port (probe)),
-                         g_udev_device_get_sysfs_path (udev_port)))
-            return probe;
-    }
+    probe = probe_index_lookup (self->priv->port_probes_by_sysfs_path,
+                                self->priv->port_probes_by_devpath,
+                                udev_port);
+    if (probe || !lookup_ignored)
+        return probe;
 
-    return NULL;
+    return probe_index_lookup (self->priv->ignored_port_probes_by_sysfs_path,
+                               self->priv->ignored_port_probes_by_devpath,
+                               udev_port);
 }
 
 gboolean
@@ -334,6 +371,9 @@ mm_device_grab_port (MMDevice    *self,
     /* Create and store new port probe */
     probe = mm_port_probe_new (self, udev_port);
     self->priv->port_probes = g_list_prepend (self->priv->port_probes, probe);
+    probe_index_add (self->priv->port_probes_by_sysfs_path,
+                     self->priv->port_probes_by_devpath,
+                     probe);
 
     /* Notify about the grabbed port */
     g_signal_emit (self, signals[SIGNAL_PORT_GRABBED], 0, udev_port);
@@ -347,8 +387,18 @@ mm_device_release_port (MMDevice    *self,
 
     probe = device_find_probe_with_device (self, udev_port, TRUE);
     if (probe) {
-        /* Found, remove from list and destroy probe */
-        self->priv->port_probes = g_list_remove (self->priv->port_probes, probe);
+        /* Found, remove from whichever list it is in and destroy probe */
+        if (g_list_find (self->priv->port_probes, probe)) {
+            self->priv->port_probes = g_list_remove (self->priv->port_probes, probe);
+            probe_index_remove (self->priv->port_probes_by_sysfs_path,
+                                self->priv->port_probes_by_devpath,
+                                probe);
+        } else {
+            self->priv->ignored_port_probes = g_list_remove (self->priv->ignored_port_probes, probe);
+            probe_index_remove (self->priv->ignored_port_probes_by_sysfs_path,
+                                self->priv->ignored_port_probes_by_devpath,
+                                probe);
+        }
         g_signal_emit (self, signals[SIGNAL_PORT_RELEASED], 0, mm_port_probe_peek_port (probe));
         g_object_unref (probe);
     }
@@ -367,7 +417,13 @@ mm_device_ignore_port  (MMDevice *self,
                 g_udev_device_get_subsystem (udev_port),
                 g_udev_device_get_name (udev_port));
         self->priv->port_probes = g_list_remove (self->priv->port_probes, probe);
+        probe_index_remove (self->priv->port_probes_by_sysfs_path,
+                            self->priv->port_probes_by_devpath,
+                            probe);
         self->priv->ignored_port_probes = g_list_prepend (self->priv->ignored_port_probes, probe);
+        probe_index_add (self->priv->ignored_port_probes_by_sysfs_path,
+                         self->priv->ignored_port_probes_by_devpath,
+                         probe);
     }
 }
 
@@ -474,6 +530,8 @@ mm_device_remove_modem (MMDevice  *self)
     g_object_run_dispose (G_OBJECT (self->priv->modem));
     g_clear_object (&(self->priv->modem));
     g_clear_object (&(self->priv->object_manager));
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEM]);
 }
 
 /*****************************************************************************/
@@ -542,6 +600,8 @@ mm_device_create_modem (MMDevice                  *self,
                           "notify::" MM_BASE_MODEM_VALID,
                           G_CALLBACK (modem_valid),
                           self);
+
+        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEM]);
     }
 
     return !!self->priv->modem;
@@ -737,6 +797,11 @@ mm_device_init (MMDevice *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_DEVICE,
                                               MMDevicePrivate);
+
+    self->priv->port_probes_by_sysfs_path = g_hash_table_new (g_str_hash, g_str_equal);
+    self->priv->port_probes_by_devpath = g_hash_table_new (g_str_hash, g_str_equal);
+    self->priv->ignored_port_probes_by_sysfs_path = g_hash_table_new (g_str_hash, g_str_equal);
+    self->priv->ignored_port_probes_by_devpath = g_hash_table_new (g_str_hash, g_str_equal);
 }
 
 static void
@@ -813,8 +878,14 @@ dispose (GObject *object)
 
     g_clear_object (&(self->priv->udev_device));
     g_clear_object (&(self->priv->plugin));
+    g_hash_table_remove_all (self->priv->port_probes_by_sysfs_path);
+    g_hash_table_remove_all (self->priv->port_probes_by_devpath);
+    g_hash_table_remove_all (self->priv->ignored_port_probes_by_sysfs_path);
+    g_hash_table_remove_all (self->priv->ignored_port_probes_by_devpath);
     g_list_free_full (self->priv->port_probes, (GDestroyNotify)g_object_unref);
+    self->priv->port_probes = NULL;
     g_list_free_full (self->priv->ignored_port_probes, (GDestroyNotify)g_object_unref);
+    self->priv->ignored_port_probes = NULL;
     g_clear_object (&(self->priv->modem));
 
     G_OBJECT_CLASS (mm_device_parent_class)->dispose (object);
@@ -828,6 +899,10 @@ finalize (GObject *object)
     g_free (self->priv->path);
     g_strfreev (self->priv->drivers);
     g_strfreev (self->priv->virtual_ports);
+    g_hash_table_unref (self->priv->port_probes_by_sysfs_path);
+    g_hash_table_unref (self->priv->port_probes_by_devpath);
+    g_hash_table_unref (self->priv->ignored_port_probes_by_sysfs_path);
+    g_hash_table_unref (self->priv->ignored_port_probes_by_devpath);
 
     G_OBJECT_CLASS (mm_device_parent_class)->finalize (object);
 }
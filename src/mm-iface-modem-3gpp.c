@@ -26,17 +26,23 @@
 #include "mm-base-modem.h"
 #include "mm-modem-helpers.h"
 #include "mm-error-helpers.h"
+#include "mm-context.h"
 #include "mm-log.h"
 
 #define REGISTRATION_CHECK_TIMEOUT_SEC 30
 
+/* Network scan results younger than this are reused as they are */
+#define NETWORK_SCAN_RESULTS_MAX_AGE_SEC 60
+
 #define SUBSYSTEM_3GPP "3gpp"
 
 #define REGISTRATION_STATE_CONTEXT_TAG    "3gpp-registration-state-context-tag"
 #define REGISTRATION_CHECK_CONTEXT_TAG    "3gpp-registration-check-context-tag"
+#define NETWORK_SCAN_CONTEXT_TAG          "3gpp-network-scan-context-tag"
 
 static GQuark registration_state_context_quark;
 static GQuark registration_check_context_quark;
+static GQuark network_scan_context_quark;
 
 /*****************************************************************************/
 
@@ -171,6 +177,8 @@ typedef struct {
     gchar *operator_id;
     GTimer *timer;
     guint max_registration_time;
+    guint recheck_id;
+    gulong registration_state_changed_id;
 } RegisterInNetworkContext;
 
 static void
@@ -179,6 +187,11 @@ register_in_network_context_complete_and_free (RegisterInNetworkContext *ctx)
     g_simple_async_result_complete_in_idle (ctx->result);
     g_object_unref (ctx->result);
 
+    if (ctx->recheck_id)
+        g_source_remove (ctx->recheck_id);
+    if (ctx->registration_state_changed_id)
+        g_signal_handler_disconnect (ctx->self, ctx->registration_state_changed_id);
+
     if (ctx->timer)
         g_timer_destroy (ctx->timer);
 
@@ -221,6 +234,11 @@ mm_iface_modem_3gpp_register_in_network_finish (MMIfaceModem3gpp *self,
     return !g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error);
 }
 
+/* While waiting to get registered, registration state updates are processed as
+ * soon as they're received; polling is just a safety net for modems without
+ * unsolicited registration messages */
+#define REGISTRATION_RECHECK_TIMEOUT_SECS 10
+
 static void run_registration_checks_ready (MMIfaceModem3gpp *self,
                                            GAsyncResult *res,
                                            RegisterInNetworkContext *ctx);
@@ -228,6 +246,8 @@ static void run_registration_checks_ready (MMIfaceModem3gpp *self,
 static gboolean
 run_registration_checks_again (RegisterInNetworkContext *ctx)
 {
+    ctx->recheck_id = 0;
+
     /* Get fresh registration state */
     mm_iface_modem_3gpp_run_registration_checks (
         ctx->self,
@@ -236,30 +256,24 @@ run_registration_checks_again (RegisterInNetworkContext *ctx)
     return FALSE;
 }
 
+static void registration_state_changed (RegisterInNetworkContext *ctx);
+
 static void
-run_registration_checks_ready (MMIfaceModem3gpp *self,
-                               GAsyncResult *res,
-                               RegisterInNetworkContext *ctx)
+register_in_network_context_check_state (RegisterInNetworkContext *ctx,
+                                         const gchar *source)
 {
-    GError *error = NULL;
     RegistrationStateContext *registration_state_context;
     MMModem3gppRegistrationState current_registration_state;
-
-    mm_iface_modem_3gpp_run_registration_checks_finish (MM_IFACE_MODEM_3GPP (self), res, &error);
-    if (error) {
-        mm_dbg ("3GPP registration check failed: '%s'", error->message);
-        register_in_network_context_failed (ctx, error);
-        register_in_network_context_complete_and_free (ctx);
-        return;
-    }
+    gdouble elapsed;
 
     registration_state_context = get_registration_state_context (ctx->self);
     current_registration_state = get_consolidated_reg_state (registration_state_context);
+    elapsed = g_timer_elapsed (ctx->timer, NULL);
 
     /* If we got a final state and it's denied, we can assume the registration is
      * finished */
     if (current_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_DENIED) {
-        mm_dbg ("Registration denied");
+        mm_dbg ("Registration denied (%s, after %.3lfs)", source, elapsed);
         register_in_network_context_failed (
             ctx,
             mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_NETWORK_NOT_ALLOWED));
@@ -272,14 +286,15 @@ run_registration_checks_ready (MMIfaceModem3gpp *self,
         current_registration_state == MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING) {
         /* Request immediate access tech update */
         mm_iface_modem_refresh_access_technologies (MM_IFACE_MODEM (ctx->self));
-        mm_dbg ("Modem is currently registered in a 3GPP network");
+        mm_dbg ("Modem is currently registered in a 3GPP network (%s, after %.3lfs)",
+                source, elapsed);
         g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
         register_in_network_context_complete_and_free (ctx);
         return;
     }
 
     /* Don't spend too much time waiting to get registered */
-    if (g_timer_elapsed (ctx->timer, NULL) > ctx->max_registration_time) {
+    if (elapsed > ctx->max_registration_time) {
         mm_dbg ("3GPP registration check timed out");
         register_in_network_context_failed (
             ctx,
@@ -289,13 +304,61 @@ run_registration_checks_ready (MMIfaceModem3gpp *self,
     }
 
     /* If we're still waiting for automatic registration to complete or
-     * fail, check again in a few seconds.
-     *
-     * This 3s timeout will catch results from automatic registrations as
-     * well.
+     * fail, wait for the registration state to change, and check again
+     * later on anyway; right when the maximum registration time is over at
+     * the latest.
      */
     mm_dbg ("Modem not yet registered in a 3GPP network... will recheck soon");
-    g_timeout_add_seconds (3, (GSourceFunc)run_registration_checks_again, ctx);
+    if (!ctx->registration_state_changed_id)
+        ctx->registration_state_changed_id =
+            g_signal_connect_swapped (ctx->self,
+                                      "notify::" MM_IFACE_MODEM_3GPP_REGISTRATION_STATE,
+                                      G_CALLBACK (registration_state_changed),
+                                      ctx);
+    if (!ctx->recheck_id)
+        ctx->recheck_id = g_timeout_add_seconds (MIN (REGISTRATION_RECHECK_TIMEOUT_SECS,
+                                                      ctx->max_registration_time - (guint)elapsed + 1),
+                                                 (GSourceFunc)run_registration_checks_again,
+                                                 ctx);
+}
+
+static void
+registration_state_changed (RegisterInNetworkContext *ctx)
+{
+    MMModem3gppRegistrationState current_registration_state;
+
+    /* If a registration check is running, its result will be processed */
+    if (!ctx->recheck_id)
+        return;
+
+    /* Only final states are relevant */
+    current_registration_state = get_consolidated_reg_state (get_registration_state_context (ctx->self));
+    if (current_registration_state != MM_MODEM_3GPP_REGISTRATION_STATE_HOME &&
+        current_registration_state != MM_MODEM_3GPP_REGISTRATION_STATE_ROAMING &&
+        current_registration_state != MM_MODEM_3GPP_REGISTRATION_STATE_DENIED)
+        return;
+
+    g_source_remove (ctx->recheck_id);
+    ctx->recheck_id = 0;
+    register_in_network_context_check_state (ctx, "state update");
+}
+
+static void
+run_registration_checks_ready (MMIfaceModem3gpp *self,
+                               GAsyncResult *res,
+                               RegisterInNetworkContext *ctx)
+{
+    GError *error = NULL;
+
+    mm_iface_modem_3gpp_run_registration_checks_finish (MM_IFACE_MODEM_3GPP (self), res, &error);
+    if (error) {
+        mm_dbg ("3GPP registration check failed: '%s'", error->message);
+        register_in_network_context_failed (ctx, error);
+        register_in_network_context_complete_and_free (ctx);
+        return;
+    }
+
+    register_in_network_context_check_state (ctx, "registration check");
 }
 
 static void
@@ -608,32 +671,205 @@ scan_networks_build_result (GList *info_list)
         g_variant_builder_close (&builder);
     }
 
-    return g_variant_ref (g_variant_builder_end (&builder));
+    return g_variant_builder_end (&builder);
+}
+
+/* Network scan context, shared by all Scan() requests and by the periodic
+ * background scan: there is never more than one scan running in the modem,
+ * and the results of the last one are kept around for a while. */
+typedef struct {
+    /* Results of the last successful scan, and when they were received */
+    GVariant *results;
+    gint64 results_time;
+    /* Requests waiting for the ongoing scan to finish */
+    gboolean running;
+    GList *pending;
+    /* Periodic background scan */
+    guint periodic_id;
+} NetworkScanContext;
+
+static void
+network_scan_context_free (NetworkScanContext *ctx)
+{
+    /* Pending requests hold a reference to the modem, so the context
+     * cannot go away while a scan is running */
+    g_assert (ctx->pending == NULL);
+
+    if (ctx->periodic_id)
+        g_source_remove (ctx->periodic_id);
+    if (ctx->results)
+        g_variant_unref (ctx->results);
+    g_free (ctx);
+}
+
+static NetworkScanContext *
+get_network_scan_context (MMIfaceModem3gpp *self)
+{
+    NetworkScanContext *ctx;
+
+    if (G_UNLIKELY (!network_scan_context_quark))
+        network_scan_context_quark = (g_quark_from_static_string (
+                                          NETWORK_SCAN_CONTEXT_TAG));
+
+    ctx = g_object_get_qdata (G_OBJECT (self), network_scan_context_quark);
+    if (!ctx) {
+        ctx = g_new0 (NetworkScanContext, 1);
+        g_object_set_qdata_full (G_OBJECT (self),
+                                 network_scan_context_quark,
+                                 ctx,
+                                 (GDestroyNotify)network_scan_context_free);
+    }
+
+    return ctx;
+}
+
+static void
+network_scan_results_clear (NetworkScanContext *ctx)
+{
+    if (ctx->results) {
+        g_variant_unref (ctx->results);
+        ctx->results = NULL;
+    }
+    ctx->results_time = 0;
+}
+
+static gboolean
+network_scan_results_fresh (NetworkScanContext *ctx)
+{
+    return (ctx->results &&
+            (g_get_monotonic_time () - ctx->results_time) < (NETWORK_SCAN_RESULTS_MAX_AGE_SEC * G_USEC_PER_SEC));
 }
 
 static void
-handle_scan_ready (MMIfaceModem3gpp *self,
-                   GAsyncResult *res,
-                   HandleScanContext *ctx)
+network_scan_ready (MMIfaceModem3gpp *self,
+                    GAsyncResult *res)
 {
+    NetworkScanContext *ctx;
     GError *error = NULL;
     GList *info_list;
+    GList *pending;
+    GList *l;
+
+    ctx = get_network_scan_context (self);
+    g_assert (ctx->running);
 
     info_list = MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish (self, res, &error);
     if (error)
-        g_dbus_method_invocation_take_error (ctx->invocation, error);
+        mm_dbg ("Couldn't scan networks: '%s'", error->message);
     else {
-        GVariant *dict_array;
+        network_scan_results_clear (ctx);
+        ctx->results = g_variant_ref_sink (scan_networks_build_result (info_list));
+        ctx->results_time = g_get_monotonic_time ();
+        mm_dbg ("Network scan finished: %u networks found", g_list_length (info_list));
+    }
+    mm_3gpp_network_info_list_free (info_list);
 
-        dict_array = scan_networks_build_result (info_list);
-        mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
-                                          ctx->invocation,
-                                          dict_array);
-        g_variant_unref (dict_array);
+    /* Complete all requests that were waiting for this scan */
+    pending = ctx->pending;
+    ctx->pending = NULL;
+    ctx->running = FALSE;
+
+    for (l = pending; l; l = g_list_next (l)) {
+        HandleScanContext *scan_ctx = l->data;
+
+        if (error)
+            g_dbus_method_invocation_return_gerror (scan_ctx->invocation, error);
+        else
+            mm_gdbus_modem3gpp_complete_scan (scan_ctx->skeleton,
+                                              scan_ctx->invocation,
+                                              ctx->results);
     }
 
-    mm_3gpp_network_info_list_free (info_list);
-    handle_scan_context_free (ctx);
+    if (error)
+        g_error_free (error);
+
+    /* The context is not used after this point */
+    g_list_free_full (pending, (GDestroyNotify)handle_scan_context_free);
+    g_object_unref (self);
+}
+
+static void
+network_scan_run (MMIfaceModem3gpp *self,
+                  NetworkScanContext *ctx)
+{
+    if (ctx->running)
+        return;
+
+    mm_dbg ("Launching network scan...");
+    ctx->running = TRUE;
+    MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
+        self,
+        (GAsyncReadyCallback)network_scan_ready,
+        g_object_ref (self));
+}
+
+static gboolean
+periodic_network_scan (MMIfaceModem3gpp *self)
+{
+    NetworkScanContext *ctx;
+    MMModemState modem_state;
+
+    ctx = get_network_scan_context (self);
+
+    /* Background scans have the lowest priority: skip them while a scan is
+     * already running, while results are still fresh, or while the modem is
+     * busy with a connection. */
+    if (ctx->running || network_scan_results_fresh (ctx))
+        return TRUE;
+
+    modem_state = MM_MODEM_STATE_UNKNOWN;
+    g_object_get (self,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+    if (modem_state != MM_MODEM_STATE_ENABLED &&
+        modem_state != MM_MODEM_STATE_SEARCHING &&
+        modem_state != MM_MODEM_STATE_REGISTERED)
+        return TRUE;
+
+    network_scan_run (self, ctx);
+    return TRUE;
+}
+
+static void
+periodic_network_scan_disable (MMIfaceModem3gpp *self)
+{
+    NetworkScanContext *ctx;
+
+    /* Results are meaningless once the modem is disabled */
+    ctx = get_network_scan_context (self);
+    network_scan_results_clear (ctx);
+
+    if (ctx->periodic_id) {
+        g_source_remove (ctx->periodic_id);
+        ctx->periodic_id = 0;
+        mm_dbg ("Periodic 3GPP network scan disabled");
+    }
+}
+
+static void
+periodic_network_scan_enable (MMIfaceModem3gpp *self)
+{
+    NetworkScanContext *ctx;
+    guint interval;
+
+    interval = mm_context_get_network_scan_interval ();
+    if (!interval)
+        return;
+
+    if (!MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks ||
+        !MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks_finish)
+        return;
+
+    ctx = get_network_scan_context (self);
+    if (ctx->periodic_id)
+        return;
+
+    mm_dbg ("Periodic 3GPP network scan enabled (every %u seconds)", interval);
+    ctx->periodic_id = g_timeout_add_seconds_full (G_PRIORITY_LOW,
+                                                   interval,
+                                                   (GSourceFunc)periodic_network_scan,
+                                                   self,
+                                                   NULL);
 }
 
 static void
@@ -696,13 +932,27 @@ handle_scan_auth_ready (MMBaseModem *self,
     case MM_MODEM_STATE_REGISTERED:
     case MM_MODEM_STATE_DISCONNECTING:
     case MM_MODEM_STATE_CONNECTING:
-    case MM_MODEM_STATE_CONNECTED:
-        MM_IFACE_MODEM_3GPP_GET_INTERFACE (self)->scan_networks (
-            MM_IFACE_MODEM_3GPP (self),
-            (GAsyncReadyCallback)handle_scan_ready,
-            ctx);
+    case MM_MODEM_STATE_CONNECTED: {
+        NetworkScanContext *scan_ctx;
+
+        scan_ctx = get_network_scan_context (ctx->self);
+
+        /* Reuse recent enough results */
+        if (network_scan_results_fresh (scan_ctx)) {
+            mm_dbg ("Reusing network scan results from %" G_GINT64_FORMAT " seconds ago",
+                    (g_get_monotonic_time () - scan_ctx->results_time) / G_USEC_PER_SEC);
+            mm_gdbus_modem3gpp_complete_scan (ctx->skeleton,
+                                              ctx->invocation,
+                                              scan_ctx->results);
+            break;
+        }
+
+        /* Otherwise, wait for the ongoing scan or launch a new one */
+        scan_ctx->pending = g_list_append (scan_ctx->pending, ctx);
+        network_scan_run (ctx->self, scan_ctx);
         return;
     }
+    }
 
     handle_scan_context_free (ctx);
 }
@@ -1354,6 +1604,7 @@ static void interface_disabling_step (DisablingContext *ctx);
 
 typedef enum {
     DISABLING_STEP_FIRST,
+    DISABLING_STEP_PERIODIC_NETWORK_SCAN,
     DISABLING_STEP_PERIODIC_REGISTRATION_CHECKS,
     DISABLING_STEP_DISABLE_UNSOLICITED_REGISTRATION_EVENTS,
     DISABLING_STEP_CLEANUP_UNSOLICITED_REGISTRATION_EVENTS,
@@ -1426,6 +1677,12 @@ interface_disabling_step (DisablingContext *ctx)
         /* Fall down to next step */
         ctx->step++;
 
+    case DISABLING_STEP_PERIODIC_NETWORK_SCAN:
+        /* Disable periodic network scan and drop cached results */
+        periodic_network_scan_disable (ctx->self);
+        /* Fall down to next step */
+        ctx->step++;
+
     case DISABLING_STEP_PERIODIC_REGISTRATION_CHECKS:
         /* Disable periodic registration checks, if they were set */
         periodic_registration_check_disable (ctx->self);
@@ -1552,6 +1809,7 @@ typedef enum {
     ENABLING_STEP_SETUP_UNSOLICITED_REGISTRATION_EVENTS,
     ENABLING_STEP_ENABLE_UNSOLICITED_REGISTRATION_EVENTS,
     ENABLING_STEP_RUN_REGISTRATION_CHECKS,
+    ENABLING_STEP_PERIODIC_NETWORK_SCAN,
     ENABLING_STEP_LAST
 } EnablingStep;
 
@@ -1789,6 +2047,12 @@ interface_enabling_step (EnablingContext *ctx)
             ctx);
         return;
 
+    case ENABLING_STEP_PERIODIC_NETWORK_SCAN:
+        /* Enable periodic background network scan, if requested */
+        periodic_network_scan_enable (ctx->self);
+        /* Fall down to next step */
+        ctx->step++;
+
     case ENABLING_STEP_LAST:
         /* We are done without errors! */
         g_simple_async_result_set_op_res_gboolean (ctx->result, TRUE);
@@ -2090,6 +2354,10 @@ mm_iface_modem_3gpp_shutdown (MMIfaceModem3gpp *self)
                             registration_check_context_quark,
                             NULL);
 
+    /* Stop the periodic network scan, if any */
+    if (G_LIKELY (network_scan_context_quark))
+        periodic_network_scan_disable (self);
+
     /* Unexport DBus interface and remove the skeleton */
     mm_gdbus_object_skeleton_set_modem3gpp (MM_GDBUS_OBJECT_SKELETON (self), NULL);
     g_object_set (self,
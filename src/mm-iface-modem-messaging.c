@@ -20,7 +20,9 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-messaging.h"
 #include "mm-sms-list.h"
+#include "mm-modem-helpers.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 
 #define SUPPORT_CHECKED_TAG "messaging-support-checked-tag"
 #define SUPPORTED_TAG       "messaging-supported-tag"
@@ -408,6 +410,120 @@ handle_list (MmGdbusModemMessaging *skeleton,
 
 /*****************************************************************************/
 
+static gboolean
+parse_list_full_filter (GVariant *filter,
+                        MMSmsState *state,
+                        MMSmsStorage *storage,
+                        gint64 *since,
+                        GError **error)
+{
+    GVariantIter iter;
+    gchar *key;
+    GVariant *value;
+
+    *state = MM_SMS_STATE_UNKNOWN;
+    *storage = MM_SMS_STORAGE_UNKNOWN;
+    *since = -1;
+
+    g_variant_iter_init (&iter, filter);
+    while (g_variant_iter_next (&iter, "{sv}", &key, &value)) {
+        gboolean valid = FALSE;
+
+        if (g_str_equal (key, "state") &&
+            g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32)) {
+            *state = (MMSmsState) g_variant_get_uint32 (value);
+            valid = TRUE;
+        } else if (g_str_equal (key, "storage") &&
+                   g_variant_is_of_type (value, G_VARIANT_TYPE_UINT32)) {
+            *storage = (MMSmsStorage) g_variant_get_uint32 (value);
+            valid = TRUE;
+        } else if (g_str_equal (key, "since") &&
+                   g_variant_is_of_type (value, G_VARIANT_TYPE_STRING)) {
+            valid = mm_iso8601_time_to_unix (g_variant_get_string (value, NULL), since);
+        }
+
+        if (!valid)
+            g_set_error (error,
+                         MM_CORE_ERROR,
+                         MM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid SMS list filter '%s'",
+                         key);
+
+        g_variant_unref (value);
+        g_free (key);
+
+        if (!valid)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+handle_list_full (MmGdbusModemMessaging *skeleton,
+                  GDBusMethodInvocation *invocation,
+                  GVariant *filter,
+                  const gchar *cursor,
+                  guint limit,
+                  MMIfaceModemMessaging *self)
+{
+    MMSmsList *list = NULL;
+    MMModemState modem_state;
+    MMSmsState state;
+    MMSmsStorage storage;
+    gint64 since;
+    GVariant *messages;
+    gchar *next_cursor = NULL;
+    GError *error = NULL;
+
+    modem_state = MM_MODEM_STATE_UNKNOWN;
+    g_object_get (self,
+                  MM_IFACE_MODEM_STATE, &modem_state,
+                  NULL);
+
+    if (modem_state < MM_MODEM_STATE_ENABLED) {
+        g_dbus_method_invocation_return_error (invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot list SMS messages: "
+                                               "device not yet enabled");
+        return TRUE;
+    }
+
+    if (!parse_list_full_filter (filter, &state, &storage, &since, &error)) {
+        g_dbus_method_invocation_take_error (invocation, error);
+        return TRUE;
+    }
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_MESSAGING_SMS_LIST, &list,
+                  NULL);
+    if (!list) {
+        g_dbus_method_invocation_return_error (invocation,
+                                               MM_CORE_ERROR,
+                                               MM_CORE_ERROR_WRONG_STATE,
+                                               "Cannot list SMS: missing SMS list");
+        return TRUE;
+    }
+
+    messages = mm_sms_list_get_full (list, state, storage, since, cursor, limit, &next_cursor, &error);
+    if (!messages) {
+        g_dbus_method_invocation_take_error (invocation, error);
+        g_object_unref (list);
+        return TRUE;
+    }
+
+    mm_gdbus_modem_messaging_complete_list_full (skeleton,
+                                                 invocation,
+                                                 messages,
+                                                 next_cursor);
+    g_free (next_cursor);
+    g_object_unref (list);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 gboolean
 mm_iface_modem_messaging_take_part (MMIfaceModemMessaging *self,
                                     MMSmsPart *sms_part,
@@ -905,6 +1021,12 @@ interface_enabling_step (EnablingContext *ctx)
     if (enabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "iface-messaging-enabling",
+                   ctx,
+                   ctx->step,
+                   ctx->step == ENABLING_STEP_LAST);
+
     switch (ctx->step) {
     case ENABLING_STEP_FIRST: {
         MMSmsList *list;
@@ -1219,6 +1341,12 @@ interface_initialization_step (InitializationContext *ctx)
     if (initialization_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "iface-messaging-initialization",
+                   ctx,
+                   ctx->step,
+                   ctx->step == INITIALIZATION_STEP_LAST);
+
     switch (ctx->step) {
     case INITIALIZATION_STEP_FIRST:
         /* Setup quarks if we didn't do it before */
@@ -1300,6 +1428,10 @@ interface_initialization_step (InitializationContext *ctx)
                           "handle-list",
                           G_CALLBACK (handle_list),
                           ctx->self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-list-full",
+                          G_CALLBACK (handle_list_full),
+                          ctx->self);
 
         /* Finally, export the new interface */
         mm_gdbus_object_skeleton_set_modem_messaging (MM_GDBUS_OBJECT_SKELETON (ctx->self),
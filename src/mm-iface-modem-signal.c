@@ -72,33 +72,16 @@ clear_values (MMIfaceModemSignal *self)
 }
 
 static void
-load_values_ready (MMIfaceModemSignal *self,
-                   GAsyncResult *res)
+update_values (MMIfaceModemSignal *self,
+               MMSignal *cdma,
+               MMSignal *evdo,
+               MMSignal *gsm,
+               MMSignal *umts,
+               MMSignal *lte)
 {
     GVariant *dictionary;
-    GError *error = NULL;
-    MMSignal *cdma = NULL;
-    MMSignal *evdo = NULL;
-    MMSignal *gsm = NULL;
-    MMSignal *umts = NULL;
-    MMSignal *lte = NULL;
     MmGdbusModemSignal *skeleton;
 
-    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
-            self,
-            res,
-            &cdma,
-            &evdo,
-            &gsm,
-            &umts,
-            &lte,
-            &error)) {
-        mm_warn ("Couldn't load extended signal information: %s", error->message);
-        g_error_free (error);
-        clear_values (self);
-        return;
-    }
-
     g_object_get (self,
                   MM_IFACE_MODEM_SIGNAL_DBUS_SKELETON, &skeleton,
                   NULL);
@@ -112,35 +95,30 @@ load_values_ready (MMIfaceModemSignal *self,
         dictionary = mm_signal_get_dictionary (cdma);
         mm_gdbus_modem_signal_set_cdma (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (cdma);
     }
 
     if (evdo) {
         dictionary = mm_signal_get_dictionary (evdo);
         mm_gdbus_modem_signal_set_evdo (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (evdo);
     }
 
     if (gsm) {
         dictionary = mm_signal_get_dictionary (gsm);
         mm_gdbus_modem_signal_set_gsm (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (gsm);
     }
 
     if (umts) {
         dictionary = mm_signal_get_dictionary (umts);
         mm_gdbus_modem_signal_set_umts (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (umts);
     }
 
     if (lte) {
         dictionary = mm_signal_get_dictionary (lte);
         mm_gdbus_modem_signal_set_lte (skeleton, dictionary);
         g_variant_unref (dictionary);
-        g_object_unref (lte);
     }
 
     /* Flush right away */
@@ -149,14 +127,82 @@ load_values_ready (MMIfaceModemSignal *self,
     g_object_unref (skeleton);
 }
 
-static gboolean
-refresh_context_cb (MMIfaceModemSignal *self)
+void
+mm_iface_modem_signal_update (MMIfaceModemSignal *self,
+                              MMSignal *cdma,
+                              MMSignal *evdo,
+                              MMSignal *gsm,
+                              MMSignal *umts,
+                              MMSignal *lte)
+{
+    RefreshContext *ctx;
+
+    /* Values are only exposed while the user has reporting enabled */
+    if (G_UNLIKELY (!refresh_context_quark))
+        refresh_context_quark  = g_quark_from_static_string (REFRESH_CONTEXT_TAG);
+    ctx = g_object_get_qdata (G_OBJECT (self), refresh_context_quark);
+    if (!ctx || !ctx->rate)
+        return;
+
+    update_values (self, cdma, evdo, gsm, umts, lte);
+}
+
+static void
+load_values_ready (MMIfaceModemSignal *self,
+                   GAsyncResult *res)
+{
+    GError *error = NULL;
+    MMSignal *cdma = NULL;
+    MMSignal *evdo = NULL;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    if (!MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values_finish (
+            self,
+            res,
+            &cdma,
+            &evdo,
+            &gsm,
+            &umts,
+            &lte,
+            &error)) {
+        mm_warn ("Couldn't load extended signal information: %s", error->message);
+        g_error_free (error);
+        clear_values (self);
+        return;
+    }
+
+    update_values (self, cdma, evdo, gsm, umts, lte);
+
+    g_clear_object (&cdma);
+    g_clear_object (&evdo);
+    g_clear_object (&gsm);
+    g_clear_object (&umts);
+    g_clear_object (&lte);
+}
+
+static void
+load_values (MMIfaceModemSignal *self)
 {
     MM_IFACE_MODEM_SIGNAL_GET_INTERFACE (self)->load_values (
         self,
         NULL,
         (GAsyncReadyCallback)load_values_ready,
         NULL);
+}
+
+static gboolean
+refresh_context_cb (MMIfaceModemSignal *self)
+{
+    gboolean periodic_check_disabled = FALSE;
+
+    /* No need to poll if the modem reports changes by itself */
+    g_object_get (self,
+                  MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED, &periodic_check_disabled,
+                  NULL);
+    if (!periodic_check_disabled)
+        load_values (self);
     return TRUE;
 }
 
@@ -237,8 +283,9 @@ setup_refresh_context (MMIfaceModemSignal *self,
         g_source_remove (ctx->timeout_source);
     ctx->timeout_source = g_timeout_add_seconds (ctx->rate, (GSourceFunc) refresh_context_cb, self);
 
-    /* Also launch right away */
-    refresh_context_cb (self);
+    /* Also launch right away, so that there is a first value even when
+     * further updates come from the modem itself */
+    load_values (self);
 
     return TRUE;
 }
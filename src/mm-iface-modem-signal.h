@@ -88,6 +88,15 @@ gboolean mm_iface_modem_signal_disable_finish (MMIfaceModemSignal *self,
 /* Shutdown Signal interface */
 void mm_iface_modem_signal_shutdown (MMIfaceModemSignal *self);
 
+/* Update extended signal values with ones reported by the modem itself;
+ * ignored unless reporting is enabled. Any of them may be NULL. */
+void mm_iface_modem_signal_update (MMIfaceModemSignal *self,
+                                   MMSignal *cdma,
+                                   MMSignal *evdo,
+                                   MMSignal *gsm,
+                                   MMSignal *umts,
+                                   MMSignal *lte);
+
 /* Bind properties for simple GetStatus() */
 void mm_iface_modem_signal_bind_simple_status (MMIfaceModemSignal *self,
                                                MMSimpleStatus *status);
@@ -27,6 +27,7 @@
 #include "mm-iface-modem-cdma.h"
 #include "mm-iface-modem-simple.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 
 /*****************************************************************************/
 /* Register in either a CDMA or a 3GPP network (or both) */
@@ -192,11 +193,16 @@ typedef struct {
 
     /* Results to set */
     MMBaseBearer *bearer;
+
+    /* Time since the connection request, and since the registration */
+    GTimer *timer;
+    gdouble registered_time;
 } ConnectionContext;
 
 static void
 connection_context_free (ConnectionContext *ctx)
 {
+    g_timer_destroy (ctx->timer);
     g_variant_unref (ctx->dictionary);
     if (ctx->properties)
         g_object_unref (ctx->properties);
@@ -263,6 +269,7 @@ register_in_3gpp_or_cdma_network_ready (MMIfaceModemSimple *self,
     }
 
     /* Registered now! */
+    ctx->registered_time = g_timer_elapsed (ctx->timer, NULL);
     ctx->step++;
     connection_step (ctx);
 }
@@ -433,6 +440,12 @@ bearer_list_find_disconnected (MMBaseBearer *bearer,
 static void
 connection_step (ConnectionContext *ctx)
 {
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "simple-connect",
+                   ctx,
+                   ctx->step,
+                   ctx->step == CONNECTION_STEP_LAST);
+
     switch (ctx->step) {
     case CONNECTION_STEP_FIRST:
         /* Fall down to next step */
@@ -600,6 +613,9 @@ connection_step (ConnectionContext *ctx)
     case CONNECTION_STEP_LAST:
         mm_info ("Simple connect state (%d/%d): All done",
                  ctx->step, CONNECTION_STEP_LAST);
+        mm_dbg ("Simple connect finished in %.3lfs (%.3lfs since registered)",
+                g_timer_elapsed (ctx->timer, NULL),
+                g_timer_elapsed (ctx->timer, NULL) - ctx->registered_time);
         /* All done, yey! */
         mm_gdbus_modem_simple_complete_connect (
             ctx->skeleton,
@@ -731,6 +747,7 @@ handle_connect (MmGdbusModemSimple *skeleton,
     ctx->invocation = g_object_ref (invocation);
     ctx->self = g_object_ref (self);
     ctx->dictionary = g_variant_ref (dictionary);
+    ctx->timer = g_timer_new ();
 
     mm_base_modem_authorize (MM_BASE_MODEM (self),
                              invocation,
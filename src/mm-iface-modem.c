@@ -25,6 +25,7 @@
 #include "mm-base-sim.h"
 #include "mm-bearer-list.h"
 #include "mm-log.h"
+#include "mm-trace.h"
 #include "mm-context.h"
 
 #define SIGNAL_QUALITY_RECENT_TIMEOUT_SEC        60
@@ -1122,9 +1123,11 @@ update_signal_quality (MMIfaceModem *self,
     SignalQualityUpdateContext *ctx;
     MmGdbusModem *skeleton = NULL;
     const gchar *dbus_path;
+    gboolean periodic_check_disabled = FALSE;
 
     g_object_get (self,
                   MM_IFACE_MODEM_DBUS_SKELETON, &skeleton,
+                  MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED, &periodic_check_disabled,
                   NULL);
 
     /* Don't process updates if the interface is shut down */
@@ -1170,8 +1173,9 @@ update_signal_quality (MMIfaceModem *self,
         ctx->recent_timeout_source = 0;
     }
 
-    /* If we got a new expirable value, setup new timeout */
-    if (expire)
+    /* If we got a new expirable value, setup new timeout. Values reported by
+     * the modem itself stay valid until it reports a new one. */
+    if (expire && !periodic_check_disabled)
         ctx->recent_timeout_source = (g_timeout_add_seconds (
                                           SIGNAL_QUALITY_RECENT_TIMEOUT_SEC,
                                           (GSourceFunc)expire_signal_quality,
@@ -1187,6 +1191,29 @@ mm_iface_modem_update_signal_quality (MMIfaceModem *self,
     update_signal_quality (self, signal_quality, TRUE);
 }
 
+static void
+periodic_signal_check_disabled_updated (MMIfaceModem *self,
+                                        GParamSpec *pspec)
+{
+    SignalQualityUpdateContext *ctx;
+    gboolean periodic_check_disabled = FALSE;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED, &periodic_check_disabled,
+                  NULL);
+    if (!periodic_check_disabled || G_UNLIKELY (!signal_quality_update_context_quark))
+        return;
+
+    /* A value loaded before the modem started reporting changes by itself may
+     * have setup an expiration timeout; it won't be refreshed by polling any
+     * more, so don't let it mark the value as not being recent */
+    ctx = g_object_get_qdata (G_OBJECT (self), signal_quality_update_context_quark);
+    if (ctx && ctx->recent_timeout_source) {
+        g_source_remove (ctx->recent_timeout_source);
+        ctx->recent_timeout_source = 0;
+    }
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -1204,7 +1231,7 @@ signal_quality_check_context_free (SignalQualityCheckContext *ctx)
     g_free (ctx);
 }
 
-static gboolean periodic_signal_quality_check (MMIfaceModem *self);
+static gboolean periodic_signal_quality_check_cb (MMIfaceModem *self);
 
 static void
 signal_quality_check_ready (MMIfaceModem *self,
@@ -1235,7 +1262,7 @@ signal_quality_check_ready (MMIfaceModem *self,
                 mm_dbg ("Periodic signal quality checks rescheduled (interval = %ds)", ctx->interval);
                 g_source_remove(ctx->timeout_source);
                 ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
-                                                             (GSourceFunc)periodic_signal_quality_check,
+                                                             (GSourceFunc)periodic_signal_quality_check_cb,
                                                              self);
             }
         }
@@ -1264,6 +1291,22 @@ periodic_signal_quality_check (MMIfaceModem *self)
     return TRUE;
 }
 
+static gboolean
+periodic_signal_quality_check_cb (MMIfaceModem *self)
+{
+    gboolean periodic_check_disabled = FALSE;
+
+    /* If the modem reports signal quality changes by itself, there is no need
+     * to poll; the first value is still loaded when enabling */
+    g_object_get (self,
+                  MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED, &periodic_check_disabled,
+                  NULL);
+    if (periodic_check_disabled)
+        return TRUE;
+
+    return periodic_signal_quality_check (self);
+}
+
 static void
 periodic_signal_quality_check_disable (MMIfaceModem *self)
 {
@@ -1315,7 +1358,7 @@ periodic_signal_quality_check_enable (MMIfaceModem *self)
     ctx->initial_retries = 5;
     mm_dbg ("Periodic signal quality checks enabled (interval = %ds)", ctx->interval);
     ctx->timeout_source = g_timeout_add_seconds (ctx->interval,
-                                                 (GSourceFunc)periodic_signal_quality_check,
+                                                 (GSourceFunc)periodic_signal_quality_check_cb,
                                                  self);
     g_object_set_qdata_full (G_OBJECT (self),
                              signal_quality_check_context_quark,
@@ -3575,6 +3618,12 @@ interface_enabling_step (EnablingContext *ctx)
     if (enabling_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "iface-modem-enabling",
+                   ctx,
+                   ctx->step,
+                   ctx->step == ENABLING_STEP_LAST);
+
     switch (ctx->step) {
     case ENABLING_STEP_FIRST:
         /* Fall down to next step */
@@ -4176,6 +4225,12 @@ interface_initialization_step (InitializationContext *ctx)
     if (initialization_context_complete_and_free_if_cancelled (ctx))
         return;
 
+    mm_trace_step (mm_base_modem_get_device (MM_BASE_MODEM (ctx->self)),
+                   "iface-modem-initialization",
+                   ctx,
+                   ctx->step,
+                   ctx->step == INITIALIZATION_STEP_LAST);
+
     switch (ctx->step) {
     case INITIALIZATION_STEP_FIRST:
         /* Load device if not done before */
@@ -4777,6 +4832,13 @@ mm_iface_modem_initialize (MMIfaceModem *self,
                                 skeleton, "state",
                                 G_BINDING_DEFAULT | G_BINDING_SYNC_CREATE);
 
+        /* Want to get notified when the modem starts reporting signal
+         * quality changes by itself */
+        g_signal_connect (self,
+                          "notify::" MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED,
+                          G_CALLBACK (periodic_signal_check_disabled_updated),
+                          NULL);
+
         g_object_set (self,
                       MM_IFACE_MODEM_DBUS_SKELETON, skeleton,
                       NULL);
@@ -5086,6 +5148,15 @@ iface_modem_init (gpointer g_iface)
                               MM_TYPE_BEARER_LIST,
                               G_PARAM_READWRITE));
 
+    g_object_interface_install_property
+        (g_iface,
+         g_param_spec_boolean (MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED,
+                               "Periodic signal quality check disabled",
+                               "Whether periodic signal quality checks are disabled, "
+                               "e.g. because the modem reports changes by itself",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
     initialized = TRUE;
 }
 
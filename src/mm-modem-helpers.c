@@ -246,6 +246,43 @@ mm_new_iso8601_time (guint year,
     return g_string_free (str, FALSE);
 }
 
+gboolean
+mm_iso8601_time_to_unix (const gchar *str,
+                         gint64 *out_unix_time)
+{
+    guint year, month, day, hour, minute, second;
+    guint offset_hours = 0;
+    guint offset_minutes = 0;
+    gint offset_sign = 0;
+    gint consumed = 0;
+    GDateTime *dt;
+
+    /* Parses the strings built by mm_new_iso8601_time(); if no offset is
+     * given, UTC is assumed */
+    if (!str ||
+        sscanf (str, "%4u-%2u-%2uT%2u:%2u:%2u%n",
+                &year, &month, &day, &hour, &minute, &second, &consumed) != 6)
+        return FALSE;
+
+    str += consumed;
+    if (*str == '+' || *str == '-') {
+        offset_sign = (*str == '+' ? 1 : -1);
+        if (sscanf (str + 1, "%2u:%2u", &offset_hours, &offset_minutes) < 1)
+            return FALSE;
+    } else if (*str != '\0' && *str != 'Z')
+        return FALSE;
+
+    dt = g_date_time_new_utc (year, month, day, hour, minute, (gdouble) second);
+    if (!dt)
+        return FALSE;
+
+    if (out_unix_time)
+        *out_unix_time = (g_date_time_to_unix (dt) -
+                          offset_sign * (gint64)(offset_hours * 3600 + offset_minutes * 60));
+    g_date_time_unref (dt);
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 GArray *
@@ -906,6 +943,85 @@ mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
 
 /*************************************************************************/
 
+static void
+mm_3gpp_pdp_context_active_free (MM3gppPdpContextActive *pdp_active)
+{
+    g_slice_free (MM3gppPdpContextActive, pdp_active);
+}
+
+void
+mm_3gpp_pdp_context_active_list_free (GList *pdp_active_list)
+{
+    g_list_free_full (pdp_active_list, (GDestroyNotify) mm_3gpp_pdp_context_active_free);
+}
+
+static gint
+mm_3gpp_pdp_context_active_cmp (MM3gppPdpContextActive *a,
+                                MM3gppPdpContextActive *b)
+{
+    return (a->cid - b->cid);
+}
+
+GList *
+mm_3gpp_parse_cgact_read_response (const gchar *reply,
+                                   GError **error)
+{
+    GError *inner_error = NULL;
+    GRegex *r;
+    GMatchInfo *match_info;
+    GList *list;
+
+    if (!reply || !reply[0])
+        /* Nothing configured, all done */
+        return NULL;
+
+    list = NULL;
+    r = g_regex_new ("\\+CGACT:\\s*(\\d+)\\s*,\\s*(\\d+)",
+                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
+                     0, &inner_error);
+    if (r) {
+        g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
+
+        while (!inner_error &&
+               g_match_info_matches (match_info)) {
+            MM3gppPdpContextActive *pdp_active;
+            guint state = 0;
+
+            pdp_active = g_slice_new0 (MM3gppPdpContextActive);
+            if (!mm_get_uint_from_match_info (match_info, 1, &pdp_active->cid) ||
+                !mm_get_uint_from_match_info (match_info, 2, &state) ||
+                state > 1) {
+                inner_error = g_error_new (MM_CORE_ERROR,
+                                           MM_CORE_ERROR_FAILED,
+                                           "Couldn't parse CGACT state from reply: '%s'",
+                                           reply);
+                mm_3gpp_pdp_context_active_free (pdp_active);
+                break;
+            }
+            pdp_active->active = (state == 1);
+
+            list = g_list_prepend (list, pdp_active);
+            g_match_info_next (match_info, &inner_error);
+        }
+
+        g_match_info_free (match_info);
+        g_regex_unref (r);
+    }
+
+    if (inner_error) {
+        mm_3gpp_pdp_context_active_list_free (list);
+        g_propagate_error (error, inner_error);
+        g_prefix_error (error, "Couldn't properly parse list of active/inactive PDP contexts. ");
+        return NULL;
+    }
+
+    list = g_list_sort (list, (GCompareFunc)mm_3gpp_pdp_context_active_cmp);
+
+    return list;
+}
+
+/*************************************************************************/
+
 static gulong
 parse_uint (char *str, int base, glong nmin, glong nmax, gboolean *valid)
 {
@@ -1449,6 +1565,191 @@ mm_3gpp_parse_cnum_exec_response (const gchar *reply,
 
 /*************************************************************************/
 
+gboolean
+mm_3gpp_parse_cesq_response (const gchar *response,
+                             guint *out_rxlev,
+                             guint *out_ber,
+                             guint *out_rscp,
+                             guint *out_ecn0,
+                             guint *out_rsrq,
+                             guint *out_rsrp,
+                             GError **error)
+{
+    GRegex *r;
+    GMatchInfo *match_info;
+    gboolean success = FALSE;
+
+    g_assert (out_rxlev != NULL);
+    g_assert (out_ber != NULL);
+    g_assert (out_rscp != NULL);
+    g_assert (out_ecn0 != NULL);
+    g_assert (out_rsrq != NULL);
+    g_assert (out_rsrp != NULL);
+
+    /* Format:
+     *
+     * +CESQ: <rxlev>,<ber>,<rscp>,<ecn0>,<rsrq>,<rsrp>
+     *
+     * Some modems append vendor-specific fields, which we ignore.
+     */
+    r = g_regex_new ("\\+CESQ:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,"
+                     "\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)",
+                     0, 0, NULL);
+    g_assert (r != NULL);
+
+    if (g_regex_match (r, response, 0, &match_info) &&
+        mm_get_uint_from_match_info (match_info, 1, out_rxlev) &&
+        mm_get_uint_from_match_info (match_info, 2, out_ber) &&
+        mm_get_uint_from_match_info (match_info, 3, out_rscp) &&
+        mm_get_uint_from_match_info (match_info, 4, out_ecn0) &&
+        mm_get_uint_from_match_info (match_info, 5, out_rsrq) &&
+        mm_get_uint_from_match_info (match_info, 6, out_rsrp))
+        success = TRUE;
+    else
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "Couldn't parse +CESQ response: '%s'",
+                     response);
+
+    g_match_info_free (match_info);
+    g_regex_unref (r);
+    return success;
+}
+
+/* Each index covers a 1 dBm (or 0.5 dB) range, starting below the given
+ * minimum; we report the lower bound of the range. */
+
+static gboolean
+cesq_rxlev_to_rssi (guint rxlev,
+                    gdouble *out)
+{
+    /* 0: below -110 dBm ... 63: -48 dBm or above; 99: unknown */
+    if (rxlev > 63)
+        return FALSE;
+    *out = -111.0 + rxlev;
+    return TRUE;
+}
+
+static gboolean
+cesq_rscp_to_rscp (guint rscp,
+                   gdouble *out)
+{
+    /* 0: below -120 dBm ... 96: -25 dBm or above; 255: unknown */
+    if (rscp > 96)
+        return FALSE;
+    *out = -121.0 + rscp;
+    return TRUE;
+}
+
+static gboolean
+cesq_ecn0_to_ecio (guint ecn0,
+                   gdouble *out)
+{
+    /* 0: below -24 dB ... 49: 0 dB or above; 255: unknown */
+    if (ecn0 > 49)
+        return FALSE;
+    *out = -24.5 + ((gdouble) ecn0 * 0.5);
+    return TRUE;
+}
+
+static gboolean
+cesq_rsrq_to_rsrq (guint rsrq,
+                   gdouble *out)
+{
+    /* 0: below -19.5 dB ... 34: -3 dB or above; 255: unknown */
+    if (rsrq > 34)
+        return FALSE;
+    *out = -20.0 + ((gdouble) rsrq * 0.5);
+    return TRUE;
+}
+
+static gboolean
+cesq_rsrp_to_rsrp (guint rsrp,
+                   gdouble *out)
+{
+    /* 0: below -140 dBm ... 97: -44 dBm or above; 255: unknown */
+    if (rsrp > 97)
+        return FALSE;
+    *out = -141.0 + rsrp;
+    return TRUE;
+}
+
+gboolean
+mm_3gpp_cesq_response_to_signal_info (const gchar *response,
+                                      MMSignal **out_gsm,
+                                      MMSignal **out_umts,
+                                      MMSignal **out_lte,
+                                      GError **error)
+{
+    guint rxlev = 0;
+    guint ber = 0;
+    guint rscp_level = 0;
+    guint ecn0_level = 0;
+    guint rsrq_level = 0;
+    guint rsrp_level = 0;
+    gdouble rssi = 0.0;
+    gdouble rscp = 0.0;
+    gdouble ecio = 0.0;
+    gdouble rsrq = 0.0;
+    gdouble rsrp = 0.0;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    g_assert (out_gsm != NULL);
+    g_assert (out_umts != NULL);
+    g_assert (out_lte != NULL);
+
+    if (!mm_3gpp_parse_cesq_response (response,
+                                      &rxlev, &ber,
+                                      &rscp_level, &ecn0_level,
+                                      &rsrq_level, &rsrp_level,
+                                      error))
+        return FALSE;
+
+    /* GERAN */
+    if (cesq_rxlev_to_rssi (rxlev, &rssi)) {
+        gsm = mm_signal_new ();
+        mm_signal_set_rssi (gsm, rssi);
+    }
+
+    /* UTRAN; there is no RSCP in MMSignal, but as Ec/Io is RSCP over the
+     * carrier RSSI, the latter can be computed when both are given */
+    if (cesq_ecn0_to_ecio (ecn0_level, &ecio)) {
+        umts = mm_signal_new ();
+        mm_signal_set_ecio (umts, ecio);
+        if (cesq_rscp_to_rscp (rscp_level, &rscp))
+            mm_signal_set_rssi (umts, rscp - ecio);
+    }
+
+    /* E-UTRAN */
+    if (cesq_rsrq_to_rsrq (rsrq_level, &rsrq)) {
+        lte = mm_signal_new ();
+        mm_signal_set_rsrq (lte, rsrq);
+    }
+    if (cesq_rsrp_to_rsrp (rsrp_level, &rsrp)) {
+        if (!lte)
+            lte = mm_signal_new ();
+        mm_signal_set_rsrp (lte, rsrp);
+    }
+
+    if (!gsm && !umts && !lte) {
+        g_set_error (error,
+                     MM_CORE_ERROR,
+                     MM_CORE_ERROR_FAILED,
+                     "No valid signal information in +CESQ response");
+        return FALSE;
+    }
+
+    *out_gsm = gsm;
+    *out_umts = umts;
+    *out_lte = lte;
+    return TRUE;
+}
+
+/*************************************************************************/
+
 struct MM3gppCindResponse {
     gchar *desc;
     guint idx;
@@ -1699,8 +2000,8 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
         if (mm_get_int_from_match_info (match_info, 1, &info->index) &&
             mm_get_int_from_match_info (match_info, 2, &info->status) &&
             (info->pdu = mm_get_string_unquoted_from_match_info (match_info, 4)) != NULL) {
-            /* Append to our list of results and keep on */
-            list = g_list_append (list, info);
+            /* Prepend to our list of results and keep on */
+            list = g_list_prepend (list, info);
             g_match_info_next (match_info, &inner_error);
         } else {
             inner_error = g_error_new (MM_CORE_ERROR,
@@ -1719,7 +2020,33 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
         return NULL;
     }
 
-    return list;
+    return g_list_reverse (list);
+}
+
+gboolean
+mm_3gpp_parse_pdu_cmgl_header (const gchar *line,
+                               gint *out_index,
+                               gint *out_status)
+{
+    gint index;
+    gint status;
+
+    /* Single header line of a streamed AT+CMGL=4 reply, the PDU itself
+     * comes in the next line:
+     * +CMGL: <index>, <status>, [<alpha>], <length>
+     *   or
+     * +CMGL: <index>, <status>, <length>
+     */
+    while (g_ascii_isspace (*line))
+        line++;
+    if (sscanf (line, "+CMGL:%d ,%d", &index, &status) != 2)
+        return FALSE;
+
+    if (out_index)
+        *out_index = index;
+    if (out_status)
+        *out_status = status;
+    return TRUE;
 }
 
 /*************************************************************************/
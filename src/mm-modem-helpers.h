@@ -19,6 +19,8 @@
 #define MM_MODEM_HELPERS_H
 
 #include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
 
 #include "glib-object.h"
 #include "mm-charsets.h"
@@ -72,6 +74,8 @@ gchar *mm_new_iso8601_time (guint year,
                             guint second,
                             gboolean have_offset,
                             gint offset_minutes);
+gboolean mm_iso8601_time_to_unix (const gchar *str,
+                                  gint64 *out_unix_time);
 
 GArray *mm_filter_supported_modes (const GArray *all,
                                    const GArray *supported_combinations);
@@ -124,6 +128,15 @@ void mm_3gpp_pdp_context_list_free (GList *pdp_list);
 GList *mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
                                             GError **error);
 
+/* AT+CGACT? (PDP context activation state query) response parser */
+typedef struct {
+    guint cid;
+    gboolean active;
+} MM3gppPdpContextActive;
+void mm_3gpp_pdp_context_active_list_free (GList *pdp_active_list);
+GList *mm_3gpp_parse_cgact_read_response (const gchar *reply,
+                                          GError **error);
+
 /* CREG/CGREG response/unsolicited message parser */
 gboolean mm_3gpp_parse_creg_response (GMatchInfo *info,
                                       MMModem3gppRegistrationState *out_reg_state,
@@ -162,6 +175,21 @@ gboolean mm_3gpp_parse_clck_write_response (const gchar *reply,
 GStrv mm_3gpp_parse_cnum_exec_response (const gchar *reply,
                                         GError **error);
 
+/* AT+CESQ (Extended signal quality) response parser */
+gboolean mm_3gpp_parse_cesq_response (const gchar *response,
+                                      guint *out_rxlev,
+                                      guint *out_ber,
+                                      guint *out_rscp,
+                                      guint *out_ecn0,
+                                      guint *out_rsrq,
+                                      guint *out_rsrp,
+                                      GError **error);
+gboolean mm_3gpp_cesq_response_to_signal_info (const gchar *response,
+                                               MMSignal **out_gsm,
+                                               MMSignal **out_umts,
+                                               MMSignal **out_lte,
+                                               GError **error);
+
 /* AT+CIND=? (Supported indicators) response parser */
 typedef struct MM3gppCindResponse MM3gppCindResponse;
 GHashTable  *mm_3gpp_parse_cind_test_response    (const gchar *reply,
@@ -184,6 +212,10 @@ typedef struct {
 void   mm_3gpp_pdu_info_list_free      (GList *info_list);
 GList *mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                         GError **error);
+/* Single header line of a streamed AT+CMGL=4 response */
+gboolean mm_3gpp_parse_pdu_cmgl_header (const gchar *line,
+                                        gint *out_index,
+                                        gint *out_status);
 
 
 /* Additional 3GPP-specific helpers */
@@ -61,6 +61,16 @@ struct _MMPluginManagerPrivate {
     GList *plugins;
     /* Last, the generic plugin. */
     MMPlugin *generic;
+
+    /* Index of the mandatory pre-probing filters of the plugins, built once
+     * all plugins are loaded. Each table maps a filter value to a GSList of
+     * indexes in the plugins array. */
+    GPtrArray *plugins_array;
+    guint8 *plugins_mandatory_filters;
+    GHashTable *plugins_by_driver;
+    GHashTable *plugins_by_vendor;
+    GHashTable *plugins_by_product;
+    GHashTable *plugins_by_udev_tag;
 };
 
 /*****************************************************************************/
@@ -598,6 +608,172 @@ port_probe_context_step (PortProbeContext *port_probe_ctx)
                              port_probe_ctx);
 }
 
+/*****************************************************************************/
+/* Plugin filter index */
+
+enum {
+    MANDATORY_FILTER_DRIVERS   = 1 << 0,
+    MANDATORY_FILTER_IDS       = 1 << 1,
+    MANDATORY_FILTER_UDEV_TAGS = 1 << 2,
+};
+
+#define PRODUCT_KEY(vendor, product) GUINT_TO_POINTER (((guint)(vendor) << 16) | (guint)(product))
+
+static void
+filter_index_add (GHashTable *table,
+                  gpointer key,
+                  guint plugin_index)
+{
+    GSList *list;
+
+    /* The first list element never changes when appending, so the value
+     * stored in the table stays valid */
+    list = g_hash_table_lookup (table, key);
+    if (!list)
+        g_hash_table_insert (table, key, g_slist_prepend (NULL, GUINT_TO_POINTER (plugin_index)));
+    else
+        list = g_slist_append (list, GUINT_TO_POINTER (plugin_index));
+}
+
+static void
+filter_index_match (GHashTable *table,
+                    gconstpointer key,
+                    guint8 *matched,
+                    guint8 filter)
+{
+    GSList *l;
+
+    for (l = g_hash_table_lookup (table, key); l; l = g_slist_next (l))
+        matched[GPOINTER_TO_UINT (l->data)] |= filter;
+}
+
+static void
+build_filter_index (MMPluginManager *self)
+{
+    GList *l;
+    guint i;
+
+    self->priv->plugins_array = g_ptr_array_new ();
+    for (l = self->priv->plugins; l; l = g_list_next (l))
+        g_ptr_array_add (self->priv->plugins_array, l->data);
+
+    self->priv->plugins_mandatory_filters = g_new0 (guint8, self->priv->plugins_array->len);
+    self->priv->plugins_by_driver = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_slist_free);
+    self->priv->plugins_by_vendor = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)g_slist_free);
+    self->priv->plugins_by_product = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)g_slist_free);
+    self->priv->plugins_by_udev_tag = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify)g_slist_free);
+
+    for (i = 0; i < self->priv->plugins_array->len; i++) {
+        MMPlugin *plugin = g_ptr_array_index (self->priv->plugins_array, i);
+        const gchar * const *drivers;
+        const guint16 *vendor_ids;
+        const mm_uint16_pair *product_ids;
+        const gchar * const *udev_tags;
+        guint j;
+
+        /* Strings are owned by the plugins, which outlive the index */
+        mm_plugin_peek_mandatory_filters (plugin, &drivers, &vendor_ids, &product_ids, &udev_tags);
+
+        if (drivers) {
+            self->priv->plugins_mandatory_filters[i] |= MANDATORY_FILTER_DRIVERS;
+            for (j = 0; drivers[j]; j++)
+                filter_index_add (self->priv->plugins_by_driver, (gpointer)drivers[j], i);
+        }
+
+        /* When both vendor and product IDs are given, matching either of them
+         * is enough */
+        if (vendor_ids) {
+            self->priv->plugins_mandatory_filters[i] |= MANDATORY_FILTER_IDS;
+            for (j = 0; vendor_ids[j]; j++)
+                filter_index_add (self->priv->plugins_by_vendor, GUINT_TO_POINTER (vendor_ids[j]), i);
+        }
+        if (product_ids) {
+            self->priv->plugins_mandatory_filters[i] |= MANDATORY_FILTER_IDS;
+            for (j = 0; product_ids[j].l; j++)
+                filter_index_add (self->priv->plugins_by_product, PRODUCT_KEY (product_ids[j].l, product_ids[j].r), i);
+        }
+
+        if (udev_tags) {
+            self->priv->plugins_mandatory_filters[i] |= MANDATORY_FILTER_UDEV_TAGS;
+            for (j = 0; udev_tags[j]; j++)
+                filter_index_add (self->priv->plugins_by_udev_tag, (gpointer)udev_tags[j], i);
+        }
+    }
+
+    mm_dbg ("(Plugin Manager) Indexed %u drivers, %u vendor IDs, %u product IDs and %u udev tags",
+            g_hash_table_size (self->priv->plugins_by_driver),
+            g_hash_table_size (self->priv->plugins_by_vendor),
+            g_hash_table_size (self->priv->plugins_by_product),
+            g_hash_table_size (self->priv->plugins_by_udev_tag));
+}
+
+static void
+clear_filter_index (MMPluginManager *self)
+{
+    if (self->priv->plugins_array) {
+        g_ptr_array_unref (self->priv->plugins_array);
+        self->priv->plugins_array = NULL;
+    }
+    g_free (self->priv->plugins_mandatory_filters);
+    self->priv->plugins_mandatory_filters = NULL;
+    if (self->priv->plugins_by_driver) {
+        g_hash_table_destroy (self->priv->plugins_by_driver);
+        self->priv->plugins_by_driver = NULL;
+    }
+    if (self->priv->plugins_by_vendor) {
+        g_hash_table_destroy (self->priv->plugins_by_vendor);
+        self->priv->plugins_by_vendor = NULL;
+    }
+    if (self->priv->plugins_by_product) {
+        g_hash_table_destroy (self->priv->plugins_by_product);
+        self->priv->plugins_by_product = NULL;
+    }
+    if (self->priv->plugins_by_udev_tag) {
+        g_hash_table_destroy (self->priv->plugins_by_udev_tag);
+        self->priv->plugins_by_udev_tag = NULL;
+    }
+}
+
+/* Flags in the output array the mandatory filters matched by each plugin.
+ * Plugins failing to match any of their mandatory filters would be filtered
+ * out by mm_plugin_discard_port_early() anyway. */
+static void
+match_filter_index (MMPluginManager *self,
+                    MMDevice *device,
+                    GUdevDevice *port,
+                    guint8 *matched)
+{
+    const gchar **drivers;
+    guint16 vendor;
+    guint16 product;
+    GHashTableIter iter;
+    gpointer key;
+    guint i;
+
+    drivers = mm_device_get_drivers (device);
+    for (i = 0; drivers && drivers[i]; i++)
+        filter_index_match (self->priv->plugins_by_driver, drivers[i], matched, MANDATORY_FILTER_DRIVERS);
+    /* Ports of embedded modems are reported with a virtual driver; the
+     * plugin decides whether the port really is one of those */
+    filter_index_match (self->priv->plugins_by_driver, "virtual", matched, MANDATORY_FILTER_DRIVERS);
+
+    vendor = mm_device_get_vendor (device);
+    product = mm_device_get_product (device);
+    if (vendor) {
+        filter_index_match (self->priv->plugins_by_vendor, GUINT_TO_POINTER (vendor), matched, MANDATORY_FILTER_IDS);
+        if (product)
+            filter_index_match (self->priv->plugins_by_product, PRODUCT_KEY (vendor, product), matched, MANDATORY_FILTER_IDS);
+    }
+
+    g_hash_table_iter_init (&iter, self->priv->plugins_by_udev_tag);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+        if (g_udev_device_get_property_as_boolean (port, (const gchar *)key))
+            filter_index_match (self->priv->plugins_by_udev_tag, key, matched, MANDATORY_FILTER_UDEV_TAGS);
+    }
+}
+
+/*****************************************************************************/
+
 static GList *
 build_plugins_list (MMPluginManager *self,
                     MMDevice *device,
@@ -606,22 +782,32 @@ build_plugins_list (MMPluginManager *self,
     GList *list = NULL;
     GList *l;
     gboolean supported_found = FALSE;
+    guint8 *matched;
+    guint i;
 
-    for (l = self->priv->plugins; l && !supported_found; l = g_list_next (l)) {
+    matched = g_new0 (guint8, self->priv->plugins_array->len);
+    match_filter_index (self, device, port, matched);
+
+    for (i = 0; i < self->priv->plugins_array->len && !supported_found; i++) {
+        MMPlugin *plugin = g_ptr_array_index (self->priv->plugins_array, i);
         MMPluginSupportsHint hint;
 
-        hint = mm_plugin_discard_port_early (MM_PLUGIN (l->data), device, port);
+        /* Skip right away plugins not matching all their mandatory filters */
+        if (self->priv->plugins_mandatory_filters[i] & ~matched[i])
+            continue;
+
+        hint = mm_plugin_discard_port_early (plugin, device, port);
         switch (hint) {
         case MM_PLUGIN_SUPPORTS_HINT_UNSUPPORTED:
             /* Fully discard */
             break;
         case MM_PLUGIN_SUPPORTS_HINT_MAYBE:
             /* Maybe supported, add to tail of list */
-            list = g_list_append (list, g_object_ref (l->data));
+            list = g_list_append (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_LIKELY:
             /* Likely supported, add to head of list */
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_SUPPORTED:
             /* Really supported, clean existing list and add it alone */
@@ -629,7 +815,7 @@ build_plugins_list (MMPluginManager *self,
                 g_list_free_full (list, (GDestroyNotify)g_object_unref);
                 list = NULL;
             }
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             /* This will end the loop as well */
             supported_found = TRUE;
             break;
@@ -638,6 +824,8 @@ build_plugins_list (MMPluginManager *self,
         }
     }
 
+    g_free (matched);
+
     /* Add the generic plugin at the end of the list */
     if (self->priv->generic)
         list = g_list_append (list, g_object_ref (self->priv->generic));
@@ -929,6 +1117,8 @@ load_plugins (MMPluginManager *self,
     if (!self->priv->generic)
         mm_warn ("Generic plugin not loaded");
 
+    build_filter_index (self);
+
     /* Treat as error if we don't find any plugin */
     if (!self->priv->plugins && !self->priv->generic) {
         g_set_error (error,
@@ -1022,6 +1212,8 @@ dispose (GObject *object)
 {
     MMPluginManager *self = MM_PLUGIN_MANAGER (object);
 
+    clear_filter_index (self);
+
     /* Cleanup list of plugins */
     if (self->priv->plugins) {
         g_list_free_full (self->priv->plugins, (GDestroyNotify)g_object_unref);
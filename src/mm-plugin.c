@@ -866,6 +866,31 @@ mm_plugin_discard_port_early (MMPlugin *self,
 
 /*****************************************************************************/
 
+void
+mm_plugin_peek_mandatory_filters (MMPlugin *self,
+                                  const gchar * const **drivers,
+                                  const guint16 **vendor_ids,
+                                  const mm_uint16_pair **product_ids,
+                                  const gchar * const **udev_tags)
+{
+    *drivers = (const gchar * const *)self->priv->drivers;
+    *udev_tags = (const gchar * const *)self->priv->udev_tags;
+
+    /* Vendor and product IDs are not mandatory if the plugin may still accept
+     * the port based on the vendor/product strings found while probing */
+    if (self->priv->vendor_strings ||
+        self->priv->product_strings ||
+        self->priv->forbidden_product_strings) {
+        *vendor_ids = NULL;
+        *product_ids = NULL;
+    } else {
+        *vendor_ids = self->priv->vendor_ids;
+        *product_ids = self->priv->product_ids;
+    }
+}
+
+/*****************************************************************************/
+
 MMBaseModem *
 mm_plugin_create_modem (MMPlugin  *self,
                         MMDevice *device,
@@ -997,8 +1022,23 @@ mm_plugin_create_modem (MMPlugin  *self,
     }
 
     /* If organizing ports fails, consider the modem invalid */
-    if (!mm_base_modem_organize_ports (modem, error))
+    if (!mm_base_modem_organize_ports (modem, error)) {
         g_clear_object (&modem);
+        return NULL;
+    }
+
+    /* Let the AT ports reuse the replies already received while probing,
+     * instead of sending the same commands again during initialization */
+    if (port_probes) {
+        MMPortSerialAt *port;
+
+        port = mm_base_modem_peek_port_primary (modem);
+        if (port)
+            mm_port_probe_list_seed_at_replies (port_probes, port);
+        port = mm_base_modem_peek_port_secondary (modem);
+        if (port)
+            mm_port_probe_list_seed_at_replies (port_probes, port);
+    }
 
     return modem;
 }
@@ -26,6 +26,7 @@
 #include "mm-port.h"
 #include "mm-port-probe.h"
 #include "mm-device.h"
+#include "mm-private-boxed-types.h"
 
 #define MM_PLUGIN_GENERIC_NAME "Generic"
 #define MM_PLUGIN_MAJOR_VERSION 4
@@ -119,6 +120,15 @@ MMPluginSupportsHint mm_plugin_discard_port_early (MMPlugin *plugin,
                                                    MMDevice *device,
                                                    GUdevDevice *port);
 
+/* Pre-probing filters that a port must always match to be supported by the
+ * plugin; any of them may be NULL if the plugin doesn't require it. Used by
+ * the plugin manager to index plugins by filter. */
+void mm_plugin_peek_mandatory_filters (MMPlugin *plugin,
+                                       const gchar * const **drivers,
+                                       const guint16 **vendor_ids,
+                                       const mm_uint16_pair **product_ids,
+                                       const gchar * const **udev_tags);
+
 void                   mm_plugin_supports_port        (MMPlugin *plugin,
                                                        MMDevice *device,
                                                        GUdevDevice *port,
@@ -31,6 +31,7 @@
 #include "mm-serial-parsers.h"
 #include "mm-port-probe-at.h"
 #include "libqcdm/src/commands.h"
+#include "libqcdm/src/dm-commands.h"
 #include "libqcdm/src/utils.h"
 #include "libqcdm/src/errors.h"
 #include "mm-port-serial-qcdm.h"
@@ -62,6 +63,14 @@
 
 G_DEFINE_TYPE (MMPortProbe, mm_port_probe, G_TYPE_OBJECT)
 
+/* Once a port of the same device has replied to AT probing, timeouts of the
+ * built-in AT probing commands are reduced to this many times the learned
+ * response time (never less than 1s, never more than the default). */
+#define AT_PROBE_TIMEOUT_MARGIN 3
+
+/* Learned AT response times (ms) per VID/PID, shared by all probes */
+static GHashTable *at_response_times;
+
 enum {
     PROP_0,
     PROP_DEVICE,
@@ -78,6 +87,7 @@ typedef struct {
     GCancellable *cancellable;
     guint32 flags;
     guint source_id;
+    GTimer *timer;
 
     /* ---- Serial probing specific context ---- */
 
@@ -105,6 +115,12 @@ typedef struct {
     const MMPortProbeAtCommand *at_commands;
     /* Seconds between each AT command sent in the group */
     guint at_commands_wait_secs;
+    /* Whether timeouts of the current group may be adapted */
+    gboolean at_commands_adaptive;
+    /* Time since the last AT command was sent */
+    GTimer *at_command_timer;
+    /* Set when QCDM framing is received as reply to an AT command */
+    gboolean at_qcdm_framing;
     /* Current AT Result processor */
     void (* at_result_processor) (MMPortProbe *self,
                                   GVariant *result);
@@ -137,6 +153,11 @@ struct _MMPortProbePrivate {
     gboolean is_qmi;
     gboolean is_mbim;
 
+    /* Time it took to reply to AT probing, in ms; 0 if unknown */
+    guint at_response_time;
+    /* Replies to vendor/product probing commands, to be reused by the modem */
+    GHashTable *at_replies;
+
     /* From udev tags */
     gboolean is_ignored;
 
@@ -363,6 +384,10 @@ port_probe_run_task_free (PortProbeRunTask *task)
         g_object_unref (task->cancellable);
     if (task->at_probing_cancellable)
         g_object_unref (task->at_probing_cancellable);
+    if (task->at_command_timer)
+        g_timer_destroy (task->at_command_timer);
+    if (task->timer)
+        g_timer_destroy (task->timer);
 
     g_object_unref (task->result);
     g_free (task);
@@ -796,6 +821,180 @@ is_non_at_response (const guint8 *data, gsize len)
     return FALSE;
 }
 
+/* NMEA sentences look like "$GPGGA,...*hh" */
+static gboolean
+is_nmea_response (const guint8 *data, gsize len)
+{
+    gsize i;
+    gsize j;
+
+    for (i = 0; len >= 7 && i < len - 7; i++) {
+        if (data[i] != '$')
+            continue;
+
+        /* Talker + sentence identifier, then a comma */
+        for (j = i + 1; j < i + 6; j++) {
+            if (!g_ascii_isupper (data[j]) && !g_ascii_isdigit (data[j]))
+                break;
+        }
+        if (j < i + 6 || data[j] != ',')
+            continue;
+
+        /* Checksum at the end of the sentence */
+        for (; j + 2 < len; j++) {
+            if (data[j] == '*' &&
+                g_ascii_isxdigit (data[j + 1]) &&
+                g_ascii_isxdigit (data[j + 2]))
+                return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/* QCDM ports take the AT command as a malformed QCDM request, and reply with
+ * a valid (escaped and CRC-protected) QCDM error frame, which echoes back the
+ * beginning of the request */
+static gboolean
+is_qcdm_response (const guint8 *data, gsize len)
+{
+    gsize used = 0;
+
+    while (used < len) {
+        char frame[512];
+        size_t frame_len = 0;
+        size_t frame_used = 0;
+        qcdmbool need_more = FALSE;
+
+        if (!dm_decapsulate_buffer ((const char *) data + used, len - used,
+                                    frame, sizeof (frame),
+                                    &frame_len, &frame_used, &need_more)) {
+            /* Skip leading frame markers and invalid frames */
+            if (!frame_used)
+                return FALSE;
+            used += frame_used;
+            continue;
+        }
+
+        if (need_more || !frame_len)
+            return FALSE;
+
+        switch ((guint8) frame[0]) {
+        case DIAG_CMD_BAD_CMD:
+        case DIAG_CMD_BAD_PARM:
+        case DIAG_CMD_BAD_LEN:
+        case DIAG_CMD_BAD_DEV:
+        case DIAG_CMD_BAD_MODE:
+            /* If the request is echoed back, it must be our AT command */
+            return (frame_len == 1 || frame[1] == 'A' || frame[1] == 'a');
+        default:
+            return FALSE;
+        }
+    }
+
+    return FALSE;
+}
+
+static guint
+at_response_time_key (MMPortProbe *self)
+{
+    guint16 vid;
+    guint16 pid;
+
+    if (!self->priv->device)
+        return 0;
+
+    vid = mm_device_get_vendor (self->priv->device);
+    pid = mm_device_get_product (self->priv->device);
+    if (!vid || !pid)
+        return 0;
+
+    return ((guint) vid << 16) | pid;
+}
+
+static void
+at_response_time_learn (MMPortProbe *self,
+                        guint elapsed_ms)
+{
+    guint key;
+    guint learned;
+
+    /* Never report 0, which means unknown */
+    elapsed_ms = MAX (elapsed_ms, 1);
+
+    if (!self->priv->at_response_time)
+        self->priv->at_response_time = elapsed_ms;
+
+    key = at_response_time_key (self);
+    if (!key)
+        return;
+
+    if (G_UNLIKELY (!at_response_times))
+        at_response_times = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    /* Moving average, so that a single slow reply is not enough to make
+     * all further probings of the same model slower */
+    learned = GPOINTER_TO_UINT (g_hash_table_lookup (at_response_times, GUINT_TO_POINTER (key)));
+    learned = learned ? ((learned * 3 + elapsed_ms) / 4) : elapsed_ms;
+    g_hash_table_insert (at_response_times, GUINT_TO_POINTER (key), GUINT_TO_POINTER (MAX (learned, 1)));
+
+    mm_dbg ("(%s/%s) AT reply received in %ums (learned for %04x:%04x: %ums)",
+            g_udev_device_get_subsystem (self->priv->port),
+            g_udev_device_get_name (self->priv->port),
+            elapsed_ms,
+            key >> 16,
+            key & 0xFFFF,
+            learned);
+}
+
+/* Returns the expected AT response time in ms, only known once another port
+ * of the same device has already replied to AT probing; 0 otherwise */
+static guint
+at_response_time_lookup (MMPortProbe *self)
+{
+    GList *l;
+    guint sibling_time = 0;
+    guint key;
+
+    if (!self->priv->device)
+        return 0;
+
+    for (l = mm_device_peek_port_probe_list (self->priv->device); l; l = g_list_next (l)) {
+        MMPortProbe *sibling = MM_PORT_PROBE (l->data);
+
+        if (sibling != self && sibling->priv->is_at && sibling->priv->at_response_time)
+            sibling_time = MAX (sibling_time, sibling->priv->at_response_time);
+    }
+
+    if (!sibling_time)
+        return 0;
+
+    key = at_response_time_key (self);
+    if (key && at_response_times)
+        return MAX (sibling_time,
+                    GPOINTER_TO_UINT (g_hash_table_lookup (at_response_times, GUINT_TO_POINTER (key))));
+
+    return sibling_time;
+}
+
+static guint
+serial_probe_at_timeout (MMPortProbe *self)
+{
+    PortProbeRunTask *task = self->priv->task;
+    guint expected_ms;
+    guint timeout;
+
+    if (!task->at_commands_adaptive)
+        return task->at_commands->timeout;
+
+    expected_ms = at_response_time_lookup (self);
+    if (!expected_ms)
+        return task->at_commands->timeout;
+
+    timeout = (expected_ms * AT_PROBE_TIMEOUT_MARGIN + 999) / 1000;
+    return CLAMP (timeout, 1, task->at_commands->timeout);
+}
+
 static void
 serial_probe_at_icera_result_processor (MMPortProbe *self,
                                         GVariant *result)
@@ -876,6 +1075,16 @@ serial_probe_at_parse_response (MMPortSerialAt *port,
     if (port_probe_run_is_cancelled (self))
         goto out;
 
+    /* QCDM framing received? Then this is not an AT port, but we don't
+     * want to abort the whole probing as it may be QCDM-capable */
+    if (task->at_qcdm_framing) {
+        mm_dbg ("(%s/%s) QCDM framing received, port is not AT-capable",
+                g_udev_device_get_subsystem (self->priv->port),
+                g_udev_device_get_name (self->priv->port));
+        mm_port_probe_set_result_at (self, FALSE);
+        g_cancellable_cancel (task->at_probing_cancellable);
+    }
+
     /* If AT probing cancelled, end this partial probing */
     if (g_cancellable_is_cancelled (task->at_probing_cancellable)) {
         mm_dbg ("(%s/%s) no need to keep on probing the port for AT support",
@@ -930,6 +1139,21 @@ serial_probe_at_parse_response (MMPortSerialAt *port,
         goto out;
     }
 
+    /* Learn how long the port took to reply */
+    if (task->at_result_processor == serial_probe_at_result_processor && response)
+        at_response_time_learn (self, (guint) (g_timer_elapsed (task->at_command_timer, NULL) * 1000));
+
+    /* Keep vendor and product replies, the modem will ask for them again */
+    if ((task->at_result_processor == serial_probe_at_vendor_result_processor ||
+         task->at_result_processor == serial_probe_at_product_result_processor) &&
+        response) {
+        if (!self->priv->at_replies)
+            self->priv->at_replies = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+        g_hash_table_insert (self->priv->at_replies,
+                             g_strdup (task->at_commands->command),
+                             g_strdup (response));
+    }
+
     /* Run result processor.
      * Note that custom init commands are allowed to not return anything */
     task->at_result_processor (self, result);
@@ -967,10 +1191,11 @@ serial_probe_at (MMPortProbe *self)
         return FALSE;
     }
 
+    g_timer_start (task->at_command_timer);
     mm_port_serial_at_command (
         MM_PORT_SERIAL_AT (task->serial),
         task->at_commands->command,
-        task->at_commands->timeout,
+        serial_probe_at_timeout (self),
         FALSE,
         FALSE,
         task->at_probing_cancellable,
@@ -1053,6 +1278,7 @@ serial_probe_schedule (MMPortProbe *self)
     task->at_result_processor = NULL;
     task->at_commands = NULL;
     task->at_commands_wait_secs = 0;
+    task->at_commands_adaptive = FALSE;
 
     /* AT check requested and not already probed? */
     if ((task->flags & MM_PORT_PROBE_AT) &&
@@ -1060,8 +1286,10 @@ serial_probe_schedule (MMPortProbe *self)
         /* Prepare AT probing */
         if (task->at_custom_probe)
             task->at_commands = task->at_custom_probe;
-        else
+        else {
             task->at_commands = at_probing;
+            task->at_commands_adaptive = TRUE;
+        }
         task->at_result_processor = serial_probe_at_result_processor;
     }
     /* Vendor requested and not already probed? */
@@ -1070,6 +1298,7 @@ serial_probe_schedule (MMPortProbe *self)
         /* Prepare AT vendor probing */
         task->at_result_processor = serial_probe_at_vendor_result_processor;
         task->at_commands = vendor_probing;
+        task->at_commands_adaptive = TRUE;
     }
     /* Product requested and not already probed? */
     else if ((task->flags & MM_PORT_PROBE_AT_PRODUCT) &&
@@ -1077,6 +1306,7 @@ serial_probe_schedule (MMPortProbe *self)
         /* Prepare AT product probing */
         task->at_result_processor = serial_probe_at_product_result_processor;
         task->at_commands = product_probing;
+        task->at_commands_adaptive = TRUE;
     }
     /* Icera support check requested and not already done? */
     else if ((task->flags & MM_PORT_PROBE_AT_ICERA) &&
@@ -1084,8 +1314,10 @@ serial_probe_schedule (MMPortProbe *self)
         /* Prepare AT product probing */
         task->at_result_processor = serial_probe_at_icera_result_processor;
         task->at_commands = icera_probing;
-        /* By default, wait 2 seconds between ICERA probing retries */
-        task->at_commands_wait_secs = 2;
+        task->at_commands_adaptive = TRUE;
+        /* By default, wait 2 seconds between ICERA probing retries; 1 second
+         * is enough if we already know the device replies quickly */
+        task->at_commands_wait_secs = (at_response_time_lookup (self) ? 1 : 2);
     }
 
     /* If a next AT group detected, go for it */
@@ -1141,7 +1373,10 @@ serial_parser_filter_cb (gpointer filter,
                          GString *response,
                          GError **error)
 {
-    if (is_non_at_response ((const guint8 *) response->str, response->len)) {
+    MMPortProbe *self = MM_PORT_PROBE (user_data);
+
+    if (is_non_at_response ((const guint8 *) response->str, response->len) ||
+        is_nmea_response ((const guint8 *) response->str, response->len)) {
         g_set_error (error,
                      MM_SERIAL_ERROR,
                      MM_SERIAL_ERROR_PARSE_FAILED,
@@ -1149,6 +1384,18 @@ serial_parser_filter_cb (gpointer filter,
         return FALSE;
     }
 
+    /* QCDM frames don't abort the probing; the reply handler will just
+     * skip any further AT probing */
+    if (is_qcdm_response ((const guint8 *) response->str, response->len)) {
+        if (self->priv->task)
+            self->priv->task->at_qcdm_framing = TRUE;
+        g_set_error (error,
+                     MM_SERIAL_ERROR,
+                     MM_SERIAL_ERROR_PARSE_FAILED,
+                     "QCDM framing in AT response");
+        return FALSE;
+    }
+
     return TRUE;
 }
 
@@ -1196,7 +1443,7 @@ serial_open_at (MMPortProbe *self)
         parser = mm_serial_parser_v1_new ();
         mm_serial_parser_v1_add_filter (parser,
                                         serial_parser_filter_cb,
-                                        NULL);
+                                        self);
         mm_port_serial_at_set_response_parser (MM_PORT_SERIAL_AT (task->serial),
                                                mm_serial_parser_v1_parse,
                                                parser,
@@ -1301,6 +1548,13 @@ mm_port_probe_run_finish (MMPortProbe *self,
     else
         res = g_simple_async_result_get_op_res_gboolean (G_SIMPLE_ASYNC_RESULT (result));
 
+    /* Report how long it took */
+    if (self->priv->task && self->priv->task->timer)
+        mm_dbg ("(%s/%s) port probing finished in %.3f seconds",
+                g_udev_device_get_subsystem (self->priv->port),
+                g_udev_device_get_name (self->priv->port),
+                g_timer_elapsed (self->priv->task->timer, NULL));
+
     /* Cleanup probing task */
     if (self->priv->task) {
         port_probe_run_task_free (self->priv->task);
@@ -1366,6 +1620,7 @@ mm_port_probe_run (MMPortProbe *self,
 
     /* Setup internal cancellable */
     task->cancellable = g_cancellable_new ();
+    task->timer = g_timer_new ();
 
     probe_list_str = mm_port_probe_flag_build_string_from_mask (task->flags);
     mm_dbg ("(%s/%s) launching port probing: '%s'",
@@ -1380,6 +1635,7 @@ mm_port_probe_run (MMPortProbe *self,
         task->flags & MM_PORT_PROBE_AT_PRODUCT ||
         task->flags & MM_PORT_PROBE_AT_ICERA) {
         task->at_probing_cancellable = g_cancellable_new ();
+        task->at_command_timer = g_timer_new ();
         task->source_id = g_idle_add ((GSourceFunc)serial_open_at, self);
         return;
     }
@@ -1694,6 +1950,39 @@ mm_port_probe_get_parent_path (MMPortProbe *self)
 
 /*****************************************************************************/
 
+void
+mm_port_probe_list_seed_at_replies (GList *list,
+                                    MMPortSerialAt *port)
+{
+    GList *l;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (port));
+
+    /* Vendor and product replies are the same in all AT ports of a device,
+     * so preload the ones gathered by any of the probes */
+    for (l = list; l; l = g_list_next (l)) {
+        MMPortProbe *probe = MM_PORT_PROBE (l->data);
+        GHashTableIter iter;
+        gpointer command;
+        gpointer response;
+
+        if (!probe->priv->at_replies)
+            continue;
+
+        g_hash_table_iter_init (&iter, probe->priv->at_replies);
+        while (g_hash_table_iter_next (&iter, &command, &response)) {
+            mm_dbg ("(%s) reusing reply to '%s' received while probing (%s/%s)",
+                    mm_port_get_device (MM_PORT (port)),
+                    (const gchar *) command,
+                    g_udev_device_get_subsystem (probe->priv->port),
+                    g_udev_device_get_name (probe->priv->port));
+            mm_port_serial_at_set_cached_reply (port, command, response);
+        }
+    }
+}
+
+/*****************************************************************************/
+
 MMPortProbe *
 mm_port_probe_new (MMDevice *device,
                    GUdevDevice *port)
@@ -1768,6 +2057,8 @@ finalize (GObject *object)
 
     g_free (self->priv->vendor);
     g_free (self->priv->product);
+    if (self->priv->at_replies)
+        g_hash_table_unref (self->priv->at_replies);
 
     G_OBJECT_CLASS (mm_port_probe_parent_class)->finalize (object);
 }
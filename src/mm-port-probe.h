@@ -138,5 +138,7 @@ gboolean mm_port_probe_list_has_at_port   (GList *list);
 gboolean mm_port_probe_list_has_qmi_port  (GList *list);
 gboolean mm_port_probe_list_has_mbim_port (GList *list);
 gboolean mm_port_probe_list_is_icera      (GList *list);
+void     mm_port_probe_list_seed_at_replies (GList *list,
+                                             MMPortSerialAt *port);
 
 #endif /* MM_PORT_PROBE_H */
@@ -340,10 +340,65 @@ string_free (GString *str)
     g_string_free (str, TRUE);
 }
 
+typedef struct {
+    MMPortSerialAt *self;
+    GSimpleAsyncResult *result;
+    MMPortSerialAtResponseLineFn line_fn;
+    gpointer line_fn_user_data;
+} CommandContext;
+
+static void
+command_context_complete_and_free (CommandContext *ctx)
+{
+    g_simple_async_result_complete (ctx->result);
+    g_object_unref (ctx->result);
+    g_object_unref (ctx->self);
+    g_slice_free (CommandContext, ctx);
+}
+
+static void
+serial_command_response_chunk (MMPortSerial *port,
+                               GByteArray *response,
+                               CommandContext *ctx)
+{
+    guint start = 0;
+
+    /* Intermediate lines are given between <CR><LF> pairs. Every complete
+     * line is reported and removed from the buffer, but always leaving the
+     * <CR><LF> which starts the next one, as the response parser expects
+     * the final result code to come after it. */
+    while ((response->len - start) >= 2 &&
+           response->data[start] == '\r' &&
+           response->data[start + 1] == '\n') {
+        guint end;
+
+        for (end = start + 2; end < (response->len - 1); end++) {
+            if (response->data[end] == '\r' && response->data[end + 1] == '\n')
+                break;
+        }
+
+        /* Line not yet complete */
+        if (end >= (response->len - 1))
+            break;
+
+        /* Report non-empty lines, NUL-terminated in place */
+        if (end > start + 2) {
+            response->data[end] = '\0';
+            ctx->line_fn (ctx->self, (const gchar *) &response->data[start + 2], ctx->line_fn_user_data);
+            response->data[end] = '\r';
+        }
+
+        start = end;
+    }
+
+    if (start > 0)
+        g_byte_array_remove_range (response, 0, start);
+}
+
 static void
 serial_command_ready (MMPortSerial *port,
                       GAsyncResult *res,
-                      GSimpleAsyncResult *simple)
+                      CommandContext *ctx)
 {
     GByteArray *response_buffer;
     GError *error = NULL;
@@ -351,9 +406,8 @@ serial_command_ready (MMPortSerial *port,
 
     response_buffer = mm_port_serial_command_finish (port, res, &error);
     if (!response_buffer) {
-        g_simple_async_result_take_error (simple, error);
-        g_simple_async_result_complete (simple);
-        g_object_unref (simple);
+        g_simple_async_result_take_error (ctx->result, error);
+        command_context_complete_and_free (ctx);
         return;
     }
 
@@ -364,30 +418,42 @@ serial_command_ready (MMPortSerial *port,
         g_byte_array_remove_range (response_buffer, 0, response_buffer->len);
     g_byte_array_unref (response_buffer);
 
-    g_simple_async_result_set_op_res_gpointer (simple,
+    /* When streaming, the lines received along with the final result code
+     * are also reported one by one */
+    if (ctx->line_fn && response->len > 0) {
+        gchar **lines;
+        guint i;
+
+        lines = g_strsplit (response->str, "\r\n", -1);
+        for (i = 0; lines[i]; i++) {
+            if (lines[i][0])
+                ctx->line_fn (ctx->self, lines[i], ctx->line_fn_user_data);
+        }
+        g_strfreev (lines);
+        g_string_truncate (response, 0);
+    }
+
+    g_simple_async_result_set_op_res_gpointer (ctx->result,
                                                response,
                                                (GDestroyNotify)string_free);
-    g_simple_async_result_complete (simple);
-    g_object_unref (simple);
+    command_context_complete_and_free (ctx);
 }
 
-void
-mm_port_serial_at_command (MMPortSerialAt *self,
-                           const char *command,
-                           guint32 timeout_seconds,
-                           gboolean is_raw,
-                           gboolean allow_cached,
-                           GCancellable *cancellable,
-                           GAsyncReadyCallback callback,
-                           gpointer user_data)
+static void
+port_serial_at_command (MMPortSerialAt *self,
+                        const char *command,
+                        guint32 timeout_seconds,
+                        gboolean is_raw,
+                        gboolean allow_cached,
+                        MMPortSerialAtResponseLineFn line_fn,
+                        gpointer line_fn_user_data,
+                        GCancellable *cancellable,
+                        GAsyncReadyCallback callback,
+                        gpointer user_data)
 {
-    GSimpleAsyncResult *simple;
+    CommandContext *ctx;
     GByteArray *buf;
 
-    g_return_if_fail (self != NULL);
-    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
-    g_return_if_fail (command != NULL);
-
     buf = at_command_to_byte_array (command,
                                     is_raw,
                                     (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
@@ -395,21 +461,81 @@ mm_port_serial_at_command (MMPortSerialAt *self,
                                      TRUE));
     g_return_if_fail (buf != NULL);
 
-    simple = g_simple_async_result_new (G_OBJECT (self),
-                                        callback,
-                                        user_data,
-                                        mm_port_serial_at_command);
+    ctx = g_slice_new0 (CommandContext);
+    ctx->self = g_object_ref (self);
+    ctx->result = g_simple_async_result_new (G_OBJECT (self),
+                                             callback,
+                                             user_data,
+                                             mm_port_serial_at_command);
+    ctx->line_fn = line_fn;
+    ctx->line_fn_user_data = line_fn_user_data;
 
     mm_port_serial_command (MM_PORT_SERIAL (self),
                             buf,
                             timeout_seconds,
                             allow_cached,
+                            line_fn ? (MMPortSerialResponseChunkFn)serial_command_response_chunk : NULL,
+                            ctx,
                             cancellable,
                             (GAsyncReadyCallback)serial_command_ready,
-                            simple);
+                            ctx);
     g_byte_array_unref (buf);
 }
 
+void
+mm_port_serial_at_command (MMPortSerialAt *self,
+                           const char *command,
+                           guint32 timeout_seconds,
+                           gboolean is_raw,
+                           gboolean allow_cached,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (command != NULL);
+
+    port_serial_at_command (self,
+                            command,
+                            timeout_seconds,
+                            is_raw,
+                            allow_cached,
+                            NULL,
+                            NULL,
+                            cancellable,
+                            callback,
+                            user_data);
+}
+
+void
+mm_port_serial_at_command_streamed (MMPortSerialAt *self,
+                                    const char *command,
+                                    guint32 timeout_seconds,
+                                    gboolean is_raw,
+                                    MMPortSerialAtResponseLineFn line_fn,
+                                    gpointer line_fn_user_data,
+                                    GCancellable *cancellable,
+                                    GAsyncReadyCallback callback,
+                                    gpointer user_data)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (command != NULL);
+    g_return_if_fail (line_fn != NULL);
+
+    port_serial_at_command (self,
+                            command,
+                            timeout_seconds,
+                            is_raw,
+                            FALSE, /* never cached */
+                            line_fn,
+                            line_fn_user_data,
+                            cancellable,
+                            callback,
+                            user_data);
+}
+
 static void
 debug_log (MMPortSerial *port, const char *prefix, const char *buf, gsize len)
 {
@@ -441,6 +567,38 @@ debug_log (MMPortSerial *port, const char *prefix, const char *buf, gsize len)
     g_string_truncate (debug, 0);
 }
 
+void
+mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                    const gchar *command,
+                                    const gchar *response)
+{
+    GByteArray *cmd;
+    GByteArray *rsp = NULL;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (command != NULL);
+
+    /* Build the command exactly as port_serial_at_command() would, so that
+     * the cache lookup matches */
+    cmd = at_command_to_byte_array (command,
+                                    FALSE,
+                                    (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
+                                     self->priv->send_lf :
+                                     TRUE));
+    g_return_if_fail (cmd != NULL);
+
+    if (response) {
+        rsp = g_byte_array_sized_new (strlen (response));
+        g_byte_array_append (rsp, (const guint8 *) response, strlen (response));
+    }
+
+    mm_port_serial_set_cached_reply (MM_PORT_SERIAL (self), cmd, rsp);
+
+    g_byte_array_unref (cmd);
+    if (rsp)
+        g_byte_array_unref (rsp);
+}
+
 void
 mm_port_serial_at_set_flags (MMPortSerialAt *self, MMPortSerialAtFlag flags)
 {
@@ -57,6 +57,10 @@ typedef gboolean (*MMPortSerialAtResponseParserFn) (gpointer user_data,
                                                     GString *response,
                                                     GError **error);
 
+typedef void (*MMPortSerialAtResponseLineFn) (MMPortSerialAt *port,
+                                              const gchar *line,
+                                              gpointer user_data);
+
 typedef void (*MMPortSerialAtUnsolicitedMsgFn) (MMPortSerialAt *port,
                                                 GMatchInfo *match_info,
                                                 gpointer user_data);
@@ -107,6 +111,28 @@ const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                                GAsyncResult *res,
                                                GError **error);
 
+/* Like mm_port_serial_at_command(), but every intermediate line of the reply
+ * is given to @line_fn as soon as it's fully received, instead of being kept
+ * in the final response string. Use mm_port_serial_at_command_finish() to
+ * get the final result, which will be an empty string on success. Streamed
+ * replies are never cached. The line callback must not cancel the command
+ * nor close the port. */
+void         mm_port_serial_at_command_streamed (MMPortSerialAt *self,
+                                                 const char *command,
+                                                 guint32 timeout_seconds,
+                                                 gboolean is_raw,
+                                                 MMPortSerialAtResponseLineFn line_fn,
+                                                 gpointer line_fn_user_data,
+                                                 GCancellable *cancellable,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data);
+
+/* Preload the reply to give to @command (not raw) when run with cached
+ * replies allowed, e.g. with a reply already received during probing */
+void         mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                                 const gchar *command,
+                                                 const gchar *response);
+
 /*
  * Convert a string into a quoted and escaped string. Returns a new
  * allocated string. Follows ITU V.250 5.4.2.2 "String constants".
@@ -179,6 +179,8 @@ mm_port_serial_qcdm_command (MMPortSerialQcdm *self,
                             command,
                             timeout_seconds,
                             FALSE, /* never cached */
+                            NULL, /* no partial replies */
+                            NULL,
                             cancellable,
                             (GAsyncReadyCallback)serial_command_ready,
                             simple);
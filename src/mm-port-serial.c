@@ -34,6 +34,7 @@
 #include <mm-errors-types.h>
 
 #include "mm-port-serial.h"
+#include "mm-trace.h"
 #include "mm-log.h"
 
 static gboolean port_serial_queue_process          (gpointer data);
@@ -41,9 +42,6 @@ static void     port_serial_schedule_queue_process (MMPortSerial *self,
                                                     guint timeout_ms);
 static void     port_serial_close_force            (MMPortSerial *self);
 static void     port_serial_reopen_cancel          (MMPortSerial *self);
-static void     port_serial_set_cached_reply       (MMPortSerial *self,
-                                                    const GByteArray *command,
-                                                    const GByteArray *response);
 
 G_DEFINE_TYPE (MMPortSerial, mm_port_serial, MM_TYPE_PORT)
 
@@ -109,6 +107,9 @@ struct _MMPortSerialPrivate {
 
     guint n_consecutive_timeouts;
 
+    /* I/O counters */
+    MMPortSerialMetrics metrics;
+
     guint connected_id;
 
     gpointer flash_ctx;
@@ -125,11 +126,16 @@ typedef struct {
     GByteArray *command;
     guint32 timeout;
     gboolean allow_cached;
+    MMPortSerialResponseChunkFn chunk_fn;
+    gpointer chunk_fn_user_data;
     guint32 eagain_count;
 
     guint32 idx;
     gboolean started;
     gboolean done;
+
+    /* When the command was first sent */
+    gint64 send_time;
 } CommandContext;
 
 static void
@@ -163,6 +169,8 @@ mm_port_serial_command (MMPortSerial *self,
                         GByteArray *command,
                         guint32 timeout_seconds,
                         gboolean allow_cached,
+                        MMPortSerialResponseChunkFn chunk_fn,
+                        gpointer chunk_fn_user_data,
                         GCancellable *cancellable,
                         GAsyncReadyCallback callback,
                         gpointer user_data)
@@ -171,6 +179,8 @@ mm_port_serial_command (MMPortSerial *self,
 
     g_return_if_fail (MM_IS_PORT_SERIAL (self));
     g_return_if_fail (command != NULL);
+    /* A reply processed in chunks is never fully available, so cannot be cached */
+    g_return_if_fail (!(allow_cached && chunk_fn));
 
     /* Setup command context */
     ctx = g_slice_new0 (CommandContext);
@@ -181,6 +191,8 @@ mm_port_serial_command (MMPortSerial *self,
                                              mm_port_serial_command);
     ctx->command = g_byte_array_ref (command);
     ctx->allow_cached = allow_cached;
+    ctx->chunk_fn = chunk_fn;
+    ctx->chunk_fn_user_data = chunk_fn_user_data;
     ctx->timeout = timeout_seconds;
     ctx->cancellable = (cancellable ? g_object_ref (cancellable) : NULL);
 
@@ -201,9 +213,11 @@ mm_port_serial_command (MMPortSerial *self,
 
     /* Clear the cached value for this command if not asking for cached value */
     if (!allow_cached)
-        port_serial_set_cached_reply (self, ctx->command, NULL);
+        mm_port_serial_set_cached_reply (self, ctx->command, NULL);
 
     g_queue_push_tail (self->priv->queue, ctx);
+    self->priv->metrics.queue_depth_max = MAX (self->priv->metrics.queue_depth_max,
+                                               g_queue_get_length (self->priv->queue));
 
     if (g_queue_get_length (self->priv->queue) == 1)
         port_serial_schedule_queue_process (self, 0);
@@ -551,6 +565,8 @@ port_serial_process_command (MMPortSerial *self,
     /* Only print command the first time */
     if (ctx->started == FALSE) {
         ctx->started = TRUE;
+        ctx->send_time = g_get_monotonic_time ();
+        self->priv->metrics.commands++;
         serial_debug (self, "-->", (const char *) ctx->command->data, ctx->command->len);
     }
 
@@ -583,6 +599,7 @@ port_serial_process_command (MMPortSerial *self,
         case G_IO_STATUS_NORMAL:
             if (written > 0) {
                 ctx->idx += written;
+                self->priv->metrics.bytes_out += written;
                 break;
             }
             /* If written == 0, treat as EAGAIN, so fall down */
@@ -590,6 +607,7 @@ port_serial_process_command (MMPortSerial *self,
         case G_IO_STATUS_AGAIN:
             /* We're in a non-blocking channel and therefore we're up to receive
              * EAGAIN; just retry in this case. */
+            self->priv->metrics.eagain++;
             ctx->eagain_count--;
             if (ctx->eagain_count <= 0) {
                 /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
@@ -623,6 +641,7 @@ port_serial_process_command (MMPortSerial *self,
 
             g_error_free (inner_error);
 
+            self->priv->metrics.eagain++;
             ctx->eagain_count--;
             if (ctx->eagain_count <= 0) {
                 /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
@@ -639,6 +658,7 @@ port_serial_process_command (MMPortSerial *self,
           written = bytes_sent;
 
         ctx->idx += written;
+        self->priv->metrics.bytes_out += written;
     } else
         g_assert_not_reached ();
 
@@ -648,10 +668,10 @@ port_serial_process_command (MMPortSerial *self,
     return TRUE;
 }
 
-static void
-port_serial_set_cached_reply (MMPortSerial *self,
-                              const GByteArray *command,
-                              const GByteArray *response)
+void
+mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                 const GByteArray *command,
+                                 const GByteArray *response)
 {
     g_return_if_fail (self != NULL);
     g_return_if_fail (MM_IS_PORT_SERIAL (self));
@@ -675,6 +695,94 @@ port_serial_get_cached_reply (MMPortSerial *self,
     return (const GByteArray *)g_hash_table_lookup (self->priv->reply_cache, command);
 }
 
+/*****************************************************************************/
+/* I/O metrics */
+
+static const guint latency_bucket_bounds[MM_PORT_SERIAL_LATENCY_BUCKETS - 1] = MM_PORT_SERIAL_LATENCY_BUCKET_BOUNDS;
+
+void
+mm_port_serial_get_metrics (MMPortSerial *self,
+                            MMPortSerialMetrics *metrics)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+    g_return_if_fail (metrics != NULL);
+
+    *metrics = self->priv->metrics;
+    metrics->queue_depth = g_queue_get_length (self->priv->queue);
+}
+
+GVariant *
+mm_port_serial_build_metrics_variant (MMPortSerial *self)
+{
+    MMPortSerialMetrics metrics;
+    GVariantBuilder builder;
+    GVariantBuilder histogram;
+    guint i;
+
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), NULL);
+
+    mm_port_serial_get_metrics (self, &metrics);
+
+    g_variant_builder_init (&histogram, G_VARIANT_TYPE ("at"));
+    for (i = 0; i < MM_PORT_SERIAL_LATENCY_BUCKETS; i++)
+        g_variant_builder_add (&histogram, "t", metrics.latency_histogram[i]);
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{sv}"));
+    g_variant_builder_add (&builder, "{sv}", "bytes-in",         g_variant_new_uint64 (metrics.bytes_in));
+    g_variant_builder_add (&builder, "{sv}", "bytes-out",        g_variant_new_uint64 (metrics.bytes_out));
+    g_variant_builder_add (&builder, "{sv}", "commands",         g_variant_new_uint64 (metrics.commands));
+    g_variant_builder_add (&builder, "{sv}", "cache-hits",       g_variant_new_uint64 (metrics.cache_hits));
+    g_variant_builder_add (&builder, "{sv}", "timeouts",         g_variant_new_uint64 (metrics.timeouts));
+    g_variant_builder_add (&builder, "{sv}", "errors",           g_variant_new_uint64 (metrics.errors));
+    g_variant_builder_add (&builder, "{sv}", "buffer-full",      g_variant_new_uint64 (metrics.buffer_full));
+    g_variant_builder_add (&builder, "{sv}", "eagain",           g_variant_new_uint64 (metrics.eagain));
+    g_variant_builder_add (&builder, "{sv}", "queue-depth",      g_variant_new_uint32 (metrics.queue_depth));
+    g_variant_builder_add (&builder, "{sv}", "queue-depth-max",  g_variant_new_uint32 (metrics.queue_depth_max));
+    g_variant_builder_add (&builder, "{sv}", "latency-total-ms", g_variant_new_uint64 (metrics.latency_total_ms));
+    g_variant_builder_add (&builder, "{sv}", "latency-max-ms",   g_variant_new_uint32 (metrics.latency_max_ms));
+    g_variant_builder_add (&builder, "{sv}", "latency-histogram", g_variant_builder_end (&histogram));
+    return g_variant_builder_end (&builder);
+}
+
+gchar *
+mm_port_serial_build_metrics_string (MMPortSerial *self)
+{
+    MMPortSerialMetrics metrics;
+    GString *str;
+    guint64 completed = 0;
+    guint i;
+
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), NULL);
+
+    mm_port_serial_get_metrics (self, &metrics);
+
+    for (i = 0; i < MM_PORT_SERIAL_LATENCY_BUCKETS; i++)
+        completed += metrics.latency_histogram[i];
+
+    str = g_string_new (NULL);
+    g_string_append_printf (str,
+                            "in: %" G_GUINT64_FORMAT " bytes, out: %" G_GUINT64_FORMAT " bytes, "
+                            "commands: %" G_GUINT64_FORMAT " (cached: %" G_GUINT64_FORMAT ", "
+                            "timeouts: %" G_GUINT64_FORMAT ", errors: %" G_GUINT64_FORMAT "), "
+                            "buffer full: %" G_GUINT64_FORMAT ", eagain: %" G_GUINT64_FORMAT ", "
+                            "queue: %u (max %u), latency avg/max: %" G_GUINT64_FORMAT "/%u ms, histogram:",
+                            metrics.bytes_in, metrics.bytes_out,
+                            metrics.commands, metrics.cache_hits,
+                            metrics.timeouts, metrics.errors,
+                            metrics.buffer_full, metrics.eagain,
+                            metrics.queue_depth, metrics.queue_depth_max,
+                            completed ? metrics.latency_total_ms / completed : 0,
+                            metrics.latency_max_ms);
+    for (i = 0; i < MM_PORT_SERIAL_LATENCY_BUCKETS; i++) {
+        if (i < G_N_ELEMENTS (latency_bucket_bounds))
+            g_string_append_printf (str, " <%ums:%" G_GUINT64_FORMAT, latency_bucket_bounds[i], metrics.latency_histogram[i]);
+        else
+            g_string_append_printf (str, " more:%" G_GUINT64_FORMAT, metrics.latency_histogram[i]);
+    }
+
+    return g_string_free (str, FALSE);
+}
+
 static void
 port_serial_schedule_queue_process (MMPortSerial *self, guint timeout_ms)
 {
@@ -694,6 +802,52 @@ port_serial_schedule_queue_process (MMPortSerial *self, guint timeout_ms)
         self->priv->queue_id = g_idle_add (port_serial_queue_process, self);
 }
 
+static void
+port_serial_metrics_add_latency (MMPortSerial *self,
+                                 guint latency_ms)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (latency_bucket_bounds); i++) {
+        if (latency_ms < latency_bucket_bounds[i])
+            break;
+    }
+    self->priv->metrics.latency_histogram[i]++;
+    self->priv->metrics.latency_total_ms += latency_ms;
+    self->priv->metrics.latency_max_ms = MAX (self->priv->metrics.latency_max_ms, latency_ms);
+}
+
+static void
+port_serial_trace_command (MMPortSerial *self,
+                           CommandContext *ctx,
+                           gboolean success)
+{
+    gchar name[32];
+    guint i;
+    guint len;
+
+    /* Printable version of the command, without trailing CR/LF. Arguments
+     * are never recorded (e.g. PIN/PUK codes in +CPIN, +CLCK or +CPWD), so
+     * the name ends right after the first '=' or '?' found. */
+    len = MIN (ctx->command->len, sizeof (name) - 1);
+    for (i = 0; i < len; i++) {
+        name[i] = g_ascii_isprint (ctx->command->data[i]) ? ctx->command->data[i] : '.';
+        if (name[i] == '=' || name[i] == '?') {
+            i++;
+            break;
+        }
+    }
+    while (i > 0 && name[i - 1] == '.')
+        i--;
+    name[i] = '\0';
+
+    mm_trace_span (mm_port_get_device (MM_PORT (self)),
+                   "serial",
+                   name,
+                   ctx->send_time,
+                   success);
+}
+
 static void
 port_serial_got_response (MMPortSerial *self,
                           const GError *error)
@@ -716,11 +870,24 @@ port_serial_got_response (MMPortSerial *self,
 
     ctx = (CommandContext *) g_queue_pop_head (self->priv->queue);
     if (ctx) {
+        if (error && g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT))
+            self->priv->metrics.timeouts++;
+        else {
+            if (error)
+                self->priv->metrics.errors++;
+            /* Latency only of the commands that did get a response */
+            if (ctx->send_time)
+                port_serial_metrics_add_latency (self, (g_get_monotonic_time () - ctx->send_time) / 1000);
+        }
+
+        if (G_UNLIKELY (mm_trace_active) && ctx->send_time)
+            port_serial_trace_command (self, ctx, !error);
+
         if (error)
             g_simple_async_result_set_from_error (ctx->result, error);
         else {
             if (ctx->allow_cached && !error)
-                port_serial_set_cached_reply (self, ctx->command, self->priv->response);
+                mm_port_serial_set_cached_reply (self, ctx->command, self->priv->response);
 
             /* Upon completion, it is a task of the caller to remove from the response
              * buffer the processed data */
@@ -813,6 +980,7 @@ port_serial_queue_process (gpointer data)
             }
 
             g_byte_array_append (self->priv->response, cached->data, cached->len);
+            self->priv->metrics.cache_hits++;
             port_serial_got_response (self, NULL);
             return FALSE;
         }
@@ -873,6 +1041,20 @@ parse_response (MMPortSerial *self,
     return MM_PORT_SERIAL_GET_CLASS (self)->parse_response (self, response, error);
 }
 
+static void
+process_response_chunk (MMPortSerial *self)
+{
+    CommandContext *ctx;
+
+    /* Only if the command in flight asked for it, and only once the command
+     * has been fully sent */
+    ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+    if (!ctx || !ctx->chunk_fn || !ctx->done || !self->priv->response->len)
+        return;
+
+    ctx->chunk_fn (self, self->priv->response, ctx->chunk_fn_user_data);
+}
+
 static gboolean
 common_input_available (MMPortSerial *self,
                         GIOCondition condition)
@@ -951,10 +1133,12 @@ common_input_available (MMPortSerial *self,
         g_assert (bytes_read > 0);
         serial_debug (self, "<--", buf, bytes_read);
         g_byte_array_append (self->priv->response, (const guint8 *) buf, bytes_read);
+        self->priv->metrics.bytes_in += bytes_read;
 
         /* Make sure the response doesn't grow too long */
         if ((self->priv->response->len > SERIAL_BUF_SIZE) && self->priv->spew_control) {
             /* Notify listeners and then trim the buffer */
+            self->priv->metrics.buffer_full++;
             g_signal_emit (self, signals[BUFFER_FULL], 0, self->priv->response);
             g_byte_array_remove_range (self->priv->response, 0, (SERIAL_BUF_SIZE / 2));
         }
@@ -967,7 +1151,8 @@ common_input_available (MMPortSerial *self,
             /* Process response retrieved */
             port_serial_got_response (self, error);
             g_clear_error (&error);
-        }
+        } else
+            process_response_chunk (self);
     } while (   (bytes_read == SERIAL_BUF_SIZE || status == G_IO_STATUS_AGAIN)
              && (self->priv->iochannel_id > 0 || self->priv->socket_source != NULL));
 
@@ -44,6 +44,28 @@ typedef struct _MMPortSerial MMPortSerial;
 typedef struct _MMPortSerialClass MMPortSerialClass;
 typedef struct _MMPortSerialPrivate MMPortSerialPrivate;
 
+/* Upper bounds (ms) of the command latency histogram buckets; the last
+ * bucket takes all commands slower than the last bound */
+#define MM_PORT_SERIAL_LATENCY_BUCKET_BOUNDS { 10, 50, 100, 250, 500, 1000, 2500, 5000, 10000 }
+#define MM_PORT_SERIAL_LATENCY_BUCKETS 10
+
+/* Cumulative I/O counters, kept since the port object was created */
+typedef struct {
+    guint64 bytes_in;
+    guint64 bytes_out;
+    guint64 commands;
+    guint64 cache_hits;
+    guint64 timeouts;
+    guint64 errors;
+    guint64 buffer_full;
+    guint64 eagain;
+    guint   queue_depth;
+    guint   queue_depth_max;
+    guint64 latency_total_ms;
+    guint   latency_max_ms;
+    guint64 latency_histogram[MM_PORT_SERIAL_LATENCY_BUCKETS];
+} MMPortSerialMetrics;
+
 struct _MMPortSerial {
     MMPort parent;
     MMPortSerialPrivate *priv;
@@ -123,10 +145,21 @@ gboolean mm_port_serial_flash_finish      (MMPortSerial *self,
                                            GError **error);
 void     mm_port_serial_flash_cancel      (MMPortSerial *self);
 
+/* Called while the reply to a command is still being received (i.e. before
+ * the response parser finds the final result), so that complete chunks of
+ * the reply may be processed right away. Processed data should be removed
+ * from the beginning of the response buffer. The callback must not cancel the
+ * command nor close the port. */
+typedef void (* MMPortSerialResponseChunkFn) (MMPortSerial *self,
+                                              GByteArray *response,
+                                              gpointer user_data);
+
 void        mm_port_serial_command        (MMPortSerial *self,
                                            GByteArray *command,
                                            guint32 timeout_seconds,
                                            gboolean allow_cached,
+                                           MMPortSerialResponseChunkFn chunk_fn,
+                                           gpointer chunk_fn_user_data,
                                            GCancellable *cancellable,
                                            GAsyncReadyCallback callback,
                                            gpointer user_data);
@@ -134,4 +167,15 @@ GByteArray *mm_port_serial_command_finish (MMPortSerial *self,
                                            GAsyncResult *res,
                                            GError **error);
 
+/* Preload the reply to give to @command when run with cached replies
+ * allowed; a NULL @response removes the cached reply */
+void        mm_port_serial_set_cached_reply (MMPortSerial *self,
+                                             const GByteArray *command,
+                                             const GByteArray *response);
+
+void        mm_port_serial_get_metrics          (MMPortSerial *self,
+                                                 MMPortSerialMetrics *metrics);
+GVariant   *mm_port_serial_build_metrics_variant (MMPortSerial *self);
+gchar      *mm_port_serial_build_metrics_string  (MMPortSerial *self);
+
 #endif /* MM_PORT_SERIAL_H */
@@ -19,6 +19,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
 
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
@@ -27,6 +28,7 @@
 #include "mm-iface-modem-messaging.h"
 #include "mm-sms-list.h"
 #include "mm-base-sms.h"
+#include "mm-modem-helpers.h"
 #include "mm-log.h"
 
 G_DEFINE_TYPE (MMSmsList, mm_sms_list, G_TYPE_OBJECT);
@@ -113,6 +115,153 @@ mm_sms_list_get_paths (MMSmsList *self)
 
 /*****************************************************************************/
 
+typedef struct {
+    guint id;
+    MMBaseSms *sms;
+} SmsById;
+
+static guint
+sms_path_get_id (const gchar *path)
+{
+    const gchar *aux;
+
+    /* Object paths are built with an increasing numeric suffix, so they give
+     * us the order in which the SMS objects were exported */
+    aux = strrchr (path, '/');
+    return (guint) strtoul (aux ? aux + 1 : path, NULL, 10);
+}
+
+static gboolean
+sms_cursor_get_id (const gchar *cursor,
+                   guint *id,
+                   GError **error)
+{
+    const gchar *aux;
+    guint64 value;
+
+    /* The cursor must be the path of an SMS object, as previously returned
+     * in the listing; otherwise we would silently restart from the beginning */
+    if (g_str_has_prefix (cursor, MM_DBUS_SMS_PREFIX "/")) {
+        aux = cursor + strlen (MM_DBUS_SMS_PREFIX "/");
+        if (aux[0] && strspn (aux, "0123456789") == strlen (aux)) {
+            errno = 0;
+            value = g_ascii_strtoull (aux, NULL, 10);
+            if (errno == 0 && value <= G_MAXUINT) {
+                *id = (guint) value;
+                return TRUE;
+            }
+        }
+    }
+
+    g_set_error (error,
+                 MM_CORE_ERROR,
+                 MM_CORE_ERROR_INVALID_ARGS,
+                 "Invalid SMS list cursor '%s'",
+                 cursor);
+    return FALSE;
+}
+
+static gint
+sms_by_id_cmp (const SmsById *a,
+               const SmsById *b)
+{
+    return (a->id > b->id) - (a->id < b->id);
+}
+
+static gboolean
+sms_matches_filter (MMBaseSms *sms,
+                    MMSmsState state,
+                    MMSmsStorage storage,
+                    gint64 since)
+{
+    gint64 timestamp;
+
+    if (state != MM_SMS_STATE_UNKNOWN &&
+        mm_gdbus_sms_get_state (MM_GDBUS_SMS (sms)) != state)
+        return FALSE;
+
+    if (storage != MM_SMS_STORAGE_UNKNOWN &&
+        mm_base_sms_get_storage (sms) != storage)
+        return FALSE;
+
+    if (since >= 0 &&
+        (!mm_iso8601_time_to_unix (mm_gdbus_sms_get_timestamp (MM_GDBUS_SMS (sms)), &timestamp) ||
+         timestamp < since))
+        return FALSE;
+
+    return TRUE;
+}
+
+GVariant *
+mm_sms_list_get_full (MMSmsList *self,
+                      MMSmsState state,
+                      MMSmsStorage storage,
+                      gint64 since,
+                      const gchar *cursor,
+                      guint limit,
+                      gchar **next_cursor,
+                      GError **error)
+{
+    GVariantBuilder builder;
+    GArray *matches;
+    GList *l;
+    gboolean has_cursor = FALSE;
+    guint cursor_id = 0;
+    guint i;
+
+    if (cursor && cursor[0]) {
+        if (!sms_cursor_get_id (cursor, &cursor_id, error))
+            return NULL;
+        has_cursor = TRUE;
+    }
+
+    matches = g_array_sized_new (FALSE, FALSE, sizeof (SmsById), g_list_length (self->priv->list));
+    for (l = self->priv->list; l; l = g_list_next (l)) {
+        SmsById item;
+        const gchar *path;
+
+        /* Don't report not yet exported SMS objects */
+        item.sms = MM_BASE_SMS (l->data);
+        path = mm_base_sms_get_path (item.sms);
+        if (!path)
+            continue;
+
+        item.id = sms_path_get_id (path);
+        if (has_cursor && item.id <= cursor_id)
+            continue;
+
+        if (sms_matches_filter (item.sms, state, storage, since))
+            g_array_append_val (matches, item);
+    }
+    g_array_sort (matches, (GCompareFunc)sms_by_id_cmp);
+
+    if (limit == 0 || limit > matches->len)
+        limit = matches->len;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(oa{sv})"));
+    for (i = 0; i < limit; i++) {
+        SmsById *item;
+        GVariant *properties;
+
+        item = &g_array_index (matches, SmsById, i);
+        properties = g_dbus_interface_skeleton_get_properties (G_DBUS_INTERFACE_SKELETON (item->sms));
+        g_variant_builder_add (&builder, "(o@a{sv})",
+                               mm_base_sms_get_path (item->sms),
+                               properties);
+        g_variant_unref (properties);
+    }
+
+    if (next_cursor)
+        *next_cursor = (limit < matches->len ?
+                        g_strdup (mm_base_sms_get_path (g_array_index (matches, SmsById, limit - 1).sms)) :
+                        g_strdup (""));
+
+    g_array_unref (matches);
+    return g_variant_builder_end (&builder);
+}
+
+/*****************************************************************************/
+
 typedef struct {
     MMSmsList *self;
     GSimpleAsyncResult *result;
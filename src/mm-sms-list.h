@@ -61,6 +61,18 @@ MMSmsList *mm_sms_list_new (MMBaseModem *modem);
 GStrv mm_sms_list_get_paths (MMSmsList *self);
 guint mm_sms_list_get_count (MMSmsList *self);
 
+/* Filtered listing of SMS objects with all their properties, as a
+ * 'a(oa{sv})' GVariant. MM_SMS_STATE_UNKNOWN and MM_SMS_STORAGE_UNKNOWN
+ * match any state or storage; a negative @since matches any timestamp. */
+GVariant *mm_sms_list_get_full (MMSmsList *self,
+                                MMSmsState state,
+                                MMSmsStorage storage,
+                                gint64 since,
+                                const gchar *cursor,
+                                guint limit,
+                                gchar **next_cursor,
+                                GError **error);
+
 gboolean mm_sms_list_has_part (MMSmsList *self,
                                MMSmsStorage storage,
                                guint index);
@@ -237,15 +237,17 @@ static char *
 sms_decode_text (const guint8 *text, int len, MMSmsEncoding encoding, int bit_offset)
 {
     char *utf8;
-    guint8 *unpacked;
-    guint32 unpacked_len;
 
     if (encoding == MM_SMS_ENCODING_GSM7) {
+        /* TP-UDL is a single octet */
+        guint8 unpacked[G_MAXUINT8];
+
+        g_return_val_if_fail (len >= 0 && len <= G_MAXUINT8, g_strdup (""));
+
         mm_dbg ("Converting SMS part text from GSM7 to UTF8...");
-        unpacked = gsm_unpack ((const guint8 *) text, len, bit_offset, &unpacked_len);
-        utf8 = (char *) mm_charset_gsm_unpacked_to_utf8 (unpacked, unpacked_len);
+        gsm_unpack_buf ((const guint8 *) text, len, bit_offset, unpacked);
+        utf8 = (char *) mm_charset_gsm_unpacked_to_utf8 (unpacked, len);
         mm_dbg ("   Got UTF-8 text: '%s'", utf8);
-        g_free (unpacked);
     } else if (encoding == MM_SMS_ENCODING_UCS2) {
         mm_dbg ("Converting SMS part text from UCS-2BE to UTF8...");
         utf8 = g_convert ((char *) text, len, "UTF8", "UCS-2BE", NULL, NULL, NULL);
@@ -320,22 +322,28 @@ mm_sms_part_3gpp_new_from_pdu (guint index,
                                const gchar *hexpdu,
                                GError **error)
 {
+    guint8 pdu_buf[MM_SMS_PART_3GPP_MAX_PDU_LEN / 2];
+    guint8 *pdu = pdu_buf;
+    gsize hexpdu_len;
     gsize pdu_len;
-    guint8 *pdu;
-    MMSmsPart *part;
+    MMSmsPart *part = NULL;
+
+    /* Only PDUs not fitting in the stack buffer need an allocation */
+    hexpdu_len = strlen (hexpdu);
+    if (hexpdu_len / 2 > sizeof (pdu_buf))
+        pdu = g_malloc (hexpdu_len / 2);
 
     /* Convert PDU from hex to binary */
-    pdu = (guint8 *) mm_utils_hexstr2bin (hexpdu, &pdu_len);
-    if (!pdu) {
+    if (!mm_utils_hexstr2bin_buf (hexpdu, hexpdu_len, pdu, MAX (hexpdu_len / 2, sizeof (pdu_buf)), &pdu_len))
         g_set_error_literal (error,
                              MM_CORE_ERROR,
                              MM_CORE_ERROR_FAILED,
                              "Couldn't convert 3GPP PDU from hex to binary");
-        return NULL;
-    }
+    else
+        part = mm_sms_part_3gpp_new_from_binary_pdu (index, pdu, pdu_len, error);
 
-    part = mm_sms_part_3gpp_new_from_binary_pdu (index, pdu, pdu_len, error);
-    g_free (pdu);
+    if (pdu != pdu_buf)
+        g_free (pdu);
 
     return part;
 }
@@ -624,7 +632,7 @@ mm_sms_part_3gpp_new_from_binary_pdu (guint index,
 
         bit_offset = 0;
         if (has_udh) {
-            guint udhl, end;
+            guint udhl, end, udh_elements;
 
             udhl = pdu[tp_user_data_offset] + 1;
             end = tp_user_data_offset + udhl;
@@ -675,17 +683,30 @@ mm_sms_part_3gpp_new_from_binary_pdu (guint index,
              * Move past the user data headers to prevent it from being
              * decoded into garbage text.
              */
-            tp_user_data_offset += udhl;
-            tp_user_data_size_bytes -= udhl;
             if (user_data_encoding == MM_SMS_ENCODING_GSM7) {
                 /*
                  * Find the number of bits we need to add to the length of the
                  * user data to get a multiple of 7 (the padding).
                  */
                 bit_offset = (7 - udhl % 7) % 7;
-                tp_user_data_size_elements -= (udhl * 8 + bit_offset) / 7;
+                udh_elements = (udhl * 8 + bit_offset) / 7;
             } else
-                tp_user_data_size_elements -= udhl;
+                udh_elements = udhl;
+
+            if (udhl > tp_user_data_size_bytes || udh_elements > tp_user_data_size_elements) {
+                g_set_error (error,
+                             MM_CORE_ERROR,
+                             MM_CORE_ERROR_FAILED,
+                             "UDH longer than user data: %u > %u",
+                             udhl,
+                             tp_user_data_size_bytes);
+                mm_sms_part_free (sms_part);
+                return NULL;
+            }
+
+            tp_user_data_offset += udhl;
+            tp_user_data_size_bytes -= udhl;
+            tp_user_data_size_elements -= udh_elements;
         }
 
         switch (user_data_encoding) {
@@ -935,7 +956,7 @@ mm_sms_part_3gpp_get_submit_pdu (MMSmsPart *part,
     }
 
     if (mm_sms_part_get_encoding (part) == MM_SMS_ENCODING_GSM7) {
-        guint8 *unpacked, *packed;
+        guint8 *unpacked;
         guint32 unlen = 0, packlen = 0;
 
         unpacked = mm_charset_utf8_to_unpacked_gsm (mm_sms_part_get_text (part), &unlen);
@@ -956,19 +977,18 @@ mm_sms_part_3gpp_get_submit_pdu (MMSmsPart *part,
                 *udl_ptr,
                 mm_sms_part_get_concat_sequence (part) ? "with" : "without");
 
-        packed = gsm_pack (unpacked, unlen, shift, &packlen);
-        g_free (unpacked);
-        if (!packed || packlen == 0) {
-            g_free (packed);
+        /* Pack straight into the PDU */
+        if (offset + GSM_PACKED_LEN (unlen, shift) > PDU_SIZE) {
+            g_free (unpacked);
             g_set_error_literal (error,
                                  MM_MESSAGE_ERROR,
                                  MM_MESSAGE_ERROR_INVALID_PDU_PARAMETER,
-                                 "Failed to pack message text to GSM");
+                                 "Failed to pack message text to GSM: too long");
             goto error;
         }
 
-        memcpy (&pdu[offset], packed, packlen);
-        g_free (packed);
+        packlen = gsm_pack_buf (unpacked, unlen, shift, &pdu[offset]);
+        g_free (unpacked);
         offset += packlen;
     } else if (mm_sms_part_get_encoding (part) == MM_SMS_ENCODING_UCS2) {
         GByteArray *array;
@@ -984,6 +1004,15 @@ mm_sms_part_3gpp_get_submit_pdu (MMSmsPart *part,
             goto error;
         }
 
+        if (offset + array->len > PDU_SIZE) {
+            g_byte_array_free (array, TRUE);
+            g_set_error_literal (error,
+                                 MM_MESSAGE_ERROR,
+                                 MM_MESSAGE_ERROR_INVALID_PDU_PARAMETER,
+                                 "Failed to convert message text to UCS2: too long");
+            goto error;
+        }
+
         /* Set real data length, in octets
          * If we had UDH, add 6 octets
          */
@@ -999,6 +1028,13 @@ mm_sms_part_3gpp_get_submit_pdu (MMSmsPart *part,
         const GByteArray *data;
 
         data = mm_sms_part_get_data (part);
+        if (offset + data->len > PDU_SIZE) {
+            g_set_error_literal (error,
+                                 MM_MESSAGE_ERROR,
+                                 MM_MESSAGE_ERROR_INVALID_PDU_PARAMETER,
+                                 "Binary user data too long");
+            goto error;
+        }
 
         /* Set real data length, in octets
          * If we had UDH, add 6 octets
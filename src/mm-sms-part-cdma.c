@@ -229,34 +229,258 @@ encoding_to_string (Encoding encoding)
 }
 
 /*****************************************************************************/
-/* Read bits; o_bits < 8; n_bits <= 8
+/* Bitstream cursors
+ *
+ * Fields are packed most significant bit first, and aren't byte aligned:
  *
  * Byte 0            Byte 1
  * [7|6|5|4|3|2|1|0] [7|6|5|4|3|2|1|0]
  *
- * o_bits+n_bits <= 16
- *
+ * Up to 64 bits are read or written at once. Going past the end of the
+ * buffer sets a sticky error flag: reads return 0 and writes are ignored
+ * from then on.
  */
-static guint8
-read_bits (const guint8 *bytes,
-           guint8 o_bits,
-           guint8 n_bits)
+
+typedef struct {
+    const guint8 *data;
+    guint len;      /* in bytes */
+    guint pos;      /* in bits */
+    gboolean error;
+} BitReader;
+
+typedef struct {
+    guint8 *data;
+    guint len;      /* in bytes */
+    guint pos;      /* in bits */
+    gboolean error;
+} BitWriter;
+
+static void
+bit_reader_init (BitReader *reader,
+                 const guint8 *data,
+                 guint len)
+{
+    reader->data = data;
+    reader->len = len;
+    reader->pos = 0;
+    reader->error = FALSE;
+}
+
+static guint
+bit_reader_remaining (const BitReader *reader)
+{
+    return (reader->len * 8) - reader->pos;
+}
+
+static guint64
+bit_reader_read (BitReader *reader,
+                 guint n_bits)
+{
+    guint64 value = 0;
+    guint byte;
+    guint n_bytes;
+    guint i;
+
+    g_assert (n_bits <= 64);
+
+    if (reader->error || n_bits > bit_reader_remaining (reader)) {
+        reader->error = TRUE;
+        return 0;
+    }
+
+    /* Keep at most 56 bits plus the offset in the accumulator */
+    if (n_bits > 56) {
+        value = bit_reader_read (reader, n_bits - 32) << 32;
+        return value | bit_reader_read (reader, 32);
+    }
+
+    if (!n_bits)
+        return 0;
+
+    byte = reader->pos / 8;
+    n_bytes = ((reader->pos % 8) + n_bits + 7) / 8;
+    for (i = 0; i < n_bytes; i++)
+        value = (value << 8) | reader->data[byte + i];
+
+    value >>= (n_bytes * 8) - (reader->pos % 8) - n_bits;
+    reader->pos += n_bits;
+    return value & ((G_GUINT64_CONSTANT (1) << n_bits) - 1);
+}
+
+static void
+bit_reader_read_bytes (BitReader *reader,
+                       guint8 *out,
+                       guint n_bytes)
+{
+    guint i = 0;
+
+    if (reader->error || (n_bytes * 8) > bit_reader_remaining (reader)) {
+        reader->error = TRUE;
+        memset (out, 0, n_bytes);
+        return;
+    }
+
+    /* Byte aligned runs are just copied */
+    if (reader->pos % 8 == 0) {
+        memcpy (out, &reader->data[reader->pos / 8], n_bytes);
+        reader->pos += n_bytes * 8;
+        return;
+    }
+
+    for (; i + 7 <= n_bytes; i += 7) {
+        guint64 value;
+
+        value = bit_reader_read (reader, 56);
+        out[i]     = value >> 48;
+        out[i + 1] = value >> 40;
+        out[i + 2] = value >> 32;
+        out[i + 3] = value >> 24;
+        out[i + 4] = value >> 16;
+        out[i + 5] = value >> 8;
+        out[i + 6] = value;
+    }
+    for (; i < n_bytes; i++)
+        out[i] = bit_reader_read (reader, 8);
+}
+
+static void
+bit_reader_read_septets (BitReader *reader,
+                         guint8 *out,
+                         guint n_septets)
+{
+    guint i = 0;
+
+    if (reader->error || (n_septets * 7) > bit_reader_remaining (reader)) {
+        reader->error = TRUE;
+        memset (out, 0, n_septets);
+        return;
+    }
+
+    /* 8 septets per 56-bit read */
+    for (; i + 8 <= n_septets; i += 8) {
+        guint64 value;
+
+        value = bit_reader_read (reader, 56);
+        out[i]     = (value >> 49) & 0x7F;
+        out[i + 1] = (value >> 42) & 0x7F;
+        out[i + 2] = (value >> 35) & 0x7F;
+        out[i + 3] = (value >> 28) & 0x7F;
+        out[i + 4] = (value >> 21) & 0x7F;
+        out[i + 5] = (value >> 14) & 0x7F;
+        out[i + 6] = (value >> 7)  & 0x7F;
+        out[i + 7] =  value        & 0x7F;
+    }
+    for (; i < n_septets; i++)
+        out[i] = bit_reader_read (reader, 7);
+}
+
+/* NOTE! The buffer being written should be all 0 initially */
+static void
+bit_writer_init (BitWriter *writer,
+                 guint8 *data,
+                 guint len)
+{
+    writer->data = data;
+    writer->len = len;
+    writer->pos = 0;
+    writer->error = FALSE;
+}
+
+/* Number of bytes written so far, including the last partial one */
+static guint
+bit_writer_get_len (const BitWriter *writer)
+{
+    return (writer->pos + 7) / 8;
+}
+
+static void
+bit_writer_write (BitWriter *writer,
+                  guint n_bits,
+                  guint64 value)
 {
-    guint8 bits_in_first;
-    guint8 bits_in_second;
+    guint byte;
+    guint n_bytes;
+    guint i;
 
-    g_assert (o_bits < 8);
-    g_assert (n_bits <= 8);
-    g_assert (o_bits + n_bits <= 16);
+    g_assert (n_bits <= 64);
 
-    /* Read only from the first byte */
-    if (o_bits + n_bits <= 8)
-        return (bytes[0] >> (8 - o_bits - n_bits)) & ((1 << n_bits) - 1);
+    if (writer->error || n_bits > (writer->len * 8) - writer->pos) {
+        writer->error = TRUE;
+        return;
+    }
+
+    if (n_bits > 56) {
+        bit_writer_write (writer, n_bits - 32, value >> 32);
+        bit_writer_write (writer, 32, value & 0xFFFFFFFF);
+        return;
+    }
 
-    /* Read (8 - o_bits) from the first byte and (n_bits - (8 - o_bits)) from the second byte */
-    bits_in_first = 8 - o_bits;
-    bits_in_second = n_bits - bits_in_first;
-    return (read_bits (&bytes[0], o_bits, bits_in_first) << bits_in_second) | read_bits (&bytes[1], 0, bits_in_second);
+    if (!n_bits)
+        return;
+
+    byte = writer->pos / 8;
+    n_bytes = ((writer->pos % 8) + n_bits + 7) / 8;
+    value &= (G_GUINT64_CONSTANT (1) << n_bits) - 1;
+    value <<= (n_bytes * 8) - (writer->pos % 8) - n_bits;
+    for (i = n_bytes; i > 0; i--) {
+        writer->data[byte + i - 1] |= value & 0xFF;
+        value >>= 8;
+    }
+    writer->pos += n_bits;
+}
+
+static void
+bit_writer_write_bytes (BitWriter *writer,
+                        const guint8 *bytes,
+                        guint n_bytes)
+{
+    guint i = 0;
+
+    if (writer->error || (n_bytes * 8) > (writer->len * 8) - writer->pos) {
+        writer->error = TRUE;
+        return;
+    }
+
+    /* Byte aligned runs are just copied */
+    if (writer->pos % 8 == 0) {
+        memcpy (&writer->data[writer->pos / 8], bytes, n_bytes);
+        writer->pos += n_bytes * 8;
+        return;
+    }
+
+    for (; i + 7 <= n_bytes; i += 7)
+        bit_writer_write (writer, 56,
+                          ((guint64) bytes[i]     << 48) |
+                          ((guint64) bytes[i + 1] << 40) |
+                          ((guint64) bytes[i + 2] << 32) |
+                          ((guint64) bytes[i + 3] << 24) |
+                          ((guint64) bytes[i + 4] << 16) |
+                          ((guint64) bytes[i + 5] << 8)  |
+                           (guint64) bytes[i + 6]);
+    for (; i < n_bytes; i++)
+        bit_writer_write (writer, 8, bytes[i]);
+}
+
+static void
+bit_writer_write_septets (BitWriter *writer,
+                          const guint8 *septets,
+                          guint n_septets)
+{
+    guint i = 0;
+
+    /* 8 septets per 56-bit write */
+    for (; i + 8 <= n_septets; i += 8)
+        bit_writer_write (writer, 56,
+                          ((guint64) (septets[i]     & 0x7F) << 49) |
+                          ((guint64) (septets[i + 1] & 0x7F) << 42) |
+                          ((guint64) (septets[i + 2] & 0x7F) << 35) |
+                          ((guint64) (septets[i + 3] & 0x7F) << 28) |
+                          ((guint64) (septets[i + 4] & 0x7F) << 21) |
+                          ((guint64) (septets[i + 5] & 0x7F) << 14) |
+                          ((guint64) (septets[i + 6] & 0x7F) << 7)  |
+                           (guint64) (septets[i + 7] & 0x7F));
+    for (; i < n_septets; i++)
+        bit_writer_write (writer, 7, septets[i]);
 }
 
 /*****************************************************************************/
@@ -314,22 +538,28 @@ mm_sms_part_cdma_new_from_pdu (guint index,
                                const gchar *hexpdu,
                                GError **error)
 {
+    guint8 pdu_buf[256];
+    guint8 *pdu = pdu_buf;
+    gsize hexpdu_len;
     gsize pdu_len;
-    guint8 *pdu;
-    MMSmsPart *part;
+    MMSmsPart *part = NULL;
+
+    /* Only PDUs not fitting in the stack buffer need an allocation */
+    hexpdu_len = strlen (hexpdu);
+    if (hexpdu_len / 2 > sizeof (pdu_buf))
+        pdu = g_malloc (hexpdu_len / 2);
 
     /* Convert PDU from hex to binary */
-    pdu = (guint8 *) mm_utils_hexstr2bin (hexpdu, &pdu_len);
-    if (!pdu) {
+    if (!mm_utils_hexstr2bin_buf (hexpdu, hexpdu_len, pdu, MAX (hexpdu_len / 2, sizeof (pdu_buf)), &pdu_len))
         g_set_error_literal (error,
                              MM_CORE_ERROR,
                              MM_CORE_ERROR_FAILED,
                              "Couldn't convert CDMA PDU from hex to binary");
-        return NULL;
-    }
+    else
+        part = mm_sms_part_cdma_new_from_binary_pdu (index, pdu, pdu_len, error);
 
-    part = mm_sms_part_cdma_new_from_binary_pdu (index, pdu, pdu_len, error);
-    g_free (pdu);
+    if (pdu != pdu_buf)
+        g_free (pdu);
 
     return part;
 }
@@ -470,33 +700,25 @@ read_address (MMSmsPart *sms_part,
     guint8 number_type;
     guint8 numbering_plan;
     guint8 num_fields;
-    guint byte_offset = 0;
-    guint bit_offset = 0;
+    BitReader reader;
     guint i;
     gchar *number = NULL;
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
-#define PARAMETER_SIZE_CHECK(required_size)                             \
-    if (parameter->parameter_len < required_size) {                     \
-        mm_dbg ("        cannot read address, need at least %u bytes (got %u)", \
-                required_size,                                          \
-                parameter->parameter_len);                              \
+#define PARAMETER_SIZE_CHECK(required_bits)                             \
+    if (bit_reader_remaining (&reader) < (required_bits)) {             \
+        mm_dbg ("        cannot read address, need at least %u more bits (got %u)", \
+                (guint) (required_bits),                                \
+                bit_reader_remaining (&reader));                        \
         return;                                                         \
     }
 
-    /* Readability of digit mode and number mode (first 2 bits, i.e. first byte) */
-    PARAMETER_SIZE_CHECK (1);
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
+
+    /* Readability of digit mode and number mode (first 2 bits) */
+    PARAMETER_SIZE_CHECK (2);
 
     /* Digit mode */
-    digit_mode = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 1);
-    OFFSETS_UPDATE (1);
+    digit_mode = bit_reader_read (&reader, 1);
     g_assert (digit_mode <= 1);
     switch (digit_mode) {
     case DIGIT_MODE_DTMF:
@@ -510,8 +732,7 @@ read_address (MMSmsPart *sms_part,
     }
 
     /* Number mode */
-    number_mode = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 1);
-    OFFSETS_UPDATE (1);
+    number_mode = bit_reader_read (&reader, 1);
     switch (number_mode) {
     case NUMBER_MODE_DIGIT:
         mm_dbg ("        number mode: digit");
@@ -526,8 +747,7 @@ read_address (MMSmsPart *sms_part,
     /* Number type */
     if (digit_mode == DIGIT_MODE_ASCII) {
         /* No need for readability check, still in first byte always */
-        number_type = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 3);
-        OFFSETS_UPDATE (3);
+        number_type = bit_reader_read (&reader, 3);
         switch (number_type) {
         case NUMBER_TYPE_UNKNOWN:
             mm_dbg ("        number type: unknown");
@@ -557,9 +777,8 @@ read_address (MMSmsPart *sms_part,
     /* Numbering plan */
     if (digit_mode == DIGIT_MODE_ASCII && number_mode == NUMBER_MODE_DIGIT) {
         /* Readability of numbering plan; may go to second byte */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + 4) / 8));
-        numbering_plan = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 4);
-        OFFSETS_UPDATE (4);
+        PARAMETER_SIZE_CHECK (4);
+        numbering_plan = bit_reader_read (&reader, 4);
         switch (numbering_plan) {
         case NUMBERING_PLAN_UNKNOWN:
             mm_dbg ("        numbering plan: unknown");
@@ -583,54 +802,41 @@ read_address (MMSmsPart *sms_part,
     } else
         numbering_plan = 0xFF;
 
-    /* Readability of num_fields; will go to third byte (((bit_offset + 8) / 8) == 1) */
-    PARAMETER_SIZE_CHECK (byte_offset + 2);
-    num_fields = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-    OFFSETS_UPDATE (8);
+    /* Readability of num_fields */
+    PARAMETER_SIZE_CHECK (8);
+    num_fields = bit_reader_read (&reader, 8);
     mm_dbg ("        num fields: %u", num_fields);
 
     /* Address string */
 
     if (digit_mode == DIGIT_MODE_DTMF) {
         /* DTMF */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 4)) / 8));
+        PARAMETER_SIZE_CHECK (num_fields * 4);
         number = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            number[i] = dtmf_to_ascii (read_bits (&parameter->parameter_value[byte_offset], bit_offset, 4));
-            OFFSETS_UPDATE (4);
-        }
+        for (i = 0; i < num_fields; i++)
+            number[i] = dtmf_to_ascii (bit_reader_read (&reader, 4));
         number[i] = '\0';
     } else if (number_mode == NUMBER_MODE_DIGIT) {
         /* ASCII
          * TODO: should we expose numbering plan and number type? */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        PARAMETER_SIZE_CHECK (num_fields * 8);
         number = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            number[i] = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        number[i] = '\0';
+        bit_reader_read_bytes (&reader, (guint8 *) number, num_fields);
+        number[num_fields] = '\0';
     } else if (number_type == DATA_NETWORK_ADDRESS_TYPE_INTERNET_EMAIL_ADDRESS) {
         /* Internet e-mail address (ASCII) */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        PARAMETER_SIZE_CHECK (num_fields * 8);
         number = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            number[i] = read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        number[i] = '\0';
+        bit_reader_read_bytes (&reader, (guint8 *) number, num_fields);
+        number[num_fields] = '\0';
     } else if (number_type == DATA_NETWORK_ADDRESS_TYPE_INTERNET_PROTOCOL) {
-        GString *str;
+        guint8 address[G_MAXUINT8];
 
         /* Binary data network address (most significant first)
          * For now, just print the hex string (e.g. FF:01...) */
-        PARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
-        str = g_string_sized_new (num_fields * 2);
-        for (i = 0; i < num_fields; i++) {
-            g_string_append_printf (str, "%.2X", read_bits (&parameter->parameter_value[byte_offset], bit_offset, 8));
-            OFFSETS_UPDATE (8);
-        }
-        number = g_string_free (str, FALSE);
+        PARAMETER_SIZE_CHECK (num_fields * 8);
+        bit_reader_read_bytes (&reader, address, num_fields);
+        number = mm_utils_bin2hexstr (address, num_fields);
     } else
         mm_dbg ("        data network address number type unknown (%u)", number_type);
 
@@ -639,7 +845,6 @@ read_address (MMSmsPart *sms_part,
     mm_sms_part_set_number (sms_part, number);
     g_free (number);
 
-#undef OFFSETS_UPDATE
 #undef PARAMETER_SIZE_CHECK
 }
 
@@ -647,6 +852,7 @@ static void
 read_bearer_reply_option (MMSmsPart *sms_part,
                           const struct Parameter *parameter)
 {
+    BitReader reader;
     guint8 sequence;
 
     g_assert (parameter->parameter_id == PARAMETER_ID_BEARER_REPLY_OPTION);
@@ -657,7 +863,8 @@ read_bearer_reply_option (MMSmsPart *sms_part,
         return;
     }
 
-    sequence = read_bits (&parameter->parameter_value[0], 0, 6);
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
+    sequence = bit_reader_read (&reader, 6);
     mm_dbg ("        sequence: %u", sequence);
 
     mm_sms_part_set_message_reference (sms_part, sequence);
@@ -667,6 +874,7 @@ static void
 read_cause_codes (MMSmsPart *sms_part,
                   const struct Parameter *parameter)
 {
+    BitReader reader;
     guint8 sequence;
     guint8 error_class;
     guint8 cause_code;
@@ -680,10 +888,12 @@ read_cause_codes (MMSmsPart *sms_part,
         return;
     }
 
-    sequence = read_bits (&parameter->parameter_value[0], 0, 6);
+    bit_reader_init (&reader, parameter->parameter_value, parameter->parameter_len);
+
+    sequence = bit_reader_read (&reader, 6);
     mm_dbg ("        sequence: %u", sequence);
 
-    error_class = read_bits (&parameter->parameter_value[0], 6, 2);
+    error_class = bit_reader_read (&reader, 2);
     mm_dbg ("        error class: %u", error_class);
 
     if (error_class != ERROR_CLASS_NO_ERROR) {
@@ -708,6 +918,7 @@ static void
 read_bearer_data_message_identifier (MMSmsPart *sms_part,
                                      const struct Parameter *subparameter)
 {
+    BitReader reader;
     guint8 message_type;
     guint16 message_id;
     guint8 header_ind;
@@ -720,7 +931,9 @@ read_bearer_data_message_identifier (MMSmsPart *sms_part,
         return;
     }
 
-    message_type = read_bits (&subparameter->parameter_value[0], 0, 4);
+    bit_reader_init (&reader, subparameter->parameter_value, subparameter->parameter_len);
+
+    message_type = bit_reader_read (&reader, 4);
     switch (message_type) {
     case TELESERVICE_MESSAGE_TYPE_UNKNOWN:
         mm_dbg ("            message type: unknown");
@@ -754,12 +967,11 @@ read_bearer_data_message_identifier (MMSmsPart *sms_part,
         break;
     }
 
-    message_id = ((read_bits (&subparameter->parameter_value[0], 4, 8) << 8) |
-                  (read_bits (&subparameter->parameter_value[1], 4, 8)));
+    message_id = bit_reader_read (&reader, 16);
     message_id = GUINT16_FROM_BE (message_id);
     mm_dbg ("            message id: %u", (guint) message_id);
 
-    header_ind = read_bits (&subparameter->parameter_value[2], 4, 1);
+    header_ind = bit_reader_read (&reader, 1);
     mm_dbg ("            header indicator: %u", header_ind);
 }
 
@@ -770,61 +982,47 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
     guint8 message_encoding;
     guint8 message_type = 0;
     guint8 num_fields;
-    guint byte_offset = 0;
-    guint bit_offset = 0;
-
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
-#define SUBPARAMETER_SIZE_CHECK(required_size)                             \
-    if (subparameter->parameter_len < required_size) {                  \
-        mm_dbg ("        cannot read user data, need at least %u bytes (got %u)", \
-                required_size,                                          \
-                subparameter->parameter_len);                           \
+    BitReader reader;
+
+#define SUBPARAMETER_SIZE_CHECK(required_bits)                          \
+    if (bit_reader_remaining (&reader) < (required_bits)) {             \
+        mm_dbg ("        cannot read user data, need at least %u more bits (got %u)", \
+                (guint) (required_bits),                                \
+                bit_reader_remaining (&reader));                        \
         return;                                                         \
     }
 
     g_assert (subparameter->parameter_id == SUBPARAMETER_ID_USER_DATA);
 
+    bit_reader_init (&reader, subparameter->parameter_value, subparameter->parameter_len);
+
     /* Message encoding */
-    SUBPARAMETER_SIZE_CHECK (1);
-    message_encoding = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 5);
-    OFFSETS_UPDATE (5);
+    SUBPARAMETER_SIZE_CHECK (5);
+    message_encoding = bit_reader_read (&reader, 5);
     mm_dbg ("            message encoding: %s", encoding_to_string (message_encoding));
 
     /* Message type, only if extended protocol message */
     if (message_encoding == ENCODING_EXTENDED_PROTOCOL_MESSAGE) {
-        SUBPARAMETER_SIZE_CHECK (2);
-        message_type = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-        OFFSETS_UPDATE (8);
+        SUBPARAMETER_SIZE_CHECK (8);
+        message_type = bit_reader_read (&reader, 8);
         mm_dbg ("            message type: %u", message_type);
     }
 
     /* Number of fields */
-    SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + 8) / 8));
-    num_fields = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-    OFFSETS_UPDATE (8);
+    SUBPARAMETER_SIZE_CHECK (8);
+    num_fields = bit_reader_read (&reader, 8);
     mm_dbg ("            num fields: %u", num_fields);
 
     /* Now, process actual text or data */
     switch (message_encoding) {
     case ENCODING_OCTET: {
         GByteArray *data;
-        guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        SUBPARAMETER_SIZE_CHECK (num_fields * 8);
 
         data = g_byte_array_sized_new (num_fields);
         g_byte_array_set_size (data, num_fields);
-        for (i = 0; i < num_fields; i++) {
-            data->data[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
+        bit_reader_read_bytes (&reader, data->data, num_fields);
 
         mm_dbg ("            data: (%u bytes)", num_fields);
         mm_sms_part_take_data (sms_part, data);
@@ -833,16 +1031,12 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
 
     case ENCODING_ASCII_7BIT: {
         gchar *text;
-        guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 7)) / 8));
+        SUBPARAMETER_SIZE_CHECK (num_fields * 7);
 
         text = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            text[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 7);
-            OFFSETS_UPDATE (7);
-        }
-        text[i] = '\0';
+        bit_reader_read_septets (&reader, (guint8 *) text, num_fields);
+        text[num_fields] = '\0';
 
         mm_dbg ("            text: '%s'", text);
         mm_sms_part_take_text (sms_part, text);
@@ -852,16 +1046,12 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
     case ENCODING_LATIN: {
         gchar *latin;
         gchar *text;
-        guint i;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_fields * 8)) / 8));
+        SUBPARAMETER_SIZE_CHECK (num_fields * 8);
 
         latin = g_malloc (num_fields + 1);
-        for (i = 0; i < num_fields; i++) {
-            latin[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
-        latin[i] = '\0';
+        bit_reader_read_bytes (&reader, (guint8 *) latin, num_fields);
+        latin[num_fields] = '\0';
 
         text = g_convert (latin, -1, "UTF-8", "ISO−8859−1", NULL, NULL, NULL);
         if (!text) {
@@ -878,19 +1068,15 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
     case ENCODING_UNICODE: {
         gchar *utf16;
         gchar *text;
-        guint i;
         guint num_bytes;
 
         /* 2 bytes per field! */
         num_bytes = num_fields * 2;
 
-        SUBPARAMETER_SIZE_CHECK (byte_offset + 1 + ((bit_offset + (num_bytes * 8)) / 8));
+        SUBPARAMETER_SIZE_CHECK (num_bytes * 8);
 
         utf16 = g_malloc (num_bytes);
-        for (i = 0; i < num_bytes; i++) {
-            utf16[i] = read_bits (&subparameter->parameter_value[byte_offset], bit_offset, 8);
-            OFFSETS_UPDATE (8);
-        }
+        bit_reader_read_bytes (&reader, (guint8 *) utf16, num_bytes);
 
         text = g_convert (utf16, num_bytes, "UTF-8", "UCS-2BE", NULL, NULL, NULL);
         if (!text) {
@@ -908,7 +1094,6 @@ read_bearer_data_user_data (MMSmsPart *sms_part,
         mm_dbg ("            text/data: ignored (unsupported encoding)");
     }
 
-#undef OFFSETS_UPDATE
 #undef SUBPARAMETER_SIZE_CHECK
 }
 
@@ -1153,43 +1338,6 @@ mm_sms_part_cdma_new_from_binary_pdu (guint index,
     return sms_part;
 }
 
-/*****************************************************************************/
-/* Write bits; o_bits < 8; n_bits <= 8
- *
- * Byte 0            Byte 1
- * [7|6|5|4|3|2|1|0] [7|6|5|4|3|2|1|0]
- *
- * o_bits+n_bits <= 16
- *
- * NOTE! The bits being set should be 0 initially.
- */
-static void
-write_bits (guint8 *bytes,
-            guint8 o_bits,
-            guint8 n_bits,
-            guint8 bits)
-{
-    guint8 bits_in_first;
-    guint8 bits_in_second;
-
-    g_assert (o_bits < 8);
-    g_assert (n_bits <= 8);
-    g_assert (o_bits + n_bits <= 16);
-
-    /* Write only in the first byte */
-    if (o_bits + n_bits <= 8) {
-        bytes[0] |= (bits & ((1 << n_bits) - 1)) << (8 - o_bits - n_bits);
-        return;
-    }
-
-    /* Write (8 - o_bits) in the first byte and (n_bits - (8 - o_bits)) in the second byte */
-    bits_in_first = 8 - o_bits;
-    bits_in_second = n_bits - bits_in_first;
-
-    write_bits (&bytes[0], o_bits, bits_in_first, (bits >> bits_in_second));
-    write_bits (&bytes[1], 0, bits_in_second, bits);
-}
-
 /*****************************************************************************/
 
 static guint8
@@ -1249,39 +1397,27 @@ write_destination_address (MMSmsPart *part,
                            GError **error)
 {
     const gchar *number;
-    guint bit_offset;
-    guint byte_offset;
+    BitWriter writer;
     guint n_digits;
     guint i;
 
     mm_dbg ("    writing destination address...");
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
     number = mm_sms_part_get_number (part);
     n_digits = strlen (number);
 
     pdu[0] = PARAMETER_ID_DESTINATION_ADDRESS;
-    /* Write parameter length at the end */
-
-    byte_offset = 2;
-    bit_offset = 0;
+    /* Write parameter length at the end; the length field is a single byte,
+     * so up to 255 bytes of parameter value fit after the header */
+    bit_writer_init (&writer, &pdu[2], 255);
 
     /* Digit mode: DTMF always */
     mm_dbg ("        digit mode: dtmf");
-    write_bits (&pdu[byte_offset], bit_offset, 1, DIGIT_MODE_DTMF);
-    OFFSETS_UPDATE (1);
+    bit_writer_write (&writer, 1, DIGIT_MODE_DTMF);
 
     /* Number mode: DIGIT always */
     mm_dbg ("        number mode: digit");
-    write_bits (&pdu[byte_offset], bit_offset, 1, NUMBER_MODE_DIGIT);
-    OFFSETS_UPDATE (1);
+    bit_writer_write (&writer, 1, NUMBER_MODE_DIGIT);
 
     /* Number type and numbering plan only needed in ASCII digit mode, so skip */
 
@@ -1295,8 +1431,7 @@ write_destination_address (MMSmsPart *part,
         return FALSE;
     }
     mm_dbg ("        num fields: %u", n_digits);
-    write_bits (&pdu[byte_offset], bit_offset, 8, n_digits);
-    OFFSETS_UPDATE (8);
+    bit_writer_write (&writer, 8, n_digits);
 
     /* Actual DTMF encoded number */
     mm_dbg ("        address: %s", number);
@@ -1312,23 +1447,18 @@ write_destination_address (MMSmsPart *part,
                          number[i]);
             return FALSE;
         }
-        write_bits (&pdu[byte_offset], bit_offset, 4, dtmf);
-        OFFSETS_UPDATE (4);
+        bit_writer_write (&writer, 4, dtmf);
     }
 
-#undef OFFSETS_UPDATE
-
-    /* Write parameter length (remove header length to offset) */
-    byte_offset += !!bit_offset - 2;
-    if (byte_offset > 256) {
+    /* Write parameter length */
+    if (writer.error) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_UNSUPPORTED,
-                     "Number too long (max 256 bytes, %u given)",
-                     byte_offset);
+                     "Number too long (max 255 bytes)");
         return FALSE;
     }
-    pdu[1] = byte_offset;
+    pdu[1] = bit_writer_get_len (&writer);
 
     *absolute_offset += (2 + pdu[1]);
     return TRUE;
@@ -1340,13 +1470,17 @@ write_bearer_data_message_identifier (MMSmsPart *part,
                                       guint *parameter_offset,
                                       GError **error)
 {
+    BitWriter writer;
+
     pdu[0] = SUBPARAMETER_ID_MESSAGE_ID;
     pdu[1] = 3; /* subparameter_len, always 3 */
 
     mm_dbg ("        writing message identifier: submit");
 
+    bit_writer_init (&writer, &pdu[2], 3);
+
     /* Message type */
-    write_bits (&pdu[2], 0, 4, TELESERVICE_MESSAGE_TYPE_SUBMIT);
+    bit_writer_write (&writer, 4, TELESERVICE_MESSAGE_TYPE_SUBMIT);
 
     /* Skip adding a message id; assume it's filled in by device */
 
@@ -1423,35 +1557,24 @@ write_bearer_data_user_data (MMSmsPart *part,
 {
     const gchar *text;
     const GByteArray *data;
-    guint bit_offset = 0;
-    guint byte_offset = 0;
+    BitWriter writer;
     guint num_fields;
     guint num_bits_per_field;
-    guint i;
     Encoding encoding;
     GByteArray *converted = NULL;
     const GByteArray *aux;
-    guint num_bits_per_iter;
 
     mm_dbg ("        writing user data...");
 
-#define OFFSETS_UPDATE(n_bits) do { \
-        bit_offset += n_bits;       \
-        if (bit_offset >= 8) {      \
-            bit_offset-=8;          \
-            byte_offset++;          \
-        }                           \
-    } while (0)
-
     text = mm_sms_part_get_text (part);
     data = mm_sms_part_get_data (part);
     g_assert (text || data);
     g_assert (!(!text && !data));
 
     pdu[0] = SUBPARAMETER_ID_USER_DATA;
-    /* Write parameter length at the end */
-    byte_offset = 2;
-    bit_offset = 0;
+    /* Write subparameter length at the end; the length field is a single
+     * byte, so up to 255 bytes of subparameter value fit after the header */
+    bit_writer_init (&writer, &pdu[2], 255);
 
     /* Text or Data */
     if (text) {
@@ -1470,8 +1593,7 @@ write_bearer_data_user_data (MMSmsPart *part,
 
     /* Message encoding*/
     mm_dbg ("            message encoding: %s", encoding_to_string (encoding));
-    write_bits (&pdu[byte_offset], bit_offset, 5, encoding);
-    OFFSETS_UPDATE (5);
+    bit_writer_write (&writer, 5, encoding);
 
     /* Number of fields */
     if (num_fields > 256) {
@@ -1485,37 +1607,31 @@ write_bearer_data_user_data (MMSmsPart *part,
         return FALSE;
     }
     mm_dbg ("            num fields: %u", num_fields);
-    write_bits (&pdu[byte_offset], bit_offset, 8, num_fields);
-    OFFSETS_UPDATE (8);
+    bit_writer_write (&writer, 8, num_fields);
 
-    /* For ASCII-7, write 7 bits in each iteration; for the remaining ones
-     * go byte per byte */
+    /* For ASCII-7, write 7 bits per field; for the remaining ones (including
+     * the 16-bit UTF-16 fields) go byte per byte */
     if (text)
         mm_dbg ("            text: '%s'", text);
     else
         mm_dbg ("            data: (%u bytes)", num_fields);
-    num_bits_per_iter = num_bits_per_field < 8 ? num_bits_per_field : 8;
-    for (i = 0; i < aux->len; i++) {
-        write_bits (&pdu[byte_offset], bit_offset, num_bits_per_iter, aux->data[i]);
-        OFFSETS_UPDATE (num_bits_per_iter);
-    }
+    if (num_bits_per_field == 7)
+        bit_writer_write_septets (&writer, aux->data, aux->len);
+    else
+        bit_writer_write_bytes (&writer, aux->data, aux->len);
 
     if (converted)
         g_byte_array_unref (converted);
 
-#undef OFFSETS_UPDATE
-
-    /* Write subparameter length (remove header length to offset) */
-    byte_offset += !!bit_offset - 2;
-    if (byte_offset > 256) {
+    /* Write subparameter length */
+    if (writer.error) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_UNSUPPORTED,
-                     "Data or Text too long (max 256 bytes, %u given)",
-                     byte_offset);
+                     "Data or Text too long (max 255 bytes)");
         return FALSE;
     }
-    pdu[1] = byte_offset;
+    pdu[1] = bit_writer_get_len (&writer);
 
     *parameter_offset += (2 + pdu[1]);
     return TRUE;
@@ -1549,11 +1665,11 @@ write_bearer_data (MMSmsPart *part,
 
     /* Write parameter length (remove header length to offset) */
     offset -= 2;
-    if (offset > 256) {
+    if (offset > 255) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_UNSUPPORTED,
-                     "Bearer data too long (max 256 bytes, %u given)",
+                     "Bearer data too long (max 255 bytes, %u given)",
                      offset);
         return FALSE;
     }
@@ -1589,8 +1705,8 @@ mm_sms_part_cdma_get_submit_pdu (MMSmsPart *part,
     /* Current max size estimations:
      *  Message type: 1 byte
      *  Teleservice ID: 5 bytes
-     *  Destination address: 2 + 256 bytes
-     *  Bearer data: 2 + 256 bytes
+     *  Destination address: 2 + 255 bytes
+     *  Bearer data: 2 + 255 bytes
      */
     pdu = g_malloc0 (1024);
 
@@ -0,0 +1,392 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2015 The ModemManager Authors
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "mm-trace.h"
+
+/* Longest span name stored; longer ones get truncated */
+#define TRACE_NAME_MAX 48
+
+/* Upper limit of step machines being tracked at the same time; contexts
+ * which never reach their last step (e.g. on errors) stay in the table
+ * until this limit is reached */
+#define TRACE_OPEN_STEPS_MAX 512
+
+typedef struct {
+    const gchar *owner;     /* interned */
+    const gchar *category;  /* static */
+    gchar        name[TRACE_NAME_MAX];
+    gint         first_step; /* -1 if not a step span */
+    gint         step;
+    gint64       start;
+    gint64       duration;
+    gboolean     success;
+} TraceSpan;
+
+typedef struct {
+    const gchar *owner;     /* interned */
+    const gchar *machine;   /* static */
+    guint        step;
+    gint64       start;
+} TraceOpenStep;
+
+gboolean mm_trace_active;
+
+static TraceSpan  *spans;
+static guint       spans_capacity;
+static guint       spans_next;
+static guint64     spans_total;
+static GHashTable *open_steps;
+
+/*****************************************************************************/
+
+static TraceSpan *
+trace_span_new (const gchar *owner,
+                const gchar *category,
+                gint64 start,
+                gint64 end)
+{
+    TraceSpan *span;
+
+    span = &spans[spans_next];
+    spans_next = (spans_next + 1) % spans_capacity;
+    spans_total++;
+
+    span->owner = g_intern_string (owner ? owner : "unknown");
+    span->category = category;
+    span->start = start;
+    span->duration = end - start;
+    span->first_step = -1;
+    span->step = -1;
+    span->success = TRUE;
+    span->name[0] = '\0';
+    return span;
+}
+
+void
+mm_trace_record_span (const gchar *owner,
+                      const gchar *category,
+                      const gchar *name,
+                      gint64 start,
+                      gboolean success)
+{
+    TraceSpan *span;
+
+    if (!mm_trace_active)
+        return;
+
+    span = trace_span_new (owner, category, start, g_get_monotonic_time ());
+    span->success = success;
+    if (name)
+        g_strlcpy (span->name, name, sizeof (span->name));
+}
+
+static void
+trace_open_step_close (TraceOpenStep *open_step,
+                       guint next_step,
+                       gint64 now)
+{
+    TraceSpan *span;
+
+    span = trace_span_new (open_step->owner, "step", open_step->start, now);
+    g_strlcpy (span->name, open_step->machine, sizeof (span->name));
+    span->first_step = open_step->step;
+    /* Steps going backwards mean a retry; report the one we started with */
+    span->step = (next_step > open_step->step ? next_step - 1 : open_step->step);
+}
+
+void
+mm_trace_record_step (const gchar *owner,
+                      const gchar *machine,
+                      gconstpointer ctx,
+                      guint step,
+                      gboolean last)
+{
+    TraceOpenStep *open_step;
+    gint64 now;
+
+    if (!mm_trace_active)
+        return;
+
+    now = g_get_monotonic_time ();
+
+    open_step = g_hash_table_lookup (open_steps, ctx);
+    if (open_step) {
+        /* A context reused for another machine, or a new run of the same
+         * machine, means the previous one was abandoned; just forget it */
+        if (open_step->machine == machine && step != 0)
+            trace_open_step_close (open_step, step, now);
+        g_hash_table_remove (open_steps, ctx);
+    }
+
+    if (last)
+        return;
+
+    if (g_hash_table_size (open_steps) >= TRACE_OPEN_STEPS_MAX)
+        g_hash_table_remove_all (open_steps);
+
+    open_step = g_slice_new (TraceOpenStep);
+    open_step->owner = g_intern_string (owner ? owner : "unknown");
+    open_step->machine = machine;
+    open_step->step = step;
+    open_step->start = now;
+    g_hash_table_insert (open_steps, (gpointer) ctx, open_step);
+}
+
+/*****************************************************************************/
+
+static void
+append_json_string (GString *str,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    g_string_append_c (str, '"');
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (str, "\\\"");
+            break;
+        case '\\':
+            g_string_append (str, "\\\\");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf (str, "\\u%04x", (guint) (guchar) *p);
+            else
+                g_string_append_c (str, *p);
+            break;
+        }
+    }
+    g_string_append_c (str, '"');
+}
+
+static guint
+owner_tid (GPtrArray *owners,
+           const gchar *owner)
+{
+    guint i;
+
+    /* Owners are interned, compare pointers */
+    for (i = 0; i < owners->len; i++) {
+        if (g_ptr_array_index (owners, i) == owner)
+            return i + 1;
+    }
+    g_ptr_array_add (owners, (gpointer) owner);
+    return owners->len;
+}
+
+static void
+append_event_header (GString *str,
+                     gboolean *first,
+                     const gchar *name,
+                     const gchar *category,
+                     const gchar *phase,
+                     gint64 ts,
+                     guint tid)
+{
+    g_string_append (str, *first ? "\n  " : ",\n  ");
+    *first = FALSE;
+
+    g_string_append (str, "{\"name\":");
+    append_json_string (str, name);
+    g_string_append (str, ",\"cat\":");
+    append_json_string (str, category);
+    g_string_append_printf (str,
+                            ",\"ph\":\"%s\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":%u,\"tid\":%u",
+                            phase, ts, (guint) getpid (), tid);
+}
+
+/* The trace includes device names and command timings, so make sure that
+ * only the owner of the daemon is able to read it, regardless of the
+ * umask and of whether the file already existed */
+static gboolean
+write_private_file (const gchar *path,
+                    const gchar *contents,
+                    gsize len,
+                    GError **error)
+{
+    gint fd;
+    gint errsv;
+
+    fd = open (path, O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        errsv = errno;
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                     "Couldn't open file: %s", g_strerror (errsv));
+        return FALSE;
+    }
+
+    if (fchmod (fd, S_IRUSR | S_IWUSR) < 0)
+        goto failed;
+
+    while (len > 0) {
+        gssize written;
+
+        written = write (fd, contents, len);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            goto failed;
+        }
+        contents += written;
+        len -= written;
+    }
+
+    if (close (fd) < 0) {
+        errsv = errno;
+        g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                     "Couldn't close file: %s", g_strerror (errsv));
+        return FALSE;
+    }
+    return TRUE;
+
+failed:
+    errsv = errno;
+    close (fd);
+    g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+                 "Couldn't write file: %s", g_strerror (errsv));
+    return FALSE;
+}
+
+gboolean
+mm_trace_dump (const gchar *path,
+               GError **error)
+{
+    GString *str;
+    GPtrArray *owners;
+    GHashTableIter iter;
+    gpointer value;
+    gboolean first = TRUE;
+    gboolean success;
+    guint n_spans;
+    guint start;
+    guint i;
+
+    if (!mm_trace_active) {
+        g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "Tracing is not enabled");
+        return FALSE;
+    }
+
+    str = g_string_sized_new (4096);
+    owners = g_ptr_array_new ();
+
+    g_string_append (str, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+
+    /* Oldest span first */
+    n_spans = MIN (spans_total, (guint64) spans_capacity);
+    start = (spans_total > spans_capacity ? spans_next : 0);
+
+    for (i = 0; i < n_spans; i++) {
+        const TraceSpan *span = &spans[(start + i) % spans_capacity];
+        gchar *name;
+
+        if (span->step >= 0)
+            name = g_strdup_printf ("%s [%d]", span->name, span->step);
+        else
+            name = g_strdup (span->name);
+
+        append_event_header (str, &first, name, span->category, "X",
+                             span->start, owner_tid (owners, span->owner));
+        g_string_append_printf (str, ",\"dur\":%" G_GINT64_FORMAT ",\"args\":{\"owner\":", span->duration);
+        append_json_string (str, span->owner);
+        g_string_append (str, ",\"outcome\":");
+        append_json_string (str, span->success ? "success" : "failure");
+        if (span->first_step >= 0)
+            g_string_append_printf (str, ",\"first-step\":%d", span->first_step);
+        g_string_append (str, "}}");
+        g_free (name);
+    }
+
+    /* Steps not finished (yet) are reported as instant events */
+    g_hash_table_iter_init (&iter, open_steps);
+    while (g_hash_table_iter_next (&iter, NULL, &value)) {
+        const TraceOpenStep *open_step = value;
+        gchar *name;
+
+        name = g_strdup_printf ("%s [%u]", open_step->machine, open_step->step);
+        append_event_header (str, &first, name, "step", "i",
+                             open_step->start, owner_tid (owners, open_step->owner));
+        g_string_append (str, ",\"s\":\"t\",\"args\":{\"owner\":");
+        append_json_string (str, open_step->owner);
+        g_string_append (str, ",\"outcome\":\"unfinished\"}}");
+        g_free (name);
+    }
+
+    /* Name each thread after its owner */
+    for (i = 0; i < owners->len; i++) {
+        append_event_header (str, &first, "thread_name", "__metadata", "M", 0, i + 1);
+        g_string_append (str, ",\"args\":{\"name\":");
+        append_json_string (str, g_ptr_array_index (owners, i));
+        g_string_append (str, "}}");
+    }
+
+    g_string_append (str, "\n]}\n");
+
+    success = write_private_file (path, str->str, str->len, error);
+
+    g_ptr_array_unref (owners);
+    g_string_free (str, TRUE);
+    return success;
+}
+
+/*****************************************************************************/
+
+static void
+trace_open_step_free (TraceOpenStep *open_step)
+{
+    g_slice_free (TraceOpenStep, open_step);
+}
+
+void
+mm_trace_init (guint capacity)
+{
+    g_return_if_fail (!mm_trace_active);
+
+    if (!capacity)
+        return;
+
+    spans = g_new0 (TraceSpan, capacity);
+    spans_capacity = capacity;
+    spans_next = 0;
+    spans_total = 0;
+    open_steps = g_hash_table_new_full (g_direct_hash,
+                                        g_direct_equal,
+                                        NULL,
+                                        (GDestroyNotify)trace_open_step_free);
+    mm_trace_active = TRUE;
+}
+
+void
+mm_trace_shutdown (void)
+{
+    if (!mm_trace_active)
+        return;
+
+    mm_trace_active = FALSE;
+    g_hash_table_unref (open_steps);
+    open_steps = NULL;
+    g_free (spans);
+    spans = NULL;
+    spans_capacity = 0;
+}
@@ -0,0 +1,69 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2015 The ModemManager Authors
+ */
+
+#ifndef MM_TRACE_H
+#define MM_TRACE_H
+
+#include <glib.h>
+
+/*
+ * Lightweight tracing of step machines and port transactions.
+ *
+ * Spans are kept in a fixed size ring buffer, and can be dumped as Chrome
+ * trace event JSON (loadable in chrome://tracing or Perfetto). When tracing
+ * is not enabled the macros below only check a global flag, so callers don't
+ * need to guard them.
+ */
+
+/* Not to be used directly, use the macros */
+extern gboolean mm_trace_active;
+
+void     mm_trace_init     (guint capacity);
+void     mm_trace_shutdown (void);
+gboolean mm_trace_dump     (const gchar *path,
+                            GError **error);
+
+void mm_trace_record_span (const gchar *owner,
+                           const gchar *category,
+                           const gchar *name,
+                           gint64 start,
+                           gboolean success);
+void mm_trace_record_step (const gchar *owner,
+                           const gchar *machine,
+                           gconstpointer ctx,
+                           guint step,
+                           gboolean last);
+
+/* Start time for a span, 0 if tracing is disabled */
+#define mm_trace_now() \
+    (G_UNLIKELY (mm_trace_active) ? g_get_monotonic_time () : 0)
+
+/* Record a span of the given @category and @name, started at @start
+ * (as given by mm_trace_now()) and finishing right now */
+#define mm_trace_span(owner, category, name, start, success) G_STMT_START { \
+        if (G_UNLIKELY (mm_trace_active) && (start) > 0)                    \
+            mm_trace_record_span (owner, category, name, start, success);   \
+    } G_STMT_END
+
+/* Record that the step machine @machine running with context @ctx entered
+ * @step. The time until the next step is entered is reported as a span of
+ * the step before that one, which is the step that was waiting for an
+ * asynchronous operation. @last must be set for the final step. */
+#define mm_trace_step(owner, machine, ctx, step, last) G_STMT_START { \
+        if (G_UNLIKELY (mm_trace_active))                             \
+            mm_trace_record_step (owner, machine, ctx, step, last);   \
+    } G_STMT_END
+
+#endif /* MM_TRACE_H */
@@ -0,0 +1,282 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+/*
+ * Fuzzing entry point over the SMS PDU decoders and the GSM 7-bit
+ * conversions. The first input byte selects the target (see
+ * FuzzSmsPartTarget), the remaining ones are given to it as they are.
+ *
+ * Texts successfully decoded are encoded back into a SUBMIT PDU, so that
+ * the encoders also see whatever the decoders are able to produce, and
+ * the resulting PDU must be parseable again.
+ *
+ * This file is linked both into test-sms-codecs, which runs it over a
+ * mutated corpus, and into the libFuzzer target built when configuring
+ * with --enable-fuzzers.
+ */
+
+#include <glib.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-sms-part-3gpp.h"
+#include "mm-sms-part-cdma.h"
+#include "mm-charsets.h"
+#include "mm-log.h"
+
+#include "fuzz-sms-part.h"
+
+/* Longest input given to the targets; valid PDUs are way shorter, and the
+ * GSM 7-bit to UTF-8 conversion refuses 4096 septets or more */
+#define FUZZ_INPUT_MAX 2048
+
+#define FUZZ_NUMBER "+15555551234"
+
+/*****************************************************************************/
+
+static void
+fuzz_3gpp_reencode (const gchar *text)
+{
+    MMSmsPart *part;
+    MMSmsEncoding encoding = MM_SMS_ENCODING_UNKNOWN;
+    gchar **split;
+    guint8 *pdu;
+    guint len = 0;
+    guint msgstart = 0;
+
+    if (!g_utf8_validate (text, -1, NULL))
+        return;
+
+    split = mm_sms_part_3gpp_util_split_text (text, &encoding);
+    if (!split)
+        return;
+    g_strfreev (split);
+
+    /* Texts from a single part are encoded as a single part again; this
+     * may still fail if they don't fit with the encoding chosen by us */
+    part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_SUBMIT);
+    mm_sms_part_set_number (part, FUZZ_NUMBER);
+    mm_sms_part_set_text (part, text);
+    mm_sms_part_set_encoding (part, encoding);
+    pdu = mm_sms_part_3gpp_get_submit_pdu (part, &len, &msgstart, NULL);
+    mm_sms_part_free (part);
+    if (!pdu)
+        return;
+
+    g_assert_cmpuint (msgstart, <, len);
+    part = mm_sms_part_3gpp_new_from_binary_pdu (0, pdu, len, NULL);
+    g_assert (part != NULL);
+    mm_sms_part_free (part);
+    g_free (pdu);
+}
+
+static void
+fuzz_3gpp_part (MMSmsPart *part)
+{
+    const gchar *text;
+
+    if (!part)
+        return;
+
+    text = mm_sms_part_get_text (part);
+    if (text)
+        fuzz_3gpp_reencode (text);
+    mm_sms_part_free (part);
+}
+
+static void
+fuzz_3gpp_pdu (const guint8 *data,
+               gsize size)
+{
+    fuzz_3gpp_part (mm_sms_part_3gpp_new_from_binary_pdu (0, data, size, NULL));
+}
+
+static void
+fuzz_3gpp_hex_pdu (const guint8 *data,
+                   gsize size)
+{
+    gchar *hex;
+
+    /* The hex PDU is read up to the first NUL */
+    hex = g_strndup ((const gchar *) data, size);
+    fuzz_3gpp_part (mm_sms_part_3gpp_new_from_pdu (0, hex, NULL));
+    g_free (hex);
+}
+
+/*****************************************************************************/
+
+static void
+fuzz_cdma_reencode (const gchar *text)
+{
+    MMSmsPart *part;
+    guint8 *pdu;
+    guint len = 0;
+
+    if (!g_utf8_validate (text, -1, NULL))
+        return;
+
+    part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_CDMA_SUBMIT);
+    mm_sms_part_set_cdma_teleservice_id (part, MM_SMS_CDMA_TELESERVICE_ID_WMT);
+    mm_sms_part_set_number (part, FUZZ_NUMBER);
+    mm_sms_part_set_text (part, text);
+    pdu = mm_sms_part_cdma_get_submit_pdu (part, &len, NULL);
+    mm_sms_part_free (part);
+    if (!pdu)
+        return;
+
+    part = mm_sms_part_cdma_new_from_binary_pdu (0, pdu, len, NULL);
+    g_assert (part != NULL);
+    mm_sms_part_free (part);
+    g_free (pdu);
+}
+
+static void
+fuzz_cdma_pdu (const guint8 *data,
+               gsize size)
+{
+    MMSmsPart *part;
+    const gchar *text;
+
+    part = mm_sms_part_cdma_new_from_binary_pdu (0, data, size, NULL);
+    if (!part)
+        return;
+
+    text = mm_sms_part_get_text (part);
+    if (text)
+        fuzz_cdma_reencode (text);
+    mm_sms_part_free (part);
+}
+
+/*****************************************************************************/
+
+/* Bits are numbered from the least significant one of the first octet, as
+ * in the GSM 7-bit packing */
+static gboolean
+bits_equal (const guint8 *a,
+            const guint8 *b,
+            guint first_bit,
+            guint n_bits)
+{
+    guint i;
+
+    for (i = first_bit; i < first_bit + n_bits; i++) {
+        if (((a[i / 8] ^ b[i / 8]) >> (i % 8)) & 1)
+            return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+fuzz_gsm7 (const guint8 *data,
+           gsize size)
+{
+    guint8 *unpacked;
+    guint8 *packed;
+    guint8 *utf8;
+    guint8 *gsm;
+    guint32 gsm_len = 0;
+    guint32 n_septets;
+    guint32 packed_len;
+    guint8 offset;
+
+    if (size < 2)
+        return;
+
+    /* Bit offset of the first septet */
+    offset = data[0] % 7;
+    data++;
+    size--;
+
+    /* Packing what was unpacked must give back the same bits */
+    n_septets = (size * 8 - offset) / 7;
+    unpacked = g_malloc (n_septets + 1);
+    gsm_unpack_buf (data, n_septets, offset, unpacked);
+
+    packed = g_malloc0 (GSM_PACKED_LEN (n_septets, offset) + 1);
+    packed_len = gsm_pack_buf (unpacked, n_septets, offset, packed);
+    g_assert_cmpuint (packed_len, ==, GSM_PACKED_LEN (n_septets, offset));
+    g_assert (bits_equal (data, packed, offset, n_septets * 7));
+    g_free (packed);
+
+    /* Whatever we get in UTF-8 must be convertible to GSM again */
+    utf8 = mm_charset_gsm_unpacked_to_utf8 (unpacked, n_septets);
+    g_assert (utf8 != NULL);
+    g_assert (g_utf8_validate ((const gchar *) utf8, -1, NULL));
+    gsm = mm_charset_utf8_to_unpacked_gsm ((const gchar *) utf8, &gsm_len);
+    g_assert (gsm != NULL);
+    g_free (gsm);
+    g_free (utf8);
+
+    g_free (unpacked);
+}
+
+/*****************************************************************************/
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data,
+                        size_t size)
+{
+    if (size < 1 || size > FUZZ_INPUT_MAX)
+        return 0;
+
+    switch (data[0] % FUZZ_SMS_PART_N_TARGETS) {
+    case FUZZ_SMS_PART_3GPP_PDU:
+        fuzz_3gpp_pdu (data + 1, size - 1);
+        break;
+    case FUZZ_SMS_PART_3GPP_HEX_PDU:
+        fuzz_3gpp_hex_pdu (data + 1, size - 1);
+        break;
+    case FUZZ_SMS_PART_CDMA_PDU:
+        fuzz_cdma_pdu (data + 1, size - 1);
+        break;
+    case FUZZ_SMS_PART_GSM7:
+        fuzz_gsm7 (data + 1, size - 1);
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    return 0;
+}
+
+/*****************************************************************************/
+
+#if defined FUZZ_SMS_PART_STANDALONE
+
+/* When built as libFuzzer target there is no test program providing these */
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+}
+
+int LLVMFuzzerInitialize (int *argc, char ***argv);
+
+int
+LLVMFuzzerInitialize (int *argc,
+                      char ***argv)
+{
+    g_type_init ();
+
+    /* Failed preconditions are bugs; warnings about malformed texts are
+     * expected and not fatal */
+    g_log_set_always_fatal (G_LOG_FATAL_MASK | G_LOG_LEVEL_CRITICAL);
+    return 0;
+}
+
+#endif
@@ -0,0 +1,33 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef FUZZ_SMS_PART_H
+#define FUZZ_SMS_PART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* First byte of the input selects what is being fuzzed */
+typedef enum {
+    FUZZ_SMS_PART_3GPP_PDU     = 0,
+    FUZZ_SMS_PART_3GPP_HEX_PDU = 1,
+    FUZZ_SMS_PART_CDMA_PDU     = 2,
+    FUZZ_SMS_PART_GSM7         = 3,
+    FUZZ_SMS_PART_N_TARGETS
+} FuzzSmsPartTarget;
+
+/* libFuzzer entry point */
+int LLVMFuzzerTestOneInput (const uint8_t *data,
+                            size_t size);
+
+#endif /* FUZZ_SMS_PART_H */
@@ -326,6 +326,75 @@ test_pack_gsm7_7_chars_offset (void *f, gpointer d)
     g_free (packed);
 }
 
+/* Bit by bit packing, to compare the bulk codecs against */
+static void
+reference_gsm_pack (const guint8 *unpacked,
+                    guint32 len,
+                    guint8 start_offset,
+                    guint8 *packed)
+{
+    guint32 i;
+    guint j;
+
+    for (i = 0; i < len; i++) {
+        for (j = 0; j < 7; j++) {
+            guint32 bit = start_offset + i * 7 + j;
+
+            if (unpacked[i] & (1 << j))
+                packed[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+}
+
+static void
+test_pack_unpack_gsm7_offsets (void *f, gpointer d)
+{
+    guint8 unpacked[40];
+    guint32 len;
+    guint8 start_offset;
+    guint32 i;
+
+    for (i = 0; i < G_N_ELEMENTS (unpacked); i++)
+        unpacked[i] = (guint8) ((i * 37 + 5) & 0x7F);
+
+    /* All lengths up to several 8-septet blocks, with any padding */
+    for (len = 0; len <= G_N_ELEMENTS (unpacked); len++) {
+        for (start_offset = 0; start_offset < 8; start_offset++) {
+            guint8 expected[64] = { 0 };
+            guint8 packed[64] = { 0 };
+            guint8 result[G_N_ELEMENTS (unpacked)];
+            guint8 *allocated;
+            guint32 packed_len;
+            guint32 expected_len;
+
+            expected_len = GSM_PACKED_LEN (len, start_offset);
+            reference_gsm_pack (unpacked, len, start_offset, expected);
+
+            packed_len = gsm_pack_buf (unpacked, len, start_offset, packed);
+            g_assert_cmpuint (packed_len, ==, expected_len);
+            g_assert_cmpint (memcmp (packed, expected, sizeof (packed)), ==, 0);
+
+            if (len > 0) {
+                allocated = gsm_pack (unpacked, len, start_offset, &packed_len);
+                g_assert_cmpuint (packed_len, ==, expected_len);
+                g_assert_cmpint (memcmp (allocated, expected, packed_len), ==, 0);
+                g_free (allocated);
+            }
+
+            /* Bits before the start offset must be kept */
+            if (start_offset > 0) {
+                memset (packed, 0, sizeof (packed));
+                packed[0] = 0xFF >> (8 - start_offset);
+                gsm_pack_buf (unpacked, len, start_offset, packed);
+                g_assert_cmphex (packed[0] & (0xFF >> (8 - start_offset)), ==, 0xFF >> (8 - start_offset));
+            }
+
+            gsm_unpack_buf (expected, len, start_offset, result);
+            g_assert_cmpint (memcmp (result, unpacked, len), ==, 0);
+        }
+    }
+}
+
 static void
 test_take_convert_ucs2_hex_utf8 (void *f, gpointer d)
 {
@@ -361,6 +430,254 @@ test_take_convert_ucs2_bad_ascii2 (void *f, gpointer d)
     g_assert (converted == NULL);
 }
 
+static void
+common_test_single_byte_charset (MMModemCharset charset,
+                                 const gchar *iconv_name)
+{
+    guint i;
+
+    /* Every byte decoded through the charset tables must match the iconv
+     * conversion, and must encode back to the same byte */
+    for (i = 0x01; i <= 0xFF; i++) {
+        gchar hex[3];
+        gchar raw[2];
+        gchar *utf8;
+        gchar *expected;
+        gchar *back;
+
+        g_snprintf (hex, sizeof (hex), "%.2X", i);
+        raw[0] = (gchar) i;
+        raw[1] = '\0';
+
+        expected = g_convert (raw, 1, "UTF-8", iconv_name, NULL, NULL, NULL);
+        g_assert (expected);
+
+        utf8 = mm_modem_charset_hex_to_utf8 (hex, charset);
+        g_assert_cmpstr (utf8, ==, expected);
+
+        back = mm_modem_charset_utf8_to_hex (utf8, charset);
+        g_assert_cmpstr (back, ==, hex);
+
+        g_free (expected);
+        g_free (utf8);
+        g_free (back);
+    }
+}
+
+static void
+test_charset_8859_1 (void *f, gpointer d)
+{
+    common_test_single_byte_charset (MM_MODEM_CHARSET_8859_1, "ISO8859-1");
+}
+
+static void
+test_charset_pccp437 (void *f, gpointer d)
+{
+    common_test_single_byte_charset (MM_MODEM_CHARSET_PCCP437, "CP437");
+}
+
+static void
+test_charset_pcdn (void *f, gpointer d)
+{
+    common_test_single_byte_charset (MM_MODEM_CHARSET_PCDN, "CP850");
+}
+
+static void
+test_charset_gsm_hex (void *f, gpointer d)
+{
+    gchar *utf8;
+    gchar *hex;
+
+    /* "@£{€}" in unpacked GSM, including extension table chars */
+    utf8 = mm_modem_charset_hex_to_utf8 ("00011B281B651B29", MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (utf8, ==, "@£{€}");
+
+    hex = mm_modem_charset_utf8_to_hex (utf8, MM_MODEM_CHARSET_GSM);
+    g_assert_cmpstr (hex, ==, "00011B281B651B29");
+
+    g_free (utf8);
+    g_free (hex);
+
+    /* Chars above 0x7F are not valid GSM */
+    utf8 = mm_modem_charset_hex_to_utf8 ("4180", MM_MODEM_CHARSET_GSM);
+    g_assert (utf8 == NULL);
+}
+
+static void
+test_charset_ucs2_hex (void *f, gpointer d)
+{
+    static const gchar *s = "Привет, 世界! ¥€";
+    gchar *hex;
+    gchar *utf8;
+
+    hex = mm_modem_charset_utf8_to_hex (s, MM_MODEM_CHARSET_UCS2);
+    g_assert_cmpstr (hex, ==, "041F04400438043204350442002C00204E16754C0021002000A520AC");
+
+    utf8 = mm_modem_charset_hex_to_utf8 (hex, MM_MODEM_CHARSET_UCS2);
+    g_assert_cmpstr (utf8, ==, s);
+
+    g_free (hex);
+    g_free (utf8);
+
+    /* Surrogates are not valid UCS-2 */
+    utf8 = mm_modem_charset_hex_to_utf8 ("D83DDE00", MM_MODEM_CHARSET_UCS2);
+    g_assert (utf8 == NULL);
+
+    /* Neither are chars outside the BMP representable */
+    hex = mm_modem_charset_utf8_to_hex ("\xf0\x9f\x98\x80", MM_MODEM_CHARSET_UCS2);
+    g_assert (hex == NULL);
+}
+
+static void
+test_byte_array_append_translit (void *f, gpointer d)
+{
+    GByteArray *array;
+
+    /* Characters not in the target charset are replaced */
+    array = g_byte_array_new ();
+    g_assert (mm_modem_charset_byte_array_append (array, "a€b", TRUE, MM_MODEM_CHARSET_8859_1));
+    g_assert_cmpuint (array->len, ==, 5);
+    g_assert (memcmp (array->data, "\"a?b\"", 5) == 0);
+    g_byte_array_unref (array);
+}
+
+/********************* PERFORMANCE TESTS *********************/
+
+#define PERF_ITERATIONS 20000
+
+static gchar *
+iconv_hex_to_utf8 (const gchar *src,
+                   const gchar *iconv_from)
+{
+    gchar *unconverted;
+    gchar *converted;
+    gsize unconverted_len = 0;
+
+    unconverted = mm_utils_hexstr2bin (src, &unconverted_len);
+    converted = g_convert (unconverted, unconverted_len, "UTF-8//TRANSLIT", iconv_from, NULL, NULL, NULL);
+    g_free (unconverted);
+    return converted;
+}
+
+static gchar *
+iconv_utf8_to_hex (const gchar *src,
+                   const gchar *iconv_to)
+{
+    gchar *converted;
+    gchar *hex;
+    gsize converted_len = 0;
+
+    converted = g_convert (src, -1, iconv_to, "UTF-8", NULL, &converted_len, NULL);
+    hex = mm_utils_bin2hexstr ((const guint8 *) converted, converted_len);
+    g_free (converted);
+    return hex;
+}
+
+static void
+common_perf_hex_to_utf8 (const gchar *hex,
+                         MMModemCharset charset,
+                         const gchar *iconv_from)
+{
+    gdouble iconv_time;
+    gdouble table_time;
+    guint i;
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        g_free (iconv_hex_to_utf8 (hex, iconv_from));
+    iconv_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        g_free (mm_modem_charset_hex_to_utf8 (hex, charset));
+    table_time = g_test_timer_elapsed ();
+
+    g_test_minimized_result (table_time, "%s hex to UTF-8: %.3fs (iconv: %.3fs)",
+                             mm_modem_charset_to_string (charset), table_time, iconv_time);
+}
+
+static void
+common_perf_utf8_to_hex (const gchar *utf8,
+                         MMModemCharset charset,
+                         const gchar *iconv_to)
+{
+    gdouble iconv_time;
+    gdouble table_time;
+    guint i;
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        g_free (iconv_utf8_to_hex (utf8, iconv_to));
+    iconv_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        g_free (mm_modem_charset_utf8_to_hex (utf8, charset));
+    table_time = g_test_timer_elapsed ();
+
+    g_test_minimized_result (table_time, "UTF-8 to %s hex: %.3fs (iconv: %.3fs)",
+                             mm_modem_charset_to_string (charset), table_time, iconv_time);
+}
+
+static void
+test_perf_ucs2 (void *f, gpointer d)
+{
+    /* A typical operator name and a USSD reply */
+    common_perf_hex_to_utf8 ("0054002d004d006f00620069006c0065", MM_MODEM_CHARSET_UCS2, "UCS-2BE");
+    common_perf_hex_to_utf8 ("0059006F00750072002000620061006C0061006E00630065002000690073002000310032002E0035003000200045005500520020", MM_MODEM_CHARSET_UCS2, "UCS-2BE");
+    common_perf_utf8_to_hex ("Your balance is 12.50 EUR", MM_MODEM_CHARSET_UCS2, "UCS-2BE");
+}
+
+static void
+test_perf_8859_1 (void *f, gpointer d)
+{
+    common_perf_hex_to_utf8 ("4F72616E676520C9737061F161", MM_MODEM_CHARSET_8859_1, "ISO8859-1");
+    common_perf_utf8_to_hex ("Orange España", MM_MODEM_CHARSET_8859_1, "ISO8859-1");
+}
+
+static void
+test_perf_pccp437 (void *f, gpointer d)
+{
+    common_perf_hex_to_utf8 ("546F6C6C20467265756E646520A4819A", MM_MODEM_CHARSET_PCCP437, "CP437");
+    common_perf_utf8_to_hex ("Toll Freunde ñüÜ", MM_MODEM_CHARSET_PCCP437, "CP437");
+}
+
+
+static void
+test_perf_gsm7 (void *f, gpointer d)
+{
+    /* A full single-part SMS */
+    guint8 unpacked[160];
+    guint8 packed[140];
+    gdouble reference_time;
+    gdouble time;
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (unpacked); i++)
+        unpacked[i] = g_random_int_range (0, 128);
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        memset (packed, 0, sizeof (packed));
+        reference_gsm_pack (unpacked, G_N_ELEMENTS (unpacked), 0, packed);
+    }
+    reference_time = g_test_timer_elapsed ();
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        gsm_pack_buf (unpacked, G_N_ELEMENTS (unpacked), 0, packed);
+    time = g_test_timer_elapsed ();
+
+    g_test_minimized_result (time, "GSM7 pack 160 septets: %.3fs (bit by bit: %.3fs)",
+                             time, reference_time);
+
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++)
+        gsm_unpack_buf (packed, G_N_ELEMENTS (unpacked), 0, unpacked);
+    time = g_test_timer_elapsed ();
+
+    g_test_minimized_result (time, "GSM7 unpack 160 septets: %.3fs", time);
+}
 
 typedef GTestFixtureFunc TCFunc;
 
@@ -390,11 +707,28 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_last_septet_alone, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_pack_gsm7_7_chars_offset, NULL));
+    g_test_suite_add (suite, TESTCASE (test_pack_unpack_gsm7_offsets, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_hex_utf8, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii, NULL));
     g_test_suite_add (suite, TESTCASE (test_take_convert_ucs2_bad_ascii2, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_charset_8859_1, NULL));
+    g_test_suite_add (suite, TESTCASE (test_charset_pccp437, NULL));
+    g_test_suite_add (suite, TESTCASE (test_charset_pcdn, NULL));
+    g_test_suite_add (suite, TESTCASE (test_charset_gsm_hex, NULL));
+    g_test_suite_add (suite, TESTCASE (test_charset_ucs2_hex, NULL));
+    g_test_suite_add (suite, TESTCASE (test_byte_array_append_translit, NULL));
+
+    /* Benchmarks against the iconv based conversions and bit by bit GSM7
+     * packing, run with -m perf */
+    if (g_test_perf ()) {
+        g_test_suite_add (suite, TESTCASE (test_perf_ucs2, NULL));
+        g_test_suite_add (suite, TESTCASE (test_perf_8859_1, NULL));
+        g_test_suite_add (suite, TESTCASE (test_perf_pccp437, NULL));
+        g_test_suite_add (suite, TESTCASE (test_perf_gsm7, NULL));
+    }
+
     result = g_test_run ();
 
     return result;
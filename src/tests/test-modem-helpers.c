@@ -195,6 +195,52 @@ test_cmgl_response_pantech_multiple (void *f, gpointer d)
     test_cmgl_response (str, expected, G_N_ELEMENTS (expected));
 }
 
+static void
+test_cmgl_header (void *f, gpointer d)
+{
+    gint index = -1;
+    gint status = -1;
+
+    g_assert (mm_3gpp_parse_pdu_cmgl_header ("+CMGL: 0,1,,147", &index, &status));
+    g_assert_cmpint (index, ==, 0);
+    g_assert_cmpint (status, ==, 1);
+
+    g_assert (mm_3gpp_parse_pdu_cmgl_header ("+CMGL: 17 , 3,35", &index, &status));
+    g_assert_cmpint (index, ==, 17);
+    g_assert_cmpint (status, ==, 3);
+
+    g_assert (!mm_3gpp_parse_pdu_cmgl_header ("079100F40D1101000F001000B917118336058F300", NULL, NULL));
+    g_assert (!mm_3gpp_parse_pdu_cmgl_header ("+CMGL: 17", NULL, NULL));
+}
+
+/*****************************************************************************/
+/* Test ISO8601 time parsing */
+
+static void
+test_iso8601_time_to_unix (void *f, gpointer d)
+{
+    gchar *str;
+    gint64 unix_time = 0;
+
+    g_assert (mm_iso8601_time_to_unix ("1970-01-01T00:00:00", &unix_time));
+    g_assert_cmpint (unix_time, ==, 0);
+
+    g_assert (mm_iso8601_time_to_unix ("2013-01-01T12:00:00+02:00", &unix_time));
+    g_assert_cmpint (unix_time, ==, 1357034400);
+
+    g_assert (mm_iso8601_time_to_unix ("2013-01-01T12:00:00-01:30", &unix_time));
+    g_assert_cmpint (unix_time, ==, 1357047000);
+
+    str = mm_new_iso8601_time (2013, 1, 1, 12, 0, 0, TRUE, 120);
+    g_assert (mm_iso8601_time_to_unix (str, &unix_time));
+    g_assert_cmpint (unix_time, ==, 1357034400);
+    g_free (str);
+
+    g_assert (!mm_iso8601_time_to_unix ("2013-01-01", NULL));
+    g_assert (!mm_iso8601_time_to_unix ("2013-13-01T12:00:00", NULL));
+    g_assert (!mm_iso8601_time_to_unix ("2013-01-01T12:00:00 foo", NULL));
+}
+
 /*****************************************************************************/
 /* Test COPS responses */
 
@@ -1805,6 +1851,71 @@ test_cgdcont_read_response_samsung (void *f, gpointer d)
     test_cgdcont_read_results ("Samsung", reply, &expected[0], G_N_ELEMENTS (expected));
 }
 
+/*****************************************************************************/
+/* Test CGACT read responses */
+
+static void
+test_cgact_read_results (const gchar *desc,
+                         const gchar *reply,
+                         MM3gppPdpContextActive *expected_results,
+                         guint32 expected_results_len)
+{
+    GList *l;
+    GError *error = NULL;
+    GList *results;
+    guint i;
+
+    trace ("\nTesting %s +CGACT response...\n", desc);
+
+    results = mm_3gpp_parse_cgact_read_response (reply, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (g_list_length (results), ==, expected_results_len);
+
+    /* Results are sorted by CID */
+    for (l = results, i = 0; l; l = g_list_next (l), i++) {
+        MM3gppPdpContextActive *pdp_active = l->data;
+
+        g_assert_cmpuint (pdp_active->cid, ==, expected_results[i].cid);
+        g_assert (pdp_active->active == expected_results[i].active);
+    }
+
+    mm_3gpp_pdp_context_active_list_free (results);
+}
+
+static void
+test_cgact_read_response_none (void *f, gpointer d)
+{
+    test_cgact_read_results ("none", "", NULL, 0);
+}
+
+static void
+test_cgact_read_response_multiple (void *f, gpointer d)
+{
+    const gchar *reply =
+        "+CGACT: 3,0\r\n"
+        "+CGACT: 1,1\r\n"
+        "+CGACT: 2, 0\r\n";
+    static MM3gppPdpContextActive expected[] = {
+        { 1, TRUE  },
+        { 2, FALSE },
+        { 3, FALSE }
+    };
+
+    test_cgact_read_results ("multiple", reply, &expected[0], G_N_ELEMENTS (expected));
+}
+
+static void
+test_cgact_read_response_invalid (void *f, gpointer d)
+{
+    GError *error = NULL;
+    GList *results;
+
+    results = mm_3gpp_parse_cgact_read_response ("+CGACT: 1,7\r\n", &error);
+    g_assert (results == NULL);
+    g_assert (error != NULL);
+    g_error_free (error);
+}
+
 /*****************************************************************************/
 /* Test CPMS responses */
 
@@ -1949,6 +2060,114 @@ test_cnum_response_generic_multiple_numbers (void *f, gpointer d)
     test_cnum_results ("Generic, multiple numbers", reply, (GStrv)expected);
 }
 
+/*****************************************************************************/
+/* Test +CESQ responses */
+
+typedef struct {
+    const gchar *str;
+    guint rxlev;
+    guint ber;
+    guint rscp;
+    guint ecn0;
+    guint rsrq;
+    guint rsrp;
+} CesqResponseTest;
+
+static const CesqResponseTest cesq_response_tests[] = {
+    { "+CESQ: 99,99,255,255,20,80",       99, 99, 255, 255,  20,  80 },
+    { "+CESQ: 99,99,95,40,255,255",       99, 99,  95,  40, 255, 255 },
+    { "+CESQ:10,6,255,255,255,255",       10,  6, 255, 255, 255, 255 },
+    { "+CESQ: 99,99,255,255,12,46,17,1",  99, 99, 255, 255,  12,  46 }
+};
+
+static void
+test_cesq_response (void *f, gpointer d)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (cesq_response_tests); i++) {
+        GError *error = NULL;
+        gboolean success;
+        guint rxlev = G_MAXUINT;
+        guint ber = G_MAXUINT;
+        guint rscp = G_MAXUINT;
+        guint ecn0 = G_MAXUINT;
+        guint rsrq = G_MAXUINT;
+        guint rsrp = G_MAXUINT;
+
+        success = mm_3gpp_parse_cesq_response (cesq_response_tests[i].str,
+                                               &rxlev, &ber,
+                                               &rscp, &ecn0,
+                                               &rsrq, &rsrp,
+                                               &error);
+        g_assert_no_error (error);
+        g_assert (success);
+
+        g_assert_cmpuint (cesq_response_tests[i].rxlev, ==, rxlev);
+        g_assert_cmpuint (cesq_response_tests[i].ber,   ==, ber);
+        g_assert_cmpuint (cesq_response_tests[i].rscp,  ==, rscp);
+        g_assert_cmpuint (cesq_response_tests[i].ecn0,  ==, ecn0);
+        g_assert_cmpuint (cesq_response_tests[i].rsrq,  ==, rsrq);
+        g_assert_cmpuint (cesq_response_tests[i].rsrp,  ==, rsrp);
+    }
+}
+
+static void
+test_cesq_response_to_signal (void *f, gpointer d)
+{
+    GError *error = NULL;
+    gboolean success;
+    MMSignal *gsm = NULL;
+    MMSignal *umts = NULL;
+    MMSignal *lte = NULL;
+
+    /* LTE only */
+    success = mm_3gpp_cesq_response_to_signal_info ("+CESQ: 99,99,255,255,20,80",
+                                                    &gsm, &umts, &lte,
+                                                    &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    g_assert (!gsm);
+    g_assert (!umts);
+    g_assert (lte);
+    g_assert_cmpfloat (mm_signal_get_rsrq (lte), ==, -10.0);
+    g_assert_cmpfloat (mm_signal_get_rsrp (lte), ==, -61.0);
+    g_object_unref (lte);
+
+    /* UMTS only, RSSI computed from RSCP and Ec/Io */
+    success = mm_3gpp_cesq_response_to_signal_info ("+CESQ: 99,99,95,40,255,255",
+                                                    &gsm, &umts, &lte,
+                                                    &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    g_assert (!gsm);
+    g_assert (umts);
+    g_assert (!lte);
+    g_assert_cmpfloat (mm_signal_get_ecio (umts), ==, -4.5);
+    g_assert_cmpfloat (mm_signal_get_rssi (umts), ==, -21.5);
+    g_object_unref (umts);
+
+    /* GSM only */
+    success = mm_3gpp_cesq_response_to_signal_info ("+CESQ: 10,6,255,255,255,255",
+                                                    &gsm, &umts, &lte,
+                                                    &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    g_assert (gsm);
+    g_assert (!umts);
+    g_assert (!lte);
+    g_assert_cmpfloat (mm_signal_get_rssi (gsm), ==, -101.0);
+    g_object_unref (gsm);
+
+    /* Nothing known */
+    success = mm_3gpp_cesq_response_to_signal_info ("+CESQ: 99,99,255,255,255,255",
+                                                    &gsm, &umts, &lte,
+                                                    &error);
+    g_assert (error);
+    g_assert (!success);
+    g_clear_error (&error);
+}
+
 /*****************************************************************************/
 /* Test operator ID parsing */
 
@@ -2480,12 +2699,19 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cgdcont_read_response_nokia, NULL));
     g_test_suite_add (suite, TESTCASE (test_cgdcont_read_response_samsung, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_cgact_read_response_none, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cgact_read_response_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cgact_read_response_invalid, NULL));
+
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_without_detail, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_detail_unquoted, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_international_number, NULL));
     g_test_suite_add (suite, TESTCASE (test_cnum_response_generic_multiple_numbers, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_cesq_response, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cesq_response_to_signal, NULL));
+
     g_test_suite_add (suite, TESTCASE (test_parse_operator_id, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_parse_cds, NULL));
@@ -2496,6 +2722,9 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_generic_multiple, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgl_header, NULL));
+
+    g_test_suite_add (suite, TESTCASE (test_iso8601_time_to_unix, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_supported_mode_filter, NULL));
 
@@ -0,0 +1,682 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+#include <string.h>
+#include <stdlib.h>
+#include <locale.h>
+
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-sms-part-3gpp.h"
+#include "mm-sms-part-cdma.h"
+#include "mm-log.h"
+
+#include "fuzz-sms-part.h"
+
+/* Runs over the whole corpus in the benchmarks */
+#define PERF_ITERATIONS 2000
+
+/************************************************************/
+/* Corpus */
+
+/* Real PDUs, as received from modems */
+static const gchar *corpus_3gpp[] = {
+    /* GSM7 */
+    "07912104442961F4040B916171957291F800001120821105050A6AC8B2BC7C9A83C220F6DB7D2ECB41EDF27C1E3E97411BDE06754FD3D1A0F9BB5D0695F1F4B29B5C2683C6E8B03C3CA697E5F34D6AE303D1D1F2F7DD0D4ABB59A0797D8C0685E7A00028EC26832A960B28EC2683BE6050780EBA97D96C17",
+    /* UCS-2 */
+    "07919730071111F10414D04937BD2C7797E9D3E614000811309291024061080442043504410442",
+    /* GSM7, and the same as 8-bit data */
+    "07912143658709F1040B918100551512F20000111010214365000AE8329BFD4697D9EC37",
+    "07912143658709F1040B918100551512F20004111010214365000AE8329BFD4697D9EC37DE",
+    /* DCS with class 0xF1 */
+    "07913306091093F0040485810000F111604231805180A049B7F90D9A1AA5A01668F8769BD3E4B29B9E2EB359A03FC85D06A9C3ED707A0EA2CBC3EE79BB4CA7CBCBA05643617DA7C76990FD4D979741EE77DD5E0ED741ED371D442E83E0E1F9BC0CD281E677D9B84C06C1DF7539E85C9097E520FB9B2E2F83C6EF369C5E064D8D52D0BC2E07DDEF77D7DC2C7799E5A0771D040FCB41F402BB0047BFDD6550B80ECAD966",
+    /* UDH with a non-concatenation element */
+    "07911356131313F64004850120390011609232239180A006080400100201D7327BFD6EB340E2321BF46E83EA7790F59D1E97DBE1341B442F83C465763D3DA797E56537C81D0ECB41AB59CC1693C16031D96C064241E5656838AF03A96230982A269BCD462917C8FA4E8FCBED709A0D7ABBE9F6B0FB5C7683D27350984D4FABC9A0B33C4C4FCF5D20EBFB2D079DCB62793DBD06D9C36E50FB2D4E97D9A0B49B5E96BBCB",
+    /* Concatenated, both parts */
+    "07912160130320F5440B916171056429F5000021405291650569A00500034C0201A9E8F41C949E83C2207B599E07B1DFEE33885E9ED341E4F23C7D7697C920FA1B54C697E5E3F4BC0C6AD7D9F434081E96D341E3303C2C4EB3D3F4BC0B94A483E6E8779D4D06CDD1EF3BA80E0785E7A0B7BB0C6A97E7F3F0B9CC02B9DF7450780EA2DFDF2C50780EA2A3CBA0BA9B5C96B3F369F71954768FDFE4B4FB0C9297E1F2F2BCECA6CF41",
+    "07912160130320F6440B916171056429F5000021405291651569320500034C0202E9E8301D44479741F0B09C3E0785E56590BCCC0ED3CB6410FD0D7ABBCBA0B0FB4D4797E52E10",
+    /* SUBMIT stored by us, UCS-2 */
+    "002100098136397339F70008224F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60597D4F60",
+    /* Status report */
+    "07914356060013F1065A098136397339F7219011700463802190117004638030",
+};
+
+static const gchar *corpus_cdma[] = {
+    /* ASCII */
+    "00000210020207028CE95DCC65800601FC08150003168D3001061024183060800306101004044847",
+    /* Created by us */
+    "00000210020407028CE95DCC6580080D00032000000106102418306080",
+    /* Latin */
+    "00000210020207028CE95DCC65800601FC08390003138D20012741291922E1191AE11A0119A119A1A9B1B9E9534B23AB5323AB232BABAB2B23AB53232BAB53AB200306131023200637080100",
+    "00000210020207028CE95DCC65800601FC081C0003138D20010A40421B0B6B832F9B71080306131023200637080100",
+    /* Unicode */
+    "00000210020207028CE95DCC65800601FC082800031B73F001162052716AB85AA792DBC337C4B7DADA8298B4504294180306131024104528080100",
+};
+
+/* Synthetic texts, encoded by us */
+static const gchar *texts_3gpp[] = {
+    "Hello",
+    /* Extension table characters take two septets each */
+    "Price: 5€ {incl. VAT} [see ~terms~] ^_^ | \\o/",
+    /* Exactly one full part */
+    "0123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890123456789"
+    "012345678901234567890123456789012345678901234567890123456789",
+    /* Three parts */
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog. "
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog. "
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog. "
+    "The quick brown fox jumps over the lazy dog. The quick brown fox jumps over the lazy dog.",
+    /* UCS-2, single and concatenated */
+    "Да здравствует король, детка!",
+    "Съешь же ещё этих мягких французских булок, да выпей чаю. "
+    "Съешь же ещё этих мягких французских булок, да выпей чаю.",
+};
+
+static const gchar *texts_cdma[] = {
+    "Hello",
+    "The quick brown fox jumps over the lazy dog 0123456789",
+    "Orange España",
+    "Съешь же ещё этих мягких французских булок",
+};
+
+static GByteArray *
+hex_to_array (const gchar *hex)
+{
+    GByteArray *array;
+    gchar *bin;
+    gsize len = 0;
+
+    bin = mm_utils_hexstr2bin (hex, &len);
+    g_assert (bin != NULL);
+    array = g_byte_array_sized_new (len);
+    g_byte_array_append (array, (const guint8 *) bin, len);
+    g_free (bin);
+    return array;
+}
+
+static void
+append_3gpp_submit_part (GPtrArray *pdus,
+                         MMSmsPart *part)
+{
+    GError *error = NULL;
+    guint8 *pdu;
+    guint len = 0;
+    guint msgstart = 0;
+
+    mm_sms_part_set_number (part, "+15555551234");
+    mm_sms_part_set_validity_relative (part, 5);
+    pdu = mm_sms_part_3gpp_get_submit_pdu (part, &len, &msgstart, &error);
+    g_assert_no_error (error);
+    g_assert (pdu != NULL);
+    g_ptr_array_add (pdus, g_byte_array_new_take (pdu, len));
+    mm_sms_part_free (part);
+}
+
+/* Same as MMBaseSms does when sending */
+static void
+append_3gpp_submit_pdus (GPtrArray *pdus,
+                         const gchar *text,
+                         const guint8 *data,
+                         gsize data_len)
+{
+    MMSmsEncoding encoding = MM_SMS_ENCODING_UNKNOWN;
+    gchar **split_text = NULL;
+    GByteArray **split_data = NULL;
+    guint n_parts;
+    guint i;
+
+    if (text) {
+        split_text = mm_sms_part_3gpp_util_split_text (text, &encoding);
+        g_assert (split_text != NULL);
+        n_parts = g_strv_length (split_text);
+    } else {
+        encoding = MM_SMS_ENCODING_8BIT;
+        split_data = mm_sms_part_3gpp_util_split_data (data, data_len);
+        for (n_parts = 0; split_data[n_parts]; n_parts++);
+    }
+
+    for (i = 0; i < n_parts; i++) {
+        MMSmsPart *part;
+
+        part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_SUBMIT);
+        if (split_text)
+            mm_sms_part_take_text (part, split_text[i]);
+        else
+            mm_sms_part_take_data (part, split_data[i]);
+        mm_sms_part_set_encoding (part, encoding);
+        if (n_parts > 1) {
+            mm_sms_part_set_concat_reference (part, 0x42);
+            mm_sms_part_set_concat_sequence (part, i + 1);
+            mm_sms_part_set_concat_max (part, n_parts);
+        }
+        append_3gpp_submit_part (pdus, part);
+    }
+
+    /* Contents were taken by the parts */
+    g_free (split_text);
+    g_free (split_data);
+}
+
+static GPtrArray *
+build_corpus_3gpp (void)
+{
+    GPtrArray *pdus;
+    guint8 data[300];
+    guint i;
+
+    pdus = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+    for (i = 0; i < G_N_ELEMENTS (corpus_3gpp); i++)
+        g_ptr_array_add (pdus, hex_to_array (corpus_3gpp[i]));
+    for (i = 0; i < G_N_ELEMENTS (texts_3gpp); i++)
+        append_3gpp_submit_pdus (pdus, texts_3gpp[i], NULL, 0);
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = i;
+    append_3gpp_submit_pdus (pdus, NULL, data, sizeof (data));
+    return pdus;
+}
+
+static GByteArray *
+build_cdma_submit_pdu (const gchar *text)
+{
+    MMSmsPart *part;
+    GError *error = NULL;
+    guint8 *pdu;
+    guint len = 0;
+
+    part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_CDMA_SUBMIT);
+    mm_sms_part_set_cdma_teleservice_id (part, MM_SMS_CDMA_TELESERVICE_ID_WMT);
+    mm_sms_part_set_number (part, "3305773196");
+    mm_sms_part_set_text (part, text);
+    pdu = mm_sms_part_cdma_get_submit_pdu (part, &len, &error);
+    mm_sms_part_free (part);
+    g_assert_no_error (error);
+    g_assert (pdu != NULL);
+    return g_byte_array_new_take (pdu, len);
+}
+
+static GPtrArray *
+build_corpus_cdma (void)
+{
+    GPtrArray *pdus;
+    guint i;
+
+    pdus = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+    for (i = 0; i < G_N_ELEMENTS (corpus_cdma); i++)
+        g_ptr_array_add (pdus, hex_to_array (corpus_cdma[i]));
+    for (i = 0; i < G_N_ELEMENTS (texts_cdma); i++)
+        g_ptr_array_add (pdus, build_cdma_submit_pdu (texts_cdma[i]));
+    return pdus;
+}
+
+/************************************************************/
+/* Allocation counting */
+
+static guint64 n_allocs;
+static gboolean n_allocs_available;
+
+static gpointer
+counting_malloc (gsize n_bytes)
+{
+    n_allocs++;
+    return malloc (n_bytes);
+}
+
+static gpointer
+counting_realloc (gpointer mem,
+                  gsize n_bytes)
+{
+    if (!mem)
+        n_allocs++;
+    return realloc (mem, n_bytes);
+}
+
+static gpointer
+counting_calloc (gsize n_blocks,
+                 gsize n_block_bytes)
+{
+    n_allocs++;
+    return calloc (n_blocks, n_block_bytes);
+}
+
+static GMemVTable counting_vtable = {
+    counting_malloc,
+    counting_realloc,
+    free,
+    counting_calloc,
+    NULL,
+    NULL
+};
+
+static void
+setup_alloc_counting (void)
+{
+    guint64 before;
+
+    /* Newer GLib versions ignore custom vtables; only g_malloc() and
+     * friends are counted, not GSlice allocations */
+    g_mem_set_vtable (&counting_vtable);
+    before = n_allocs;
+    g_free (g_malloc (1));
+    n_allocs_available = (n_allocs > before);
+}
+
+static gchar *
+allocs_per_part_to_string (guint64 allocs,
+                           guint64 n_parts)
+{
+    if (!n_allocs_available)
+        return g_strdup ("n/a");
+    return g_strdup_printf ("%.1f", (gdouble) allocs / n_parts);
+}
+
+/************************************************************/
+
+static void
+test_corpus_3gpp (void)
+{
+    GPtrArray *pdus;
+    guint i;
+
+    pdus = build_corpus_3gpp ();
+    for (i = 0; i < pdus->len; i++) {
+        GByteArray *pdu = g_ptr_array_index (pdus, i);
+        MMSmsPart *part;
+        GError *error = NULL;
+
+        part = mm_sms_part_3gpp_new_from_binary_pdu (0, pdu->data, pdu->len, &error);
+        g_assert_no_error (error);
+        g_assert (part != NULL);
+        mm_sms_part_free (part);
+    }
+    g_ptr_array_unref (pdus);
+}
+
+static void
+test_corpus_cdma (void)
+{
+    GPtrArray *pdus;
+    guint i;
+
+    pdus = build_corpus_cdma ();
+    for (i = 0; i < pdus->len; i++) {
+        GByteArray *pdu = g_ptr_array_index (pdus, i);
+        MMSmsPart *part;
+        GError *error = NULL;
+
+        part = mm_sms_part_cdma_new_from_binary_pdu (0, pdu->data, pdu->len, &error);
+        g_assert_no_error (error);
+        g_assert (part != NULL);
+        mm_sms_part_free (part);
+    }
+    g_ptr_array_unref (pdus);
+}
+
+/************************************************************/
+
+static void
+common_test_roundtrip_3gpp (const gchar *text,
+                            const guint8 *data,
+                            gsize data_len)
+{
+    GPtrArray *pdus;
+    GPtrArray *parts;
+    GString *decoded_text;
+    GByteArray *decoded_data;
+    guint i;
+
+    pdus = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+    append_3gpp_submit_pdus (pdus, text, data, data_len);
+
+    /* Decode all parts, which must come in order */
+    parts = g_ptr_array_new_with_free_func ((GDestroyNotify) mm_sms_part_free);
+    for (i = 0; i < pdus->len; i++) {
+        GByteArray *pdu = g_ptr_array_index (pdus, i);
+        MMSmsPart *part;
+        GError *error = NULL;
+
+        part = mm_sms_part_3gpp_new_from_binary_pdu (0, pdu->data, pdu->len, &error);
+        g_assert_no_error (error);
+        g_assert (part != NULL);
+        g_assert_cmpstr (mm_sms_part_get_number (part), ==, "+15555551234");
+        if (pdus->len > 1) {
+            g_assert (mm_sms_part_should_concat (part));
+            g_assert_cmpuint (mm_sms_part_get_concat_reference (part), ==, 0x42);
+            g_assert_cmpuint (mm_sms_part_get_concat_max (part), ==, pdus->len);
+            g_assert_cmpuint (mm_sms_part_get_concat_sequence (part), ==, i + 1);
+        }
+        g_ptr_array_add (parts, part);
+    }
+
+    decoded_text = g_string_new (NULL);
+    decoded_data = g_byte_array_new ();
+    for (i = 0; i < parts->len; i++) {
+        MMSmsPart *part = g_ptr_array_index (parts, i);
+
+        if (text)
+            g_string_append (decoded_text, mm_sms_part_get_text (part));
+        else
+            g_byte_array_append (decoded_data,
+                                 mm_sms_part_get_data (part)->data,
+                                 mm_sms_part_get_data (part)->len);
+    }
+
+    if (text)
+        g_assert_cmpstr (decoded_text->str, ==, text);
+    else {
+        g_assert_cmpuint (decoded_data->len, ==, data_len);
+        g_assert (memcmp (decoded_data->data, data, data_len) == 0);
+    }
+
+    g_string_free (decoded_text, TRUE);
+    g_byte_array_unref (decoded_data);
+    g_ptr_array_unref (parts);
+    g_ptr_array_unref (pdus);
+}
+
+static void
+test_roundtrip_3gpp (void)
+{
+    guint8 data[300];
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (texts_3gpp); i++)
+        common_test_roundtrip_3gpp (texts_3gpp[i], NULL, 0);
+
+    for (i = 0; i < sizeof (data); i++)
+        data[i] = i;
+    common_test_roundtrip_3gpp (NULL, data, 100);
+    common_test_roundtrip_3gpp (NULL, data, sizeof (data));
+}
+
+static void
+test_roundtrip_cdma (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (texts_cdma); i++) {
+        GByteArray *pdu;
+        MMSmsPart *part;
+        GError *error = NULL;
+
+        pdu = build_cdma_submit_pdu (texts_cdma[i]);
+        part = mm_sms_part_cdma_new_from_binary_pdu (0, pdu->data, pdu->len, &error);
+        g_assert_no_error (error);
+        g_assert (part != NULL);
+        g_assert_cmpstr (mm_sms_part_get_number (part), ==, "3305773196");
+        g_assert_cmpstr (mm_sms_part_get_text (part), ==, texts_cdma[i]);
+        mm_sms_part_free (part);
+        g_byte_array_unref (pdu);
+    }
+}
+
+/************************************************************/
+/* Runs the fuzzing entry point over mutations of the corpus: every single
+ * bit flip and every truncation. Anything more elaborate is left to the
+ * libFuzzer target. */
+
+static void
+fuzz_one (FuzzSmsPartTarget target,
+          const guint8 *data,
+          gsize size)
+{
+    guint8 *input;
+
+    input = g_malloc (size + 1);
+    input[0] = target;
+    memcpy (&input[1], data, size);
+    LLVMFuzzerTestOneInput (input, size + 1);
+    g_free (input);
+}
+
+static void
+fuzz_mutations (FuzzSmsPartTarget target,
+                const GByteArray *pdu)
+{
+    guint8 *mutated;
+    gsize i;
+
+    mutated = g_malloc (pdu->len + 1);
+    memcpy (mutated, pdu->data, pdu->len);
+    for (i = 0; i < pdu->len * 8; i++) {
+        mutated[i / 8] ^= (1 << (i % 8));
+        fuzz_one (target, mutated, pdu->len);
+        mutated[i / 8] ^= (1 << (i % 8));
+    }
+    g_free (mutated);
+
+    for (i = 0; i <= pdu->len; i++)
+        fuzz_one (target, pdu->data, i);
+}
+
+static void
+quiet_log_handler (const gchar *log_domain,
+                   GLogLevelFlags log_level,
+                   const gchar *message,
+                   gpointer user_data)
+{
+}
+
+static gboolean
+warnings_not_fatal (const gchar *log_domain,
+                    GLogLevelFlags log_level,
+                    const gchar *message,
+                    gpointer user_data)
+{
+    return !(log_level & G_LOG_LEVEL_WARNING);
+}
+
+static void
+test_mutations (void)
+{
+    GPtrArray *pdus;
+    guint handler_id;
+    guint i;
+
+    /* Texts which can't be converted are reported with warnings; those are
+     * expected here, failed preconditions are still fatal */
+    handler_id = g_log_set_handler (NULL, G_LOG_LEVEL_WARNING, quiet_log_handler, NULL);
+    g_test_log_set_fatal_handler (warnings_not_fatal, NULL);
+
+    pdus = build_corpus_3gpp ();
+    for (i = 0; i < pdus->len; i++) {
+        GByteArray *pdu = g_ptr_array_index (pdus, i);
+        GByteArray *hex;
+        gchar *str;
+
+        fuzz_mutations (FUZZ_SMS_PART_3GPP_PDU, pdu);
+        fuzz_mutations (FUZZ_SMS_PART_GSM7, pdu);
+
+        str = mm_utils_bin2hexstr (pdu->data, pdu->len);
+        hex = g_byte_array_new_take ((guint8 *) str, strlen (str));
+        fuzz_mutations (FUZZ_SMS_PART_3GPP_HEX_PDU, hex);
+        g_byte_array_unref (hex);
+    }
+    g_ptr_array_unref (pdus);
+
+    pdus = build_corpus_cdma ();
+    for (i = 0; i < pdus->len; i++)
+        fuzz_mutations (FUZZ_SMS_PART_CDMA_PDU, g_ptr_array_index (pdus, i));
+    g_ptr_array_unref (pdus);
+
+    g_test_log_set_fatal_handler (NULL, NULL);
+    g_log_remove_handler (NULL, handler_id);
+}
+
+/************************************************************/
+/* Benchmarks, run with -m perf */
+
+typedef MMSmsPart *(* DecodeFunc) (guint index,
+                                   const guint8 *pdu,
+                                   gsize pdu_len,
+                                   GError **error);
+
+static void
+common_perf_decode (const gchar *name,
+                    GPtrArray *pdus,
+                    DecodeFunc decode)
+{
+    guint64 allocs;
+    guint64 n_parts;
+    gdouble time;
+    gchar *allocs_str;
+    guint i;
+    guint j;
+
+    allocs = n_allocs;
+    n_parts = 0;
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        for (j = 0; j < pdus->len; j++) {
+            GByteArray *pdu = g_ptr_array_index (pdus, j);
+
+            mm_sms_part_free (decode (0, pdu->data, pdu->len, NULL));
+            n_parts++;
+        }
+    }
+    time = g_test_timer_elapsed ();
+    allocs = n_allocs - allocs;
+
+    allocs_str = allocs_per_part_to_string (allocs, n_parts);
+    g_test_maximized_result (n_parts / time, "%s decode: %.0f parts/s, %s allocations/part",
+                             name, n_parts / time, allocs_str);
+    g_free (allocs_str);
+}
+
+static void
+test_perf_decode_3gpp (void)
+{
+    GPtrArray *pdus;
+
+    pdus = build_corpus_3gpp ();
+    common_perf_decode ("3GPP", pdus, mm_sms_part_3gpp_new_from_binary_pdu);
+    g_ptr_array_unref (pdus);
+}
+
+static void
+test_perf_decode_cdma (void)
+{
+    GPtrArray *pdus;
+
+    pdus = build_corpus_cdma ();
+    common_perf_decode ("CDMA", pdus, mm_sms_part_cdma_new_from_binary_pdu);
+    g_ptr_array_unref (pdus);
+}
+
+static void
+test_perf_encode_3gpp (void)
+{
+    GPtrArray *pdus;
+    guint64 allocs;
+    gdouble time;
+    gchar *allocs_str;
+    guint i;
+    guint j;
+
+    /* Splitting included, as done when sending */
+    pdus = g_ptr_array_new_with_free_func ((GDestroyNotify) g_byte_array_unref);
+    allocs = n_allocs;
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        for (j = 0; j < G_N_ELEMENTS (texts_3gpp); j++)
+            append_3gpp_submit_pdus (pdus, texts_3gpp[j], NULL, 0);
+        g_ptr_array_set_size (pdus, 0);
+    }
+    time = g_test_timer_elapsed ();
+    allocs = n_allocs - allocs;
+
+    /* Number of parts per iteration */
+    for (j = 0; j < G_N_ELEMENTS (texts_3gpp); j++)
+        append_3gpp_submit_pdus (pdus, texts_3gpp[j], NULL, 0);
+
+    allocs_str = allocs_per_part_to_string (allocs, (guint64) pdus->len * PERF_ITERATIONS);
+    g_test_maximized_result (pdus->len * PERF_ITERATIONS / time, "3GPP encode: %.0f parts/s, %s allocations/part",
+                             pdus->len * PERF_ITERATIONS / time, allocs_str);
+    g_free (allocs_str);
+    g_ptr_array_unref (pdus);
+}
+
+static void
+test_perf_encode_cdma (void)
+{
+    guint64 allocs;
+    gdouble time;
+    gchar *allocs_str;
+    guint i;
+    guint j;
+
+    allocs = n_allocs;
+    g_test_timer_start ();
+    for (i = 0; i < PERF_ITERATIONS; i++) {
+        for (j = 0; j < G_N_ELEMENTS (texts_cdma); j++)
+            g_byte_array_unref (build_cdma_submit_pdu (texts_cdma[j]));
+    }
+    time = g_test_timer_elapsed ();
+    allocs = n_allocs - allocs;
+
+    allocs_str = allocs_per_part_to_string (allocs, (guint64) G_N_ELEMENTS (texts_cdma) * PERF_ITERATIONS);
+    g_test_maximized_result (G_N_ELEMENTS (texts_cdma) * PERF_ITERATIONS / time, "CDMA encode: %.0f parts/s, %s allocations/part",
+                             G_N_ELEMENTS (texts_cdma) * PERF_ITERATIONS / time, allocs_str);
+    g_free (allocs_str);
+}
+
+/************************************************************/
+
+void
+_mm_log (const char *loc,
+         const char *func,
+         guint32 level,
+         const char *fmt,
+         ...)
+{
+#if defined ENABLE_TEST_MESSAGE_TRACES
+    /* Dummy log function */
+    va_list args;
+    gchar *msg;
+
+    va_start (args, fmt);
+    msg = g_strdup_vprintf (fmt, args);
+    va_end (args);
+    g_print ("%s\n", msg);
+    g_free (msg);
+#endif
+}
+
+int main (int argc, char **argv)
+{
+    /* Before anything gets allocated */
+    setup_alloc_counting ();
+
+    setlocale (LC_ALL, "");
+
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/SMS/Codecs/corpus-3gpp", test_corpus_3gpp);
+    g_test_add_func ("/MM/SMS/Codecs/corpus-cdma", test_corpus_cdma);
+    g_test_add_func ("/MM/SMS/Codecs/roundtrip-3gpp", test_roundtrip_3gpp);
+    g_test_add_func ("/MM/SMS/Codecs/roundtrip-cdma", test_roundtrip_cdma);
+    g_test_add_func ("/MM/SMS/Codecs/mutations", test_mutations);
+
+    /* Parts per second and allocations per part */
+    if (g_test_perf ()) {
+        g_test_add_func ("/MM/SMS/Codecs/perf/decode-3gpp", test_perf_decode_3gpp);
+        g_test_add_func ("/MM/SMS/Codecs/perf/decode-cdma", test_perf_decode_cdma);
+        g_test_add_func ("/MM/SMS/Codecs/perf/encode-3gpp", test_perf_encode_3gpp);
+        g_test_add_func ("/MM/SMS/Codecs/perf/encode-cdma", test_perf_encode_cdma);
+    }
+
+    return g_test_run ();
+}
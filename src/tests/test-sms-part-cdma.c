@@ -503,6 +503,73 @@ test_create_pdu_text_unicode_encoding (void)
                             expected, sizeof (expected));
 }
 
+static void
+common_test_create_and_parse (const gchar *text)
+{
+    MMSmsPart *part;
+    guint8 *pdu;
+    guint len = 0;
+    GError *error = NULL;
+
+    part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_CDMA_SUBMIT);
+    mm_sms_part_set_cdma_teleservice_id (part, MM_SMS_CDMA_TELESERVICE_ID_WMT);
+    mm_sms_part_set_number (part, "3305773196");
+    mm_sms_part_set_text (part, text);
+
+    pdu = mm_sms_part_cdma_get_submit_pdu (part, &len, &error);
+    mm_sms_part_free (part);
+    g_assert_no_error (error);
+    g_assert (pdu != NULL);
+
+    trace_pdu (pdu, len);
+
+    common_test_part_from_pdu (pdu, len,
+                               MM_SMS_CDMA_TELESERVICE_ID_WMT,
+                               MM_SMS_CDMA_SERVICE_CATEGORY_UNKNOWN,
+                               "3305773196",
+                               0,
+                               text);
+    g_free (pdu);
+}
+
+static void
+test_create_and_parse_long_texts (void)
+{
+    /* Long enough to go through the multi-field paths of the bitstream
+     * cursors; user data fields are never byte aligned */
+    common_test_create_and_parse ("The quick brown fox jumps over the lazy dog 0123456789");
+    common_test_create_and_parse ("Съешь же ещё этих мягких французских булок");
+}
+
+static void
+test_create_pdu_bearer_data_too_long (void)
+{
+    MMSmsPart *part;
+    GString *text;
+    guint8 *pdu;
+    guint len = 0;
+    GError *error = NULL;
+
+    /* 250 Latin-1 characters, one byte each: fits in the user data, but not
+     * in the 255-byte bearer data along with the message identifier */
+    text = g_string_new ("\xc3\xa9");
+    while (text->len < 251)
+        g_string_append_c (text, 'a');
+
+    part = mm_sms_part_new (0, MM_SMS_PDU_TYPE_CDMA_SUBMIT);
+    mm_sms_part_set_cdma_teleservice_id (part, MM_SMS_CDMA_TELESERVICE_ID_WMT);
+    mm_sms_part_set_number (part, "3305773196");
+    mm_sms_part_set_text (part, text->str);
+
+    pdu = mm_sms_part_cdma_get_submit_pdu (part, &len, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED);
+    g_assert (pdu == NULL);
+
+    g_error_free (error);
+    mm_sms_part_free (part);
+    g_string_free (text, TRUE);
+}
+
 /************************************************************/
 
 void
@@ -544,5 +611,8 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/SMS/CDMA/PDU-Creator/latin-encoding", test_create_pdu_text_latin_encoding);
     g_test_add_func ("/MM/SMS/CDMA/PDU-Creator/unicode-encoding", test_create_pdu_text_unicode_encoding);
 
+    g_test_add_func ("/MM/SMS/CDMA/PDU-Creator/bearer-data-too-long", test_create_pdu_bearer_data_too_long);
+    g_test_add_func ("/MM/SMS/CDMA/PDU-Creator-Parser/long-texts", test_create_and_parse_long_texts);
+
     return g_test_run ();
 }